@@ -27,9 +27,9 @@
 #include "git-version.h"
 
 #ifdef _WIN32
-#define FALLBACK_CACHE_PATH  "C:/babl-fishes.txt"
+#define FALLBACK_CACHE_DIR  "C:"
 #else
-#define FALLBACK_CACHE_PATH  "/tmp/babl-fishes.txt"
+#define FALLBACK_CACHE_DIR  "/tmp"
 #endif
 
 static int
@@ -74,25 +74,25 @@ mk_ancestry (const char *path)
 }
 
 static const char *
-fish_cache_path (void)
+cache_file_path (char       *path,
+                 size_t      size,
+                 const char *name)
 {
   struct stat stat_buf;
-  static char path[4096];
 
-  strncpy (path, FALLBACK_CACHE_PATH, 4096);
-  path[sizeof (path) - 1] = '\0';
+  snprintf (path, size, "%s/%s.txt", FALLBACK_CACHE_DIR, name);
 #ifndef _WIN32
   if (getenv ("XDG_CACHE_HOME"))
-    snprintf (path, sizeof (path), "%s/babl/babl-fishes", getenv("XDG_CACHE_HOME"));
+    snprintf (path, size, "%s/babl/%s", getenv("XDG_CACHE_HOME"), name);
   else if (getenv ("HOME"))
-    snprintf (path, sizeof (path), "%s/.cache/babl/babl-fishes", getenv("HOME"));
+    snprintf (path, size, "%s/.cache/babl/%s", getenv("HOME"), name);
 #else
 {
   char win32path[4096];
   if (SHGetFolderPathA (NULL, CSIDL_LOCAL_APPDATA, NULL, SHGFP_TYPE_CURRENT, win32path) == S_OK)
-    snprintf (path, sizeof (path), "%s\\%s\\babl-fishes.txt", win32path, BABL_LIBRARY);
+    snprintf (path, size, "%s\\%s\\%s.txt", win32path, BABL_LIBRARY, name);
   else if (getenv ("TEMP"))
-    snprintf (path, sizeof (path), "%s\\babl-fishes.txt", getenv("TEMP"));
+    snprintf (path, size, "%s\\%s.txt", getenv("TEMP"), name);
 }
 #endif
 
@@ -100,11 +100,30 @@ fish_cache_path (void)
     return path;
 
   if (mk_ancestry (path) != 0)
-    return FALLBACK_CACHE_PATH;
+    snprintf (path, size, "%s/%s.txt", FALLBACK_CACHE_DIR, name);
 
   return path;
 }
 
+static const char *
+fish_cache_path (void)
+{
+  static char path[4096];
+
+  return cache_file_path (path, sizeof (path), "babl-fishes");
+}
+
+/* the default location of the conversion cost profile written by
+ * babl-calibrate, next to the fish cache.
+ */
+const char *
+_babl_cost_profile_default_path (void)
+{
+  static char path[4096];
+
+  return cache_file_path (path, sizeof (path), "babl-costs");
+}
+
 static char *
 babl_fish_serialize (Babl *fish, char *dest, int n)
 {
@@ -174,6 +193,14 @@ cache_header (void)
   else
     snprintf (buf, sizeof (buf), "#%s BABL_PATH_LENGTH=%d BABL_TOLERANCE=%f",
              BABL_GIT_VERSION, _babl_max_path_len (), _babl_legal_error ());
+  /* paths picked with measured and with calibrated costs do not mix */
+  if (_babl_cost_profile_loaded ())
+    strncat (buf, " BABL_COST_PROFILE", sizeof (buf) - strlen (buf) - 1);
+  /* nor do paths through conversions of other instruction set tiers,
+   * see BABL_CPU_ACCEL
+   */
+  snprintf (buf + strlen (buf), sizeof (buf) - strlen (buf), " accel=%x",
+            (unsigned int) babl_cpu_accel_get_support ());
   return buf;
 }
 
@@ -256,11 +283,13 @@ babl_init_db (void)
         case '-': /* finalize */
           if (babl)
           {
-            if ((babl->fish.pixels) == (tim % 100))
+            if (!_babl_cost_profile_loaded () &&
+                (babl->fish.pixels) == (tim % 100))
             {
               /* 1% chance of individual cached conversions being dropped -
                * making sure mis-measured conversions do not
-                 stick around for a long time*/
+                 stick around for a long time, not needed when the costs
+                 come from a calibrated profile */
               babl_free (babl);
             }
             else
@@ -306,7 +335,7 @@ babl_init_db (void)
                * does not exist.
                */
               const char *name = "X"; /* name does not matter */
-              babl = babl_calloc (1, sizeof (BablFish) + strlen (name) + 1);
+              babl = babl_arena_calloc (BABL_FISH, sizeof (BablFish) + strlen (name) + 1);
 
               babl->class_type       = BABL_FISH;
               babl->instance.id      = babl_fish_get_id (from_format,
@@ -323,8 +352,8 @@ babl_init_db (void)
             }
             else
             {
-              babl = babl_calloc (1, sizeof (BablFishPath) +
-                                  strlen (name) + 1);
+              babl = babl_arena_calloc (BABL_FISH_PATH, sizeof (BablFishPath) +
+                                        strlen (name) + 1);
               babl_set_destructor (babl, _babl_fish_path_destroy);
 
               babl->class_type     = BABL_FISH_PATH;
@@ -0,0 +1,208 @@
+/* babl - dynamically extendable universal pixel fish library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* a BablColorTransform is a fish compiled for converting one pixel at a
+ * time; the conversions babl_process () would make are resolved up front
+ * into a list of steps, leaving out the lookups, allocations and locking
+ * the reference and path dispatch do for each call, while keeping the
+ * same conversions and thus the same results
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <stdint.h>
+#include "babl-internal.h"
+
+#define SCRATCH_SIZE (BABL_MAX_COMPONENTS * sizeof (double))
+
+struct _BablColorTransform
+{
+  const Babl    *fish;
+  int            count;
+  BablColorStep  steps[];
+};
+
+static int
+compile_path (BablList      *path,
+              BablColorStep *steps)
+{
+  int conversions = babl_list_size (path);
+  int i;
+
+  if (conversions < 2 || conversions > BABL_COLOR_MAX_STEPS)
+    return 0;
+
+  /* as process_conversion_path_buffered () does, through two scratch
+   * buffers used in turn
+   */
+  for (i = 0; i < conversions; i++)
+    {
+      Babl          *conv = path->items[i];
+      BablColorStep *step = &steps[i];
+
+      if (conv->class_type != BABL_CONVERSION_LINEAR)
+        return 0;
+
+      memset (step, 0, sizeof (BablColorStep));
+      step->kind              = BABL_COLOR_STEP_DISPATCH;
+      step->src               = i == 0 ? BABL_COLOR_SOURCE
+                                       : BABL_COLOR_SCRATCH + (i - 1) % 2;
+      step->dst               = i == conversions - 1 ? BABL_COLOR_DESTINATION
+                                                     : BABL_COLOR_SCRATCH + i % 2;
+      step->babl              = conv;
+      step->function.dispatch = conv->conversion.dispatch;
+      step->data              = conv->conversion.data;
+    }
+  return conversions;
+}
+
+BablColorTransform *
+babl_color_transform_new (const Babl *babl_fish)
+{
+  BablColorTransform *transform;
+  BablColorStep      *steps;
+  BablList           *path;
+  int                 count = 0;
+
+  babl_assert (babl_fish && BABL_IS_BABL (babl_fish));
+
+  steps = babl_malloc (sizeof (BablColorStep) * BABL_COLOR_MAX_STEPS);
+
+  path = _babl_fish_path_conversions (babl_fish);
+  if (path)
+    count = compile_path (path, steps);
+  else if (babl_fish->fish.dispatch == babl_fish_reference_process)
+    count = _babl_fish_reference_compile (babl_fish, steps);
+
+  /* everything else, like single conversions, is called as it is */
+  if (!count)
+    {
+      memset (steps, 0, sizeof (BablColorStep));
+      steps[0].kind              = BABL_COLOR_STEP_DISPATCH;
+      steps[0].src               = BABL_COLOR_SOURCE;
+      steps[0].dst               = BABL_COLOR_DESTINATION;
+      steps[0].babl              = babl_fish;
+      steps[0].function.dispatch = babl_fish->fish.dispatch;
+      steps[0].data              = *babl_fish->fish.data;
+      count = 1;
+    }
+
+  transform = babl_malloc (offsetof (BablColorTransform, steps) +
+                           sizeof (BablColorStep) * count);
+  transform->fish  = babl_fish;
+  transform->count = count;
+  memcpy (transform->steps, steps, sizeof (BablColorStep) * count);
+  babl_free (steps);
+
+  return transform;
+}
+
+void
+babl_color_transform_process (const BablColorTransform *transform,
+                              const void               *source,
+                              void                     *destination)
+{
+  unsigned char  scratch[SCRATCH_SIZE * BABL_COLOR_SCRATCHES + 16];
+  char          *buffers[BABL_COLOR_SCRATCH + BABL_COLOR_SCRATCHES];
+  int            i;
+
+  /* a fish of a single conversion is called directly */
+  if (transform->count == 1)
+    {
+      const BablColorStep *step = &transform->steps[0];
+
+      step->function.dispatch (step->babl, source, destination, 1, step->data);
+      if (_babl_instrument)
+        ((Babl *) transform->fish)->fish.pixels++;
+      return;
+    }
+
+  buffers[BABL_COLOR_SOURCE]      = (char *) source;
+  buffers[BABL_COLOR_DESTINATION] = destination;
+  for (i = 0; i < BABL_COLOR_SCRATCHES; i++)
+    buffers[BABL_COLOR_SCRATCH + i] =
+      (char *) scratch + (16 - ((uintptr_t) scratch) % 16) % 16 +
+      SCRATCH_SIZE * i;
+
+  for (i = 0; i < transform->count; i++)
+    {
+      const BablColorStep *step = &transform->steps[i];
+      const char          *src  = buffers[step->src] + step->src_offset;
+      char                *dst  = buffers[step->dst] + step->dst_offset;
+
+      switch (step->kind)
+        {
+          case BABL_COLOR_STEP_DISPATCH:
+            step->function.dispatch (step->babl, src, dst, 1, step->data);
+            break;
+          case BABL_COLOR_STEP_PLANAR:
+            {
+              const char *src_data[BABL_MAX_COMPONENTS];
+              char       *dst_data[BABL_MAX_COMPONENTS];
+              int         src_pitch[BABL_MAX_COMPONENTS];
+              int         dst_pitch[BABL_MAX_COMPONENTS];
+              int         c;
+
+              for (c = 0; c < step->src_bands; c++)
+                {
+                  src_data[c]  = src + step->size * c;
+                  src_pitch[c] = step->src_pitch;
+                }
+              for (c = 0; c < step->dst_bands; c++)
+                {
+                  dst_data[c]  = dst + step->size * c;
+                  dst_pitch[c] = step->dst_pitch;
+                }
+              step->function.planar (step->babl,
+                                     step->src_bands, src_data, src_pitch,
+                                     step->dst_bands, dst_data, dst_pitch,
+                                     1, step->data);
+            }
+            break;
+          case BABL_COLOR_STEP_PLANE:
+            step->function.plane ((void*)step->babl, src, dst,
+                                  step->src_pitch, step->dst_pitch,
+                                  1, step->data);
+            break;
+          case BABL_COLOR_STEP_FILL:
+            if (step->size == sizeof (double))
+              *(double *) dst = step->value;
+            else
+              *(float *) dst = step->value;
+            break;
+          case BABL_COLOR_STEP_MATRIX:
+            babl_matrix_mul_vector_buf4 (step->matrix, (const double *) src,
+                                         (double *) dst, 1);
+            break;
+          case BABL_COLOR_STEP_MATRIXF:
+            babl_matrix_mul_vectorff_buf4 (step->matrixf, (const float *) src,
+                                           (float *) dst, 1);
+            break;
+        }
+    }
+
+  if (_babl_instrument)
+    ((Babl *) transform->fish)->fish.pixels++;
+}
+
+void
+babl_color_transform_free (BablColorTransform *transform)
+{
+  if (transform)
+    babl_free (transform);
+}
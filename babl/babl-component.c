@@ -34,7 +34,7 @@ component_new (const char *name,
 {
   Babl *babl;
 
-  babl                = babl_malloc (sizeof (BablComponent) + strlen (name) + 1);
+  babl                = babl_arena_calloc (BABL_COMPONENT, sizeof (BablComponent) + strlen (name) + 1);
   babl->instance.name = (char *) babl + sizeof (BablComponent);
   strcpy (babl->instance.name, name);
 
@@ -149,7 +149,7 @@ _conversion_new (const char    *name,
   babl_assert (source->class_type ==
                destination->class_type);
 
-  babl                = babl_malloc (sizeof (BablConversion) + strlen (name) + 1);
+  babl                = babl_arena_calloc (BABL_CONVERSION, sizeof (BablConversion) + strlen (name) + 1);
   babl->instance.name = (char *) babl + sizeof (BablConversion);
   strcpy (babl->instance.name, name);
 
@@ -326,6 +326,7 @@ babl_conversion_new (const void *first_arg,
   Babl          *destination;
   char          *name;
   int            allow_collision = 0;
+  int            accel    = 0;
 
   va_start (varg, first_arg);
   source      = (Babl *) arg;
@@ -352,6 +353,11 @@ babl_conversion_new (const void *first_arg,
         {
           allow_collision = 1;
         }
+
+      else if (!strcmp (arg, "accel"))
+        {
+          accel = va_arg (varg, int);
+        }
       else if (!strcmp (arg, "linear"))
         {
           if (got_func++)
@@ -405,10 +411,14 @@ babl_conversion_new (const void *first_arg,
       type = BABL_CONVERSION_PLANAR;
     }
 
+  if (accel && (babl_cpu_accel_get_support () & accel) != accel)
+    return NULL;
+
   name = (void*) babl_conversion_create_name (source, destination, type, allow_collision);
 
   babl = _conversion_new (name, id, source, destination, linear, plane, planar,
                           user_data, allow_collision);
+  babl->conversion.accel = accel;
 
   /* Since there is not an already registered instance by the required
    * id/name, inserting newly created class into database.
@@ -421,6 +431,67 @@ babl_conversion_new (const void *first_arg,
 }
 
 
+/* conversions registered with "accel" are implementations of the same
+ * conversion for different instruction set tiers, all of them stay in
+ * the from_list of the source. Path search only follows the one with the
+ * lowest measured, or profiled, cost; a higher tier is not necessarily
+ * faster. With BABL_CPU_ACCEL naming a tier the highest one is followed.
+ * Variants less accurate than the one they lose to are kept as well, the
+ * error of the whole path decides about them.
+ */
+int
+babl_conversion_is_superseded (const Babl *conversion)
+{
+  BablConversion *self = (void *) conversion;
+  BablList       *list = self->source->type.from_list;
+  int             seen_self = 0;
+  int             forced;
+  int             tier;
+  int             i;
+
+  if (!self->accel || !list)
+    return 0;
+
+  forced = babl_cpu_accel_is_forced ();
+  tier   = babl_cpu_accel_get_tier (self->accel);
+
+  for (i = 0; i < babl_list_size (list); i++)
+    {
+      BablConversion *other = (void *) list->items[i];
+      int             other_tier;
+      long            cost;
+      long            other_cost;
+
+      if (other == self)
+        {
+          seen_self = 1;
+          continue;
+        }
+      if (BABL (other)->class_type != BABL (self)->class_type ||
+          other->destination != self->destination ||
+          !other->accel)
+        continue;
+
+      other_tier = babl_cpu_accel_get_tier (other->accel);
+      if (forced && other_tier != tier)
+        {
+          if (other_tier > tier)
+            return 1;
+          continue;
+        }
+
+      if (babl_conversion_error (other) > babl_conversion_error (self))
+        continue;
+
+      cost       = babl_conversion_cost (self);
+      other_cost = babl_conversion_cost (other);
+      /* ties go to the variant registered first */
+      if (other_cost < cost || (other_cost == cost && !seen_self))
+        return 1;
+    }
+  return 0;
+}
+
 long
 babl_conversion_cost (BablConversion *conversion)
 {
@@ -437,9 +508,10 @@ babl_conversion_error (BablConversion *conversion)
   Babl *fmt_source;
   Babl *fmt_destination;
 
-  const Babl *fmt_rgba_double = babl_format_with_space ("RGBA double",
+  const Babl *fmt_rgba_double = babl_format_with_space ((void *) _babl_format_rgba_double (),
                                                  conversion->destination->format.space);
   double  error       = 0.0;
+  double  profile_cost;
   long    ticks_start = 0;
   long    ticks_end   = 0;
 
@@ -467,6 +539,20 @@ babl_conversion_error (BablConversion *conversion)
   fmt_source      = BABL (conversion->source);
   fmt_destination = BABL (conversion->destination);
 
+  if (BABL (conversion)->class_type == BABL_CONVERSION_PLANAR &&
+      fmt_source->class_type == BABL_FORMAT &&
+      (fmt_source->format.planar || fmt_destination->format.planar))
+    {
+      /* cannot be run on the linear test buffers, such conversions are
+       * only used by babl_process_planar () and never enter fish paths
+       */
+      conversion->error = 0.0;
+      return 0.0;
+    }
+
+  /* a calibrated cost replaces timing the conversion */
+  profile_cost = _babl_cost_profile_conversion (BABL (conversion));
+
   fish_rgba_to_source      = babl_fish_reference (fmt_rgba_double, fmt_source);
   fish_reference           = babl_fish_reference (fmt_source, fmt_destination);
   fish_destination_to_rgba = babl_fish_reference (fmt_destination, fmt_rgba_double);
@@ -500,10 +586,13 @@ babl_conversion_error (BablConversion *conversion)
 
   if (BABL(conversion)->class_type == BABL_CONVERSION_LINEAR)
   {
-    ticks_start = babl_ticks ();
+    /* with a calibrated cost the run is only needed for the error */
+    if (profile_cost < 0.0)
+      ticks_start = babl_ticks ();
     babl_process (babl_fish_simple (conversion),
                   source, destination, test_pixels);
-    ticks_end = babl_ticks ();
+    if (profile_cost < 0.0)
+      ticks_end = babl_ticks ();
   }
   else
   {
@@ -535,7 +624,10 @@ babl_conversion_error (BablConversion *conversion)
   babl_free (ref_destination_rgba_double);
 
   conversion->error = error;
-  conversion->cost  = ticks_end - ticks_start;
+  if (profile_cost >= 0.0)
+    conversion->cost = profile_cost * test_pixels / 1000.0;
+  else
+    conversion->cost = ticks_end - ticks_start;
 
   return error;
 }
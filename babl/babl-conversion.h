@@ -55,6 +55,7 @@ _BablConversion {
       BablFuncPlanar     planar;
     } function;
   long                   pixels;
+  int                    accel; /* BablCpuAccelFlags the function needs */
 };
 
 
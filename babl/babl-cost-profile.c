@@ -0,0 +1,476 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* Calibrated conversion costs.
+ *
+ * babl-calibrate benchmarks every conversion between formats, and the
+ * reference fishes to and from RGBA double of every format, and writes
+ * the median cost per pixel to a profile tied to the babl version and the
+ * instruction sets of the CPU. When a matching profile is found at
+ * startup, path search and babl_conversion_error () take their costs from
+ * it instead of timing single runs, making the chosen fishes the same from
+ * run to run. Conversions missing from the profile are still timed.
+ *
+ * Conversions created for other spaces than sRGB share the entry of the
+ * sRGB conversion they were made from.
+ */
+
+#include "config.h"
+#include "babl-internal.h"
+#include "babl-ref-pixels.h"
+
+#define CALIBRATE_PIXELS     4096
+#define CALIBRATE_SAMPLES    9
+#define CALIBRATE_MIN_TICKS  250 /* microseconds spent in each sample */
+
+typedef struct
+{
+  char   *name;
+  double  cost;      /* ns per pixel, to RGBA double for references */
+  double  cost_back; /* ns per pixel from RGBA double, references only */
+} BablCostEntry;
+
+typedef struct
+{
+  BablCostEntry *entries;
+  int            count;
+  int            size;
+} BablCostTable;
+
+static BablCostTable conversion_costs;
+static BablCostTable reference_costs;
+static int           profile_loaded = 0;
+
+static const char *
+profile_header (void)
+{
+  static char buf[256];
+
+  snprintf (buf, sizeof (buf), "#babl-cost-profile %i.%i.%i accel=%x",
+            BABL_MAJOR_VERSION, BABL_MINOR_VERSION, BABL_MICRO_VERSION,
+            (unsigned int) babl_cpu_accel_get_support ());
+  return buf;
+}
+
+static const char *
+profile_path (const char *path)
+{
+  if (path)
+    return path;
+  if (getenv ("BABL_COST_PROFILE"))
+    return getenv ("BABL_COST_PROFILE");
+  return _babl_cost_profile_default_path ();
+}
+
+static void
+cost_table_add (BablCostTable *table,
+                const char    *name,
+                double         cost,
+                double         cost_back)
+{
+  if (table->count >= table->size)
+    {
+      table->size    = table->size ? table->size * 2 : 256;
+      table->entries = babl_realloc (table->entries,
+                                     table->size * sizeof (BablCostEntry));
+    }
+  table->entries[table->count].name      = babl_strdup (name);
+  table->entries[table->count].cost      = cost;
+  table->entries[table->count].cost_back = cost_back;
+  table->count++;
+}
+
+static int
+cost_entry_compare (const void *a,
+                    const void *b)
+{
+  return strcmp (((const BablCostEntry *) a)->name,
+                 ((const BablCostEntry *) b)->name);
+}
+
+static const BablCostEntry *
+cost_table_find (const BablCostTable *table,
+                 const char          *name)
+{
+  BablCostEntry key;
+
+  if (!table->count)
+    return NULL;
+  key.name = (char *) name;
+  return bsearch (&key, table->entries, table->count,
+                  sizeof (BablCostEntry), cost_entry_compare);
+}
+
+static void
+cost_table_clear (BablCostTable *table)
+{
+  int i;
+
+  for (i = 0; i < table->count; i++)
+    babl_free (table->entries[i].name);
+  if (table->entries)
+    babl_free (table->entries);
+  memset (table, 0, sizeof (BablCostTable));
+}
+
+void
+babl_cost_profile_load (void)
+{
+  char *contents = NULL;
+  long  length   = -1;
+  char *line;
+  char *linep;
+
+  babl_cost_profile_unload ();
+
+  if (getenv ("BABL_DEBUG_CONVERSIONS"))
+    return;
+
+  _babl_file_get_contents (profile_path (NULL), &contents, &length, NULL);
+  if (!contents)
+    return;
+
+  line = strtok_r (contents, "\n\r", &linep);
+  if (!line || strcmp (line, profile_header ()))
+    {
+      /* written by another version of babl or on another CPU */
+      free (contents);
+      return;
+    }
+
+  for (line = strtok_r (NULL, "\n\r", &linep); line;
+       line = strtok_r (NULL, "\n\r", &linep))
+    {
+      char *fieldp;
+      char *kind  = strtok_r (line, "\t", &fieldp);
+      char *cost  = strtok_r (NULL, "\t", &fieldp);
+      char *field = strtok_r (NULL, "\t", &fieldp);
+
+      if (!kind || !cost || !field)
+        continue;
+
+      if (!strcmp (kind, "conversion"))
+        {
+          cost_table_add (&conversion_costs, field,
+                          babl_parse_double (cost), 0.0);
+        }
+      else if (!strcmp (kind, "reference"))
+        {
+          char *name = strtok_r (NULL, "\t", &fieldp);
+          if (name)
+            cost_table_add (&reference_costs, name,
+                            babl_parse_double (cost),
+                            babl_parse_double (field));
+        }
+    }
+  free (contents);
+
+  qsort (conversion_costs.entries, conversion_costs.count,
+         sizeof (BablCostEntry), cost_entry_compare);
+  qsort (reference_costs.entries, reference_costs.count,
+         sizeof (BablCostEntry), cost_entry_compare);
+  profile_loaded = conversion_costs.count > 0;
+}
+
+void
+babl_cost_profile_unload (void)
+{
+  cost_table_clear (&conversion_costs);
+  cost_table_clear (&reference_costs);
+  profile_loaded = 0;
+}
+
+int
+_babl_cost_profile_loaded (void)
+{
+  return profile_loaded;
+}
+
+static int
+is_calibrated_format (const Babl *format)
+{
+  return format->class_type == BABL_FORMAT &&
+         !format->format.planar &&
+         !babl_format_is_palette (format) &&
+         !babl_format_is_format_n (format);
+}
+
+/* the conversion between sRGB formats that /conversion/ was made from */
+static const Babl *
+srgb_conversion (const Babl *conversion)
+{
+  const Babl *sRGB   = _babl_space_srgb ();
+  const Babl *source = conversion->conversion.source;
+  const Babl *destination = conversion->conversion.destination;
+  const Babl *srgb_source;
+  BablList   *list;
+  int         i;
+
+  if (source->format.space == sRGB && destination->format.space == sRGB)
+    return conversion;
+
+  srgb_source = babl_format_with_space (babl_format_get_encoding (source),
+                                        sRGB);
+  list = srgb_source->format.from_list;
+  if (!list)
+    return NULL;
+
+  for (i = 0; i < babl_list_size (list); i++)
+    {
+      const Babl *candidate = list->items[i];
+
+      if (candidate->class_type == conversion->class_type &&
+          candidate->conversion.function.linear ==
+            conversion->conversion.function.linear &&
+          !strcmp (babl_format_get_encoding (candidate->conversion.destination),
+                   babl_format_get_encoding (destination)))
+        return candidate;
+    }
+  return NULL;
+}
+
+double
+_babl_cost_profile_conversion (const Babl *conversion)
+{
+  const BablCostEntry *entry;
+
+  if (!profile_loaded ||
+      !is_calibrated_format (conversion->conversion.source) ||
+      !is_calibrated_format (conversion->conversion.destination))
+    return -1.0;
+
+  conversion = srgb_conversion (conversion);
+  if (!conversion)
+    return -1.0;
+
+  entry = cost_table_find (&conversion_costs, babl_get_name (conversion));
+  return entry ? entry->cost : -1.0;
+}
+
+int
+_babl_cost_profile_estimate (BablList   *path,
+                             const Babl *source,
+                             const Babl *destination,
+                             double     *path_cost,
+                             double     *ref_cost)
+{
+  const BablCostEntry *to_rgba;
+  const BablCostEntry *from_rgba;
+  double               cost = 0.0;
+  int                  i;
+
+  if (!profile_loaded ||
+      !is_calibrated_format (source) ||
+      !is_calibrated_format (destination))
+    return 0;
+
+  /* the reference fish goes through RGBA double */
+  to_rgba   = cost_table_find (&reference_costs,
+                               babl_format_get_encoding (source));
+  from_rgba = cost_table_find (&reference_costs,
+                               babl_format_get_encoding (destination));
+  if (!to_rgba || !from_rgba)
+    return 0;
+
+  for (i = 0; i < babl_list_size (path); i++)
+    {
+      double step = _babl_cost_profile_conversion (path->items[i]);
+      if (step < 0.0)
+        return 0;
+      cost += step;
+    }
+
+  *path_cost = cost;
+  *ref_cost  = to_rgba->cost + from_rgba->cost_back;
+  return 1;
+}
+
+
+typedef struct
+{
+  FILE   *file;
+  double *test_pixels; /* RGBA double */
+  void   *source;
+  void   *destination;
+  int     count;
+} Calibration;
+
+static int
+compare_ticks (const void *a,
+               const void *b)
+{
+  long ta = *(const long *) a;
+  long tb = *(const long *) b;
+
+  return (ta > tb) - (ta < tb);
+}
+
+/* median ns per pixel of running /babl/, a conversion or a fish, over
+ * CALIBRATE_SAMPLES samples long enough for babl_ticks () to resolve.
+ */
+static double
+calibrate_measure (const Babl *babl,
+                   const void *source,
+                   void       *destination)
+{
+  long samples[CALIBRATE_SAMPLES];
+  long repeats = 1;
+  long ticks;
+  long r;
+  int  i;
+
+  for (;;)
+    {
+      ticks = babl_ticks ();
+      for (r = 0; r < repeats; r++)
+        {
+          if (babl->class_type >= BABL_FISH)
+            babl_process (babl, source, destination, CALIBRATE_PIXELS);
+          else
+            babl_conversion_process (babl, source, destination,
+                                     CALIBRATE_PIXELS);
+        }
+      ticks = babl_ticks () - ticks;
+      if (ticks >= CALIBRATE_MIN_TICKS || repeats >= (1 << 20))
+        break;
+      repeats *= 2;
+    }
+
+  for (i = 0; i < CALIBRATE_SAMPLES; i++)
+    {
+      ticks = babl_ticks ();
+      for (r = 0; r < repeats; r++)
+        {
+          if (babl->class_type >= BABL_FISH)
+            babl_process (babl, source, destination, CALIBRATE_PIXELS);
+          else
+            babl_conversion_process (babl, source, destination,
+                                     CALIBRATE_PIXELS);
+        }
+      samples[i] = babl_ticks () - ticks;
+    }
+
+  qsort (samples, CALIBRATE_SAMPLES, sizeof (long), compare_ticks);
+  return samples[CALIBRATE_SAMPLES / 2] * 1000.0 /
+         ((double) repeats * CALIBRATE_PIXELS);
+}
+
+/* fills the source buffer with the test pixels converted to /format/ */
+static void
+calibrate_source (Calibration *c,
+                  const Babl  *format)
+{
+  const Babl *rgba = babl_format_with_space ((void *) _babl_format_rgba_double (),
+                                             format->format.space);
+
+  babl_process (babl_fish_reference (rgba, format),
+                c->test_pixels, c->source, CALIBRATE_PIXELS);
+}
+
+static int
+calibrate_conversion (Babl *babl,
+                      void *data)
+{
+  Calibration *c      = data;
+  const Babl  *source = babl->conversion.source;
+  const Babl  *sRGB   = _babl_space_srgb ();
+
+  /* like in babl_conversion_error (), only linear conversions are timed */
+  if (babl->class_type != BABL_CONVERSION_LINEAR ||
+      !is_calibrated_format (source) ||
+      !is_calibrated_format (babl->conversion.destination) ||
+      source->format.space != sRGB ||
+      babl->conversion.destination->format.space != sRGB)
+    return 0;
+
+  calibrate_source (c, source);
+  fprintf (c->file, "conversion\t%f\t%s\n",
+           calibrate_measure (babl, c->source, c->destination),
+           babl_get_name (babl));
+  c->count++;
+  return 0;
+}
+
+static int
+calibrate_reference (Babl *babl,
+                     void *data)
+{
+  Calibration *c = data;
+  const Babl  *rgba;
+  double       to_rgba;
+  double       from_rgba;
+
+  if (!is_calibrated_format (babl) ||
+      babl->format.space != _babl_space_srgb ())
+    return 0;
+
+  rgba = babl_format_with_space ((void *) _babl_format_rgba_double (), babl->format.space);
+
+  calibrate_source (c, babl);
+  to_rgba = calibrate_measure (babl_fish_reference (babl, rgba),
+                               c->source, c->destination);
+  from_rgba = calibrate_measure (babl_fish_reference (rgba, babl),
+                                 c->test_pixels, c->destination);
+
+  fprintf (c->file, "reference\t%f\t%f\t%s\n", to_rgba, from_rgba,
+           babl_format_get_encoding (babl));
+  c->count++;
+  return 0;
+}
+
+int
+babl_cost_profile_calibrate (const char *path)
+{
+  const double *test_pixels = babl_get_path_test_pixels ();
+  int           n_test      = babl_get_num_path_test_pixels ();
+  char          tmp_path[4096];
+  Calibration   c;
+  int           i;
+
+  path = profile_path (path);
+  snprintf (tmp_path, sizeof (tmp_path), "%s~", path);
+
+  memset (&c, 0, sizeof (c));
+  c.file = fopen (tmp_path, "w");
+  if (!c.file)
+    return -1;
+
+  /* room for the widest formats */
+  c.test_pixels = babl_malloc (CALIBRATE_PIXELS * 4 * sizeof (double));
+  c.source      = babl_calloc (CALIBRATE_PIXELS, BABL_MAX_COMPONENTS * sizeof (double));
+  c.destination = babl_calloc (CALIBRATE_PIXELS, BABL_MAX_COMPONENTS * sizeof (double));
+  for (i = 0; i < CALIBRATE_PIXELS; i++)
+    memcpy (&c.test_pixels[i * 4], &test_pixels[(i % n_test) * 4],
+            4 * sizeof (double));
+
+  fprintf (c.file, "%s\n", profile_header ());
+  babl_conversion_class_for_each (calibrate_conversion, &c);
+  babl_format_class_for_each (calibrate_reference, &c);
+  fclose (c.file);
+
+  babl_free (c.test_pixels);
+  babl_free (c.source);
+  babl_free (c.destination);
+
+#ifdef _WIN32
+  remove (path);
+#endif
+  if (rename (tmp_path, path))
+    return -1;
+  return c.count;
+}
@@ -28,11 +28,13 @@
  */
 
 #include "config.h"
+#include <stdlib.h>
 #include <string.h>
 #include <signal.h>
 #include <setjmp.h>
 
 #include "babl-cpuaccel.h"
+#include "babl-vector.h"
 
 typedef unsigned int gboolean;
 typedef unsigned int guint32;
@@ -61,6 +63,99 @@ babl_cpu_accel_get_support (void)
   return use_cpu_accel ? cpu_accel () : BABL_CPU_ACCEL_NONE;
 }
 
+/* instruction set tiers, from the lowest to the highest, each implying
+ * the ones before it
+ */
+static const struct
+{
+  const char        *name;
+  BablCpuAccelFlags  flags;
+} cpu_tiers[] =
+{
+  { "none",   BABL_CPU_ACCEL_NONE },
+  { "vector", BABL_CPU_ACCEL_VECTOR },
+  { "mmx",    BABL_CPU_ACCEL_X86_MMX | BABL_CPU_ACCEL_X86_MMXEXT |
+              BABL_CPU_ACCEL_X86_3DNOW | BABL_CPU_ACCEL_PPC_ALTIVEC },
+  { "sse",    BABL_CPU_ACCEL_X86_SSE },
+  { "sse2",   BABL_CPU_ACCEL_X86_SSE2 },
+  { "sse3",   BABL_CPU_ACCEL_X86_SSE3 },
+  { "ssse3",  BABL_CPU_ACCEL_X86_SSSE3 },
+  { "sse4.1", BABL_CPU_ACCEL_X86_SSE4_1 },
+  { "f16c",   BABL_CPU_ACCEL_X86_F16C },
+  { "avx2",   BABL_CPU_ACCEL_X86_AVX2 },
+  { "avx512", BABL_CPU_ACCEL_X86_AVX512 },
+};
+
+#define N_CPU_TIERS ((int) (sizeof (cpu_tiers) / sizeof (cpu_tiers[0])))
+
+/**
+ * babl_cpu_accel_get_tier:
+ * @flags: the #BablCpuAccelFlags an implementation depends on
+ *
+ * Ranks implementations by the highest instruction set tier they
+ * depend on, 0 is portable C.
+ *
+ * Return value: the tier of @flags.
+ */
+int
+babl_cpu_accel_get_tier (BablCpuAccelFlags flags)
+{
+  int tier;
+
+  for (tier = N_CPU_TIERS - 1; tier > 0; tier--)
+    if (flags & cpu_tiers[tier].flags)
+      return tier;
+  return 0;
+}
+
+/* the tier named by BABL_CPU_ACCEL, or -1 */
+static int
+cpu_accel_forced_tier (void)
+{
+  const char *env = getenv ("BABL_CPU_ACCEL");
+  int tier;
+
+  if (!env)
+    return -1;
+
+  for (tier = 0; tier < N_CPU_TIERS; tier++)
+    if (!strcmp (env, cpu_tiers[tier].name))
+      return tier;
+  return -1;
+}
+
+/**
+ * babl_cpu_accel_is_forced:
+ *
+ * Whether BABL_CPU_ACCEL names a tier, in which case the implementations
+ * of the highest tier up to it are used rather than the fastest ones.
+ *
+ * Return value: non-zero if a tier is forced.
+ */
+int
+babl_cpu_accel_is_forced (void)
+{
+  return cpu_accel_forced_tier () >= 0;
+}
+
+/* BABL_CPU_ACCEL=sse2 and similar caps the flags reported for the CPU to
+ * a tier, making the same conversions get used on any machine supporting
+ * at least that tier - for benchmarking and comparing the tiers.
+ */
+static BablCpuAccelFlags
+cpu_accel_cap (BablCpuAccelFlags accel)
+{
+  int tier = cpu_accel_forced_tier ();
+  int i;
+
+  if (tier < 0)
+    return accel;
+
+  for (i = tier + 1; i < N_CPU_TIERS; i++)
+    accel &= ~cpu_tiers[i].flags;
+  return accel;
+}
+
 /**
  * babl_cpu_accel_set_use:
  * @use:  whether to use CPU acceleration features or not
@@ -119,13 +214,28 @@ enum
   ARCH_X86_INTEL_FEATURE_SSSE3    = 1 << 9,
   ARCH_X86_INTEL_FEATURE_SSE4_1   = 1 << 19,
   ARCH_X86_INTEL_FEATURE_SSE4_2   = 1 << 20,
+  ARCH_X86_INTEL_FEATURE_OSXSAVE  = 1 << 27,
   ARCH_X86_INTEL_FEATURE_AVX      = 1 << 28,
   ARCH_X86_INTEL_FEATURE_F16C     = 1 << 29,
 
   /* extended features */
-  ARCH_X86_INTEL_FEATURE_AVX2     = 1 << 5
+  ARCH_X86_INTEL_FEATURE_AVX2     = 1 << 5,
+  ARCH_X86_INTEL_FEATURE_AVX512F  = 1 << 16,
+  ARCH_X86_INTEL_FEATURE_AVX512DQ = 1 << 17,
+  ARCH_X86_INTEL_FEATURE_AVX512BW = 1 << 30,
+  ARCH_X86_INTEL_FEATURE_AVX512VL = 1 << 31
 };
 
+/* XCR0 state components the OS has to save for AVX-512: SSE, AVX,
+ * opmask, upper halves of zmm0-15 and zmm16-31
+ */
+#define ARCH_X86_XCR0_AVX512 0xe6
+
+#define ARCH_X86_AVX512_FEATURES (ARCH_X86_INTEL_FEATURE_AVX512F  | \
+                                  ARCH_X86_INTEL_FEATURE_AVX512DQ | \
+                                  ARCH_X86_INTEL_FEATURE_AVX512BW | \
+                                  ARCH_X86_INTEL_FEATURE_AVX512VL)
+
 #if !defined(ARCH_X86_64) && (defined(PIC) || defined(__PIC__))
 #define cpuid(op,eax,ebx,ecx,edx)  \
   __asm__ ("movl %%ebx, %%esi\n\t" \
@@ -224,6 +334,24 @@ arch_get_vendor (void)
   return ARCH_X86_VENDOR_UNKNOWN;
 }
 
+#ifdef USE_SSE
+/* the OS has to save the opmask and zmm registers on context switches */
+static gboolean
+arch_accel_avx512_os_support (void)
+{
+  guint32 eax, ebx, ecx, edx;
+
+  cpuid (1, eax, ebx, ecx, edx);
+
+  if ((ecx & ARCH_X86_INTEL_FEATURE_OSXSAVE) == 0)
+    return FALSE;
+
+  __asm__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+
+  return (eax & ARCH_X86_XCR0_AVX512) == ARCH_X86_XCR0_AVX512;
+}
+#endif /* USE_SSE */
+
 static guint32
 arch_accel_intel (void)
 {
@@ -267,6 +395,10 @@ arch_accel_intel (void)
 
         if (ebx & ARCH_X86_INTEL_FEATURE_AVX2)
           caps |= BABL_CPU_ACCEL_X86_AVX2;
+
+        if ((ebx & ARCH_X86_AVX512_FEATURES) == ARCH_X86_AVX512_FEATURES &&
+            arch_accel_avx512_os_support ())
+          caps |= BABL_CPU_ACCEL_X86_AVX512;
       }
 #endif /* USE_SSE */
   }
@@ -521,21 +653,26 @@ arch_accel (void)
 static BablCpuAccelFlags
 cpu_accel (void)
 {
-#ifdef HAVE_ACCEL
   static guint32 accel = ~0U;
 
   if (accel != ~0U)
     return accel;
 
+#ifdef HAVE_ACCEL
   accel = arch_accel ();
 
 #if defined(ARCH_X86_64)
   accel |= BABL_CPU_ACCEL_X86_64;
 #endif
-
-  return (BablCpuAccelFlags) accel;
-
 #else /* !HAVE_ACCEL */
-  return BABL_CPU_ACCEL_NONE;
+  accel = BABL_CPU_ACCEL_NONE;
+#endif
+
+#ifdef BABL_VECTOR
+  accel |= BABL_CPU_ACCEL_VECTOR;
 #endif
+
+  accel = cpu_accel_cap (accel);
+
+  return (BablCpuAccelFlags) accel;
 }
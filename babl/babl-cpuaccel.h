@@ -23,6 +23,9 @@ typedef enum
 {
   BABL_CPU_ACCEL_NONE        = 0x0,
 
+  /* portable SIMD through compiler vector extensions, see babl-vector.h */
+  BABL_CPU_ACCEL_VECTOR      = 0x00008000,
+
   /* x86 accelerations */
   BABL_CPU_ACCEL_X86_MMX     = 0x01000000,
   BABL_CPU_ACCEL_X86_3DNOW   = 0x40000000,
@@ -36,6 +39,7 @@ typedef enum
   /* BABL_CPU_ACCEL_X86_AVX     = 0x00080000, */
   BABL_CPU_ACCEL_X86_F16C    = 0x00040000,
   BABL_CPU_ACCEL_X86_AVX2    = 0x00020000,
+  BABL_CPU_ACCEL_X86_AVX512  = 0x00010000, /* F, BW, DQ and VL */
 
   /* powerpc accelerations */
   BABL_CPU_ACCEL_PPC_ALTIVEC = 0x04000000,
@@ -45,6 +49,8 @@ typedef enum
 
 BablCpuAccelFlags  babl_cpu_accel_get_support (void);
 void               babl_cpu_accel_set_use     (unsigned int use);
+int                babl_cpu_accel_get_tier    (BablCpuAccelFlags flags);
+int                babl_cpu_accel_is_forced   (void);
 
 
 #endif  /* _BABL_CPU_ACCEL_H */
@@ -283,7 +283,8 @@ get_conversion_path (PathContext *pc,
             {
               Babl *next_conversion = BABL (list->items[i]);
               Babl *next_format = BABL (next_conversion->conversion.destination);
-              if (!next_format->format.visited && !bad_idea (current_format, pc->to_format, next_format))
+              if (!next_format->format.visited && !bad_idea (current_format, pc->to_format, next_format) &&
+                  !babl_conversion_is_superseded (next_conversion))
                 {
                   /* next_format is not in the current path, we can pay a visit */
                   babl_list_insert_last (pc->current_path, next_conversion);
@@ -341,7 +342,7 @@ static int
 alias_conversion (Babl *babl,
                   void *user_data)
 {
-  const Babl *sRGB = babl_space ("sRGB");
+  const Babl *sRGB = _babl_space_srgb ();
   BablConversion *conv = (void *)babl;
   BablSpace *space = user_data;
 
@@ -363,6 +364,7 @@ alias_conversion (Babl *babl,
                       (void*)conv->destination->instance.name, (void*)space),
                 "linear", conv->function.linear,
                 "data", conv->data,
+                "accel", conv->accel,
                 NULL);
           break;
         case BABL_CONVERSION_PLANAR:
@@ -373,6 +375,7 @@ alias_conversion (Babl *babl,
                       (void*)conv->destination->instance.name, (void*)space),
                 "planar", conv->function.planar,
                 "data", conv->data,
+                "accel", conv->accel,
                 NULL);
           break;
         case BABL_CONVERSION_PLANE:
@@ -383,6 +386,7 @@ alias_conversion (Babl *babl,
                       (void*)conv->destination->instance.name, (void*)space),
                 "plane", conv->function.plane,
                 "data", conv->data,
+                "accel", conv->accel,
                 NULL);
           break;
         default:
@@ -406,6 +410,7 @@ alias_conversion (Babl *babl,
                 babl_remodel_with_space (
                       (void*)conv->destination, (void*)space),
                 "linear", conv->function.linear,
+                "data", conv->data,
                 NULL);
           break;
         case BABL_CONVERSION_PLANAR:
@@ -415,6 +420,7 @@ alias_conversion (Babl *babl,
                 babl_remodel_with_space (
                       (void*)conv->destination, (void*)space),
                 "planar", conv->function.planar,
+                "data", conv->data,
                 NULL);
           break;
         case BABL_CONVERSION_PLANE:
@@ -424,6 +430,7 @@ alias_conversion (Babl *babl,
                 babl_remodel_with_space (
                       (void*)conv->destination, (void*)space),
                 "plane", conv->function.plane,
+                "data", conv->data,
                 NULL);
           break;
         default:
@@ -506,7 +513,7 @@ babl_fish_path2 (const Babl *source,
                  double      tolerance)
 {
   Babl *babl = NULL;
-  const Babl *sRGB = babl_space ("sRGB");
+  const Babl *sRGB = _babl_space_srgb ();
   char name[BABL_MAX_NAME_LEN];
   int is_fast = 0;
   static int debug_missing = -1;
@@ -519,6 +526,13 @@ babl_fish_path2 (const Babl *source,
        debug_missing = 0;
   }
 
+  /* conversions between planar formats need more than the linear buffers
+   * paths are made for, they are left to the reference fish and
+   * babl_process_planar ()
+   */
+  if (source->format.planar || destination->format.planar)
+    return NULL;
+
   _babl_fish_create_name (name, source, destination, 1);
   babl_mutex_lock (babl_format_mutex);
   babl = babl_db_exist_by_name (babl_fish_db (), name);
@@ -582,8 +596,8 @@ babl_fish_path2 (const Babl *source,
 
   }
 
-  babl = babl_calloc (1, sizeof (BablFishPath) +
-                      strlen (name) + 1);
+  babl = babl_arena_calloc (BABL_FISH_PATH, sizeof (BablFishPath) +
+                            strlen (name) + 1);
   babl_set_destructor (babl, _babl_fish_path_destroy);
 
   babl->class_type                = BABL_FISH_PATH;
@@ -709,6 +723,15 @@ babl_fish_path_process (const Babl *babl,
                            n);
 }
 
+/* the conversions of a fish processed as a path of several, or NULL */
+BablList *
+_babl_fish_path_conversions (const Babl *babl)
+{
+  if (babl->fish.dispatch != babl_fish_path_process)
+    return NULL;
+  return babl->fish_path.conversion_list;
+}
+
 static void
 babl_fish_memcpy_process (const Babl *babl,
                           const char *source,
@@ -716,7 +739,8 @@ babl_fish_memcpy_process (const Babl *babl,
                           long        n,
                           void       *data)
 {
-  memcpy (destination, source, n * babl->fish.source->format.bytes_per_pixel);
+  if (source != destination)
+    memcpy (destination, source, n * babl->fish.source->format.bytes_per_pixel);
 }
 
 void
@@ -779,6 +803,10 @@ _babl_fish_rig_dispatch (Babl *babl)
     }
 }
 
+static void process_in_place (Babl *babl,
+                              char *buffer,
+                              long  n);
+
 static inline long
 _babl_process (const Babl *cbabl,
                const void *source,
@@ -786,7 +814,11 @@ _babl_process (const Babl *cbabl,
                long        n)
 {
   Babl *babl = (void*)cbabl;
-  babl->fish.dispatch (babl, source, destination, n, *babl->fish.data);
+
+  if (source == destination)
+    process_in_place (babl, destination, n);
+  else
+    babl->fish.dispatch (babl, source, destination, n, *babl->fish.data);
   if (_babl_instrument)
     babl->fish.pixels += n;
   return n;
@@ -824,7 +856,10 @@ babl_process_rows (const Babl *fish,
     babl->fish.pixels += n * rows;
   for (row = 0; row < rows; row++)
     {
-      babl->fish.dispatch (babl, (void*)src, (void*)dst, n, *babl->fish.data);
+      if (src == dst)
+        process_in_place (babl, (void*)dst, n);
+      else
+        babl->fish.dispatch (babl, (void*)src, (void*)dst, n, *babl->fish.data);
 
       src += source_stride;
       dst += dest_stride;
@@ -842,6 +877,161 @@ static void inline *align_16 (unsigned char *ret)
   return ret;
 }
 
+/* bytes of the scratch buffer single conversions are staged through when
+ * converting in place
+ */
+#define IN_PLACE_STAGING 16384
+
+typedef enum
+{
+  IN_PLACE_UNSUPPORTED,
+  IN_PLACE_DIRECT,      /* the fish reads a chunk of pixels, or all of
+                           them, before writing any */
+  IN_PLACE_STAGED       /* converted a chunk at a time into a scratch
+                           buffer, and copied back */
+} InPlace;
+
+static InPlace
+fish_in_place (const Babl *babl)
+{
+  const Babl *source      = babl->fish.source;
+  const Babl *destination = babl->fish.destination;
+
+  /* going forward, destination pixels no larger than the source pixels
+   * only ever land on source pixels that have been converted
+   */
+  if (destination->format.bytes_per_pixel > source->format.bytes_per_pixel)
+    return IN_PLACE_UNSUPPORTED;
+
+  /* paths of several conversions go through their scratch buffers, and
+   * the reference through buffers of doubles or floats
+   */
+  if (babl->fish.dispatch == babl_fish_path_process ||
+      babl->fish.dispatch == babl_fish_memcpy_process)
+    return IN_PLACE_DIRECT;
+  if (babl->fish.dispatch == babl_fish_reference_process &&
+      !source->format.bitpacked &&
+      !destination->format.bitpacked &&
+      (source->format.model != destination->format.model ||
+       source->format.space != destination->format.space))
+    return IN_PLACE_DIRECT;
+
+  /* a conversion function can store some of a pixel before it has read
+   * all of it, like R'G'B' to B'G'R'
+   */
+  return IN_PLACE_STAGED;
+}
+
+static void
+process_in_place (Babl *babl,
+                  char *buffer,
+                  long  n)
+{
+  void *data = *babl->fish.data;
+  int   source_bpp;
+  int   dest_bpp;
+  long  chunk;
+  char *temp;
+  long  j;
+
+  if (fish_in_place (babl) != IN_PLACE_STAGED)
+    {
+      babl->fish.dispatch (babl, buffer, buffer, n, data);
+      return;
+    }
+
+  source_bpp = babl->fish.source->format.bytes_per_pixel;
+  dest_bpp   = babl->fish.destination->format.bytes_per_pixel;
+
+  /* chunks of a multiple of 16 pixels keep vectorized conversions on the
+   * same blocks of pixels as converting all of them at once
+   */
+  chunk = (IN_PLACE_STAGING / dest_bpp) & ~15;
+  if (chunk < 16)
+    chunk = 16;
+  chunk = MIN (chunk, n);
+  temp  = align_16 (alloca (chunk * dest_bpp + 16));
+
+  for (j = 0; j < n; j += chunk)
+    {
+      long c = MIN (n - j, chunk);
+
+      babl->fish.dispatch (babl, buffer + j * source_bpp, temp, c, data);
+      memcpy (buffer + j * dest_bpp, temp, c * dest_bpp);
+    }
+}
+
+int
+babl_fish_supports_in_place (const Babl *babl_fish)
+{
+  babl_assert (babl_fish && BABL_IS_BABL (babl_fish));
+
+  return fish_in_place (babl_fish) != IN_PLACE_UNSUPPORTED;
+}
+
+/* the scratch a path of more than one conversion needs to process n
+ * pixels at a time, as many bytes as each of the buffers of
+ * process_conversion_path_buffered () take
+ */
+static inline size_t
+conversion_path_scratch_size (long n)
+{
+  return MIN (n, MAX_BUFFER_SIZE) * sizeof (double) * 5 + 16;
+}
+
+static inline void
+process_conversion_path_buffered (BablList   *path,
+                                  const void *source_buffer,
+                                  int         source_bpp,
+                                  void       *destination_buffer,
+                                  int         dest_bpp,
+                                  long        n,
+                                  void       *temp_buffer,
+                                  void       *temp_buffer2)
+{
+  int  conversions = babl_list_size (path);
+  long j;
+
+  for (j = 0; j < n; j+= MAX_BUFFER_SIZE)
+    {
+      long c = MIN (n - j, MAX_BUFFER_SIZE);
+      int i;
+
+      void *aux1_buffer = temp_buffer;
+      void *aux2_buffer = temp_buffer2;
+
+      /* The first conversion goes from source_buffer to aux1_buffer */
+      babl_conversion_process (babl_list_get_first (path),
+                               (void*)(((unsigned char*)source_buffer) +
+                                                      (j * source_bpp)),
+                               aux1_buffer,
+                               c);
+
+      /* Process, if any, conversions between the first and the last
+       * conversion in the path, in a loop */
+      for (i = 1; i < conversions - 1; i++)
+        {
+          babl_conversion_process (path->items[i],
+                                   aux1_buffer,
+                                   aux2_buffer,
+                                   c);
+          {
+            /* Swap the auxiliary buffers */
+            void *swap_buffer = aux1_buffer;
+            aux1_buffer = aux2_buffer;
+            aux2_buffer = swap_buffer;
+          }
+        }
+
+      /* The last conversion goes from aux1_buffer to destination_buffer */
+      babl_conversion_process (babl_list_get_last (path),
+                               aux1_buffer,
+                               (void*)((unsigned char*)destination_buffer +
+                                                       (j * dest_bpp)),
+                               c);
+    }
+}
+
 static inline void
 process_conversion_path (BablList   *path,
                          const void *source_buffer,
@@ -861,58 +1051,104 @@ process_conversion_path (BablList   *path,
     }
   else
     {
-      long j;
-
-      void *temp_buffer = align_16 (alloca (MIN(n, MAX_BUFFER_SIZE) *
-                                    sizeof (double) * 5 + 16));
+      void *temp_buffer = align_16 (alloca (conversion_path_scratch_size (n)));
       void *temp_buffer2 = NULL;
 
       if (conversions > 2)
         {
           /* We'll need one more auxiliary buffer */
-          temp_buffer2 = align_16 (alloca (MIN(n, MAX_BUFFER_SIZE) *
-                                   sizeof (double) * 5 + 16));
+          temp_buffer2 = align_16 (alloca (conversion_path_scratch_size (n)));
         }
 
-      for (j = 0; j < n; j+= MAX_BUFFER_SIZE)
-        {
-          long c = MIN (n - j, MAX_BUFFER_SIZE);
-          int i;
+      process_conversion_path_buffered (path,
+                                        source_buffer, source_bpp,
+                                        destination_buffer, dest_bpp,
+                                        n, temp_buffer, temp_buffer2);
+  }
+}
 
-          void *aux1_buffer = temp_buffer;
-          void *aux2_buffer = temp_buffer2;
+/* spans that continue where the previous one ended in both buffers are
+ * processed as one
+ */
+static inline int
+spans_merge (const BablSpan *span,
+             const BablSpan *next,
+             int             source_bpp,
+             int             dest_bpp)
+{
+  return next->n >= 0 &&
+         (const char *) span->source + span->n * source_bpp ==
+           (const char *) next->source &&
+         (char *) span->destination + span->n * dest_bpp ==
+           (char *) next->destination;
+}
 
-          /* The first conversion goes from source_buffer to aux1_buffer */
-          babl_conversion_process (babl_list_get_first (path),
-                                   (void*)(((unsigned char*)source_buffer) +
-                                                          (j * source_bpp)),
-                                   aux1_buffer,
-                                   c);
+long
+babl_process_spans (const Babl     *fish,
+                    const BablSpan *spans,
+                    int             count)
+{
+  Babl     *babl  = (Babl*)fish;
+  BablList *path  = NULL;
+  void     *temp  = NULL;
+  void     *temp2 = NULL;
+  void     *data;
+  int       source_bpp;
+  int       dest_bpp;
+  long      total = 0;
+  int       i;
+
+  babl_assert (babl && BABL_IS_BABL (babl));
+  babl_assert (spans || count <= 0);
+
+  source_bpp = babl->fish.source->format.bytes_per_pixel;
+  dest_bpp   = babl->fish.destination->format.bytes_per_pixel;
+
+  for (i = 0; i < count; i++)
+    if (spans[i].n > 0)
+      total += spans[i].n;
+  if (total == 0)
+    return 0;
 
-          /* Process, if any, conversions between the first and the last
-           * conversion in the path, in a loop */
-          for (i = 1; i < conversions - 1; i++)
-            {
-              babl_conversion_process (path->items[i],
-                                       aux1_buffer,
-                                       aux2_buffer,
-                                       c);
-              {
-                /* Swap the auxiliary buffers */
-                void *swap_buffer = aux1_buffer;
-                aux1_buffer = aux2_buffer;
-                aux2_buffer = swap_buffer;
-              }
-            }
+  /* paths of several conversions get their scratch once, instead of once
+   * per span; contiguous spans are merged into runs longer than any one
+   * span, so it is sized for all the pixels, up to a chunk
+   */
+  if (babl->fish.dispatch == babl_fish_path_process &&
+      babl_list_size (babl->fish_path.conversion_list) > 1)
+    {
+      path = babl->fish_path.conversion_list;
+      temp = align_16 (alloca (conversion_path_scratch_size (total)));
+      if (babl_list_size (path) > 2)
+        temp2 = align_16 (alloca (conversion_path_scratch_size (total)));
+    }
+  data = *babl->fish.data;
 
-          /* The last conversion goes from aux1_buffer to destination_buffer */
-          babl_conversion_process (babl_list_get_last (path),
-                                   aux1_buffer,
-                                   (void*)((unsigned char*)destination_buffer +
-                                                           (j * dest_bpp)),
-                                   c);
-        }
-  }
+  for (i = 0; i < count; i++)
+    {
+      const char *source = spans[i].source;
+      char       *dest   = spans[i].destination;
+      long        n      = spans[i].n;
+
+      if (n <= 0)
+        continue;
+
+      while (i + 1 < count &&
+             spans_merge (&spans[i], &spans[i + 1], source_bpp, dest_bpp))
+        n += spans[++i].n;
+
+      if (path)
+        process_conversion_path_buffered (path, source, source_bpp,
+                                          dest, dest_bpp, n, temp, temp2);
+      else if (source == dest)
+        process_in_place (babl, dest, n);
+      else
+        babl->fish.dispatch (babl, source, dest, n, data);
+    }
+
+  if (_babl_instrument)
+    babl->fish.pixels += total;
+  return total;
 }
 
 static void
@@ -928,7 +1164,7 @@ init_path_instrumentation (FishPathInstrumentation *fpi,
   if (!fpi->fmt_rgba_double)
     {
       fpi->fmt_rgba_double =
-          babl_format_with_space ("RGBA double",
+          babl_format_with_space ((void *) _babl_format_rgba_double (),
                                   fmt_destination->format.space);
     }
 
@@ -1047,13 +1283,27 @@ get_path_instrumentation (FishPathInstrumentation *fpi,
       fpi->init_instrumentation_done = 1;
     }
 
-  /* calculate this path's view of what the result should be */
-  ticks_start = babl_ticks ();
-  for (int i = 0; i < BABL_TEST_ITER; i ++)
-  process_conversion_path (path, fpi->source, source_bpp, fpi->destination,
-                           dest_bpp, fpi->num_test_pixels);
-  ticks_end = babl_ticks ();
-  *path_cost = (ticks_end - ticks_start);
+  if (_babl_cost_profile_estimate (path, babl_source, babl_destination,
+                                   path_cost, ref_cost))
+    {
+      /* calibrated costs per pixel, scaled to the unit of the measured
+       * ones; the path is only run once, for its error */
+      *path_cost *= fpi->num_test_pixels * BABL_TEST_ITER / 1000.0;
+      *ref_cost  *= fpi->num_test_pixels * BABL_TEST_ITER / 1000.0;
+      process_conversion_path (path, fpi->source, source_bpp, fpi->destination,
+                               dest_bpp, fpi->num_test_pixels);
+    }
+  else
+    {
+      /* calculate this path's view of what the result should be */
+      ticks_start = babl_ticks ();
+      for (int i = 0; i < BABL_TEST_ITER; i ++)
+      process_conversion_path (path, fpi->source, source_bpp, fpi->destination,
+                               dest_bpp, fpi->num_test_pixels);
+      ticks_end = babl_ticks ();
+      *path_cost = (ticks_end - ticks_start);
+      *ref_cost = fpi->reference_cost;
+    }
 
   /* transform the reference and the actual destination buffers to RGBA
    * for comparison with each other
@@ -1065,6 +1315,4 @@ get_path_instrumentation (FishPathInstrumentation *fpi,
   *path_error = babl_rel_avg_error (fpi->destination_rgba_double,
                                     fpi->ref_destination_rgba_double,
                                     fpi->num_test_pixels * 4);
-
-  *ref_cost = fpi->reference_cost;
 }
@@ -133,8 +133,8 @@ babl_fish_reference (const Babl *source,
   babl_assert (source->class_type == BABL_FORMAT);
   babl_assert (destination->class_type == BABL_FORMAT);
 
-  babl = babl_calloc (1, sizeof (BablFishReference) +
-                      strlen (name) + 1);
+  babl = babl_arena_calloc (BABL_FISH_REFERENCE, sizeof (BablFishReference) +
+                            strlen (name) + 1);
   babl->class_type    = BABL_FISH_REFERENCE;
   babl->instance.id   = babl_fish_get_id (source, destination);
   babl->instance.name = ((char *) babl) + sizeof (BablFishReference);
@@ -424,6 +424,11 @@ static int compatible_components (const BablFormat *a,
   for (i = 0; i < a->components; i++)
    if (a->component[i] != b->component[i])
      return 0;
+  /* the ncomponent conversions use the first type for all components */
+  for (i = 1; i < a->components; i++)
+   if (a->type[i] != a->type[0] ||
+       b->type[i] != b->type[0])
+     return 0;
   return 1;
 }
 
@@ -1224,7 +1229,7 @@ babl_fish_reference_process_float (const Babl *babl,
         babl_conversion_find (
         babl_format_with_space (src_name,
                    BABL (BABL ((babl->fish.source))->format.space)),
-        babl_format_with_space ("RGBA float",
+        babl_format_with_space ((void *) _babl_format_rgba_float (),
                    BABL (BABL ((babl->fish.source))->format.space)));
     }
     {
@@ -1234,7 +1239,7 @@ babl_fish_reference_process_float (const Babl *babl,
                    BABL (BABL ((babl->fish.destination))->format.space));
       conv_from_rgba  =
         babl_conversion_find (
-        babl_format_with_space ("RGBA float",
+        babl_format_with_space ((void *) _babl_format_rgba_float (),
                    BABL (BABL ((babl->fish.destination))->format.space)),
                    destination_float_format);
     }
@@ -1290,7 +1295,7 @@ babl_fish_reference_process_float (const Babl *babl,
 
       rgba_image = babl_image_from_linear (
           rgba_float_buf,
-        babl_format_with_space ("RGBA float",
+        babl_format_with_space ((void *) _babl_format_rgba_float (),
                    BABL (BABL ((babl->fish.source))->format.space)));
 
 
@@ -1325,7 +1330,7 @@ babl_fish_reference_process_float (const Babl *babl,
     }
 
     {
-      if(babl_format_with_space ("RGBA float",
+      if(babl_format_with_space ((void *) _babl_format_rgba_float (),
                    BABL (BABL ((babl->fish.destination))->format.space)) ==
          babl_format_with_space (dst_name,
                    BABL (BABL ((babl->fish.destination))->format.space)))
@@ -1377,6 +1382,156 @@ babl_fish_reference_process_float (const Babl *babl,
       babl_free (destination_image);
 }
 
+/* bitpacked formats are converted through their byte aligned layout, the
+ * words are unpacked into and packed from the types' own storage around a
+ * reference conversion between the byte aligned formats
+ */
+#define BITPACKED_CHUNK 256
+
+static void
+unpack_bits (const Babl *format,
+             const char *src,
+             char       *dst,
+             long        n)
+{
+  int  components = format->format.components;
+  int  bytes      = format->format.bytes_per_pixel;
+  long i;
+
+  for (i = 0; i < n; i++)
+    {
+      uint64_t word = 0;
+      int      b, c;
+
+      for (b = 0; b < bytes; b++)
+        word |= (uint64_t) (uint8_t) src[b] << (b * 8);
+
+      for (c = 0; c < components; c++)
+        {
+          const BablType *type  = format->format.type[c];
+          uint16_t        value = word & ((1u << type->packed_bits) - 1);
+
+          word >>= type->packed_bits;
+          if (type->bits == 8)
+            *(uint8_t *) dst = value;
+          else
+            memcpy (dst, &value, sizeof (value));
+          dst += type->bits / 8;
+        }
+      src += bytes;
+    }
+}
+
+static void
+pack_bits (const Babl *format,
+           const char *src,
+           char       *dst,
+           long        n)
+{
+  int  components = format->format.components;
+  int  bytes      = format->format.bytes_per_pixel;
+  long i;
+
+  for (i = 0; i < n; i++)
+    {
+      uint64_t word  = 0;
+      int      shift = 0;
+      int      b, c;
+
+      for (c = 0; c < components; c++)
+        {
+          const BablType *type = format->format.type[c];
+          uint16_t        value;
+
+          if (type->bits == 8)
+            value = *(uint8_t *) src;
+          else
+            memcpy (&value, src, sizeof (value));
+          word  |= (uint64_t) (value & ((1u << type->packed_bits) - 1)) << shift;
+          shift += type->packed_bits;
+          src   += type->bits / 8;
+        }
+
+      for (b = 0; b < bytes; b++)
+        dst[b] = word >> (b * 8);
+      dst += bytes;
+    }
+}
+
+static void
+process_bitpacked (const Babl *babl,
+                   const char *source,
+                   char       *destination,
+                   long        n,
+                   void       *data)
+{
+  const Babl *source_fmt      = babl->fish.source;
+  const Babl *destination_fmt = babl->fish.destination;
+  Babl        fish;
+  char       *source_buf      = NULL;
+  char       *destination_buf = NULL;
+
+  memset (&fish, 0, sizeof (BablFishReference));
+  fish.class_type       = BABL_FISH_REFERENCE;
+  fish.fish.source      = source_fmt;
+  fish.fish.destination = destination_fmt;
+
+  if (source_fmt->format.bitpacked)
+    {
+      fish.fish.source = babl_format_packed (source_fmt, NULL);
+      source_buf = babl_malloc (BITPACKED_CHUNK *
+                                fish.fish.source->format.bytes_per_pixel);
+    }
+  if (destination_fmt->format.bitpacked)
+    {
+      fish.fish.destination = babl_format_packed (destination_fmt, NULL);
+      destination_buf = babl_malloc (BITPACKED_CHUNK *
+                                     fish.fish.destination->format.bytes_per_pixel);
+    }
+
+  while (n > 0)
+    {
+      long        count = n < BITPACKED_CHUNK ? n : BITPACKED_CHUNK;
+      const char *src   = source;
+      char       *dst   = destination;
+
+      if (source_buf)
+        {
+          unpack_bits (source_fmt, source, source_buf, count);
+          src = source_buf;
+        }
+      if (destination_buf)
+        dst = destination_buf;
+
+      if (fish.fish.source == fish.fish.destination)
+        memcpy (dst, src, count * fish.fish.source->format.bytes_per_pixel);
+      else
+        babl_fish_reference_process (&fish, src, dst, count, data);
+
+      if (destination_buf)
+        pack_bits (destination_fmt, destination_buf, destination, count);
+
+      source      += count * source_fmt->format.bytes_per_pixel;
+      destination += count * destination_fmt->format.bytes_per_pixel;
+      n           -= count;
+    }
+
+  if (source_buf)
+    babl_free (source_buf);
+  if (destination_buf)
+    babl_free (destination_buf);
+}
+
+static int
+float_reference_allowed (void)
+{
+  static int allow_float_reference = -1;
+
+  if (allow_float_reference == -1)
+    allow_float_reference = getenv ("BABL_REFERENCE_NOFLOAT") ? 0 : 1;
+  return allow_float_reference;
+}
+
 void
 babl_fish_reference_process (const Babl *babl,
                              const char *source,
@@ -1385,7 +1540,6 @@ babl_fish_reference_process (const Babl *babl,
                              void       *data)
 {
   static const void *type_float = NULL;
-  static int allow_float_reference = -1;
 
   if (!type_float) type_float = babl_type_from_id (BABL_FLOAT);
 
@@ -1399,6 +1553,13 @@ babl_fish_reference_process (const Babl *babl,
     return;
   }
 
+  if (babl->fish.source->format.bitpacked ||
+      babl->fish.destination->format.bitpacked)
+  {
+    process_bitpacked (babl, source, destination, n, data);
+    return;
+  }
+
   /* same model and space, only convert type */
   if ((BABL (babl->fish.source)->format.model ==
        BABL (babl->fish.destination)->format.model) &&
@@ -1424,9 +1585,6 @@ babl_fish_reference_process (const Babl *babl,
     return;
   }
 
-  if (allow_float_reference == -1)
-    allow_float_reference = getenv ("BABL_REFERENCE_NOFLOAT") ? 0 : 1;
-
   /* both source and destination are either single precision float or <32bit component,
      we then do a similar to the double reference - using the first registered
      float conversions - note that this makes the first registered float conversion of
@@ -1436,7 +1594,7 @@ babl_fish_reference_process (const Babl *babl,
      registering conversions for double. When needed conversions do not exist, we defer
      to the double code paths
    */
-  if (allow_float_reference &&
+  if (float_reference_allowed () &&
       (babl->fish.source->format.type[0]->bits < 32 ||
       babl->fish.source->format.type[0] == type_float) &&
       (babl->fish.destination->format.type[0]->bits < 32 ||
@@ -1452,3 +1610,366 @@ babl_fish_reference_process (const Babl *babl,
   }
 
 }
+
+/* compiling a reference fish into the steps of a BablColorTransform: the
+ * conversions babl_fish_reference_process () makes between RGB based
+ * models, looked up once, with the source, RGBA and destination model
+ * buffers in the first, second and third scratch buffer
+ */
+
+static BablColorStep *
+compile_step (BablColorStep     *steps,
+              int               *count,
+              BablColorStepKind  kind,
+              int                src,
+              int                src_offset,
+              int                dst,
+              int                dst_offset)
+{
+  BablColorStep *step;
+
+  if (*count >= BABL_COLOR_MAX_STEPS)
+    return NULL;
+
+  step = &steps[(*count)++];
+  memset (step, 0, sizeof (BablColorStep));
+  step->kind       = kind;
+  step->src        = src;
+  step->src_offset = src_offset;
+  step->dst        = dst;
+  step->dst_offset = dst_offset;
+  return step;
+}
+
+static int
+compile_type (BablColorStep *steps,
+              int           *count,
+              const Babl    *source_type,
+              const Babl    *destination_type,
+              int            src,
+              int            src_offset,
+              int            src_pitch,
+              int            dst,
+              int            dst_offset,
+              int            dst_pitch)
+{
+  Babl          *conv = babl_conversion_find (source_type, destination_type);
+  BablColorStep *step;
+
+  if (!conv || conv->class_type != BABL_CONVERSION_PLANE)
+    return 0;
+
+  step = compile_step (steps, count, BABL_COLOR_STEP_PLANE,
+                       src, src_offset, dst, dst_offset);
+  if (!step)
+    return 0;
+  step->src_pitch      = src_pitch;
+  step->dst_pitch      = dst_pitch;
+  step->babl           = conv;
+  step->function.plane = conv->conversion.function.plane;
+  step->data           = conv->conversion.data;
+  return 1;
+}
+
+/* a model conversion between buffers of components of size bytes, given
+ * as images of linear buffers to planar conversions
+ */
+static int
+compile_model (BablColorStep *steps,
+               int           *count,
+               const Babl    *source,
+               const Babl    *destination,
+               int            size,
+               int            src,
+               int            dst)
+{
+  Babl          *conv;
+  BablColorStep *step;
+
+  babl_mutex_lock (babl_reference_mutex);
+  conv = babl_conversion_find (source, destination);
+  babl_mutex_unlock (babl_reference_mutex);
+
+  if (!conv)
+    return 0;
+
+  switch (conv->class_type)
+    {
+      case BABL_CONVERSION_LINEAR:
+        step = compile_step (steps, count, BABL_COLOR_STEP_DISPATCH,
+                             src, 0, dst, 0);
+        if (!step)
+          return 0;
+        step->function.dispatch = conv->conversion.dispatch;
+        break;
+
+      case BABL_CONVERSION_PLANAR:
+        step = compile_step (steps, count, BABL_COLOR_STEP_PLANAR,
+                             src, 0, dst, 0);
+        if (!step)
+          return 0;
+        step->src_bands       = source->format.components;
+        step->dst_bands       = destination->format.components;
+        step->src_pitch       = size * step->src_bands;
+        step->dst_pitch       = size * step->dst_bands;
+        step->size            = size;
+        step->function.planar = conv->conversion.function.planar;
+        break;
+
+      default:
+        return 0;
+    }
+  step->babl = conv;
+  step->data = conv->conversion.data;
+  return 1;
+}
+
+/* the steps of convert_to_double () and convert_to_float () */
+static int
+compile_to_model (BablColorStep *steps,
+                  int           *count,
+                  BablFormat    *source_fmt,
+                  const Babl    *type)
+{
+  int size = type->type.bits / 8;
+  int i;
+
+  for (i = 0; i < source_fmt->model->components; i++)
+    {
+      int offset = 0;
+      int j;
+
+      for (j = 0; j < source_fmt->components; j++)
+        {
+          if (source_fmt->component[j] == source_fmt->model->component[i])
+            break;
+          offset += source_fmt->type[j]->bits / 8;
+        }
+
+      if (j < source_fmt->components)
+        {
+          if (!compile_type (steps, count, BABL (source_fmt->type[j]), type,
+                             BABL_COLOR_SOURCE, offset,
+                             source_fmt->bytes_per_pixel,
+                             BABL_COLOR_SCRATCH, size * i,
+                             size * source_fmt->model->components))
+            return 0;
+        }
+      else
+        {
+          BablColorStep *step = compile_step (steps, count,
+                                              BABL_COLOR_STEP_FILL,
+                                              0, 0,
+                                              BABL_COLOR_SCRATCH, size * i);
+          if (!step)
+            return 0;
+          step->size  = size;
+          step->value = source_fmt->model->component[i]->instance.id ==
+                        BABL_ALPHA ? 1.0 : 0.0;
+        }
+    }
+  return 1;
+}
+
+/* the steps of convert_from_double () and convert_from_float () */
+static int
+compile_from_model (BablColorStep *steps,
+                    int           *count,
+                    BablFormat    *source_fmt,
+                    BablFormat    *destination_fmt,
+                    const Babl    *type,
+                    int            src)
+{
+  int size   = type->type.bits / 8;
+  int offset = 0;
+  int i;
+
+  for (i = 0; i < destination_fmt->components; i++)
+    {
+      int can_be_used = 1;
+      int j;
+
+      if (source_fmt->model == destination_fmt->model)
+        {
+          can_be_used = 0;
+          for (j = 0; j < source_fmt->components; j++)
+            if (destination_fmt->component[i] == source_fmt->component[j])
+              can_be_used = 1;
+        }
+
+      if (can_be_used)
+        for (j = 0; j < destination_fmt->model->components; j++)
+          if (destination_fmt->component[i] ==
+              destination_fmt->model->component[j])
+            {
+              if (!compile_type (steps, count,
+                                 type, BABL (destination_fmt->type[i]),
+                                 src, size * j,
+                                 size * destination_fmt->model->components,
+                                 BABL_COLOR_DESTINATION, offset,
+                                 destination_fmt->bytes_per_pixel))
+                return 0;
+              break;
+            }
+
+      offset += destination_fmt->type[i]->bits / 8;
+    }
+  return 1;
+}
+
+static int
+compile_double (const Babl    *babl,
+                BablColorStep *steps)
+{
+  const Babl *type_double       = babl_type_from_id (BABL_DOUBLE);
+  const Babl *source_space      = babl->fish.source->format.space;
+  const Babl *destination_space = babl->fish.destination->format.space;
+  const Babl *destination_rgba  =
+    babl_remodel_with_space (babl_model_from_id (BABL_RGBA), destination_space);
+  int         source_buf        = BABL_COLOR_SCRATCH;
+  int         destination_buf   = BABL_COLOR_SCRATCH + 1;
+  int         count             = 0;
+
+  if (babl->fish.source->format.type[0] == (void*)type_double &&
+      babl->fish.source->format.components ==
+      babl->fish.source->format.model->components)
+    source_buf = BABL_COLOR_SOURCE;
+  else if (!compile_to_model (steps, &count,
+                              (BablFormat *) BABL (babl->fish.source),
+                              type_double))
+    return 0;
+
+  if (!compile_model (steps, &count,
+                      BABL (babl->fish.source->format.model),
+                      babl_remodel_with_space (babl_model_from_id (BABL_RGBA),
+                                               source_space),
+                      sizeof (double), source_buf, BABL_COLOR_SCRATCH + 1))
+    return 0;
+
+  if (source_space != destination_space)
+    {
+      BablColorStep *step = compile_step (steps, &count, BABL_COLOR_STEP_MATRIX,
+                                          BABL_COLOR_SCRATCH + 1, 0,
+                                          BABL_COLOR_SCRATCH + 1, 0);
+      if (!step)
+        return 0;
+      babl_matrix_mul_matrix (destination_space->space.XYZtoRGB,
+                              source_space->space.RGBtoXYZ,
+                              step->matrix);
+    }
+
+  if (BABL (babl->fish.destination->format.model) != destination_rgba)
+    {
+      destination_buf = BABL_COLOR_SCRATCH + 2;
+      if (!compile_model (steps, &count,
+                          destination_rgba,
+                          BABL (babl->fish.destination->format.model),
+                          sizeof (double),
+                          BABL_COLOR_SCRATCH + 1, destination_buf))
+        return 0;
+    }
+
+  if (!compile_from_model (steps, &count,
+                           (BablFormat *) BABL (babl->fish.source),
+                           (BablFormat *) BABL (babl->fish.destination),
+                           type_double, destination_buf))
+    return 0;
+  return count;
+}
+
+static int
+compile_float (const Babl    *babl,
+               BablColorStep *steps)
+{
+  const Babl *type_float        = babl_type_from_id (BABL_FLOAT);
+  const Babl *source_space      = babl->fish.source->format.space;
+  const Babl *destination_space = babl->fish.destination->format.space;
+  const Babl *source_rgba       = babl_format_with_space ((void *) _babl_format_rgba_float (), source_space);
+  const Babl *destination_rgba  = babl_format_with_space ((void *) _babl_format_rgba_float (), destination_space);
+  const Babl *source_float;
+  const Babl *destination_float;
+  int         destination_buf   = BABL_COLOR_SCRATCH + 1;
+  int         count             = 0;
+  char        name[256];
+
+  snprintf (name, sizeof (name), "%s float",
+            babl_get_name ((void*)babl->fish.source->format.model));
+  source_float = babl_format_with_space (name, source_space);
+  snprintf (name, sizeof (name), "%s float",
+            babl_get_name ((void*)babl->fish.destination->format.model));
+  destination_float = babl_format_with_space (name, destination_space);
+
+  /* the reference takes the double code path without these */
+  if (!babl_conversion_find (source_float, source_rgba) ||
+      !babl_conversion_find (destination_rgba, destination_float))
+    return compile_double (babl, steps);
+
+  if (!compile_to_model (steps, &count,
+                         (BablFormat *) BABL (babl->fish.source),
+                         type_float) ||
+      !compile_model (steps, &count, source_float, source_rgba,
+                      sizeof (float),
+                      BABL_COLOR_SCRATCH, BABL_COLOR_SCRATCH + 1))
+    return 0;
+
+  if (source_space != destination_space)
+    {
+      BablColorStep *step = compile_step (steps, &count, BABL_COLOR_STEP_MATRIXF,
+                                          BABL_COLOR_SCRATCH + 1, 0,
+                                          BABL_COLOR_SCRATCH + 1, 0);
+      if (!step)
+        return 0;
+      babl_matrix_mul_matrixf (destination_space->space.XYZtoRGBf,
+                               source_space->space.RGBtoXYZf,
+                               step->matrixf);
+    }
+
+  if (destination_rgba != destination_float)
+    {
+      destination_buf = BABL_COLOR_SCRATCH + 2;
+      if (!compile_model (steps, &count, destination_rgba, destination_float,
+                          sizeof (float),
+                          BABL_COLOR_SCRATCH + 1, destination_buf))
+        return 0;
+    }
+
+  if (!compile_from_model (steps, &count,
+                           (BablFormat *) BABL (babl->fish.source),
+                           (BablFormat *) BABL (babl->fish.destination),
+                           type_float, destination_buf))
+    return 0;
+  return count;
+}
+
+int
+_babl_fish_reference_compile (const Babl    *babl,
+                              BablColorStep *steps)
+{
+  const Babl *source      = BABL (babl->fish.source);
+  const Babl *destination = BABL (babl->fish.destination);
+  const Babl *type_float  = babl_type_from_id (BABL_FLOAT);
+
+  /* the remaining ways through babl_fish_reference_process () are left to
+   * the fish itself
+   */
+  if (source == destination ||
+      source->format.bitpacked ||
+      destination->format.bitpacked ||
+      (source->format.model == destination->format.model &&
+       source->format.space == destination->format.space) ||
+      babl_format_is_format_n (destination) ||
+      format_has_cmyk_model (source) ||
+      format_has_cmyk_model (destination) ||
+      babl_format_is_palette (source) ||
+      babl_format_is_palette (destination))
+    return 0;
+
+  if (float_reference_allowed () &&
+      (source->format.type[0]->bits < 32 ||
+       source->format.type[0] == (void*)type_float) &&
+      (destination->format.type[0]->bits < 32 ||
+       destination->format.type[0] == (void*)type_float))
+    return compile_float (babl, steps);
+
+  return compile_double (babl, steps);
+}
@@ -42,8 +42,8 @@ babl_fish_simple (BablConversion *conversion)
       return babl;
     }
 
-  babl = babl_calloc (1, sizeof (BablFishSimple) +
-                      strlen (name) + 1);
+  babl = babl_arena_calloc (BABL_FISH_SIMPLE, sizeof (BablFishSimple) +
+                            strlen (name) + 1);
   babl->class_type    = BABL_FISH_SIMPLE;
   babl->instance.id   = babl_fish_get_id (conversion->source, conversion->destination);
   babl->instance.name = ((char *) babl) + sizeof (BablFishSimple);
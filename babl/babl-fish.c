@@ -21,9 +21,17 @@
 #include "babl-internal.h"
 #include "babl-db.h"
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdarg.h>
 
+#ifdef HAVE_STDATOMIC_H
+#include <stdatomic.h>
+#define BABL_ATOMIC _Atomic
+#else
+#define BABL_ATOMIC
+#endif
+
 typedef struct _BablFindFish BablFindFish;
 
 typedef struct _BablFindFish
@@ -194,9 +202,145 @@ babl_fish_get_id (const Babl *source,
   return id;
 }
 
+/* A small direct-mapped per-thread cache of recently returned fishes, keyed
+ * on the source and destination pointers passed to babl_fish (). Only lookups
+ * made with format pointers are cached, a string could be reused for another
+ * format name. The whole cache is dropped when fish_cache_generation changes,
+ * which happens on babl_exit () and palette changes.
+ */
+#define BABL_FISH_CACHE_SIZE         64
+#define BABL_FISH_CACHE_FLUSH_HITS   65536
+
+typedef struct BablFishCacheEntry
+{
+  const void *source;
+  const void *destination;
+  const Babl *fish;
+} BablFishCacheEntry;
+
+typedef struct BablFishCache
+{
+  int                generation;
+  long               hits;
+  long               misses;
+  BablFishCacheEntry entries[BABL_FISH_CACHE_SIZE];
+} BablFishCache;
+
+static BABL_ATOMIC int  fish_cache_generation = 1;
+static BABL_ATOMIC long fish_cache_hits       = 0;
+static BABL_ATOMIC long fish_cache_misses     = 0;
+
+#ifdef HAVE_TLS
+static __thread BablFishCache fish_cache;
+#endif
+
+static inline int
+fish_cache_index (const void *source,
+                  const void *destination)
+{
+  uintptr_t hash = ((uintptr_t) source >> 4) ^
+                   (((uintptr_t) destination >> 4) * 0x9e3779b1u);
+  return (hash ^ (hash >> 7)) & (BABL_FISH_CACHE_SIZE - 1);
+}
+
+#ifdef HAVE_TLS
+static void
+fish_cache_flush_stats (BablFishCache *cache)
+{
+#ifdef HAVE_STDATOMIC_H
+  atomic_fetch_add_explicit (&fish_cache_hits, cache->hits,
+                             memory_order_relaxed);
+  atomic_fetch_add_explicit (&fish_cache_misses, cache->misses,
+                             memory_order_relaxed);
+#else
+  fish_cache_hits   += cache->hits;
+  fish_cache_misses += cache->misses;
+#endif
+  cache->hits   = 0;
+  cache->misses = 0;
+}
+#endif
+
+void
+_babl_fish_cache_invalidate (void)
+{
+#ifdef HAVE_STDATOMIC_H
+  atomic_fetch_add_explicit (&fish_cache_generation, 1, memory_order_release);
+#else
+  fish_cache_generation++;
+#endif
+}
+
+void
+babl_fish_cache_get_stats (long *hits,
+                           long *misses)
+{
+#ifdef HAVE_TLS
+  fish_cache_flush_stats (&fish_cache);
+#endif
+  if (hits)
+    *hits = fish_cache_hits;
+  if (misses)
+    *misses = fish_cache_misses;
+}
+
+static const Babl *
+babl_fish_lookup (const void *source,
+                  const void *destination);
+
 const Babl *
 babl_fish (const void *source,
            const void *destination)
+{
+#ifdef HAVE_TLS
+  BablFishCache      *cache = &fish_cache;
+  BablFishCacheEntry *entry;
+  int                 generation;
+  const Babl         *fish;
+
+#ifdef HAVE_STDATOMIC_H
+  generation = atomic_load_explicit (&fish_cache_generation,
+                                     memory_order_acquire);
+#else
+  generation = fish_cache_generation;
+#endif
+
+  if (cache->generation != generation)
+    {
+      memset (cache->entries, 0, sizeof (cache->entries));
+      cache->generation = generation;
+    }
+
+  entry = &cache->entries[fish_cache_index (source, destination)];
+  if (entry->source == source &&
+      entry->destination == destination &&
+      entry->fish)
+    {
+      if (++cache->hits >= BABL_FISH_CACHE_FLUSH_HITS)
+        fish_cache_flush_stats (cache);
+      return entry->fish;
+    }
+
+  cache->misses++;
+  fish_cache_flush_stats (cache);
+
+  fish = babl_fish_lookup (source, destination);
+
+  if (fish && BABL_IS_BABL (source) && BABL_IS_BABL (destination))
+    {
+      entry->source      = source;
+      entry->destination = destination;
+      entry->fish        = fish;
+    }
+  return fish;
+#else
+  return babl_fish_lookup (source, destination);
+#endif
+}
+
+static const Babl *
+babl_fish_lookup (const void *source,
+                  const void *destination)
 {
   const Babl *source_format      = NULL;
   const Babl *destination_format = NULL;
@@ -316,7 +460,7 @@ babl_fish (const void *source,
                      * does not exist.
                      */
                     char *name = "X"; /* name does not matter */
-                    Babl *fish = babl_calloc (1, sizeof (BablFish) + strlen (name) + 1);
+                    Babl *fish = babl_arena_calloc (BABL_FISH, sizeof (BablFish) + strlen (name) + 1);
 
                     fish->class_type                = BABL_FISH;
                     fish->instance.id               = babl_fish_get_id (source_format, destination_format);
@@ -17,10 +17,18 @@
  */
 
 #include "config.h"
+#include <stdint.h>
 #include <string.h>
 #include <stdarg.h>
 #include <math.h>
 
+#ifdef HAVE_STDATOMIC_H
+#include <stdatomic.h>
+#define BABL_ATOMIC _Atomic
+#else
+#define BABL_ATOMIC
+#endif
+
 #define NEEDS_BABL_DB
 #include "babl-internal.h"
 #include "babl-db.h"
@@ -80,13 +88,13 @@ format_new (const char      *name,
     }
 
   /* allocate all memory in one chunk */
-  babl = babl_malloc (sizeof (BablFormat) +
-                      strlen (name) + 1 +
-                      sizeof (BablComponent *) * (components) +
-                      sizeof (BablSampling *) * (components) +
-                      sizeof (BablType *) * (components) +
-                      sizeof (int) * (components) +
-                      sizeof (int) * (components));
+  babl = babl_arena_calloc (BABL_FORMAT, sizeof (BablFormat) +
+                            strlen (name) + 1 +
+                            sizeof (BablComponent *) * (components) +
+                            sizeof (BablSampling *) * (components) +
+                            sizeof (BablType *) * (components) +
+                            sizeof (int) * (components) +
+                            sizeof (int) * (components));
 
   babl_set_destructor (babl, babl_format_destruct);
 
@@ -103,7 +111,7 @@ format_new (const char      *name,
 
   babl->format.components = components;
 
-  if (space == babl_space ("sRGB"))
+  if (space == _babl_space_srgb ())
     babl->format.model      = model;
   else
     babl->format.model      = (void*)babl_remodel_with_space ((void*)model, space);
@@ -113,6 +121,7 @@ format_new (const char      *name,
   memcpy (babl->format.sampling, sampling, sizeof (BablSampling *) * components);
 
   babl->format.planar = planar;
+  babl->format.bitpacked = 0;
 
   babl->format.bytes_per_pixel = 0;
   {
@@ -134,6 +143,31 @@ format_new (const char      *name,
   return babl;
 }
 
+/* lay the components out in a shared word, the first component in the
+ * least significant bits
+ */
+static void
+format_set_bitpacked (Babl *babl)
+{
+  int bits = 0;
+  int i;
+
+  for (i = 0; i < babl->format.components; i++)
+    {
+      if (babl->format.type[i]->bits > 16)
+        babl_fatal ("bitpacked format '%s' needs types of at most 16 bits",
+                    babl->instance.name);
+      bits += babl->format.type[i]->packed_bits;
+    }
+
+  if (babl->format.planar || bits % 8 || bits > 64)
+    babl_fatal ("bitpacked format '%s' does not fit a word of whole bytes",
+                babl->instance.name);
+
+  babl->format.bitpacked       = 1;
+  babl->format.bytes_per_pixel = bits / 8;
+}
+
 Babl *
 format_new_from_format_with_space (const Babl *format, 
                                    const Babl *space)
@@ -152,6 +186,8 @@ format_new_from_format_with_space (const Babl *format,
                     (void*)babl_remodel_with_space (BABL(format->format.model), space),
                     space,
                     format->format.component, format->format.sampling, (void*)format->format.type, NULL);
+  if (format->format.bitpacked)
+    format_set_bitpacked (ret);
 
   ret->format.encoding = babl_get_name(format);
   babl_db_insert (db, (void*)ret);
@@ -286,7 +322,7 @@ babl_format_n (const Babl *btype,
   babl = format_new (name,
                      id,
                      planar, components, model,
-                     babl_space("sRGB"),
+                     _babl_space_srgb (),
                      component, sampling, type, NULL);
 
   babl_format_set_is_format_n (babl);
@@ -343,9 +379,10 @@ babl_format_new (const void *first_arg,
   Babl          *babl;
   int            id         = 0;
   int            planar     = 0;
+  int            bitpacked  = 0;
   int            components = 0;
   BablModel     *model      = NULL;
-  const Babl    *space      = babl_space ("sRGB");
+  const Babl    *space      = _babl_space_srgb ();
   const char    *doc        = NULL;
   BablComponent *component [BABL_MAX_COMPONENTS];
   BablSampling  *sampling  [BABL_MAX_COMPONENTS];
@@ -386,6 +423,16 @@ babl_format_new (const void *first_arg,
           planar = 1;
         }
 
+      else if (!strcmp (arg, "semiplanar"))
+        {
+          planar = 2; /* components sharing a sampling share a plane */
+        }
+
+      else if (!strcmp (arg, "bitpacked"))
+        {
+          bitpacked = 1;
+        }
+
       /* if we didn't point to a known string, we assume argument to be babl */
       else if (BABL_IS_BABL (arg))
         {
@@ -468,9 +515,23 @@ babl_format_new (const void *first_arg,
   va_end (varg);
 
   if (!name)
-    name = create_name (model, components, component, type);
+    {
+      const char *layout = bitpacked   ? " bitpacked"  :
+                           planar == 1 ? " planar"     :
+                           planar == 2 ? " semiplanar" : NULL;
 
-  if (space != babl_space ("sRGB"))
+      name = create_name (model, components, component, type);
+      if (layout)
+        {
+          /* keep the name of the packed, byte aligned layout free */
+          char *new_name = babl_malloc (strlen (name) + strlen (layout) + 1);
+          sprintf (new_name, "%s%s", name, layout);
+          babl_free (name);
+          name = new_name;
+        }
+    }
+
+  if (space != _babl_space_srgb ())
   {
     char *new_name = babl_malloc (strlen (name) +
                                   strlen (babl_get_name ((Babl*)space)) + 1);
@@ -515,6 +576,8 @@ babl_format_new (const void *first_arg,
                      id,
                      planar, components, model, space,
                      component, sampling, type, doc);
+  if (bitpacked)
+    format_set_bitpacked (babl);
 
   babl_db_insert (db, babl);
   babl_free (name);
@@ -566,6 +629,82 @@ babl_format_get_n_components (const Babl *format)
   return 0;
 }
 
+int
+babl_format_get_n_planes (const Babl *format)
+{
+  if (format->class_type == BABL_FORMAT)
+    {
+      return babl_format_get_plane_layout (format, NULL, NULL, NULL);
+    }
+
+  return 0;
+}
+
+int
+babl_format_get_plane_layout (const Babl *format,
+                              int        *plane,
+                              int        *offset,
+                              int        *pitch)
+{
+  int planes = 0;
+  int size[BABL_MAX_COMPONENTS];
+  int plane_buf[BABL_MAX_COMPONENTS];
+  int i;
+
+  if (!plane)
+    plane = plane_buf;
+
+  if (format->format.bitpacked)
+    {
+      /* all components live in the one word */
+      for (i = 0; i < format->format.components; i++)
+        {
+          plane[i] = 0;
+          if (offset)
+            offset[i] = 0;
+          if (pitch)
+            pitch[i] = format->format.bytes_per_pixel;
+        }
+      return 1;
+    }
+
+  for (i = 0; i < format->format.components; i++)
+    {
+      int new_plane;
+
+      switch (format->format.planar)
+        {
+          case 0:
+            new_plane = (i == 0);
+            break;
+          case 1:
+            new_plane = 1;
+            break;
+          default:
+            new_plane = (i == 0 ||
+                         format->format.sampling[i] != format->format.sampling[i-1]);
+            break;
+        }
+
+      if (new_plane)
+        {
+          size[planes] = 0;
+          planes++;
+        }
+
+      plane[i] = planes - 1;
+      if (offset)
+        offset[i] = size[planes - 1];
+      size[planes - 1] += format->format.type[i]->bits / 8;
+    }
+
+  if (pitch)
+    for (i = 0; i < format->format.components; i++)
+      pitch[i] = size[plane[i]];
+
+  return planes;
+}
+
 const Babl *
 babl_format_get_type (const Babl *format,
                       int         component_index)
@@ -584,30 +723,82 @@ const Babl *
 babl_format_with_model_as_type (const Babl *model,
                                 const Babl *type)
 {
-  BablComponent *component[10];
-  int            i;
+  int             components = model->model.components;
+  BablSampling   *sampling [BABL_MAX_COMPONENTS];
+  const BablType *types    [BABL_MAX_COMPONENTS];
+  char           *name;
+  Babl           *babl;
+  int             i;
+
+  for (i = 0; i < components; i++)
+    {
+      sampling[i] = (BablSampling *) babl_sampling (1, 1);
+      types[i]    = &type->type;
+    }
+
+  /* named like babl_format_new () would name it */
+  name = create_name (&model->model, components, model->model.component, types);
+
+  babl = babl_db_exist (db, 0, name);
+  if (!babl)
+    {
+      babl = format_new (name, 0, 0, components, (BablModel *) model,
+                         _babl_space_srgb (), model->model.component,
+                         sampling, types, NULL);
+      babl_db_insert (db, babl);
+    }
+
+  babl_free (name);
+  return babl;
+}
+
+const Babl *
+babl_format_packed (const Babl *format,
+                    const Babl *type)
+{
+  BablModel      *model      = format->format.model;
+  const Babl     *space      = format->format.space;
+  int             components = format->format.components;
+  BablSampling   *sampling [BABL_MAX_COMPONENTS];
+  const BablType *types    [BABL_MAX_COMPONENTS];
+  char           *name;
+  Babl           *babl;
+  int             i;
+
+  /* name the format after the sRGB model, like babl_format_new () */
+  if (model->model)
+    model = model->model;
 
-  for (i = 0; i < model->model.components; i++)
+  for (i = 0; i < components; i++)
+    {
+      sampling[i] = (BablSampling *) babl_sampling (1, 1);
+      types[i]    = type ? &type->type : format->format.type[i];
+    }
+
+  name = create_name (model, components, format->format.component, types);
+
+  if (space != _babl_space_srgb ())
+  {
+    char *new_name = babl_malloc (strlen (name) +
+                                  strlen (babl_get_name ((Babl*)space)) + 2);
+    sprintf (new_name, "%s-%s", name, babl_get_name ((Babl*)space));
+    babl_free (name);
+    name = new_name;
+  }
+
+  babl_mutex_lock (babl_format_mutex);
+  babl = babl_db_exist (db, 0, name);
+  if (!babl)
     {
-      component[i] = model->model.component[i];
+      babl = format_new (name, 0, 0, components, model, space,
+                         format->format.component, sampling, types, NULL);
+      babl_db_insert (db, babl);
     }
-  component[i] = NULL;
+  babl_mutex_unlock (babl_format_mutex);
 
-  return babl_format_new (
-           model,
-           type,
-           component[0],
-           component[1],
-           component[2],
-           component[3],
-           component[4],
-           component[5],
-           component[6],
-           component[7],
-           component[8],
-           component[9],
-           NULL
-  );
+  babl_free (name);
+  babl_assert (!babl->format.planar);
+  return babl;
 }
 
 double
@@ -731,23 +922,238 @@ babl_format_get_encoding (const Babl *babl)
   return babl_get_name (babl);
 }
 
+/* Interning table for babl_format_with_space (), mapping an encoding format
+ * and a space to the resulting format. Encoding strings are resolved to
+ * their format first, the keys are never freed, so slots never go stale.
+ * Lookups do not take any locks, slots are written once, with the key stored
+ * last, under babl_format_mutex. When the table grows a new one is published
+ * and the old one kept around for readers still probing it until
+ * babl_format_class_deinit ().
+ */
+#define BABL_FORMAT_SPACE_TABLE_INITIAL_SIZE  256
+
+typedef struct BablFormatSpaceSlot
+{
+  const Babl *BABL_ATOMIC encoding;
+  const Babl             *space;
+  const Babl             *format;
+} BablFormatSpaceSlot;
+
+typedef struct BablFormatSpaceTable BablFormatSpaceTable;
+
+struct BablFormatSpaceTable
+{
+  int                   mask;
+  int                   count;
+  BablFormatSpaceTable *previous;
+  BablFormatSpaceSlot   slots[];
+};
+
+static BablFormatSpaceTable *BABL_ATOMIC format_space_table = NULL;
+
+static inline unsigned int
+format_space_hash (const Babl *encoding,
+                   const Babl *space)
+{
+  uintptr_t hash = ((uintptr_t) encoding >> 3) * 0x9e3779b1u;
+  hash ^= ((uintptr_t) space >> 4) * 0x85ebca6bu;
+  return (unsigned int) (hash ^ (hash >> 15));
+}
+
+static inline const Babl *
+format_space_slot_encoding (BablFormatSpaceSlot *slot)
+{
+#ifdef HAVE_STDATOMIC_H
+  return atomic_load_explicit (&slot->encoding, memory_order_acquire);
+#else
+  return slot->encoding;
+#endif
+}
+
+static inline BablFormatSpaceTable *
+format_space_table_get (void)
+{
+#ifdef HAVE_STDATOMIC_H
+  return atomic_load_explicit (&format_space_table, memory_order_acquire);
+#else
+  return format_space_table;
+#endif
+}
+
+static const Babl *
+format_space_lookup (BablFormatSpaceTable *table,
+                     const Babl           *encoding,
+                     const Babl           *space)
+{
+  unsigned int i;
+
+  if (!table)
+    return NULL;
+
+  for (i = format_space_hash (encoding, space);; i++)
+    {
+      BablFormatSpaceSlot *slot = &table->slots[i & table->mask];
+      const Babl          *slot_encoding = format_space_slot_encoding (slot);
+
+      if (!slot_encoding)
+        return NULL;
+      if (slot_encoding == encoding && slot->space == space)
+        return slot->format;
+    }
+}
+
+static void
+format_space_slot_set (BablFormatSpaceTable *table,
+                       const Babl           *encoding,
+                       const Babl           *space,
+                       const Babl           *format)
+{
+  unsigned int i;
+
+  for (i = format_space_hash (encoding, space);; i++)
+    {
+      BablFormatSpaceSlot *slot = &table->slots[i & table->mask];
+
+      if (!format_space_slot_encoding (slot))
+        {
+          slot->space  = space;
+          slot->format = format;
+#ifdef HAVE_STDATOMIC_H
+          atomic_store_explicit (&slot->encoding, encoding, memory_order_release);
+#else
+          slot->encoding = encoding;
+#endif
+          table->count++;
+          return;
+        }
+    }
+}
+
+static BablFormatSpaceTable *
+format_space_table_new (int size)
+{
+  BablFormatSpaceTable *table;
+
+  table = babl_calloc (1, sizeof (BablFormatSpaceTable) +
+                          sizeof (BablFormatSpaceSlot) * size);
+  table->mask = size - 1;
+  return table;
+}
+
+/* must be called with babl_format_mutex held */
+static void
+format_space_insert (const Babl *encoding,
+                     const Babl *space,
+                     const Babl *format)
+{
+  BablFormatSpaceTable *table = format_space_table_get ();
+
+  if (!table || (table->count + 1) * 2 > table->mask + 1)
+    {
+      BablFormatSpaceTable *new_table;
+      int                   i;
+
+      new_table = format_space_table_new (
+                    table ? (table->mask + 1) * 2
+                          : BABL_FORMAT_SPACE_TABLE_INITIAL_SIZE);
+
+      if (table)
+        {
+          for (i = 0; i <= table->mask; i++)
+            {
+              BablFormatSpaceSlot *slot = &table->slots[i];
+              if (slot->encoding)
+                format_space_slot_set (new_table, slot->encoding, slot->space,
+                                       slot->format);
+            }
+        }
+      new_table->previous = table;
+      table = new_table;
+#ifdef HAVE_STDATOMIC_H
+      atomic_store_explicit (&format_space_table, table, memory_order_release);
+#else
+      format_space_table = table;
+#endif
+    }
+
+  format_space_slot_set (table, encoding, space, format);
+}
+
+/* the encodings babl itself asks for in other spaces, resolved once */
+static const Babl *format_rgba_float  = NULL;
+static const Babl *format_rgba_double = NULL;
+
+void
+babl_format_class_init (void)
+{
+  format_rgba_float  = babl_format ("RGBA float");
+  format_rgba_double = babl_format ("RGBA double");
+}
+
 const Babl *
-babl_format_with_space (const char *encoding, const Babl *space)
+_babl_format_rgba_float (void)
 {
-  const Babl *example_format = (void*) encoding;
-  if (!encoding) return NULL;
+  return format_rgba_float;
+}
 
-  if (BABL_IS_BABL (example_format))
-  {
-    encoding = babl_get_name (example_format);
-    if (babl_format_get_space (example_format) != babl_space ("sRGB"))
+const Babl *
+_babl_format_rgba_double (void)
+{
+  return format_rgba_double;
+}
+
+void
+babl_format_class_deinit (void)
+{
+  BablFormatSpaceTable *table = format_space_table_get ();
+
+  format_space_table = NULL;
+  format_rgba_float  = NULL;
+  format_rgba_double = NULL;
+
+  while (table)
     {
-      encoding = babl_format_get_encoding (example_format);
+      BablFormatSpaceTable *previous = table->previous;
+      babl_free (table);
+      table = previous;
     }
+}
+
+static const Babl *
+format_with_space (const Babl *example_format,
+                   const Babl *space)
+{
+  if (babl_format_get_space (example_format) != _babl_space_srgb ())
+    example_format = babl_format (babl_format_get_encoding (example_format));
+
+  if (space == _babl_space_srgb ())
+    return example_format;
+
+  if (babl_format_is_palette (example_format))
+  {
+    /* XXX we should allocate a new palette name, and 
+           duplicate the path data, converted for new space
+     */
+    return example_format;
   }
 
+  return format_new_from_format_with_space (example_format, space);
+}
+
+const Babl *
+babl_format_with_space (const char *encoding, const Babl *space)
+{
+  const Babl *example_format = (void*) encoding;
+  const Babl *format;
+
+  if (!encoding) return NULL;
+
+  /* keyed on the format, the buffer holding a string might get reused */
+  if (!BABL_IS_BABL (example_format))
+    example_format = babl_format (encoding);
+
   if (!space)
-    space = babl_space ("sRGB");
+    space = _babl_space_srgb ();
 
   if (space->class_type == BABL_FORMAT)
   {
@@ -761,20 +1167,21 @@ babl_format_with_space (const char *encoding, const Babl *space)
   {
     return NULL;
   }
-  example_format = babl_format (encoding);
 
-  if (space == babl_space("sRGB"))
-    return example_format;
+  format = format_space_lookup (format_space_table_get (), example_format, space);
+  if (format)
+    return format;
 
-  if (babl_format_is_palette (example_format))
-  {
-    /* XXX we should allocate a new palette name, and 
-           duplicate the path data, converted for new space
-     */
-    return example_format;
-  }
+  babl_mutex_lock (babl_format_mutex);
+  format = format_space_lookup (format_space_table_get (), example_format, space);
+  if (!format)
+    {
+      format = format_with_space (example_format, space);
+      format_space_insert (example_format, space, format);
+    }
+  babl_mutex_unlock (babl_format_mutex);
 
-  return format_new_from_format_with_space (example_format, space);
+  return format;
 }
 
 int
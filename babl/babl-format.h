@@ -21,11 +21,15 @@
 
 BABL_CLASS_DECLARE (format);
 
+/* the members up to type are laid out like in BablModel, the rest is
+ * packed without padding, with bytes_per_pixel in the first cache line.
+ */
 typedef struct
 {
   BablInstance     instance;
   BablList        *from_list;
   int              components;
+  int              bytes_per_pixel;
   BablComponent  **component;
   BablType       **type;
   BablModel       *model;
@@ -35,15 +39,35 @@ typedef struct
                                       linear (non-planer) images */
 
   BablSampling   **sampling;
-  int              bytes_per_pixel;
   int              planar;
-  double           loss; /*< average relative error when converting
-                             from and to RGBA double */
+  int              bitpacked; /* components share a little endian word,
+                                 see babl_format_new () */
   int              visited; /* for convenience in code while searching
                                for conversion paths */
   int              format_n; /* whether the format is a format_n type or not */
   int              palette;
+  double           loss; /*< average relative error when converting
+                             from and to RGBA double */
   const char      *encoding;
 } BablFormat;
 
+void
+babl_format_class_init (void);
+
+void
+babl_format_class_deinit (void);
+
+/* _babl_format_rgba_float:
+ *
+ * Returns the same format as babl_format ("RGBA float"), without the lookup
+ * by name; passed as encoding to babl_format_with_space () it is resolved
+ * with a single pointer probe. _babl_format_rgba_double () is the same for
+ * "RGBA double".
+ */
+const Babl *
+_babl_format_rgba_float (void);
+
+const Babl *
+_babl_format_rgba_double (void);
+
 #endif
@@ -16,99 +16,220 @@
  * <https://www.gnu.org/licenses/>.
  */
 
-/* Implementation of hash table data structure based on coalesced hashing.
+/* Implementation of hash table data structure based on open addressing.
  * Copyright (C) 2008, Jan Heller
+ *
+ * Slots are grouped in runs of 16, with one control byte per slot holding
+ * either BABL_HASH_EMPTY or 7 bits of the item hash, the full hash is stored
+ * along with the item. A lookup scans the control bytes of one group at a
+ * time (with SSE2 when available) and only looks at items whose stored hash
+ * matches, an insert takes the first free slot in the probe sequence. Items
+ * are never removed, so no tombstones are needed.
+ *
+ * Lookups do not take locks, inserts are serialized by the owner of the
+ * table (the BablDb mutex). A slot is filled in before its control byte is
+ * published, and when growing, the new slot arrays are published as a whole
+ * while the old ones are kept readable until the table is destroyed.
  */
 
 #include "config.h"
 #include "babl-internal.h"
 
-#define BABL_HASH_TABLE_INITIAL_MASK   0x1FF  /* 511 */
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-/* static functions declarations */
-static inline int
-hash_insert (BablHashTable *htab,
-             Babl          *item);
+#ifdef HAVE_STDATOMIC_H
+#include <stdatomic.h>
+#endif
 
-static void
-hash_rehash (BablHashTable *htab);
+#define BABL_HASH_TABLE_INITIAL_SIZE   512
+#define BABL_HASH_GROUP_SIZE           16
+#define BABL_HASH_EMPTY                0x80
 
-static inline int
-hash_insert (BablHashTable *htab,
-             Babl          *item)
+typedef struct _BablHashTableData
+{
+  int                        mask;    /* number of slots - 1 */
+  struct _BablHashTableData *retired; /* previous, smaller slot arrays */
+  unsigned char             *ctrl;
+  unsigned int              *hashes;
+  Babl                     **items;
+} _BablHashTableData;
+
+static inline unsigned char
+hash_h2 (unsigned int hash)
+{
+  return hash & 0x7f;
+}
+
+static inline BablHashTableData *
+hash_data_get (BablHashTable *htab)
 {
-  int hash = htab->hash_func(htab, item);
+#ifdef HAVE_STDATOMIC_H
+  return atomic_load_explicit ((_Atomic (BablHashTableData *) *) &htab->data,
+                               memory_order_acquire);
+#else
+  return htab->data;
+#endif
+}
 
-  if (htab->data_table[hash] == NULL)
+static inline void
+hash_data_set (BablHashTable     *htab,
+               BablHashTableData *data)
+{
+#ifdef HAVE_STDATOMIC_H
+  atomic_store_explicit ((_Atomic (BablHashTableData *) *) &htab->data,
+                         data, memory_order_release);
+#else
+  htab->data = data;
+#endif
+}
+
+static inline unsigned char
+hash_ctrl_get (const unsigned char *ctrl)
+{
+#ifdef HAVE_STDATOMIC_H
+  return atomic_load_explicit ((_Atomic (unsigned char) *) ctrl,
+                               memory_order_acquire);
+#else
+  return *ctrl;
+#endif
+}
+
+static inline void
+hash_ctrl_set (unsigned char *ctrl,
+               unsigned char  value)
+{
+#ifdef HAVE_STDATOMIC_H
+  atomic_store_explicit ((_Atomic (unsigned char) *) ctrl, value,
+                         memory_order_release);
+#else
+  *ctrl = value;
+#endif
+}
+
+/* returns a bitmask of the slots in the group with control byte value */
+static inline unsigned int
+hash_group_match (const unsigned char *group,
+                  unsigned char        value)
+{
+#ifdef __SSE2__
+  __m128i ctrl = _mm_loadu_si128 ((const __m128i *) group);
+  unsigned int mask = _mm_movemask_epi8 (
+                        _mm_cmpeq_epi8 (ctrl, _mm_set1_epi8 ((char) value)));
+#ifdef HAVE_STDATOMIC_H
+  /* order the reads of the matching slots after the control bytes */
+  atomic_thread_fence (memory_order_acquire);
+#endif
+  return mask;
+#else
+  unsigned int mask = 0;
+  int i;
+  for (i = 0; i < BABL_HASH_GROUP_SIZE; i++)
+    if (hash_ctrl_get (&group[i]) == value)
+      mask |= 1u << i;
+  return mask;
+#endif
+}
+
+static inline int
+hash_first_bit (unsigned int mask)
+{
+#if defined(__GNUC__)
+  return __builtin_ctz (mask);
+#else
+  int i = 0;
+  while (!(mask & 1))
     {
-      /* create new chain */
-      htab->data_table[hash] = item;
+      mask >>= 1;
+      i++;
     }
-  else
+  return i;
+#endif
+}
+
+static BablHashTableData *
+hash_data_new (int size)
+{
+  BablHashTableData *data;
+  size_t             header = (sizeof (BablHashTableData) + 15) & ~15;
+
+  data = babl_malloc (header +
+                      size * sizeof (unsigned char) +
+                      size * sizeof (unsigned int) +
+                      size * sizeof (Babl *));
+  data->mask    = size - 1;
+  data->retired = NULL;
+  data->ctrl    = ((unsigned char *) data) + header;
+  data->hashes  = (void *) (data->ctrl + size);
+  data->items   = (void *) (data->hashes + size);
+  memset (data->ctrl, BABL_HASH_EMPTY, size);
+  return data;
+}
+
+static inline void
+hash_data_insert (BablHashTableData *data,
+                  unsigned int       hash,
+                  Babl              *item)
+{
+  int groups = (data->mask + 1) / BABL_HASH_GROUP_SIZE;
+  int group  = (hash >> 7) & (groups - 1);
+  int step   = 0;
+
+  for (;;)
     {
-      int it, oit, cursor = 0;
+      unsigned char *ctrl  = &data->ctrl[group * BABL_HASH_GROUP_SIZE];
+      unsigned int   empty = hash_group_match (ctrl, BABL_HASH_EMPTY);
 
-      while ((cursor < (htab->mask + 1)) && (htab->data_table[cursor] != NULL))
-        ++cursor;
+      if (empty)
+        {
+          int slot = group * BABL_HASH_GROUP_SIZE + hash_first_bit (empty);
 
-      htab->data_table[cursor] = item;
+          data->hashes[slot] = hash;
+          data->items[slot]  = item;
+          hash_ctrl_set (&data->ctrl[slot], hash_h2 (hash));
+          return;
+        }
 
-      for (oit = hash, it = htab->chain_table[oit]; it != -1; oit = it, it = htab->chain_table[oit])
-        ;
-      htab->chain_table[oit] = cursor;
+      /* triangular probing visits every group of a power of two table */
+      group = (group + ++step) & (groups - 1);
     }
-
-  htab->count++;
-  return 0;
 }
 
 static void
 hash_rehash (BablHashTable *htab)
 {
-  Babl *item;
-  int  i;
-  BablHashTable *nhtab = babl_calloc (sizeof (BablHashTable), 1);
-
-  nhtab->data_table = NULL;
-  nhtab->chain_table = NULL;
-  nhtab->mask = (htab->mask << 1) + 1;
-  nhtab->count = 0;
-  nhtab->hash_func = htab->hash_func;
-  nhtab->find_func = htab->find_func;
-  if (nhtab->mask)
-    {
-      nhtab->data_table = babl_calloc (sizeof (BablInstance *), babl_hash_table_size(nhtab));
-      nhtab->chain_table = babl_malloc (sizeof (int) * babl_hash_table_size(nhtab));
-      memset (nhtab->chain_table, -1, sizeof (int) * babl_hash_table_size(nhtab));
-    }
+  BablHashTableData *data = htab->data;
+  BablHashTableData *ndata = hash_data_new ((data->mask + 1) * 2);
+  int                i;
 
-  for (i = 0; i < babl_hash_table_size (htab); i++)
-    {
-      item = htab->data_table[i];
-      babl_hash_table_insert (nhtab, item);
-    }
+  for (i = 0; i <= data->mask; i++)
+    if (data->ctrl[i] != BABL_HASH_EMPTY)
+      hash_data_insert (ndata, data->hashes[i], data->items[i]);
 
-  htab->mask = nhtab->mask;
-  babl_free (htab->data_table);
-  babl_free (htab->chain_table);
-  htab->data_table = nhtab->data_table;
-  htab->chain_table = nhtab->chain_table;
-  babl_free (nhtab);
+  ndata->retired = data;
+  hash_data_set (htab, ndata);
 }
 
 int
 babl_hash_table_size (BablHashTable *htab)
 {
-    return htab->mask + 1;
+  return hash_data_get (htab)->mask + 1;
 }
 
 
 static int
 babl_hash_table_destroy (void *data)
 {
-  BablHashTable *htab = data;
-  babl_free (htab->data_table);
-  babl_free (htab->chain_table);
+  BablHashTable     *htab = data;
+  BablHashTableData *hdata = htab->data;
+
+  while (hdata)
+    {
+      BablHashTableData *retired = hdata->retired;
+      babl_free (hdata);
+      hdata = retired;
+    }
   return 0;
 }
 
@@ -125,18 +246,10 @@ babl_hash_table_init (BablHashValFunction  hfunc,
   htab = babl_calloc (sizeof (BablHashTable), 1);
   babl_set_destructor (htab, babl_hash_table_destroy);
 
-  htab->data_table = NULL;
-  htab->chain_table = NULL;
-  htab->mask = BABL_HASH_TABLE_INITIAL_MASK;
+  htab->data = hash_data_new (BABL_HASH_TABLE_INITIAL_SIZE);
   htab->count = 0;
   htab->hash_func = hfunc;
   htab->find_func = ffunc;
-  if (htab->mask)
-  {
-      htab->data_table = babl_calloc (sizeof (BablInstance *), babl_hash_table_size(htab));
-      htab->chain_table = babl_malloc (sizeof (int) * babl_hash_table_size(htab));
-      memset (htab->chain_table, -1, sizeof (int) * babl_hash_table_size(htab));
-  }
 
   return htab;
 }
@@ -148,9 +261,13 @@ babl_hash_table_insert (BablHashTable *htab,
   babl_assert (htab);
   babl_assert (BABL_IS_BABL(item));
 
-  if (babl_hash_table_size (htab) < htab->count + 1)
+  /* keep the load factor at or below 7/8 */
+  if ((htab->count + 1) * 8 > (htab->data->mask + 1) * 7)
     hash_rehash (htab);
-  return hash_insert (htab, item);
+
+  hash_data_insert (htab->data, htab->hash_func (htab, item), item);
+  htab->count++;
+  return 0;
 }
 
 Babl *
@@ -159,32 +276,39 @@ babl_hash_table_find (BablHashTable       *htab,
                       BablHashFindFunction find_func,
                       void                *data)
 {
-  int  it;
-  Babl *item;
+  BablHashTableData *hdata;
+  unsigned int       uhash = hash;
+  int                groups;
+  int                group;
+  int                step = 0;
 
   babl_assert (htab);
 
-  it = hash;
-  item = htab->data_table[it];
+  if (!find_func)
+    find_func = htab->find_func;
 
-  if (!item)
-    return NULL;
+  hdata  = hash_data_get (htab);
+  groups = (hdata->mask + 1) / BABL_HASH_GROUP_SIZE;
+  group  = (uhash >> 7) & (groups - 1);
 
   for (;;)
     {
-      if (find_func)
+      const unsigned char *ctrl  = &hdata->ctrl[group * BABL_HASH_GROUP_SIZE];
+      unsigned int         match = hash_group_match (ctrl, hash_h2 (uhash));
+
+      while (match)
         {
-          if (find_func (item, data))
-            return item;
+          int slot = group * BABL_HASH_GROUP_SIZE + hash_first_bit (match);
+
+          if (hdata->hashes[slot] == uhash &&
+              find_func (hdata->items[slot], data))
+            return hdata->items[slot];
+          match &= match - 1;
         }
-      else if (htab->find_func (item, data))
-        return item;
-      it = htab->chain_table[it];
-      if (it == -1)
-        break;
-      item = htab->data_table[it];
-    }
 
-  return NULL;
-}
+      if (hash_group_match (ctrl, BABL_HASH_EMPTY))
+        return NULL;
 
+      group = (group + ++step) & (groups - 1);
+    }
+}
@@ -25,15 +25,15 @@
 
 
 typedef struct _BablHashTable BablHashTable;
+typedef struct _BablHashTableData BablHashTableData;
 
+/* hash functions return the full, unmasked hash of an item */
 typedef int  (*BablHashValFunction) (BablHashTable *htab, Babl *item);
 typedef int  (*BablHashFindFunction) (Babl *item, void *data);
 
 typedef struct _BablHashTable
 {
-  Babl                 **data_table;
-  int                  *chain_table;
-  int                  mask;
+  BablHashTableData   *data;
   int                  count;
   BablHashValFunction  hash_func;
   BablHashFindFunction find_func;
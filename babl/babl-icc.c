@@ -567,6 +567,28 @@ switch (trc->type)
             babl_trc_to_linear ((void*)trc, j / (lut_size-1.0)) * 65535.5);
       }
     }
+    break;
+  // linear goes past 1.0 for these, curv can only hold them up to the peak
+  case BABL_TRC_PQ:
+  case BABL_TRC_HLG:
+    {
+      int   lut_size = 1024;
+      float peak     = babl_trc_to_linear ((void*)trc, 1.0f);
+      if (flags == BABL_ICC_COMPACT_TRC_LUT)
+        lut_size = 128;
+
+      icc_allocate_tag (state, name, 12 + lut_size * 2);
+      icc_write (sign, state->o, "curv");
+      icc_write (u32, state->o + 4, 0);
+      icc_write (u32, state->o + 8, lut_size);
+      {
+        int j;
+        for (j = 0; j < lut_size; j ++)
+        icc_write (u16, state->o + 12 + j * 2,
+            babl_trc_to_linear ((void*)trc, j / (lut_size-1.0)) / peak * 65535.5);
+      }
+    }
+    break;
 }
 }
 
@@ -32,10 +32,18 @@ enum {
 
   BABL_U8_LUMA,
   BABL_U8_CHROMA,
+  BABL_U8_CHROMA_FULL,
+  BABL_U16_LUMA,
+  BABL_U16_CHROMA,
+  BABL_U16_CHROMA_FULL,
   BABL_U16_CIE_L,
   BABL_U16_CIE_AB,
   BABL_U8_CIE_L,
   BABL_U8_CIE_AB,
+  BABL_U16BE,
+  BABL_U32BE,
+  BABL_FLOATBE,
+  BABL_BFLOAT16,
   BABL_TYPE_LAST_INTERNAL,
 
   BABL_MODEL_BASE = 1000,
@@ -123,6 +131,7 @@ enum {
   BABL_YCBCR411,
   BABL_YCBCR422,
   BABL_YCBCR420,
+  BABL_YCBCR_NV12,
   BABL_FORMAT_LAST_INTERNAL,
 
   BABL_PIXEL_USER_BASE
@@ -71,6 +71,7 @@ image_new (BablFormat     *format,
   babl->image.components = components;
 
   memcpy (babl->image.component, component, components * sizeof (void *));
+  memcpy (babl->image.sampling, sampling, components * sizeof (void *));
   memcpy (babl->image.type, type, components * sizeof (void *));
   memcpy (babl->image.data, data, components * sizeof (void *));
   memcpy (babl->image.pitch, pitch, components * sizeof (int));
@@ -183,6 +184,42 @@ babl_image_from_linear (char       *buffer,
   return babl;
 }
 
+Babl *
+babl_image_from_planes (const Babl *format,
+                        void      **planes,
+                        const int  *strides)
+{
+  BablSampling  *sampling  [BABL_MAX_COMPONENTS];
+  BablType      *type      [BABL_MAX_COMPONENTS];
+  char          *data      [BABL_MAX_COMPONENTS];
+  int            plane     [BABL_MAX_COMPONENTS];
+  int            offset    [BABL_MAX_COMPONENTS];
+  int            pitch     [BABL_MAX_COMPONENTS];
+  int            stride    [BABL_MAX_COMPONENTS];
+  int            components;
+  int            i;
+
+  babl_assert (format && format->class_type == BABL_FORMAT);
+
+  components = format->format.components;
+  babl_format_get_plane_layout (format, plane, offset, pitch);
+
+  for (i = 0; i < components; i++)
+    {
+      sampling[i] = format->format.sampling[i];
+      type[i]     = format->format.type[i];
+      data[i]     = (char *) planes[plane[i]] + offset[i];
+      stride[i]   = strides[plane[i]];
+    }
+
+  /* the format is left out, the image would otherwise be kept as the
+   * format's linear image template when freed
+   */
+  return image_new (NULL, format->format.model, components,
+                    format->format.component,
+                    sampling, type, data, pitch, stride);
+}
+
 Babl *
 babl_image_new (const void *first,
                 ...)
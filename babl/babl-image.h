@@ -30,6 +30,12 @@ BABL_CLASS_DECLARE (image);
  * needed for this since the polymorphism cannot be trusted to work on linear
  * buffers that originate outside babl's control.
  *
+ * babl_process_planar() is that second function, it wraps the planes it is
+ * given in BablImages - see babl_image_from_planes() - honoring the sampling
+ * of the components, and processes them with babl_image_process().
+ * It is the stable entry point for planar buffers; BablImages themselves
+ * remain an implementation detail.
+ *
  * Babl * babl_image_new (BablComponent *component1,
  *                        void          *data,
  *                        int            pitch,
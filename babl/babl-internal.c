@@ -90,6 +90,7 @@ babl_internal_init (void)
 {
   babl_set_malloc (malloc);
   babl_set_free (free);
+  babl_arena_init ();
   babl_fish_mutex = babl_mutex_new ();
   babl_format_mutex = babl_mutex_new ();
   babl_reference_mutex = babl_mutex_new ();
@@ -101,6 +102,7 @@ babl_internal_init (void)
 void
 babl_internal_destroy (void)
 {
+  babl_arena_deinit ();
   babl_mutex_destroy (babl_fish_mutex);
   babl_mutex_destroy (babl_format_mutex);
   babl_mutex_destroy (babl_reference_mutex);
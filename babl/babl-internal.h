@@ -27,7 +27,7 @@
 #error babl-internal.h included after babl.h
 #endif
 
-#define BABL_MAX_COMPONENTS       32
+#define BABL_MAX_COMPONENTS       128
 #define BABL_CONVERSIONS          5
 
 
@@ -67,6 +67,7 @@ Babl *   babl_conversion_find           (const void     *source,
                                          const void     *destination);
 double   babl_conversion_error          (BablConversion *conversion);
 long     babl_conversion_cost           (BablConversion *conversion);
+int      babl_conversion_is_superseded  (const Babl     *conversion);
 
 Babl   * babl_extension_base            (void);
 
@@ -95,6 +96,20 @@ double   babl_format_loss               (const Babl     *babl);
 Babl   * babl_image_from_linear         (char           *buffer,
                                          const Babl     *format);
 Babl   * babl_image_double_from_image   (const Babl     *source);
+Babl   * babl_image_from_planes         (const Babl     *format,
+                                         void          **planes,
+                                         const int      *strides);
+long     babl_image_process             (const Babl     *babl,
+                                         const Babl     *source,
+                                         Babl           *destination,
+                                         long            width,
+                                         int             rows);
+const Babl *babl_format_packed          (const Babl     *format,
+                                         const Babl     *type);
+int      babl_format_get_plane_layout   (const Babl     *format,
+                                         int            *plane,
+                                         int            *offset,
+                                         int            *pitch);
 
 double   babl_model_is_symmetric        (const Babl     *babl);
 void     babl_die                       (void);
@@ -108,6 +123,11 @@ const char * babl_get_doc (const Babl *babl);
 void     babl_core_init                 (void);
 const Babl *babl_format_with_model_as_type (const Babl     *model,
                                          const Babl     *type);
+const Babl *babl_model_new_n            (const char     *name,
+                                         int             components,
+                                         const Babl    **component,
+                                         BablModelFlag   flags,
+                                         const char     *doc);
 int      babl_formats_count             (void);                                     /* should maybe be templated? */
 int      babl_type_is_symmetric         (const Babl     *babl);
 
@@ -359,6 +379,19 @@ _conversion_new (const char    *name,
 double _babl_legal_error (void);
 void babl_init_db (void);
 void babl_store_db (void);
+const char *_babl_cost_profile_default_path (void);
+
+/* calibrated conversion costs, see babl-cost-profile.c */
+void   babl_cost_profile_load        (void);
+void   babl_cost_profile_unload      (void);
+int    babl_cost_profile_calibrate   (const char *path);
+int    _babl_cost_profile_loaded     (void);
+double _babl_cost_profile_conversion (const Babl *conversion);
+int    _babl_cost_profile_estimate   (BablList   *path,
+                                      const Babl *source,
+                                      const Babl *destination,
+                                      double     *path_cost,
+                                      double     *ref_cost);
 int _babl_max_path_len (void);
 
 
@@ -440,6 +473,57 @@ babl_conversion_process (const Babl *babl,
   conversion->dispatch (babl, source, destination, n, conversion->data);
 }
 
+/* a step of a BablColorTransform, one of the calls babl_process () makes
+ * to convert a single pixel, taken from and stored to buffers by index
+ */
+typedef enum
+{
+  BABL_COLOR_STEP_DISPATCH, /* a linear conversion, or a fish's dispatch */
+  BABL_COLOR_STEP_PLANAR,   /* a model conversion taking components */
+  BABL_COLOR_STEP_PLANE,    /* a type conversion of one component */
+  BABL_COLOR_STEP_FILL,     /* a component missing from the source */
+  BABL_COLOR_STEP_MATRIX,   /* RGB to RGB of another space, in double */
+  BABL_COLOR_STEP_MATRIXF   /* the same in float */
+} BablColorStepKind;
+
+#define BABL_COLOR_SOURCE       0
+#define BABL_COLOR_DESTINATION  1
+#define BABL_COLOR_SCRATCH      2
+#define BABL_COLOR_SCRATCHES    3
+#define BABL_COLOR_MAX_STEPS    (BABL_MAX_COMPONENTS * 2 + 8)
+
+typedef struct
+{
+  BablColorStepKind  kind;
+  int                src;
+  int                dst;
+  int                src_offset;
+  int                dst_offset;
+  int                src_pitch;  /* the pitches a PLANE or PLANAR has */
+  int                dst_pitch;
+  int                src_bands;  /* components of a PLANAR */
+  int                dst_bands;
+  int                size;       /* bytes of a component of a PLANAR, or
+                                    of the value a FILL stores */
+  const Babl        *babl;       /* first argument of the function */
+  union
+    {
+      void         (*dispatch) (const Babl *babl, const char *src, char *dst,
+                                long n, void *user_data);
+      BablFuncPlane  plane;
+      BablFuncPlanar planar;
+    } function;
+  void              *data;
+  double             value;
+  double             matrix[9];
+  float              matrixf[9];
+} BablColorStep;
+
+int       _babl_fish_reference_compile (const Babl    *babl,
+                                        BablColorStep *steps);
+BablList *_babl_fish_path_conversions  (const Babl    *babl);
+
+void _babl_fish_cache_invalidate (void);
 void _babl_fish_missing_fast_path_warning (const Babl *source,
                                            const Babl *destination);
 void _babl_fish_rig_dispatch (Babl *babl);
@@ -27,6 +27,7 @@ static void sampling_introspect (Babl *babl);
 static void model_introspect (Babl *babl);
 static void type_introspect (Babl *babl);
 static void format_introspect (Babl *babl);
+static void memory_introspect (void);
 
 static int  each_introspect (Babl *babl,
                              void *user_data);
@@ -79,6 +80,9 @@ babl_introspect (Babl *babl)
   babl_log ("fishes");
   babl_fish_class_for_each (each_introspect, NULL);
   babl_log ("");
+  babl_log ("memory footprint:");
+  memory_introspect ();
+  babl_log ("");
 
   babl_set_extender (extender_backup);
 #endif
@@ -103,6 +107,29 @@ item_conversions_introspect (Babl *babl)
    }
 }
 
+static void
+memory_introspect (void)
+{
+  BablClassType klass;
+  long          total_bytes = 0;
+  long          total_reserved = 0;
+
+  for (klass = BABL_INSTANCE; klass <= BABL_SKY; klass++)
+    {
+      long instances, bytes, reserved;
+
+      babl_arena_stats (klass, &instances, &bytes, &reserved);
+      if (!reserved)
+        continue;
+      babl_log ("\t%-22s %6li instances %8li bytes %8li reserved",
+                babl_class_name (klass), instances, bytes, reserved);
+      total_bytes    += bytes;
+      total_reserved += reserved;
+    }
+  babl_log ("\t%-22s %6s           %8li bytes %8li reserved",
+            "total", "", total_bytes, total_reserved);
+}
+
 static void
 model_introspect (Babl *babl)
 {
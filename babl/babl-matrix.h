@@ -2,6 +2,7 @@
 #define _BABL_MATRIX_H_
 
 #include <stdio.h>
+#include "babl-vector.h"
 
 #define m(matr, j, i)  matr[j*3+i]
 
@@ -165,6 +166,30 @@ static inline void babl_matrix_mul_vectorff_buf3 (const float *mat, const float
   }
 }
 
+#ifdef BABL_VECTOR
+
+static inline void babl_matrix_mul_vectorff_buf4 (const float *mat, const float *v_in, float *v_out,
+                                                  int samples)
+{
+  const BablV4f m_0 = {m(mat, 0, 0), m(mat, 1, 0), m(mat, 2, 0), 0.0f};
+  const BablV4f m_1 = {m(mat, 0, 1), m(mat, 1, 1), m(mat, 2, 1), 0.0f};
+  const BablV4f m_2 = {m(mat, 0, 2), m(mat, 1, 2), m(mat, 2, 2), 0.0f};
+  int i;
+  for (i = 0; i < samples; i ++)
+  {
+    const float a = v_in[0], b = v_in[1], c = v_in[2], alpha = v_in[3];
+
+    babl_v4f_store (v_out, m_0 * babl_v4f_splat (a) +
+                           m_1 * babl_v4f_splat (b) +
+                           m_2 * babl_v4f_splat (c));
+    v_out[3] = alpha;
+    v_in  += 4;
+    v_out += 4;
+  }
+}
+
+#else
+
 static inline void babl_matrix_mul_vectorff_buf4 (const float *mat, const float *v_in, float *v_out,
                                                   int samples)
 {
@@ -191,6 +216,8 @@ static inline void babl_matrix_mul_vectorff_buf4 (const float *mat, const float
   }
 }
 
+#endif /* BABL_VECTOR */
+
 static inline void babl_matrix_mul_vector_buf4 (const double *mat, const double *v_in, double *v_out,
                                                 int samples)
 {
@@ -42,6 +42,7 @@ babl_set_free (BablFreeFunc free_function)
 }
 
 static char *signature = "babl-memory";
+static char *arena_signature = "babl-memory-arena";
 static char *freed = "So long and thanks for all the fish.";
 
 typedef struct
@@ -54,7 +55,48 @@ typedef struct
 #define BABL_ALIGN     16
 #define BABL_ALLOC     (sizeof (BablAllocInfo) + sizeof (void *))
 #define BAI(ptr)       ((BablAllocInfo *) *((void **) ptr - 1))
-#define IS_BAI(ptr)    (BAI (ptr)->signature == signature)
+#define IS_BAI(ptr)    (BAI (ptr)->signature == signature || \
+                        BAI (ptr)->signature == arena_signature)
+#define IS_ARENA(ptr)  (BAI (ptr)->signature == arena_signature)
+
+/* Long-lived class instances (types, models, formats, conversions, fishes)
+ * are carved out of per-class arenas instead of individual mallocs. The
+ * instances of a class end up next to each other, each starting on a cache
+ * line, and the only per instance header is the pointer back to the
+ * BablAllocInfo, which is shared by all instances of the class. Freeing an
+ * instance runs the destructor, the memory is given back when babl is
+ * deinitialized.
+ */
+#define BABL_ARENA_ALIGN       64
+#define BABL_ARENA_CHUNK_MIN   (4 * 1024)
+#define BABL_ARENA_CHUNK_MAX   (64 * 1024)
+#define BABL_ARENA_CLASSES     (BABL_SKY - BABL_INSTANCE + 1)
+
+typedef struct _BablArenaChunk BablArenaChunk;
+
+struct _BablArenaChunk
+{
+  BablArenaChunk *next;
+  void           *block;  /* what malloc_f returned */
+  size_t          size;
+  size_t          used;
+};
+
+typedef struct
+{
+  BablAllocInfo   info;      /* must be first, shared by all instances */
+  BablArenaChunk *chunks;
+  void           *last;      /* most recent allocation */
+  size_t          last_used; /* chunk use to roll back to if it is freed */
+  long            instances;
+  long            bytes;
+} BablArena;
+
+static BablArena     arenas[BABL_ARENA_CLASSES];
+static BablAllocInfo arena_freed;
+static BablMutex    *arena_mutex = NULL;
+
+static void babl_arena_release (void *ptr);
 
 #if BABL_DEBUG_MEM
 
@@ -138,6 +180,10 @@ babl_set_destructor (void  *ptr,
                      int (*destructor)(void *ptr))
 {
   babl_assert (IS_BAI (ptr));
+  /* the destructor of arena memory is shared by the whole class */
+  if (IS_ARENA (ptr))
+    babl_assert (BAI (ptr)->destructor == NULL ||
+                 BAI (ptr)->destructor == destructor);
   BAI(ptr)->destructor = destructor;
 }
 
@@ -150,7 +196,7 @@ babl_dup (void *ptr)
 {
   void *ret;
 
-  babl_assert (IS_BAI (ptr));
+  babl_assert (IS_BAI (ptr) && !IS_ARENA (ptr));
 
   ret = babl_malloc (BAI (ptr)->size);
   memcpy (ret, ptr, BAI (ptr)->size);
@@ -179,7 +225,6 @@ babl_free (void *ptr,
     return;
   if (!IS_BAI (ptr))
     {
-      #define IS_BAI(ptr)    (BAI (ptr)->signature == signature)
       if (freed == BAI (ptr)->signature)
         fprintf (stderr, "\nbabl:double free detected\n");
       else
@@ -192,6 +237,12 @@ babl_free (void *ptr,
     if (BAI (ptr)->destructor (ptr))
       return; /* bail out on non 0 return from destructor */
 
+  if (IS_ARENA (ptr))
+    {
+      babl_arena_release (ptr);
+      return;
+    }
+
   BAI (ptr)->signature = freed;
   free_f (BAI (ptr));
 #if BABL_DEBUG_MEM
@@ -281,7 +332,7 @@ babl_calloc (size_t nmemb,
 size_t
 babl_sizeof (void *ptr)
 {
-  babl_assert (IS_BAI (ptr));
+  babl_assert (IS_BAI (ptr) && !IS_ARENA (ptr));
   return BAI (ptr)->size;
 }
 
@@ -348,6 +399,152 @@ babl_strcat (char       *dest,
   return ret;
 }
 
+void
+babl_arena_init (void)
+{
+  int i;
+
+  arena_mutex = babl_mutex_new ();
+  arena_freed.signature = freed;
+  for (i = 0; i < BABL_ARENA_CLASSES; i++)
+    {
+      memset (&arenas[i], 0, sizeof (BablArena));
+      arenas[i].info.signature = arena_signature;
+    }
+}
+
+void
+babl_arena_deinit (void)
+{
+  int i;
+
+  for (i = 0; i < BABL_ARENA_CLASSES; i++)
+    {
+      BablArenaChunk *chunk = arenas[i].chunks;
+
+      while (chunk)
+        {
+          BablArenaChunk *next = chunk->next;
+          free_f (chunk->block);
+          chunk = next;
+        }
+      memset (&arenas[i], 0, sizeof (BablArena));
+    }
+  babl_mutex_destroy (arena_mutex);
+  arena_mutex = NULL;
+}
+
+/* Allocate /size/ bytes, set to all zeros, for an instance of class
+ * /klass/. The memory can be passed to babl_free and babl_set_destructor
+ * like babl_malloc memory, but not be resized.
+ */
+void *
+babl_arena_calloc (BablClassType klass,
+                   size_t        size)
+{
+  BablArena      *arena;
+  BablArenaChunk *chunk;
+  size_t          offset = 0;
+  char           *ret;
+
+  babl_assert (klass >= BABL_INSTANCE && klass <= BABL_SKY);
+  arena = &arenas[klass - BABL_INSTANCE];
+
+  babl_mutex_lock (arena_mutex);
+
+  chunk = arena->chunks;
+  if (chunk)
+    offset = (chunk->used + sizeof (void *) + BABL_ARENA_ALIGN - 1) &
+             ~(size_t) (BABL_ARENA_ALIGN - 1);
+
+  if (!chunk || offset + size > chunk->size)
+    {
+      size_t chunk_size = BABL_ARENA_CHUNK_MIN;
+      char  *block;
+
+      /* chunks double in size, small classes stay small */
+      if (chunk && chunk->size * 2 <= BABL_ARENA_CHUNK_MAX)
+        chunk_size = chunk->size * 2;
+      else if (chunk)
+        chunk_size = BABL_ARENA_CHUNK_MAX;
+
+      if (chunk_size < BABL_ARENA_ALIGN + size)
+        chunk_size = BABL_ARENA_ALIGN + size;
+
+      functions_sanity ();
+      block = malloc_f (chunk_size + BABL_ARENA_ALIGN);
+      if (!block)
+        babl_fatal ("args=(%i, %i): failed", klass, size);
+
+      /* the chunk header fills the first cache line of the chunk */
+      chunk = (void *) (block + BABL_ARENA_ALIGN -
+                        (uintptr_t) block % BABL_ARENA_ALIGN);
+      chunk->block = block;
+      chunk->size  = chunk_size;
+      chunk->used  = sizeof (BablArenaChunk);
+      chunk->next  = arena->chunks;
+      arena->chunks = chunk;
+      offset = BABL_ARENA_ALIGN;
+    }
+
+  ret = (char *) chunk + offset;
+  memset (ret, 0, size);
+  *((void **) ret - 1) = &arena->info;
+
+  arena->last      = ret;
+  arena->last_used = chunk->used;
+  chunk->used      = offset + size;
+  arena->instances++;
+  arena->bytes    += size;
+
+  babl_mutex_unlock (arena_mutex);
+  return ret;
+}
+
+static void
+babl_arena_release (void *ptr)
+{
+  BablArena *arena = (BablArena *) BAI (ptr);
+
+  babl_mutex_lock (arena_mutex);
+  *((void **) ptr - 1) = &arena_freed;
+  arena->instances--;
+
+  /* give back the space of an instance that was discarded right after
+   * being created, like a fish path for which no path was found.
+   */
+  if (ptr == arena->last)
+    {
+      BablArenaChunk *chunk = arena->chunks;
+
+      arena->bytes -= chunk->used - ((char *) ptr - (char *) chunk);
+      chunk->used   = arena->last_used;
+      arena->last   = NULL;
+    }
+  babl_mutex_unlock (arena_mutex);
+}
+
+/* Returns the number of live instances of /klass/ in its arena, the bytes
+ * allocated for them and the bytes reserved by the arena.
+ */
+void
+babl_arena_stats (BablClassType klass,
+                  long         *instances,
+                  long         *bytes,
+                  long         *reserved)
+{
+  BablArena      *arena = &arenas[klass - BABL_INSTANCE];
+  BablArenaChunk *chunk;
+
+  babl_mutex_lock (arena_mutex);
+  *instances = arena->instances;
+  *bytes     = arena->bytes;
+  *reserved  = 0;
+  for (chunk = arena->chunks; chunk; chunk = chunk->next)
+    *reserved += chunk->size;
+  babl_mutex_unlock (arena_mutex);
+}
+
 #if BABL_DEBUG_MEM
 /* performs a sanity check on memory, (checks if number of
  * allocations and frees on babl memory evens out to zero).
@@ -46,4 +46,13 @@ char * babl_strdup         (const char *s);
 char * babl_strcat         (char       *dest,
                             const char *src);
 
+void   babl_arena_init     (void);
+void   babl_arena_deinit   (void);
+void * babl_arena_calloc   (BablClassType klass,
+                            size_t        size);
+void   babl_arena_stats    (BablClassType klass,
+                            long         *instances,
+                            long         *bytes,
+                            long         *reserved);
+
 #endif
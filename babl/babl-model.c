@@ -62,9 +62,9 @@ model_new (const char     *name,
 {
   Babl *babl;
 
-  babl = babl_malloc (sizeof (BablModel) +
-                      sizeof (BablComponent *) * (components) +
-                      strlen (name) + 1);
+  babl = babl_arena_calloc (BABL_MODEL, sizeof (BablModel) +
+                            sizeof (BablComponent *) * (components) +
+                            strlen (name) + 1);
   babl_set_destructor (babl, babl_model_destroy);
   babl->model.component = (void *) (((char *) babl) + sizeof (BablModel));
   babl->instance.name   = (void *) (((char *) babl->model.component) + sizeof (BablComponent *) * (components));
@@ -120,7 +120,7 @@ babl_model_new (void *first_argument,
   const char    *assigned_name = NULL;
   char          *name          = NULL;
   const char    *doc           = NULL;
-  const Babl    *space         = babl_space ("sRGB");
+  const Babl    *space         = _babl_space_srgb ();
   BablComponent *component [BABL_MAX_COMPONENTS];
   BablModelFlag  flags         = 0;
 
@@ -281,6 +281,44 @@ babl_model_new (void *first_argument,
 }
 
 
+/* babl_model_new () for models with more components than comfortably go
+ * in its argument list, like the bands of spectral models
+ */
+const Babl *
+babl_model_new_n (const char     *name,
+                  int             components,
+                  const Babl    **component,
+                  BablModelFlag   flags,
+                  const char     *doc)
+{
+  Babl *babl;
+
+  if (components > BABL_MAX_COMPONENTS)
+    {
+      babl_log ("maximum number of components (%i) exceeded for %s",
+                BABL_MAX_COMPONENTS, name);
+      return NULL;
+    }
+
+  babl = babl_db_exist (db, 0, name);
+  if (! babl)
+    {
+      babl = model_new (name, _babl_space_srgb (), 0, components,
+                        (BablComponent **) component, flags, doc);
+      babl_db_insert (db, babl);
+      babl_format_with_model_as_type (babl, babl_type_from_id (BABL_DOUBLE));
+    }
+  else if (!is_model_duplicate (babl, _babl_space_srgb (), components,
+                                (BablComponent **) component))
+    {
+      babl_fatal ("BablModel '%s' already registered "
+                  "with different components!", name);
+    }
+
+  return babl;
+}
+
+
 #define TOLERANCE      0.001
 
 static const Babl *
@@ -434,7 +472,7 @@ babl_remodel_with_space (const Babl *model,
   int i;
   assert (BABL_IS_BABL (model));
 
-  if (!space) space = babl_space ("sRGB");
+  if (!space) space = _babl_space_srgb ();
   if (space->class_type == BABL_FORMAT)
   {
     space = space->format.space;
@@ -315,7 +315,7 @@ make_pal (const Babl *pal_space,
 
   memcpy (pal->data, data, bpp * count);
 
-  babl_process (babl_fish (format, babl_format_with_space ("RGBA double", pal_space)),
+  babl_process (babl_fish (format, babl_format_with_space ((void *) _babl_format_rgba_double (), pal_space)),
                 data, pal->data_double, count);
   babl_process (babl_fish (format, babl_format_with_space ("R'G'B'A u8", pal_space)),
                 data, pal->data_u8, count);
@@ -932,6 +932,7 @@ babl_new_palette_with_space (const char  *name,
   if (format_u8_with_alpha)
     *format_u8_with_alpha = f_pal_a_u8;
   babl_sanity ();
+  _babl_fish_cache_invalidate ();
   return model;
 }
 
@@ -986,4 +987,5 @@ babl_palette_reset (const Babl *babl)
       babl_palette_free (*palptr);
     }
   *palptr = default_palette ();
+  _babl_fish_cache_invalidate ();
 }
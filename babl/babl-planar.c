@@ -0,0 +1,764 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* Processing of planar and chroma subsampled images.
+ *
+ * Fish paths only ever see linear buffers, so planar formats are handled
+ * row by row here. When a planar conversion is registered directly between
+ * the two formats of the fish - and the destination is not subsampled - it
+ * is handed the rows of every plane. Otherwise source rows are gathered
+ * into the packed counterpart of the source format, replicating subsampled
+ * components, and converted with a regular fish. For subsampled
+ * destinations a block of rows as tall as the vertical sampling is first
+ * converted to doubles, subsampled components are box filtered, and the
+ * result is converted to the packed counterpart of the destination and
+ * scattered to the planes.
+ *
+ * Conversions that only change the layout and the data type - from and to
+ * planes of the same model, "R'G'B'A u8" to "R'G'B'A float planar" or the
+ * NCHW tensors of machine learning - skip the fish altogether; blocks of
+ * four pixels are loaded, transposed with vector shuffles and stored as
+ * the other type and layout in one pass.
+ */
+
+#include "config.h"
+#include <string.h>
+#include "babl-internal.h"
+#include "babl-vector.h"
+
+#ifndef MIN
+#define MIN(a, b) (((a) > (b)) ? (b) : (a))
+#endif
+
+static int
+format_is_subsampled (const Babl *format)
+{
+  int i;
+
+  for (i = 0; i < format->format.components; i++)
+    if (format->format.sampling[i]->horizontal != 1 ||
+        format->format.sampling[i]->vertical != 1)
+      return 1;
+  return 0;
+}
+
+static int
+format_block_rows (const Babl *format)
+{
+  int rows = 1;
+  int i;
+
+  /* least common multiple of the vertical samplings */
+  for (i = 0; i < format->format.components; i++)
+    {
+      int v = format->format.sampling[i]->vertical;
+      int a = rows;
+      int b = v;
+
+      while (b)
+        {
+          int t = a % b;
+          a = b;
+          b = t;
+        }
+      rows = rows / a * v;
+    }
+  return rows;
+}
+
+static const Babl *
+find_planar_conversion (const Babl *source,
+                        const Babl *destination)
+{
+  BablList *list = source->format.from_list;
+  int       i;
+
+  if (!list || format_is_subsampled (destination))
+    return NULL;
+
+  for (i = 0; i < babl_list_size (list); i++)
+    {
+      const Babl *conversion = list->items[i];
+
+      if (conversion->class_type == BABL_CONVERSION_PLANAR &&
+          conversion->conversion.destination == (void *) destination)
+        return conversion;
+    }
+  return NULL;
+}
+
+static inline char *
+image_row (const BablImage *image,
+           int              component,
+           long             y)
+{
+  return image->data[component] +
+         (y / image->sampling[component]->vertical) * image->stride[component];
+}
+
+#ifdef BABL_VECTOR
+
+typedef enum
+{
+  LAYOUT_STRIDED,
+  LAYOUT_PLANAR,
+  LAYOUT_PACKED
+} LayoutKind;
+
+static int
+formats_share_components (const Babl *a,
+                          const Babl *b)
+{
+  int i;
+
+  if (a->format.components != b->format.components)
+    return 0;
+  for (i = 0; i < a->format.components; i++)
+    if (a->format.component[i] != b->format.component[i])
+      return 0;
+  return 1;
+}
+
+/* up to four components of a row, as pointers to the first sample of each
+ * and the bytes between the samples of consecutive pixels
+ */
+typedef struct
+{
+  int         components;
+  LayoutKind  kind;
+  char       *data[4];
+  int         pitch[4];
+} LayoutRow;
+
+static LayoutKind
+layout_kind (char * const *data,
+             const int    *pitch,
+             int           components,
+             int           size)
+{
+  int planar = 1;
+  int packed = 1;
+  int c;
+
+  for (c = 0; c < components; c++)
+    {
+      if (pitch[c] != size)
+        planar = 0;
+      if (pitch[c] != components * size || data[c] != data[0] + c * size)
+        packed = 0;
+    }
+  return planar ? LAYOUT_PLANAR : packed ? LAYOUT_PACKED : LAYOUT_STRIDED;
+}
+
+/* the four pixels from x of each component as a vector; packed rows of
+ * fewer than four components are loaded four samples per pixel, reading
+ * into the next pixel, which has to exist
+ */
+#define LAYOUT_TYPE(name, ctype, load, store)                                 \
+static inline void                                                            \
+layout_load_##name (const LayoutRow *row,                                     \
+                    long             x,                                       \
+                    long             remaining,                               \
+                    BablV4f         *v)                                       \
+{                                                                             \
+  ctype tmp[16] = { 0, };                                                     \
+  int   c;                                                                    \
+  int   p;                                                                    \
+                                                                              \
+  if (row->kind == LAYOUT_PLANAR && remaining >= 4)                           \
+    {                                                                         \
+      for (c = 0; c < row->components; c++)                                   \
+        v[c] = load ((const ctype *) row->data[c] + x);                       \
+      return;                                                                 \
+    }                                                                         \
+  if (row->kind == LAYOUT_PACKED &&                                           \
+      (remaining > 4 || (remaining == 4 && row->components == 4)))            \
+    {                                                                         \
+      for (p = 0; p < 4; p++)                                                 \
+        v[p] = load ((const ctype *) row->data[0] +                           \
+                     (x + p) * row->components);                              \
+      babl_v4f_transpose (v);                                                 \
+      return;                                                                 \
+    }                                                                         \
+                                                                              \
+  for (c = 0; c < row->components; c++)                                       \
+    for (p = 0; p < 4 && p < remaining; p++)                                  \
+      memcpy (&tmp[c * 4 + p], row->data[c] + (x + p) * row->pitch[c],        \
+              sizeof (ctype));                                                \
+  for (c = 0; c < row->components; c++)                                       \
+    v[c] = load (tmp + c * 4);                                                \
+}                                                                             \
+                                                                              \
+/* pixels are stored in order, so the samples written past the end of a    \
+ * packed pixel are overwritten by the next one                              \
+ */                                                                           \
+static inline void                                                            \
+layout_store_##name (const LayoutRow *row,                                    \
+                     long             x,                                      \
+                     long             remaining,                              \
+                     BablV4f         *v)                                      \
+{                                                                             \
+  ctype tmp[16];                                                              \
+  int   c;                                                                    \
+  int   p;                                                                    \
+                                                                              \
+  if (row->kind == LAYOUT_PLANAR && remaining >= 4)                           \
+    {                                                                         \
+      for (c = 0; c < row->components; c++)                                   \
+        store ((ctype *) row->data[c] + x, v[c]);                             \
+      return;                                                                 \
+    }                                                                         \
+  if (row->kind == LAYOUT_PACKED &&                                           \
+      (remaining > 4 || (remaining == 4 && row->components == 4)))            \
+    {                                                                         \
+      babl_v4f_transpose (v);                                                 \
+      for (p = 0; p < 4; p++)                                                 \
+        store ((ctype *) row->data[0] + (x + p) * row->components, v[p]);     \
+      return;                                                                 \
+    }                                                                         \
+                                                                              \
+  for (c = 0; c < row->components; c++)                                       \
+    store (tmp + c * 4, v[c]);                                                \
+  for (c = 0; c < row->components; c++)                                       \
+    for (p = 0; p < 4 && p < remaining; p++)                                  \
+      memcpy (row->data[c] + (x + p) * row->pitch[c], &tmp[c * 4 + p],        \
+              sizeof (ctype));                                                \
+}
+
+static inline BablV4f
+layout_v4f_load_u8 (const uint8_t *p)
+{
+  return babl_v4f_load_u8 (p) * babl_v4f_splat (1.0f / 255.0f);
+}
+
+static inline BablV4f
+layout_v4f_load_u16 (const uint16_t *p)
+{
+  return babl_v4f_load_u16 (p) * babl_v4f_splat (1.0f / 65535.0f);
+}
+
+LAYOUT_TYPE (u8,    uint8_t,  layout_v4f_load_u8,  babl_v4f_store_u8)
+LAYOUT_TYPE (u16,   uint16_t, layout_v4f_load_u16, babl_v4f_store_u16)
+LAYOUT_TYPE (half,  uint16_t, babl_v4f_load_half,  babl_v4f_store_half)
+LAYOUT_TYPE (float, float,    babl_v4f_load,       babl_v4f_store)
+
+typedef void (*LayoutFunc) (const LayoutRow *src,
+                            const LayoutRow *dst,
+                            long             n);
+
+#define LAYOUT_CONVERT(src_name, dst_name)                                    \
+static void                                                                   \
+layout_##src_name##_to_##dst_name (const LayoutRow *src,                      \
+                                   const LayoutRow *dst,                      \
+                                   long             n)                        \
+{                                                                             \
+  long x;                                                                     \
+                                                                              \
+  for (x = 0; x < n; x += 4)                                                  \
+    {                                                                         \
+      BablV4f v[4];                                                           \
+                                                                              \
+      layout_load_##src_name (src, x, n - x, v);                              \
+      layout_store_##dst_name (dst, x, n - x, v);                             \
+    }                                                                         \
+}
+
+#define LAYOUT_CONVERT_FROM(src_name)   \
+  LAYOUT_CONVERT (src_name, u8)         \
+  LAYOUT_CONVERT (src_name, u16)        \
+  LAYOUT_CONVERT (src_name, half)       \
+  LAYOUT_CONVERT (src_name, float)
+
+LAYOUT_CONVERT_FROM (u8)
+LAYOUT_CONVERT_FROM (u16)
+LAYOUT_CONVERT_FROM (half)
+LAYOUT_CONVERT_FROM (float)
+
+/* the types the layout kernels handle, indices into layout_funcs */
+static int
+layout_type_index (const BablType *type)
+{
+  switch (type->instance.id)
+    {
+      case BABL_U8:    return 0;
+      case BABL_U16:   return 1;
+      case BABL_HALF:  return 2;
+      case BABL_FLOAT: return 3;
+      default:         return -1;
+    }
+}
+
+static const LayoutFunc layout_funcs[4][4] =
+{
+  { layout_u8_to_u8,    layout_u8_to_u16,    layout_u8_to_half,    layout_u8_to_float },
+  { layout_u16_to_u8,   layout_u16_to_u16,   layout_u16_to_half,   layout_u16_to_float },
+  { layout_half_to_u8,  layout_half_to_u16,  layout_half_to_half,  layout_half_to_float },
+  { layout_float_to_u8, layout_float_to_u16, layout_float_to_half, layout_float_to_float },
+};
+
+/* the type index shared by all components of image, or -1 */
+static int
+image_layout_type (const BablImage *image)
+{
+  int index = layout_type_index (image->type[0]);
+  int c;
+
+  for (c = 1; c < image->components; c++)
+    if (image->type[c] != image->type[0])
+      return -1;
+  for (c = 0; c < image->components; c++)
+    if (image->sampling[c]->horizontal != 1 ||
+        image->sampling[c]->vertical != 1)
+      return -1;
+  return index;
+}
+
+/* convert n pixels of components, given as the sample pointers and
+ * pitches of both ends, four components at a time
+ */
+static void
+layout_convert (int          src_index,
+                char * const *src_data,
+                const int   *src_pitch,
+                int          dst_index,
+                char * const *dst_data,
+                const int   *dst_pitch,
+                int          components,
+                long         n)
+{
+  LayoutFunc func      = layout_funcs[src_index][dst_index];
+  int        src_size  = src_index == 0 ? 1 : src_index == 3 ? 4 : 2;
+  int        dst_size  = dst_index == 0 ? 1 : dst_index == 3 ? 4 : 2;
+  int        first;
+
+  for (first = 0; first < components; first += 4)
+    {
+      LayoutRow src;
+      LayoutRow dst;
+      int       c;
+
+      src.components = dst.components = MIN (4, components - first);
+      for (c = 0; c < src.components; c++)
+        {
+          src.data[c]  = src_data[first + c];
+          src.pitch[c] = src_pitch[first + c];
+          dst.data[c]  = dst_data[first + c];
+          dst.pitch[c] = dst_pitch[first + c];
+        }
+      src.kind = layout_kind (src.data, src.pitch, src.components, src_size);
+      dst.kind = layout_kind (dst.data, dst.pitch, dst.components, dst_size);
+
+      func (&src, &dst, n);
+    }
+}
+
+static void
+process_layout (int              src_index,
+                const BablImage *source,
+                int              dst_index,
+                BablImage       *destination,
+                long             width,
+                int              rows)
+{
+  char *src_data[BABL_MAX_COMPONENTS];
+  char *dst_data[BABL_MAX_COMPONENTS];
+  long  y;
+  int   c;
+
+  for (y = 0; y < rows; y++)
+    {
+      for (c = 0; c < source->components; c++)
+        {
+          src_data[c] = image_row (source, c, y);
+          dst_data[c] = image_row (destination, c, y);
+        }
+      layout_convert (src_index, src_data, source->pitch,
+                      dst_index, dst_data, destination->pitch,
+                      source->components, width);
+    }
+}
+
+#endif /* BABL_VECTOR */
+
+static void
+image_gather_row (const BablImage *image,
+                  long             y,
+                  char            *row,
+                  int              bpp,
+                  long             width)
+{
+  int offset = 0;
+  int c;
+
+#ifdef BABL_VECTOR
+  int index = image_layout_type (image);
+
+  if (index >= 0)
+    {
+      char *src_data[BABL_MAX_COMPONENTS];
+      char *dst_data[BABL_MAX_COMPONENTS];
+      int   dst_pitch[BABL_MAX_COMPONENTS];
+
+      for (c = 0; c < image->components; c++)
+        {
+          src_data[c]  = image_row (image, c, y);
+          dst_data[c]  = row + offset;
+          dst_pitch[c] = bpp;
+          offset      += image->type[c]->bits / 8;
+        }
+      layout_convert (index, src_data, image->pitch,
+                      index, dst_data, dst_pitch,
+                      image->components, width);
+      return;
+    }
+#endif
+
+  for (c = 0; c < image->components; c++)
+    {
+      int         horizontal = image->sampling[c]->horizontal;
+      int         pitch      = image->pitch[c];
+      int         size       = image->type[c]->bits / 8;
+      const char *src        = image_row (image, c, y);
+      char       *dst        = row + offset;
+      long        x;
+
+      for (x = 0; x < width; x++)
+        {
+          memcpy (dst, src + (x / horizontal) * pitch, size);
+          dst += bpp;
+        }
+      offset += size;
+    }
+}
+
+static void
+image_scatter_row (BablImage  *image,
+                   long        y,
+                   const char *row,
+                   int         bpp,
+                   long        width)
+{
+  int offset = 0;
+  int c;
+
+#ifdef BABL_VECTOR
+  int index = image_layout_type (image);
+
+  if (index >= 0)
+    {
+      char *src_data[BABL_MAX_COMPONENTS];
+      char *dst_data[BABL_MAX_COMPONENTS];
+      int   src_pitch[BABL_MAX_COMPONENTS];
+
+      for (c = 0; c < image->components; c++)
+        {
+          src_data[c]  = (char *) row + offset;
+          src_pitch[c] = bpp;
+          dst_data[c]  = image_row (image, c, y);
+          offset      += image->type[c]->bits / 8;
+        }
+      layout_convert (index, src_data, src_pitch,
+                      index, dst_data, image->pitch,
+                      image->components, width);
+      return;
+    }
+#endif
+
+  for (c = 0; c < image->components; c++)
+    {
+      int         horizontal = image->sampling[c]->horizontal;
+      int         pitch      = image->pitch[c];
+      int         size       = image->type[c]->bits / 8;
+      const char *src        = row + offset;
+      char       *dst        = image_row (image, c, y);
+      long        x;
+
+      offset += size;
+      if (y % image->sampling[c]->vertical)
+        continue;
+
+      for (x = 0; x < width; x += horizontal)
+        {
+          memcpy (dst, src + x * bpp, size);
+          dst += pitch;
+        }
+    }
+}
+
+/* box filter the subsampled components of a block of double pixels,
+ * leaving each average in the top-left pixel of the area it covers
+ */
+static void
+block_subsample (const BablImage *image,
+                 double          *block,
+                 long             width,
+                 int              rows)
+{
+  int components = image->components;
+  int c;
+
+  for (c = 0; c < components; c++)
+    {
+      int  horizontal = image->sampling[c]->horizontal;
+      int  vertical   = image->sampling[c]->vertical;
+      int  r;
+
+      if (horizontal == 1 && vertical == 1)
+        continue;
+
+      for (r = 0; r < rows; r += vertical)
+        {
+          int  r_end = MIN (r + vertical, rows);
+          long x;
+
+          for (x = 0; x < width; x += horizontal)
+            {
+              long   x_end = MIN (x + horizontal, width);
+              double sum   = 0.0;
+              int    count = 0;
+              int    rr;
+              long   xx;
+
+              for (rr = r; rr < r_end; rr++)
+                for (xx = x; xx < x_end; xx++)
+                  {
+                    sum += block[(rr * width + xx) * components + c];
+                    count++;
+                  }
+              block[(r * width + x) * components + c] = sum / count;
+            }
+        }
+    }
+}
+
+static void
+process_planar_conversion (const Babl      *conversion,
+                           const BablImage *source,
+                           BablImage       *destination,
+                           long             width,
+                           int              rows)
+{
+  const char *src_data[BABL_MAX_COMPONENTS];
+  char       *dst_data[BABL_MAX_COMPONENTS];
+  long        y;
+  int         c;
+
+  for (y = 0; y < rows; y++)
+    {
+      for (c = 0; c < source->components; c++)
+        src_data[c] = image_row (source, c, y);
+      for (c = 0; c < destination->components; c++)
+        dst_data[c] = image_row (destination, c, y);
+
+      conversion->conversion.function.planar (conversion,
+                                              source->components,
+                                              src_data,
+                                              source->pitch,
+                                              destination->components,
+                                              dst_data,
+                                              destination->pitch,
+                                              width,
+                                              conversion->conversion.data);
+    }
+}
+
+long
+babl_image_process (const Babl *babl,
+                    const Babl *source_image,
+                    Babl       *destination_image,
+                    long        width,
+                    int         rows)
+{
+  const BablImage *source      = &source_image->image;
+  BablImage       *destination = &destination_image->image;
+  const Babl      *src_fmt     = BABL (babl->fish.source);
+  const Babl      *dst_fmt     = BABL (babl->fish.destination);
+  const Babl      *src_packed  = NULL;
+  const Babl      *dst_packed  = NULL;
+  const Babl      *dst_double  = NULL;
+  const Babl      *fish;
+  const Babl      *fish_pack   = NULL;
+  const Babl      *conversion;
+  char            *src_row     = NULL;
+  char            *dst_row     = NULL;
+  double          *block       = NULL;
+  int              block_rows  = 1;
+  int              src_bpp;
+  int              dst_bpp;
+  long             y;
+
+  if (width <= 0 || rows <= 0)
+    return 0;
+
+  if (!src_fmt->format.planar && !dst_fmt->format.planar)
+    {
+      return babl_process_rows (babl,
+                                source->data[0], source->stride[0],
+                                destination->data[0], destination->stride[0],
+                                width, rows);
+    }
+
+  if (_babl_instrument)
+    ((Babl *) babl)->fish.pixels += width * rows;
+
+  conversion = find_planar_conversion (src_fmt, dst_fmt);
+  if (conversion)
+    {
+      process_planar_conversion (conversion, source, destination, width, rows);
+      return width * rows;
+    }
+
+#ifdef BABL_VECTOR
+  if (src_fmt->format.model == dst_fmt->format.model &&
+      !src_fmt->format.bitpacked && !dst_fmt->format.bitpacked &&
+      formats_share_components (src_fmt, dst_fmt))
+    {
+      int src_index = image_layout_type (source);
+      int dst_index = image_layout_type (destination);
+
+      if (src_index >= 0 && dst_index >= 0)
+        {
+          process_layout (src_index, source, dst_index, destination,
+                          width, rows);
+          return width * rows;
+        }
+    }
+#endif
+
+  if (src_fmt->format.planar)
+    {
+      src_packed = babl_format_packed (src_fmt, NULL);
+      src_bpp    = src_packed->format.bytes_per_pixel;
+      src_row    = babl_malloc (width * src_bpp);
+    }
+  else
+    {
+      src_bpp    = src_fmt->format.bytes_per_pixel;
+    }
+
+  if (dst_fmt->format.planar)
+    {
+      dst_packed = babl_format_packed (dst_fmt, NULL);
+      dst_bpp    = dst_packed->format.bytes_per_pixel;
+      dst_row    = babl_malloc (width * dst_bpp);
+    }
+  else
+    {
+      dst_bpp    = dst_fmt->format.bytes_per_pixel;
+    }
+
+  if (format_is_subsampled (dst_fmt))
+    {
+      dst_double = babl_format_packed (dst_fmt, babl_type_from_id (BABL_DOUBLE));
+      block_rows = format_block_rows (dst_fmt);
+      block      = babl_malloc (width * block_rows *
+                                dst_double->format.bytes_per_pixel);
+      fish_pack  = babl_fish (dst_double, dst_packed);
+    }
+
+  fish = babl_fish (src_packed ? src_packed : src_fmt,
+                    dst_double ? dst_double :
+                    dst_packed ? dst_packed : dst_fmt);
+
+  for (y = 0; y < rows; y += block_rows)
+    {
+      int count = MIN (block_rows, rows - y);
+      int r;
+
+      for (r = 0; r < count; r++)
+        {
+          const char *src;
+          char       *dst;
+
+          if (src_packed)
+            {
+              image_gather_row (source, y + r, src_row, src_bpp, width);
+              src = src_row;
+            }
+          else
+            {
+              src = source->data[0] + (y + r) * source->stride[0];
+            }
+
+          if (block)
+            dst = (char *) (block + r * width * dst_fmt->format.components);
+          else if (dst_packed)
+            dst = dst_row;
+          else
+            dst = destination->data[0] + (y + r) * destination->stride[0];
+
+          babl_process (fish, src, dst, width);
+
+          if (dst_packed && !block)
+            image_scatter_row (destination, y + r, dst_row, dst_bpp, width);
+        }
+
+      if (block)
+        {
+          block_subsample (destination, block, width, count);
+
+          for (r = 0; r < count; r++)
+            {
+              babl_process (fish_pack,
+                            block + r * width * dst_fmt->format.components,
+                            dst_row, width);
+              image_scatter_row (destination, y + r, dst_row, dst_bpp, width);
+            }
+        }
+    }
+
+  if (src_row)
+    babl_free (src_row);
+  if (dst_row)
+    babl_free (dst_row);
+  if (block)
+    babl_free (block);
+
+  return width * rows;
+}
+
+long
+babl_process_planar (const Babl  *babl,
+                     const void **source_planes,
+                     const int   *source_strides,
+                     void       **destination_planes,
+                     const int   *destination_strides,
+                     long         width,
+                     int          rows)
+{
+  Babl *source;
+  Babl *destination;
+  long  ret;
+
+  babl_assert (babl && BABL_IS_BABL (babl));
+  babl_assert (source_planes && source_strides);
+  babl_assert (destination_planes && destination_strides);
+
+  source      = babl_image_from_planes (babl->fish.source,
+                                        (void **) source_planes,
+                                        source_strides);
+  destination = babl_image_from_planes (babl->fish.destination,
+                                        destination_planes,
+                                        destination_strides);
+
+  ret = babl_image_process (babl, source, destination, width, rows);
+
+  babl_free (source);
+  babl_free (destination);
+  return ret;
+}
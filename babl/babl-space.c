@@ -24,10 +24,11 @@
 #include "babl-trc.h"
 
 static BablSpace space_db[MAX_SPACES];
+static const Babl *space_srgb = NULL;
 
-static void babl_chromatic_adaptation_matrix (const double *whitepoint,
-                                              const double *target_whitepoint,
-                                              double       *chad_matrix)
+void babl_chromatic_adaptation_matrix (const double *whitepoint,
+                                       const double *target_whitepoint,
+                                       double       *chad_matrix)
 {
   double bradford[9]={ 0.8951000, 0.2664000, -0.1614000,
                       -0.7502000, 1.7135000,  0.0367000,
@@ -223,6 +224,12 @@ babl_space (const char *name)
   return NULL;
 }
 
+const Babl *
+_babl_space_srgb (void)
+{
+  return space_srgb;
+}
+
 Babl *
 _babl_space_for_lcms (const char *icc_data,
                       int         icc_length)
@@ -513,7 +520,7 @@ babl_space_class_init (void)
                0.1500,  0.0600,
                babl_trc("sRGB"), NULL, NULL, 1);
 #else
-  babl_space_from_chromaticities ("sRGB",
+  space_srgb = babl_space_from_chromaticities ("sRGB",
                 0.3127,  0.3290, /* D65 */
                 0.639998686, 0.330010138,
                 0.300003784, 0.600003357,
@@ -542,6 +549,23 @@ babl_space_class_init (void)
                // XXX: is using sRGB TRC right?
                babl_trc("sRGB"), NULL, NULL, 1);
 
+  /* the HDR spaces of ITU-R BT.2100, babl_space_with_trc () of Rec2020 and
+   * the PQ and HLG TRCs finds these
+   */
+  babl_space_from_chromaticities ("Rec2100-PQ",
+               0.3127,  0.3290, /* D65 */
+               0.708,  0.292,
+               0.170,  0.797,
+               0.131,  0.046,
+               babl_trc("PQ"), NULL, NULL, 1);
+
+  babl_space_from_chromaticities ("Rec2100-HLG",
+               0.3127,  0.3290, /* D65 */
+               0.708,  0.292,
+               0.170,  0.797,
+               0.131,  0.046,
+               babl_trc("HLG"), NULL, NULL, 1);
+
   babl_space_from_chromaticities (
       "Adobish",  /* a space that can be used as a place-holder for a sRGB like
 space with displaced green coordinates from a big graphics software vendor that
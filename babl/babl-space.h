@@ -42,7 +42,6 @@ typedef struct
   int  filler;
 } BablCMYK;
 
-#if 0  // draft datastructures for spectral spaces
 typedef struct _BablSpectrumType BablSpectrumType;
 
 struct _BablSpectrumType {
@@ -52,17 +51,22 @@ struct _BablSpectrumType {
   int           bands;
 };
 
+/* the configuration behind the models of babl_spectral_format (), see
+ * babl-spectral.c
+ */
 typedef struct
 {
   BablSpectrumType spectrum_type;
-  int              is_spectral;
-  float           *observer_x;
-  float           *observer_y;
-  float           *observer_z;
-  float           *illuminant;
-  float            rev_y_scale;
+  double          *observer_x;
+  double          *observer_y;
+  double          *observer_z;
+  double          *illuminant; /* NULL for emissive data */
+  double           rev_y_scale;
+  double          *to_xyz;     /* 3 * bands weights, to D50 adapted XYZ */
+  double          *from_xyz;   /* 3 * bands, the minimal norm spectra of X, Y and Z */
 } BablSpectralSpace;
 
+#if 0  // draft datastructures for spectral ink/paint jobs
 typedef struct
 {
   BablSpectralSpace *spectral_space;
@@ -166,6 +170,21 @@ static inline void _babl_space_from_xyz (const Babl *space, const double *xyz, d
 void
 babl_space_class_init (void);
 
+/* babl_chromatic_adaptation_matrix:
+ *
+ * Bradford adaptation from whitepoint to target_whitepoint, both in XYZ.
+ */
+void babl_chromatic_adaptation_matrix (const double *whitepoint,
+                                       const double *target_whitepoint,
+                                       double       *chad_matrix);
+
+/* _babl_space_srgb:
+ *
+ * Returns the same space as babl_space ("sRGB"), without the lookup by name.
+ */
+const Babl *
+_babl_space_srgb (void);
+
 const Babl *
 babl_space_from_gray_trc (const char *name,
                           const Babl *trc_gray,
@@ -0,0 +1,532 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* Spectral pixel formats, with one component per band of evenly spaced
+ * wavelengths. The bands are integrated to CIE XYZ with an observer and
+ * optionally an illuminant, and chromatically adapted so that a flat
+ * spectrum maps to the D50 white of babls XYZ, and thus to the white of
+ * every RGB space.
+ *
+ * The model conversions go to and from RGBA double of any space. Going
+ * from RGB to spectral has no unique answer, the spectrum with the
+ * smallest norm that integrates to the same XYZ is used, which round-trips
+ * exactly but can go negative. For float data of the space the format was
+ * asked for, direct conversions to RGBA float and CIE XYZ float are
+ * registered, with the weights of the integration, the adaptation and the
+ * XYZ to RGB matrix of the space folded into one weight per band and
+ * output component.
+ */
+
+#include "config.h"
+#include "babl-internal.h"
+#include "babl-vector.h"
+
+#define D50_WHITE_REF_X   0.964202880
+#define D50_WHITE_REF_Y   1.000000000
+#define D50_WHITE_REF_Z   0.824905400
+
+typedef struct
+{
+  int   bands;
+  int   components;     /* of the float output, 3 or 4 */
+  float offset[4];      /* added to every pixel, opaque alpha for RGBA */
+  float weights[];      /* 4 per band */
+} BablSpectralWeights;
+
+/* the CIE 1931 2° standard observer, as the multi-lobe gaussian fit of
+ * Wyman, Sloan and Shirley, "Simple Analytic Approximations to the CIE XYZ
+ * Color Matching Functions", JCGT 2013. It is within the variation between
+ * observers of the tabulated functions, and covers any band spacing.
+ */
+static double
+cie_lobe (double nm,
+          double mean,
+          double below,
+          double above)
+{
+  double t = (nm - mean) * (nm < mean ? below : above);
+
+  return exp (-0.5 * t * t);
+}
+
+static void
+cie_1931_observer (double  nm,
+                   double *xyz)
+{
+  xyz[0] = 1.056 * cie_lobe (nm, 599.8, 0.0264, 0.0323) +
+           0.362 * cie_lobe (nm, 442.0, 0.0624, 0.0374) -
+           0.065 * cie_lobe (nm, 501.1, 0.0490, 0.0382);
+  xyz[1] = 0.821 * cie_lobe (nm, 568.8, 0.0213, 0.0247) +
+           0.286 * cie_lobe (nm, 530.9, 0.0613, 0.0322);
+  xyz[2] = 1.217 * cie_lobe (nm, 437.0, 0.0845, 0.0278) +
+           0.681 * cie_lobe (nm, 459.0, 0.0385, 0.0725);
+}
+
+static void
+spectral_to_rgba (const Babl *conversion,
+                  const char *src,
+                  char       *dst,
+                  long        samples,
+                  void       *data)
+{
+  const BablSpectralSpace *spectral = data;
+  const Babl              *space    = babl_conversion_get_destination_space (conversion);
+  const double            *in       = (const double *) src;
+  double                  *out      = (double *) dst;
+  int                      bands    = spectral->spectrum_type.bands;
+
+  while (samples--)
+    {
+      double xyz[3] = { 0.0, 0.0, 0.0 };
+      int    b;
+
+      for (b = 0; b < bands; b++)
+        {
+          xyz[0] += spectral->to_xyz[b * 3 + 0] * in[b];
+          xyz[1] += spectral->to_xyz[b * 3 + 1] * in[b];
+          xyz[2] += spectral->to_xyz[b * 3 + 2] * in[b];
+        }
+      _babl_space_from_xyz (space, xyz, out);
+      out[3] = 1.0;
+
+      in  += bands;
+      out += 4;
+    }
+}
+
+static void
+rgba_to_spectral (const Babl *conversion,
+                  const char *src,
+                  char       *dst,
+                  long        samples,
+                  void       *data)
+{
+  const BablSpectralSpace *spectral = data;
+  const Babl              *space    = babl_conversion_get_source_space (conversion);
+  const double            *in       = (const double *) src;
+  double                  *out      = (double *) dst;
+  int                      bands    = spectral->spectrum_type.bands;
+
+  while (samples--)
+    {
+      double xyz[3];
+      int    b;
+
+      _babl_space_to_xyz (space, in, xyz);
+      for (b = 0; b < bands; b++)
+        out[b] = spectral->from_xyz[b * 3 + 0] * xyz[0] +
+                 spectral->from_xyz[b * 3 + 1] * xyz[1] +
+                 spectral->from_xyz[b * 3 + 2] * xyz[2];
+
+      in  += 4;
+      out += bands;
+    }
+}
+
+static void
+spectral_float_to_float (const Babl *conversion,
+                         const char *src,
+                         char       *dst,
+                         long        samples,
+                         void       *data)
+{
+  const BablSpectralWeights *w          = data;
+  const float               *in         = (const float *) src;
+  float                     *out        = (float *) dst;
+  int                        bands      = w->bands;
+  int                        components = w->components;
+
+  while (samples--)
+    {
+      int c;
+
+      for (c = 0; c < components; c++)
+        {
+          float sum = w->offset[c];
+          int   b;
+
+          for (b = 0; b < bands; b++)
+            sum += w->weights[b * 4 + c] * in[b];
+          out[c] = sum;
+        }
+
+      in  += bands;
+      out += components;
+    }
+}
+
+#ifdef BABL_VECTOR
+/* a multiply-add of all output components per band, in two chains to
+ * hide the latency of the additions
+ */
+static void
+spectral_float_to_float_vector (const Babl *conversion,
+                                const char *src,
+                                char       *dst,
+                                long        samples,
+                                void       *data)
+{
+  const BablSpectralWeights *w          = data;
+  const float               *in         = (const float *) src;
+  float                     *out        = (float *) dst;
+  int                        bands      = w->bands;
+  int                        components = w->components;
+  BablV4f                    offset     = babl_v4f_load (w->offset);
+
+  while (samples--)
+    {
+      BablV4f sum0 = offset;
+      BablV4f sum1 = babl_v4f_splat (0.0f);
+      int     b;
+
+      for (b = 0; b + 1 < bands; b += 2)
+        {
+          sum0 += babl_v4f_splat (in[b]) * babl_v4f_load (&w->weights[b * 4]);
+          sum1 += babl_v4f_splat (in[b + 1]) * babl_v4f_load (&w->weights[b * 4 + 4]);
+        }
+      if (b < bands)
+        sum0 += babl_v4f_splat (in[b]) * babl_v4f_load (&w->weights[b * 4]);
+      sum0 += sum1;
+
+      if (components == 4)
+        {
+          babl_v4f_store (out, sum0);
+        }
+      else
+        {
+          out[0] = sum0[0];
+          out[1] = sum0[1];
+          out[2] = sum0[2];
+        }
+
+      in  += bands;
+      out += components;
+    }
+}
+#endif
+
+static uint32_t
+hash_doubles (uint32_t      hash,
+              const double *values,
+              int           count)
+{
+  const unsigned char *p = (const unsigned char *) values;
+  size_t               i;
+
+  for (i = 0; i < count * sizeof (double); i++)
+    hash = (hash ^ p[i]) * 16777619u;
+  return hash;
+}
+
+static BablSpectralSpace *
+spectral_space_new (double        nm_start,
+                    double        nm_gap,
+                    int           bands,
+                    const double *observer,
+                    const double *illuminant)
+{
+  BablSpectralSpace *spectral = babl_calloc (sizeof (BablSpectralSpace), 1);
+  double             d50[3]   = { D50_WHITE_REF_X, D50_WHITE_REF_Y, D50_WHITE_REF_Z };
+  double             white[3] = { 0.0, 0.0, 0.0 };
+  double             chad[9];
+  double             gram[9]  = { 0.0, };
+  double             gram_inv[9];
+  double             y_sum    = 0.0;
+  int                b;
+
+  spectral->spectrum_type.nm_start = nm_start;
+  spectral->spectrum_type.nm_gap   = nm_gap;
+  spectral->spectrum_type.nm_end   = nm_start + nm_gap * (bands - 1);
+  spectral->spectrum_type.bands    = bands;
+
+  spectral->observer_x = babl_malloc (sizeof (double) * bands * 3);
+  spectral->observer_y = spectral->observer_x + bands;
+  spectral->observer_z = spectral->observer_y + bands;
+  spectral->to_xyz     = babl_malloc (sizeof (double) * bands * 3);
+  spectral->from_xyz   = babl_malloc (sizeof (double) * bands * 3);
+
+  for (b = 0; b < bands; b++)
+    {
+      double xyz[3];
+
+      if (observer)
+        memcpy (xyz, &observer[b * 3], sizeof (xyz));
+      else
+        cie_1931_observer (nm_start + nm_gap * b, xyz);
+
+      spectral->observer_x[b] = xyz[0];
+      spectral->observer_y[b] = xyz[1];
+      spectral->observer_z[b] = xyz[2];
+    }
+
+  if (illuminant)
+    {
+      spectral->illuminant = babl_malloc (sizeof (double) * bands);
+      memcpy (spectral->illuminant, illuminant, sizeof (double) * bands);
+    }
+
+  /* normalize Y of a flat spectrum to 1.0 */
+  for (b = 0; b < bands; b++)
+    {
+      double power = illuminant ? illuminant[b] : 1.0;
+
+      white[0] += power * spectral->observer_x[b];
+      white[1] += power * spectral->observer_y[b];
+      white[2] += power * spectral->observer_z[b];
+    }
+  y_sum = white[1];
+  spectral->rev_y_scale = 1.0 / y_sum;
+  white[0] /= y_sum;
+  white[1]  = 1.0;
+  white[2] /= y_sum;
+
+  babl_chromatic_adaptation_matrix (white, d50, chad);
+
+  for (b = 0; b < bands; b++)
+    {
+      double power = (illuminant ? illuminant[b] : 1.0) * spectral->rev_y_scale;
+      double xyz[3];
+
+      xyz[0] = spectral->observer_x[b] * power;
+      xyz[1] = spectral->observer_y[b] * power;
+      xyz[2] = spectral->observer_z[b] * power;
+      babl_matrix_mul_vector (chad, xyz, &spectral->to_xyz[b * 3]);
+    }
+
+  /* with the bands to XYZ as a 3 x bands matrix A, the smallest spectra
+   * reproducing XYZ are A^T (A A^T)^-1 XYZ
+   */
+  for (b = 0; b < bands; b++)
+    {
+      int i, j;
+
+      for (i = 0; i < 3; i++)
+        for (j = 0; j < 3; j++)
+          gram[i * 3 + j] += spectral->to_xyz[b * 3 + i] * spectral->to_xyz[b * 3 + j];
+    }
+  babl_matrix_invert (gram, gram_inv);
+  for (b = 0; b < bands; b++)
+    babl_matrix_mul_vector (gram_inv, &spectral->to_xyz[b * 3], &spectral->from_xyz[b * 3]);
+
+  return spectral;
+}
+
+/* whether spectral was made from the same range, observer and illuminant;
+ * models are named after a hash of those, which can collide
+ */
+static int
+spectral_space_matches (const BablSpectralSpace *spectral,
+                        double                   nm_start,
+                        double                   nm_gap,
+                        int                      bands,
+                        const double            *observer,
+                        const double            *illuminant)
+{
+  int b;
+
+  if (spectral->spectrum_type.nm_start != nm_start ||
+      spectral->spectrum_type.nm_gap != nm_gap ||
+      spectral->spectrum_type.bands != bands)
+    return 0;
+
+  for (b = 0; b < bands; b++)
+    {
+      double xyz[3];
+
+      if (observer)
+        memcpy (xyz, &observer[b * 3], sizeof (xyz));
+      else
+        cie_1931_observer (nm_start + nm_gap * b, xyz);
+
+      if (spectral->observer_x[b] != xyz[0] ||
+          spectral->observer_y[b] != xyz[1] ||
+          spectral->observer_z[b] != xyz[2])
+        return 0;
+    }
+
+  if (!spectral->illuminant || !illuminant)
+    return !spectral->illuminant && !illuminant;
+  return !memcmp (spectral->illuminant, illuminant, sizeof (double) * bands);
+}
+
+static const Babl *
+spectral_model (double        nm_start,
+                double        nm_gap,
+                int           bands,
+                const double *observer,
+                const double *illuminant)
+{
+  const Babl         *component[BABL_MAX_COMPONENTS];
+  const Babl         *model;
+  BablSpectralSpace  *spectral;
+  uint32_t            hash = 2166136261u;
+  char                name[256];
+  int                 collisions;
+  int                 b;
+
+  if (observer)
+    hash = hash_doubles (hash ^ 'o', observer, bands * 3);
+  if (illuminant)
+    hash = hash_doubles (hash ^ 'i', illuminant, bands);
+
+  /* models of other data with the same hash get a count appended */
+  for (collisions = 0; ; collisions++)
+    {
+      int length = snprintf (name, sizeof (name),
+                             "spectral %g-%gnm %i bands %08x",
+                             nm_start, nm_start + nm_gap * (bands - 1),
+                             bands, hash);
+
+      if (collisions)
+        snprintf (name + length, sizeof (name) - length, " %i", collisions);
+
+      model = babl_db_exist_by_name (babl_model_db (), name);
+      if (!model)
+        break;
+      if (spectral_space_matches (babl_get_user_data (model), nm_start,
+                                  nm_gap, bands, observer, illuminant))
+        return model;
+    }
+
+  for (b = 0; b < bands; b++)
+    {
+      char cname[64];
+
+      snprintf (cname, sizeof (cname), "%g nm", nm_start + nm_gap * b);
+      /* re-registering is a no-op */
+      component[b] = babl_component_new (cname, NULL);
+    }
+
+  model = babl_model_new_n (name, bands, component,
+                            BABL_MODEL_FLAG_SPECTRAL | BABL_MODEL_FLAG_LINEAR,
+                            "spectral");
+  if (!model)
+    return NULL;
+
+  spectral = spectral_space_new (nm_start, nm_gap, bands, observer, illuminant);
+  babl_set_user_data (model, spectral);
+
+  babl_conversion_new (
+     model,
+     babl_model ("RGBA"),
+     "linear", spectral_to_rgba,
+     "data", spectral,
+     NULL);
+  babl_conversion_new (
+     babl_model ("RGBA"),
+     model,
+     "linear", rgba_to_spectral,
+     "data", spectral,
+     NULL);
+
+  return model;
+}
+
+static void
+spectral_fast_path (const BablSpectralSpace *spectral,
+                    const Babl              *source,
+                    const Babl              *destination,
+                    const char              *destination_model)
+{
+  const Babl              *space    = babl_format_get_space (destination);
+  int                      bands    = spectral->spectrum_type.bands;
+  int                      rgb      = !strcmp (destination_model, "RGBA");
+  BablSpectralWeights     *w;
+  int                      b;
+
+  if (babl_conversion_find (source, destination))
+    return;
+
+  w = babl_calloc (sizeof (BablSpectralWeights) + sizeof (float) * 4 * bands, 1);
+  w->bands      = bands;
+  w->components = rgb ? 4 : 3;
+  w->offset[3]  = rgb ? 1.0f : 0.0f;
+
+  for (b = 0; b < bands; b++)
+    {
+      double out[3];
+      int    c;
+
+      if (rgb)
+        _babl_space_from_xyz (space, &spectral->to_xyz[b * 3], out);
+      else
+        memcpy (out, &spectral->to_xyz[b * 3], sizeof (out));
+
+      for (c = 0; c < 3; c++)
+        w->weights[b * 4 + c] = out[c];
+    }
+
+  babl_conversion_new (source, destination,
+                       "linear", spectral_float_to_float,
+                       "data", w,
+                       NULL);
+#ifdef BABL_VECTOR
+  babl_conversion_new (source, destination,
+                       "linear", spectral_float_to_float_vector,
+                       "data", w,
+                       "accel", BABL_CPU_ACCEL_VECTOR,
+                       NULL);
+#endif
+}
+
+const Babl *
+babl_spectral_format (const Babl   *type,
+                      double        nm_start,
+                      double        nm_gap,
+                      int           bands,
+                      const double *observer,
+                      const double *illuminant,
+                      const Babl   *space)
+{
+  const Babl              *model;
+  const Babl              *format;
+  const BablSpectralSpace *spectral;
+
+  if (bands < 3 || bands > BABL_MAX_COMPONENTS || nm_gap <= 0.0)
+    {
+      babl_log ("unsupported spectral format of %i bands, %g nm apart",
+                bands, nm_gap);
+      return NULL;
+    }
+  if (!type)
+    type = babl_type_from_id (BABL_FLOAT);
+  if (!space)
+    space = _babl_space_srgb ();
+
+  model = spectral_model (nm_start, nm_gap, bands, observer, illuminant);
+  if (!model)
+    return NULL;
+
+  spectral = babl_get_user_data (model);
+  format   = babl_format_with_model_as_type (model, type);
+  if (space != _babl_space_srgb ())
+    format = babl_format_with_space (babl_get_name (format), space);
+
+  if (type == babl_type_from_id (BABL_FLOAT))
+    {
+      spectral_fast_path (spectral, format,
+                          babl_format_with_space ((void *) _babl_format_rgba_float (), space),
+                          "RGBA");
+      if (babl_format_exists ("CIE XYZ float"))
+        spectral_fast_path (spectral, format, babl_format ("CIE XYZ float"),
+                            "CIE XYZ");
+    }
+
+  _babl_fish_cache_invalidate ();
+  return format;
+}
@@ -27,6 +27,7 @@
 #include "config.h"
 #include "babl-internal.h"
 #include "base/util.h"
+#include "babl-vector.h"
 
 static BablTRC trc_db[MAX_TRCS];
 
@@ -315,6 +316,173 @@ _babl_trc_from_linear_buf_generic (const Babl  *trc_,
       out[out_gap * i + c] = trc->fun_from_linear (trc_, in[in_gap * i + c]);
 }
 
+/* SMPTE ST 2084 (PQ) and ARIB STD-B67 (HLG) of ITU-R BT.2100. Both are
+ * scaled such that linear 1.0 is the HDR reference white of ITU-R BT.2408
+ * - 203 cd/m² for PQ and a signal of 0.75 for HLG - leaving the range
+ * above it for highlights. HLG is scene referred, without the OOTF. Both
+ * are extended to negative values by symmetry.
+ */
+
+#define PQ_M1        (2610.0 / 16384.0)
+#define PQ_M2        (2523.0 / 4096.0 * 128.0)
+#define PQ_C1        (3424.0 / 4096.0)
+#define PQ_C2        (2413.0 / 4096.0 * 32.0)
+#define PQ_C3        (2392.0 / 4096.0 * 32.0)
+#define PQ_PEAK      (10000.0 / 203.0)
+
+#define HLG_A        0.17883277
+#define HLG_B        0.28466892
+#define HLG_C        0.55991072953
+#define HLG_WHITE    0.26496256042  /* the scene light of a signal of 0.75 */
+
+static inline float
+_babl_trc_pq_to_linear (const Babl *trc_,
+                        float       value)
+{
+  float x = fabsf (value) < 1.0f ? fabsf (value) : 1.0f;
+  float p = powf (x, 1.0f / PQ_M2);
+  float y = p > PQ_C1 ? powf ((p - PQ_C1) / (PQ_C2 - PQ_C3 * p), 1.0f / PQ_M1) : 0.0f;
+
+  return copysignf (y * PQ_PEAK, value);
+}
+
+static inline float
+_babl_trc_pq_from_linear (const Babl *trc_,
+                          float       value)
+{
+  float y = powf (fabsf (value) * (1.0f / PQ_PEAK), PQ_M1);
+
+  return copysignf (powf ((PQ_C1 + PQ_C2 * y) / (1.0f + PQ_C3 * y), PQ_M2), value);
+}
+
+static inline float
+_babl_trc_hlg_to_linear (const Babl *trc_,
+                         float       value)
+{
+  float x = fabsf (value);
+  float e = x <= 0.5f ? x * x * (1.0f / 3.0f) :
+                        (expf ((x - HLG_C) * (1.0f / HLG_A)) + HLG_B) * (1.0f / 12.0f);
+
+  return copysignf (e * (1.0f / HLG_WHITE), value);
+}
+
+static inline float
+_babl_trc_hlg_from_linear (const Babl *trc_,
+                           float       value)
+{
+  float e = fabsf (value) * HLG_WHITE;
+  float x = e <= 1.0f / 12.0f ? sqrtf (3.0f * e) :
+                                HLG_A * logf (12.0f * e - HLG_B) + HLG_C;
+
+  return copysignf (x, value);
+}
+
+#ifdef BABL_VECTOR
+
+static inline BablV4f
+babl_v4f_pq_to_linear (BablV4f value)
+{
+  BablV4f x = babl_v4f_min (babl_v4f_abs (value), babl_v4f_splat (1.0f));
+  BablV4f p = babl_v4f_pow (x, 1.0f / PQ_M2);
+  BablV4f y = babl_v4f_pow ((p - babl_v4f_splat (PQ_C1)) /
+                            (babl_v4f_splat (PQ_C2) - babl_v4f_splat (PQ_C3) * p),
+                            1.0f / PQ_M1);
+
+  return babl_v4f_copysign (y * babl_v4f_splat (PQ_PEAK), value);
+}
+
+static inline BablV4f
+babl_v4f_pq_from_linear (BablV4f value)
+{
+  BablV4f y = babl_v4f_pow (babl_v4f_abs (value) * babl_v4f_splat (1.0f / PQ_PEAK),
+                            PQ_M1);
+  BablV4f x = babl_v4f_pow ((babl_v4f_splat (PQ_C1) + babl_v4f_splat (PQ_C2) * y) /
+                            (babl_v4f_splat (1.0f) + babl_v4f_splat (PQ_C3) * y),
+                            PQ_M2);
+
+  return babl_v4f_copysign (x, value);
+}
+
+static inline BablV4f
+babl_v4f_hlg_to_linear (BablV4f value)
+{
+  BablV4f x    = babl_v4f_abs (value);
+  BablV4f low  = x * x * babl_v4f_splat (1.0f / 3.0f);
+  BablV4f high = (babl_v4f_exp2 ((x - babl_v4f_splat (HLG_C)) *
+                                 babl_v4f_splat (1.0 / HLG_A / M_LN2)) +
+                  babl_v4f_splat (HLG_B)) * babl_v4f_splat (1.0f / 12.0f);
+
+  return babl_v4f_copysign (babl_v4f_select (x > babl_v4f_splat (0.5f), high, low) *
+                            babl_v4f_splat (1.0f / HLG_WHITE), value);
+}
+
+static inline BablV4f
+babl_v4f_hlg_from_linear (BablV4f value)
+{
+  BablV4f e    = babl_v4f_abs (value) * babl_v4f_splat (HLG_WHITE);
+  BablV4f low  = babl_v4f_pow (babl_v4f_splat (3.0f) * e, 0.5f);
+  BablV4f high = babl_v4f_log2 (babl_v4f_max (babl_v4f_splat (12.0f) * e -
+                                              babl_v4f_splat (HLG_B),
+                                              babl_v4f_splat (0.5f))) *
+                 babl_v4f_splat (HLG_A * M_LN2) + babl_v4f_splat (HLG_C);
+
+  return babl_v4f_copysign (babl_v4f_select (e > babl_v4f_splat (1.0f / 12.0f),
+                                             high, low), value);
+}
+
+/* the components of count pixels, gathered into a contiguous run for the
+ * vector functions where they are not one already
+ */
+#define TRC_BUF_V4F(name, fun)                                                \
+static void                                                                   \
+name (const Babl  *trc_,                                                      \
+      const float *in,                                                        \
+      float       *out,                                                       \
+      int          in_gap,                                                    \
+      int          out_gap,                                                   \
+      int          components,                                                \
+      int          count)                                                     \
+{                                                                             \
+  float buf[256];                                                             \
+  int   chunk = 256 / 4 / components * 4;                                     \
+  int   i, j, c;                                                              \
+                                                                              \
+  for (i = 0; i < count; i += chunk)                                          \
+    {                                                                         \
+      int pixels = count - i < chunk ? count - i : chunk;                     \
+      int n      = pixels * components;                                       \
+                                                                              \
+      for (j = 0; j < pixels; j++)                                            \
+        for (c = 0; c < components; c++)                                      \
+          buf[j * components + c] = in[(i + j) * in_gap + c];                 \
+      for (j = n; j % 4; j++)                                                 \
+        buf[j] = 0.0f;                                                        \
+                                                                              \
+      for (j = 0; j < n; j += 4)                                              \
+        babl_v4f_store (buf + j, fun (babl_v4f_load (buf + j)));              \
+                                                                              \
+      for (j = 0; j < pixels; j++)                                            \
+        for (c = 0; c < components; c++)                                      \
+          out[(i + j) * out_gap + c] = buf[j * components + c];               \
+    }                                                                         \
+}
+
+TRC_BUF_V4F (_babl_trc_pq_to_linear_buf,    babl_v4f_pq_to_linear)
+TRC_BUF_V4F (_babl_trc_pq_from_linear_buf,  babl_v4f_pq_from_linear)
+TRC_BUF_V4F (_babl_trc_hlg_to_linear_buf,   babl_v4f_hlg_to_linear)
+TRC_BUF_V4F (_babl_trc_hlg_from_linear_buf, babl_v4f_hlg_from_linear)
+
+#undef TRC_BUF_V4F
+
+#else
+
+#define _babl_trc_pq_to_linear_buf    _babl_trc_to_linear_buf_generic
+#define _babl_trc_pq_from_linear_buf  _babl_trc_from_linear_buf_generic
+#define _babl_trc_hlg_to_linear_buf   _babl_trc_to_linear_buf_generic
+#define _babl_trc_hlg_from_linear_buf _babl_trc_from_linear_buf_generic
+
+#endif /* BABL_VECTOR */
+
 static inline void _babl_trc_linear_buf (const Babl  *trc_,
                                          const float *in, 
                                          float       *out,
@@ -522,6 +690,18 @@ babl_trc_new (const char *name,
       trc_db[i].fun_to_linear = babl_trc_lut_to_linear;
       trc_db[i].fun_from_linear = babl_trc_lut_from_linear;
       break;
+    case BABL_TRC_PQ:
+      trc_db[i].fun_to_linear = _babl_trc_pq_to_linear;
+      trc_db[i].fun_from_linear = _babl_trc_pq_from_linear;
+      trc_db[i].fun_to_linear_buf = _babl_trc_pq_to_linear_buf;
+      trc_db[i].fun_from_linear_buf = _babl_trc_pq_from_linear_buf;
+      break;
+    case BABL_TRC_HLG:
+      trc_db[i].fun_to_linear = _babl_trc_hlg_to_linear;
+      trc_db[i].fun_from_linear = _babl_trc_hlg_from_linear;
+      trc_db[i].fun_to_linear_buf = _babl_trc_hlg_to_linear_buf;
+      trc_db[i].fun_from_linear_buf = _babl_trc_hlg_from_linear_buf;
+      break;
   }
   return (Babl*)&trc_db[i];
 }
@@ -618,6 +798,8 @@ babl_trc_class_init (void)
   babl_trc_gamma (1.8);
   babl_trc_gamma (1.0);
   babl_trc_new ("linear", BABL_TRC_LINEAR, 1.0, 0, NULL);
+  babl_trc_new ("PQ", BABL_TRC_PQ, 0.0, 0, NULL);
+  babl_trc_new ("HLG", BABL_TRC_HLG, 0.0, 0, NULL);
 }
 
 #if 0
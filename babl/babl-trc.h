@@ -31,7 +31,9 @@ typedef enum {BABL_TRC_LINEAR,
               BABL_TRC_SRGB,
               BABL_TRC_FORMULA_SRGB,
               BABL_TRC_LUT,
-              BABL_TRC_FORMULA_CIE}
+              BABL_TRC_FORMULA_CIE,
+              BABL_TRC_PQ,
+              BABL_TRC_HLG}
 BablTRCType;
 
 typedef struct
@@ -39,14 +39,16 @@ static Babl *
 type_new (const char *name,
           int         id,
           int         bits,
+          int         packed_bits,
           const char *doc)
 {
   Babl *babl;
 
   babl_assert (bits != 0);
   babl_assert (bits % 8 == 0);
+  babl_assert (packed_bits <= bits);
 
-  babl                 = babl_malloc (sizeof (BablType) + strlen (name) + 1);
+  babl                 = babl_arena_calloc (BABL_TYPE, sizeof (BablType) + strlen (name) + 1);
   babl_set_destructor (babl, babl_type_destroy);
   babl->instance.name  = (void *) ((char *) babl + sizeof (BablType));
   babl->class_type     = BABL_TYPE;
@@ -54,6 +56,7 @@ type_new (const char *name,
   babl->instance.doc   = doc;
   strcpy (babl->instance.name, name);
   babl->type.bits      = bits;
+  babl->type.packed_bits = packed_bits ? packed_bits : bits;
   babl->type.from_list = NULL;
 
   return babl;
@@ -77,6 +80,7 @@ babl_type_new (void *first_arg,
   Babl       *babl;
   int         id         = 0;
   int         bits       = 0;
+  int         packed_bits = 0;
   const char *name = first_arg;
   const char *arg;
   const char *doc = NULL;
@@ -99,6 +103,10 @@ babl_type_new (void *first_arg,
         {
           bits = va_arg (varg, int);
         }
+      else if (!strcmp (arg, "packed_bits"))
+        {
+          packed_bits = va_arg (varg, int);
+        }
       else if (!strcmp (arg, "integer"))
         {
           (void) va_arg (varg, int);
@@ -157,7 +165,7 @@ babl_type_new (void *first_arg,
       return babl;
     }
 
-  babl = type_new (name, id, bits, doc);
+  babl = type_new (name, id, bits, packed_bits, doc);
 
   /* Since there is not an already registered instance by the required
    * id/name, inserting newly created class into database.
@@ -27,6 +27,8 @@ typedef struct
   BablList         *from_list;
   int              bits;  /*< number of bits used to represent the data type
                             (initially restricted to a multiple of 8) */
+  int              packed_bits; /*< number of significant bits, the width
+                                    the value occupies in a bitpacked format */
   double           min_val;
   double           max_val;
 } BablType;
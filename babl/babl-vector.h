@@ -0,0 +1,566 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005-2008, Øyvind Kolås and others.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BABL_VECTOR_H
+#define _BABL_VECTOR_H
+
+/* Portable 4 lane SIMD, through the vector extensions of GCC and clang.
+ * The compiler maps these to SSE2, NEON, AltiVec or whatever the target
+ * has, and to scalar code where it has nothing. Code using it is guarded
+ * by BABL_VECTOR, and conversions built on it are registered for the
+ * BABL_CPU_ACCEL_VECTOR tier.
+ */
+
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9)
+#define BABL_VECTOR 1
+#endif
+
+#ifdef BABL_VECTOR
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef float    BablV4f   __attribute__ ((vector_size (16)));
+typedef double   BablV4d   __attribute__ ((vector_size (32)));
+typedef int32_t  BablV4i   __attribute__ ((vector_size (16)));
+typedef uint32_t BablV4u32 __attribute__ ((vector_size (16)));
+typedef uint16_t BablV4u16 __attribute__ ((vector_size (8)));
+typedef uint8_t  BablV4u8  __attribute__ ((vector_size (4)));
+
+static inline BablV4f
+babl_v4f_splat (float x)
+{
+  return (BablV4f) { x, x, x, x };
+}
+
+static inline BablV4i
+babl_v4i_splat (int32_t x)
+{
+  return (BablV4i) { x, x, x, x };
+}
+
+/* unaligned loads and stores */
+
+static inline BablV4f
+babl_v4f_load (const float *p)
+{
+  BablV4f v;
+  memcpy (&v, p, sizeof (v));
+  return v;
+}
+
+static inline void
+babl_v4f_store (float   *p,
+                BablV4f  v)
+{
+  memcpy (p, &v, sizeof (v));
+}
+
+static inline BablV4f
+babl_v4f_load_u8 (const uint8_t *p)
+{
+  BablV4u8 v;
+  memcpy (&v, p, sizeof (v));
+  return __builtin_convertvector (v, BablV4f);
+}
+
+static inline BablV4f
+babl_v4f_load_u16 (const uint16_t *p)
+{
+  BablV4u16 v;
+  memcpy (&v, p, sizeof (v));
+  return __builtin_convertvector (v, BablV4f);
+}
+
+/* lanes of mask set pick a, the others b */
+static inline BablV4f
+babl_v4f_select (BablV4i mask,
+                 BablV4f a,
+                 BablV4f b)
+{
+  return (BablV4f) ((mask & (BablV4i) a) | (~mask & (BablV4i) b));
+}
+
+static inline BablV4f
+babl_v4f_min (BablV4f a,
+              BablV4f b)
+{
+  return babl_v4f_select (a < b, a, b);
+}
+
+static inline BablV4f
+babl_v4f_max (BablV4f a,
+              BablV4f b)
+{
+  return babl_v4f_select (a > b, a, b);
+}
+
+static inline BablV4f
+babl_v4f_clamp (BablV4f x,
+                float   max)
+{
+  return babl_v4f_min (babl_v4f_max (x, babl_v4f_splat (0.0f)),
+                       babl_v4f_splat (max));
+}
+
+static inline BablV4f
+babl_v4f_abs (BablV4f x)
+{
+  return (BablV4f) ((BablV4i) x & babl_v4i_splat (0x7fffffff));
+}
+
+/* x with the sign of sign */
+static inline BablV4f
+babl_v4f_copysign (BablV4f x,
+                   BablV4f sign)
+{
+  BablV4i mask = babl_v4i_splat (0x7fffffff);
+
+  return (BablV4f) (((BablV4i) x & mask) | ((BablV4i) sign & ~mask));
+}
+
+static inline int
+babl_v4i_any (BablV4i mask)
+{
+  return (mask[0] | mask[1] | mask[2] | mask[3]) != 0;
+}
+
+/* x, clamped to 0.0 - max, scaled by max, and rounded */
+static inline void
+babl_v4f_store_u8 (uint8_t *p,
+                   BablV4f  x)
+{
+  BablV4i  i = __builtin_convertvector (babl_v4f_clamp (x * babl_v4f_splat (255.0f),
+                                                        255.0f) +
+                                        babl_v4f_splat (0.5f), BablV4i);
+  BablV4u8 v = __builtin_convertvector (i, BablV4u8);
+
+  memcpy (p, &v, sizeof (v));
+}
+
+/* 0.0 - 1.0 to 0 - 65535, scaled in double where the product is exact;
+ * rounding it to float first can land it on .5 and round it the wrong way
+ */
+static inline BablV4u16
+babl_v4f_to_u16 (BablV4f x)
+{
+  BablV4d d = __builtin_convertvector (babl_v4f_clamp (x, 1.0f), BablV4d) *
+              (BablV4d) { 65535.0, 65535.0, 65535.0, 65535.0 } +
+              (BablV4d) { 0.5, 0.5, 0.5, 0.5 };
+
+  return __builtin_convertvector (__builtin_convertvector (d, BablV4i), BablV4u16);
+}
+
+static inline void
+babl_v4f_store_u16 (uint16_t *p,
+                    BablV4f   x)
+{
+  BablV4u16 v = babl_v4f_to_u16 (x);
+
+  memcpy (p, &v, sizeof (v));
+}
+
+/* big endian loads and stores, the byte swap is the same both ways */
+
+static inline BablV4u16
+babl_v4u16_be (BablV4u16 v)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return v;
+#else
+  return (v << 8) | (v >> 8);
+#endif
+}
+
+static inline BablV4u32
+babl_v4u32_be (BablV4u32 v)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return v;
+#else
+  v = (v << 16) | (v >> 16);
+  return ((v & 0x00ff00ff) << 8) | ((v >> 8) & 0x00ff00ff);
+#endif
+}
+
+static inline BablV4f
+babl_v4f_load_u16be (const uint16_t *p)
+{
+  BablV4u16 v;
+  memcpy (&v, p, sizeof (v));
+  return __builtin_convertvector (babl_v4u16_be (v), BablV4f);
+}
+
+static inline void
+babl_v4f_store_u16be (uint16_t *p,
+                      BablV4f   x)
+{
+  BablV4u16 v = babl_v4u16_be (babl_v4f_to_u16 (x));
+
+  memcpy (p, &v, sizeof (v));
+}
+
+static inline BablV4f
+babl_v4f_load_floatbe (const float *p)
+{
+  BablV4u32 v;
+  memcpy (&v, p, sizeof (v));
+  return (BablV4f) babl_v4u32_be (v);
+}
+
+static inline void
+babl_v4f_store_floatbe (float   *p,
+                        BablV4f  x)
+{
+  BablV4u32 v = babl_v4u32_be ((BablV4u32) x);
+
+  memcpy (p, &v, sizeof (v));
+}
+
+/* half floats, rounded to nearest even like F16C; subnormal halves are
+ * exact in float, and subnormal results come from letting the float
+ * addition of 0.5 do the rounding
+ */
+static inline BablV4f
+babl_v4f_load_half (const uint16_t *p)
+{
+  BablV4u16 h;
+  BablV4u32 v;
+  BablV4u32 em;
+  BablV4u32 bits;
+  BablV4f   subnormal;
+
+  memcpy (&h, p, sizeof (h));
+  v         = __builtin_convertvector (h, BablV4u32);
+  em        = v & 0x7fff;
+  subnormal = __builtin_convertvector ((BablV4i) em, BablV4f) *
+              babl_v4f_splat (1.0f / 16777216.0f);
+  bits      = (BablV4u32) babl_v4f_select ((BablV4i) (em >= 0x7c00),
+                                           (BablV4f) ((em << 13) | 0x7f800000),
+                                           (BablV4f) ((em << 13) + 0x38000000));
+  bits      = (BablV4u32) babl_v4f_select ((BablV4i) (em < 0x400),
+                                           subnormal, (BablV4f) bits);
+
+  return (BablV4f) (bits | (v & 0x8000) << 16);
+}
+
+static inline void
+babl_v4f_store_half (uint16_t *p,
+                     BablV4f   x)
+{
+  BablV4u32 bits      = (BablV4u32) x;
+  BablV4u32 abs       = bits & 0x7fffffff;
+  BablV4u32 is_nan    = (BablV4u32) (abs > 0x7f800000);
+  BablV4u32 is_big    = (BablV4u32) (abs >= 0x47800000);
+  BablV4u32 is_small  = (BablV4u32) (abs < 0x38800000);
+  BablV4u32 overflow  = (is_nan & 0x0200) | 0x7c00;
+  BablV4u32 subnormal = (BablV4u32) ((BablV4f) abs + babl_v4f_splat (0.5f)) -
+                        0x3f000000;
+  BablV4u32 normal    = (abs + 0xc8000fff + ((abs >> 13) & 1)) >> 13;
+  BablV4u32 half      = (is_small & subnormal) | (~is_small & normal);
+  BablV4u16 v;
+
+  half = (is_big & overflow) | (~is_big & half);
+  v    = __builtin_convertvector (half | ((bits >> 16) & 0x8000), BablV4u16);
+  memcpy (p, &v, sizeof (v));
+}
+
+/* rows become columns, a[0] ends up as { a[0][0], a[1][0], a[2][0],
+ * a[3][0] } - the interleaving of 4 pixels of 4 components from and to 4
+ * planes
+ */
+#if defined(__clang__)
+#define BABL_V4F_SHUFFLE(a, b, i0, i1, i2, i3) \
+  __builtin_shufflevector (a, b, i0, i1, i2, i3)
+#else
+#define BABL_V4F_SHUFFLE(a, b, i0, i1, i2, i3) \
+  __builtin_shuffle (a, b, (BablV4i) { i0, i1, i2, i3 })
+#endif
+
+static inline void
+babl_v4f_transpose (BablV4f *a)
+{
+  BablV4f t0 = BABL_V4F_SHUFFLE (a[0], a[1], 0, 4, 1, 5);
+  BablV4f t1 = BABL_V4F_SHUFFLE (a[2], a[3], 0, 4, 1, 5);
+  BablV4f t2 = BABL_V4F_SHUFFLE (a[0], a[1], 2, 6, 3, 7);
+  BablV4f t3 = BABL_V4F_SHUFFLE (a[2], a[3], 2, 6, 3, 7);
+
+  a[0] = BABL_V4F_SHUFFLE (t0, t1, 0, 1, 4, 5);
+  a[1] = BABL_V4F_SHUFFLE (t0, t1, 2, 3, 6, 7);
+  a[2] = BABL_V4F_SHUFFLE (t2, t3, 0, 1, 4, 5);
+  a[3] = BABL_V4F_SHUFFLE (t2, t3, 2, 3, 6, 7);
+}
+
+/* sRGB gamma 2.2 with the newton iterations of sse2-float, without
+ * relying on a vector sqrt
+ */
+
+static inline BablV4f
+babl_v4f_init_newton (BablV4f x,
+                      double  exponent,
+                      double  c0,
+                      double  c1,
+                      double  c2)
+{
+  double  norm = exponent * M_LN2 / (1 << 23);
+  BablV4f y    = __builtin_convertvector ((BablV4i) x - babl_v4i_splat (0x3f800000),
+                                          BablV4f);
+
+  return babl_v4f_splat (c0) + babl_v4f_splat (c1 * norm) * y +
+         babl_v4f_splat (c2 * norm * norm) * y * y;
+}
+
+/* large values are out of the range of the newton iterations */
+static inline BablV4f
+babl_v4f_pow_accurate (BablV4f x,
+                       float   exponent)
+{
+  return (BablV4f) { expf (logf (x[0]) * exponent),
+                     expf (logf (x[1]) * exponent),
+                     expf (logf (x[2]) * exponent),
+                     expf (logf (x[3]) * exponent) };
+}
+
+static inline BablV4f
+babl_v4f_pow_1_24 (BablV4f x)
+{
+  BablV4f y, z, y2, y4;
+  int     i;
+
+  if (babl_v4i_any (x > babl_v4f_splat (16.0f)))
+    return babl_v4f_pow_accurate (x, 1.0f / 2.4f);
+
+  /* newton's method for x^(-1/12), x^(5/12) is x * x^(-7/12) */
+  y = babl_v4f_init_newton (x, -1./12, 0.9976800269, 0.9885126933, 0.5908575383);
+  z = babl_v4f_splat (1.f/12.f) * x;
+  for (i = 0; i < 3; i++)
+    {
+      y2 = y * y;
+      y4 = y2 * y2;
+      y  = babl_v4f_splat (13.f/12.f) * y - z * (y4 * y4 * y4 * y);
+    }
+  y2 = y * y;
+  return x * (y2 * y2 * y2 * y);
+}
+
+static inline BablV4f
+babl_v4f_pow_24 (BablV4f x)
+{
+  BablV4f y, z;
+
+  if (babl_v4i_any (x > babl_v4f_splat (2.0f)))
+    return babl_v4f_pow_accurate (x, 2.4f);
+
+  /* newton's method for x^(-1/5) */
+  y = babl_v4f_init_newton (x, -1./5, 0.9953189663, 0.9594345146, 0.6742970332);
+  z = babl_v4f_splat (1.f/5.f) * x;
+  y = babl_v4f_splat (6.f/5.f) * y - z * ((y*y*y)*(y*y*y));
+  y = babl_v4f_splat (6.f/5.f) * y - z * ((y*y*y)*(y*y*y));
+  x *= y;
+  return x*x*x;
+}
+
+static inline BablV4f
+babl_v4f_linear_to_gamma_2_2 (BablV4f x)
+{
+  BablV4f curve = babl_v4f_pow_1_24 (x) * babl_v4f_splat (1.055f) -
+                  babl_v4f_splat (0.055f - 3.0f / (float) (1 << 24));
+                  /* ^ offset the result such that 1 maps to 1 */
+
+  return babl_v4f_select (x > babl_v4f_splat (0.003130804954f),
+                          curve, x * babl_v4f_splat (12.92f));
+}
+
+static inline BablV4f
+babl_v4f_gamma_2_2_to_linear (BablV4f x)
+{
+  BablV4f curve = babl_v4f_pow_24 ((x + babl_v4f_splat (0.055f)) *
+                                   babl_v4f_splat (1 / 1.055f));
+
+  return babl_v4f_select (x > babl_v4f_splat (0.04045f),
+                          curve, x * babl_v4f_splat (1 / 12.92f));
+}
+
+/* x rounded down, for values within the range of int32_t */
+static inline BablV4f
+babl_v4f_floor (BablV4f x)
+{
+  BablV4f t = __builtin_convertvector (__builtin_convertvector (x, BablV4i), BablV4f);
+
+  return babl_v4f_select (t > x, t - babl_v4f_splat (1.0f), t);
+}
+
+/* log2 of positive, normal x. The mantissa is brought to sqrt(0.5) -
+ * sqrt(2), log2 of it is an odd series in (m - 1) / (m + 1) of which the
+ * terms past t^9 stay below float precision.
+ */
+static inline BablV4f
+babl_v4f_log2 (BablV4f x)
+{
+  BablV4i bits = (BablV4i) x;
+  BablV4i e    = ((bits >> 23) & babl_v4i_splat (0xff)) - babl_v4i_splat (127);
+  BablV4f m    = (BablV4f) ((bits & babl_v4i_splat (0x007fffff)) |
+                            babl_v4i_splat (0x3f800000));
+  BablV4i big  = m > babl_v4f_splat ((float) M_SQRT2);
+  BablV4f t, t2, p;
+
+  m  = babl_v4f_select (big, m * babl_v4f_splat (0.5f), m);
+  e -= big;
+  t  = (m - babl_v4f_splat (1.0f)) / (m + babl_v4f_splat (1.0f));
+  t2 = t * t;
+  p  = babl_v4f_splat (2.0 / 9.0 / M_LN2);
+  p  = p * t2 + babl_v4f_splat (2.0 / 7.0 / M_LN2);
+  p  = p * t2 + babl_v4f_splat (2.0 / 5.0 / M_LN2);
+  p  = p * t2 + babl_v4f_splat (2.0 / 3.0 / M_LN2);
+  p  = p * t2 + babl_v4f_splat (2.0 / M_LN2);
+
+  return __builtin_convertvector (e, BablV4f) + p * t;
+}
+
+/* 2^x, x clamped to where the result stays a normal float - denormals
+ * are slow; 2^n goes in the exponent bits and 2^f of the remaining -0.5 -
+ * 0.5 is a Taylor series
+ */
+static inline BablV4f
+babl_v4f_exp2 (BablV4f x)
+{
+  BablV4f n, f, p;
+  BablV4i e;
+
+  x = babl_v4f_min (babl_v4f_max (x, babl_v4f_splat (-125.0f)),
+                    babl_v4f_splat (127.0f));
+  n = babl_v4f_floor (x + babl_v4f_splat (0.5f));
+  f = (x - n) * babl_v4f_splat (M_LN2);
+  p = babl_v4f_splat (1.0 / 5040.0);
+  p = p * f + babl_v4f_splat (1.0 / 720.0);
+  p = p * f + babl_v4f_splat (1.0 / 120.0);
+  p = p * f + babl_v4f_splat (1.0 / 24.0);
+  p = p * f + babl_v4f_splat (1.0 / 6.0);
+  p = p * f + babl_v4f_splat (1.0 / 2.0);
+  p = p * f + babl_v4f_splat (1.0f);
+  p = p * f + babl_v4f_splat (1.0f);
+  e = (__builtin_convertvector (n, BablV4i) + babl_v4i_splat (127)) << 23;
+
+  return p * (BablV4f) e;
+}
+
+/* x^y, 0.0 for x of 0.0 and below */
+static inline BablV4f
+babl_v4f_pow (BablV4f x,
+              float   y)
+{
+  BablV4f r = babl_v4f_exp2 (babl_v4f_log2 (babl_v4f_max (x, babl_v4f_splat (1.17549435e-38f))) *
+                             babl_v4f_splat (y));
+
+  return babl_v4f_select (x > babl_v4f_splat (0.0f), r, babl_v4f_splat (0.0f));
+}
+
+/* Runs step on 4 pixels of 3 or 4 float components at a time, with a
+ * vector per component - 3 component pixels get an alpha of 1.0. The
+ * tail goes through a zero padded copy.
+ */
+static inline void
+babl_v4f_process_pixels (const float *src,
+                         int          src_components,
+                         float       *dst,
+                         int          dst_components,
+                         long         samples,
+                         void       (*step) (BablV4f *c, const void *data),
+                         const void  *data)
+{
+  float in[16]  = { 0, };
+  float out[16];
+  long  i;
+  int   j, c;
+
+  for (i = 0; i < samples; i += 4)
+    {
+      const float *s     = src + i * src_components;
+      float       *d     = dst + i * dst_components;
+      int          count = samples - i < 4 ? samples - i : 4;
+      BablV4f      v[4];
+
+      if (count < 4)
+        {
+          memcpy (in, s, count * src_components * sizeof (float));
+          s = in;
+          d = out;
+        }
+
+      for (c = 0; c < src_components; c++)
+        v[c] = (BablV4f) { s[c], s[src_components + c],
+                           s[2 * src_components + c], s[3 * src_components + c] };
+      if (src_components == 3)
+        v[3] = babl_v4f_splat (1.0f);
+
+      step (v, data);
+
+      for (j = 0; j < 4; j++)
+        for (c = 0; c < dst_components; c++)
+          d[j * dst_components + c] = v[c][j];
+
+      if (count < 4)
+        memcpy (dst + i * dst_components, out, count * dst_components * sizeof (float));
+    }
+}
+
+/* The hue of the hexcone models - HSV, HSL and HCY - from 0.0 to 1.0, of
+ * components with the given max and max - min; undefined for a chroma of 0.
+ */
+static inline BablV4f
+babl_v4f_hue (BablV4f red,
+              BablV4f green,
+              BablV4f blue,
+              BablV4f max,
+              BablV4f chroma)
+{
+  BablV4f recip = babl_v4f_splat (1.0f) /
+                  babl_v4f_select (chroma > babl_v4f_splat (0.0f),
+                                   chroma, babl_v4f_splat (1.0f));
+  BablV4f hue_r = (green - blue) * recip;
+  BablV4f hue_g = babl_v4f_splat (2.0f) + (blue - red) * recip;
+  BablV4f hue_b = babl_v4f_splat (4.0f) + (red - green) * recip;
+
+  hue_r = babl_v4f_select (hue_r < babl_v4f_splat (0.0f),
+                           hue_r + babl_v4f_splat (6.0f), hue_r);
+
+  return babl_v4f_select (red == max, hue_r,
+                          babl_v4f_select (green == max, hue_g, hue_b)) *
+         babl_v4f_splat (1.0f / 6.0f);
+}
+
+/* 1.0 - how far hue is from the primary n, 5 for red, 3 for green and 1
+ * for blue, clamped to 0.0 - 1.0: the component of the pure color of hue
+ * with a max of 1.0 and a min of 0.0
+ */
+static inline BablV4f
+babl_v4f_hue_component (BablV4f hue,
+                        float   n)
+{
+  BablV4f k = babl_v4f_splat (n) + (hue - babl_v4f_floor (hue)) * babl_v4f_splat (6.0f);
+
+  k = babl_v4f_select (k >= babl_v4f_splat (6.0f), k - babl_v4f_splat (6.0f), k);
+
+  return babl_v4f_splat (1.0f) -
+         babl_v4f_clamp (babl_v4f_min (k, babl_v4f_splat (4.0f) - k), 1.0f);
+}
+
+#endif /* BABL_VECTOR */
+
+#endif /* _BABL_VECTOR_H */
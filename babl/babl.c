@@ -148,12 +148,14 @@ babl_init (void)
       babl_core_init ();
       babl_sanity ();
       babl_extension_base ();
+      babl_format_class_init ();
       babl_sanity ();
 
       dir_list = babl_dir_list ();
       babl_extension_load_dir_list (dir_list);
       babl_free (dir_list);
 
+      babl_cost_profile_load ();
       babl_init_db ();
     }
 }
@@ -164,11 +166,14 @@ babl_exit (void)
   if (!-- ref_count)
     {
       babl_store_db ();
+      babl_cost_profile_unload ();
+      _babl_fish_cache_invalidate ();
 
       babl_extension_deinit ();
       babl_free (babl_extension_db ());;
       babl_free (babl_fish_db ());;
       babl_free (babl_conversion_db ());;
+      babl_format_class_deinit ();
       babl_free (babl_format_db ());;
       babl_free (babl_model_db ());;
       babl_free (babl_component_db ());;
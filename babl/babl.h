@@ -95,7 +95,8 @@ babl_model_with_space (const char *name, const Babl *space);
  *
  * Returns the babl object representing the specific RGB matrix color
  * working space referred to by name. Babl knows of:
- *    sRGB, Rec2020, Adobish, Apple and ProPhoto
+ *    sRGB, Rec2020, Adobish, Apple and ProPhoto, and the HDR spaces
+ *    Rec2100-PQ and Rec2100-HLG
  *
  */
 const Babl * babl_space (const char *name);
@@ -189,7 +190,9 @@ const Babl * babl_format            (const char *encoding);
  * a specific RGB working space used as the space, the resulting format
  * has -space suffixed to it, unless the space requested is sRGB then
  * the unsuffixed version is used. If a format is passed in as space
- * the space of the format is used.
+ * the space of the format is used. Results are interned per encoding
+ * format and space, a format passed as @encoding is resolved without any
+ * string lookups.
  */
 const Babl * babl_format_with_space (const char *encoding, const Babl *space);
 
@@ -221,6 +224,20 @@ const Babl * babl_fish (const void *source_format,
                         const void *destination_format);
 
 
+/**
+ * babl_fish_cache_get_stats:
+ * @hits: (out) (optional): number of babl_fish() lookups answered from the
+ *        per-thread cache of recently used fishes.
+ * @misses: (out) (optional): number of babl_fish() lookups that had to
+ *          consult the global fish database.
+ *
+ * Query the effectiveness of the babl_fish() lookup cache, only lookups made
+ * with format objects, rather than format names, can be cached. The counts of
+ * other threads are accumulated in batches and can lag behind.
+ */
+void         babl_fish_cache_get_stats (long *hits,
+                                        long *misses);
+
 /**
  * babl_fast_fish:
  *
@@ -250,6 +267,22 @@ long         babl_process   (const Babl *babl_fish,
                              void *destination,
                              long  n);
 
+/**
+ * babl_fish_supports_in_place:
+ *
+ * Returns 1 when @babl_fish converts pixels in place, that is when
+ * babl_process(), babl_process_rows() with equal strides and
+ * babl_process_spans() can be given the same buffer as source and
+ * destination. This is the case when a pixel of the destination format
+ * takes no more bytes than one of the source format, like converting
+ * "RGBA float" to "R'G'B'A u8" or "R'G'B'A u8" to "R'G'B' u8". Paths of
+ * several conversions and the reference conversions read the source
+ * before writing the destination, single conversions are staged through
+ * a small buffer. Returns 0 otherwise, and then the buffers must not
+ * overlap.
+ */
+int          babl_fish_supports_in_place (const Babl *babl_fish);
+
 
 long         babl_process_rows (const Babl *babl_fish,
                                 const void *source,
@@ -259,6 +292,100 @@ long         babl_process_rows (const Babl *babl_fish,
                                 long        n,
                                 int         rows);
 
+/**
+ * BablSpan:
+ * @source: the first source pixel
+ * @destination: the first destination pixel
+ * @n: the number of pixels
+ *
+ * A run of pixels for babl_process_spans().
+ */
+typedef struct
+{
+  const void *source;
+  void       *destination;
+  long        n;
+} BablSpan;
+
+/**
+ * babl_process_spans:
+ *
+ * Process @count spans of pixels with @babl_fish, like calling
+ * babl_process() for each; the lookups and the scratch buffers of the fish
+ * are set up once for all of them, and spans that continue the previous
+ * one in both buffers are converted as the single run they make up. Like
+ * babl_process() it can be called from several threads at once, to spread
+ * the spans of a frame among them.
+ * Returns the number of pixels converted.
+ */
+long         babl_process_spans (const Babl     *babl_fish,
+                                 const BablSpan *spans,
+                                 int             count);
+
+/**
+ * babl_process_planar:
+ *
+ * Process a @width by @rows region of pixels using @babl_fish, where the
+ * source and destination are given as one pointer and row stride in bytes
+ * per plane of the fish's formats, see babl_format_get_n_planes(). The
+ * sampling of subsampled formats like "Y'CbCr420 u8" is honored; the
+ * chroma planes hold (@width + horizontal - 1) / horizontal samples per
+ * row and (@rows + vertical - 1) / vertical rows. Returns number of pixels
+ * converted.
+ *
+ * Between formats of the same model and components with u8, u16, half or
+ * float components - "R'G'B'A u8" and "R'G'B'A float planar", or the
+ * planes of an NCHW tensor - the samples are interleaved or deinterleaved
+ * and converted to the destination type in a single pass.
+ */
+long         babl_process_planar (const Babl  *babl_fish,
+                                  const void **source_planes,
+                                  const int   *source_strides,
+                                  void       **destination_planes,
+                                  const int   *destination_strides,
+                                  long         width,
+                                  int          rows);
+
+/**
+ * BablColorTransform:
+ *
+ * A fish compiled for converting single pixels, see
+ * babl_color_transform_new().
+ */
+typedef struct _BablColorTransform BablColorTransform;
+
+/**
+ * babl_color_transform_new:
+ *
+ * Compile @babl_fish for converting one pixel at a time, like a color
+ * picker or a single color in a user interface does; the conversions the
+ * fish makes are looked up once, instead of on every call. The pixels
+ * converted by the transform are identical to those babl_process() gives
+ * for the fish.
+ *
+ * Returns: a new #BablColorTransform, to be freed with
+ * babl_color_transform_free().
+ */
+BablColorTransform *babl_color_transform_new     (const Babl *babl_fish);
+
+/**
+ * babl_color_transform_process:
+ *
+ * Convert the single pixel at @source into @destination. Like
+ * babl_process() it can be called from several threads at once with the
+ * same @transform.
+ */
+void                babl_color_transform_process (const BablColorTransform *transform,
+                                                  const void               *source,
+                                                  void                     *destination);
+
+/**
+ * babl_color_transform_free:
+ *
+ * Free a #BablColorTransform.
+ */
+void                babl_color_transform_free    (BablColorTransform *transform);
+
 
 /**
  * babl_get_name:
@@ -300,6 +427,7 @@ const Babl * babl_format_get_model             (const Babl *format);
  * @BABL_MODEL_FLAG_PERCEPTUAL: the data has a TRC - a perceptual TRC where 50% gray is 0.5
  * @BABL_MODEL_FLAG_GRAY: this is a gray component model
  * @BABL_MODEL_FLAG_RGB: this is an RGB based component model, the space associated is expected to contain an RGB matrix profile.
+ * @BABL_MODEL_FLAG_SPECTRAL: the components are bands of a spectrum, see babl_spectral_format()
  * @BABL_MODEL_FLAG_CIE: this model is part of the CIE family of spaces
  * @BABL_MODEL_FLAG_CMYK: the encodings described are CMYK encodings, the space associated is expected to contain an CMYK ICC profile.
  *
@@ -316,7 +444,7 @@ typedef enum
 
   BABL_MODEL_FLAG_GRAY          = 1<<20,
   BABL_MODEL_FLAG_RGB           = 1<<21,
-  /* BABL_MODEL_FLAG_SPECTRAL   = 1<<22, NYI */
+  BABL_MODEL_FLAG_SPECTRAL      = 1<<22,
   BABL_MODEL_FLAG_CIE           = 1<<23,
   BABL_MODEL_FLAG_CMYK          = 1<<24,
   /* BABL_MODEL_FLAG_LUZ        = 1<<25, NYI */
@@ -338,6 +466,15 @@ BablModelFlag babl_get_model_flags (const Babl *model);
  */
 int          babl_format_get_n_components      (const Babl *format);
 
+/**
+ * babl_format_get_n_planes:
+ *
+ * Returns the number of planes a buffer of the given @format is stored in,
+ * 1 for packed formats, one per component for "planar" formats and one per
+ * run of components sharing a sampling for "semiplanar" formats like NV12.
+ */
+int          babl_format_get_n_planes          (const Babl *format);
+
 /**
  * babl_format_get_type:
  *
@@ -353,10 +490,13 @@ const Babl * babl_format_get_type              (const Babl *format,
  *
  * Defines a new data type in babl. A data type that babl can have in
  * its buffers requires conversions to and from "double" to be
- * registered before passing sanity.
+ * registered before passing sanity. Integer types narrower than their
+ * storage can give their significant width as "packed_bits", which is
+ * the width they occupy in "bitpacked" formats.
  *
  *     babl_type_new       (const char *name,
  *                          "bits",     int bits,
+ *                          ["packed_bits", int packed_bits,]
  *                          ["min_val", double min_val,]
  *                          ["max_val", double max_val,]
  *                          NULL);
@@ -394,7 +534,8 @@ const Babl * babl_model_new (void *first_arg,
  *
  * Defines a new pixel format in babl. Provided BablType and|or
  * BablSampling is valid for the following components as well. If no
- * name is provided a (long) descriptive name is used.
+ * name is provided a (long) descriptive name is used, ending in the
+ * layout for "planar", "semiplanar" and "bitpacked" formats.
  *
  *     babl_format_new     (["name", const char *name,]
  *                          BablModel          *model,
@@ -405,8 +546,12 @@ const Babl * babl_model_new (void *first_arg,
  *                           [BablSampling       *sampling,]
  *                           BablComponent      *componentN,
  *                           ...]
- *                          ["planar",]
+ *                          ["planar"|"semiplanar"|"bitpacked",]
  *                          NULL);
+ *
+ * Components of a "bitpacked" format share a single little endian word
+ * of up to 64 bits, the first component in the least significant bits,
+ * each occupying the "packed_bits" of its type.
  */
 const Babl * babl_format_new (const void *first_arg,
                               ...) BABL_ARG_NULL_TERMINATED;
@@ -440,7 +585,17 @@ int babl_format_is_format_n (const Babl *format);
  *                          BablModel  *source, BablModel  *destination|
  *                          BablType   *source, BablType   *destination>,
  *                          <"linear"|"planar">, <BablFuncLinear | BablFuncPlanar> conv_func,
+ *                          ["data", void *user_data,]
+ *                          ["accel", BablCpuAccelFlags flags,]
  *                          NULL);
+ *
+ * Conversions given "accel" depend on the instruction sets in flags, on
+ * CPUs lacking them nothing is registered and %NULL is returned. When the
+ * same conversion is registered for several instruction set tiers, paths
+ * use the implementation with the lowest measured cost. Setting the
+ * environment variable BABL_CPU_ACCEL to one of none, vector, sse2,
+ * sse4.1, avx2 or avx512 caps the tier, and the highest one up to it is
+ * used instead.
  */
 const Babl * babl_conversion_new (const void *first_arg,
                                   ...) BABL_ARG_NULL_TERMINATED;
@@ -517,6 +672,36 @@ void  babl_palette_set_palette (const Babl        *babl,
 void  babl_palette_reset       (const Babl        *babl);
 
 
+/**
+ * babl_spectral_format:
+ * @type: (nullable): the data type of the bands, NULL for float
+ * @nm_start: the wavelength of the first band, in nanometers
+ * @nm_gap: the distance between the centers of bands, in nanometers
+ * @bands: the number of bands, at most 128
+ * @observer: (nullable) (array): color matching functions, x̄, ȳ and z̄
+ *            interleaved for each band, or NULL for the CIE 1931 2° standard
+ *            observer
+ * @illuminant: (nullable) (array): the spectral power of the illuminant for
+ *              each band when the data is reflectance, or NULL for emissive
+ *              data
+ * @space: (nullable): the RGB space of the format, NULL for sRGB
+ *
+ * Returns a format with a component for each band of a spectrum sampled at
+ * evenly spaced wavelengths. The spectra are integrated to CIE XYZ and
+ * adapted so that a flat spectrum of 1.0 is the white of @space, with the
+ * luminance of 1.0. Converting RGB to spectral yields the smallest spectra
+ * with the same color. Float data has fast paths to "RGBA float" of @space
+ * and to "CIE XYZ float". Asking for the same configuration again returns
+ * the same format.
+ */
+const Babl *babl_spectral_format (const Babl   *type,
+                                  double        nm_start,
+                                  double        nm_gap,
+                                  int           bands,
+                                  const double *observer,
+                                  const double *illuminant,
+                                  const Babl   *space);
+
 /**
  * babl_set_user_data: (skip)
  *
@@ -588,14 +773,19 @@ const Babl * babl_trc_gamma (double gamma);
  * babl_trc:
  *
  * Look up a TRC by name, "sRGB" and "linear" are recognized
- * strings in a stock babl configuration.
+ * strings in a stock babl configuration, as are the HDR TRCs "PQ"
+ * (SMPTE ST 2084) and "HLG" (ARIB STD-B67). These put the reference
+ * white of ITU-R BT.2408 at linear 1.0 - 203 cd/m² for PQ, a signal of
+ * 0.75 for HLG - with highlights above it; HLG is scene referred.
  */
 const Babl * babl_trc (const char *name);
 
 /**
  * babl_space_with_trc:
  *
- * Creates a variant of an existing space with different trc.
+ * Creates a variant of an existing space with different trc. The
+ * "Rec2020" space with the "PQ" or "HLG" TRC gives "Rec2100-PQ" or
+ * "Rec2100-HLG".
  */
 const Babl *babl_space_with_trc (const Babl *space, const Babl *trc);
 
@@ -53,9 +53,11 @@ types (void)
   babl_base_type_float ();
   babl_base_type_u15 ();
   babl_base_type_half ();
+  babl_base_type_bfloat16 ();
   babl_base_type_u8 ();
   babl_base_type_u16 ();
   babl_base_type_u32 ();
+  babl_base_type_packed ();
 }
 
 /*
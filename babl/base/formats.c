@@ -17,6 +17,7 @@
  */
 
 #include "config.h"
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "babl-classes.h"
@@ -24,6 +25,8 @@
 #include "babl-ids.h"
 #include "babl-base.h"
 
+extern int babl_hmpf_on_name_lookups;
+
 void
 babl_formats_init (void)
 {
@@ -31,9 +34,13 @@ babl_formats_init (void)
     babl_type_from_id (BABL_DOUBLE),
     babl_type_from_id (BABL_FLOAT),
     babl_type_from_id (BABL_HALF),
+    babl_type_from_id (BABL_BFLOAT16),
     babl_type_from_id (BABL_U8),
     babl_type_from_id (BABL_U16),
-    babl_type_from_id (BABL_U32)
+    babl_type_from_id (BABL_U32),
+    babl_type_from_id (BABL_U16BE),
+    babl_type_from_id (BABL_U32BE),
+    babl_type_from_id (BABL_FLOATBE)
   };
   for (int i = 0; i < sizeof (types)/sizeof(types[0]);i++)
   {
@@ -192,6 +199,114 @@ babl_formats_init (void)
 
   }
 
+  /* bitpacked formats, the components fill a little endian word from the
+   * least significant bits up; as in RGB10_A2 red is in the low bits of
+   * 10-10-10-2, while 5-6-5 is laid out blue first to keep red in the high
+   * bits like RGB565 framebuffers
+   */
+  babl_hmpf_on_name_lookups--;
+  for (int nonlinear = 0; nonlinear < 2; nonlinear++)
+  {
+    const Babl *rgba  = babl_model_from_id (nonlinear ? BABL_RGBA_NONLINEAR :
+                                                        BABL_RGBA);
+    const Babl *rgb   = babl_model_from_id (nonlinear ? BABL_RGB_NONLINEAR :
+                                                        BABL_RGB);
+    const Babl *red   = babl_component_from_id (nonlinear ? BABL_RED_NONLINEAR :
+                                                            BABL_RED);
+    const Babl *green = babl_component_from_id (nonlinear ? BABL_GREEN_NONLINEAR :
+                                                            BABL_GREEN);
+    const Babl *blue  = babl_component_from_id (nonlinear ? BABL_BLUE_NONLINEAR :
+                                                            BABL_BLUE);
+    char        name[64];
+
+    snprintf (name, sizeof (name), "%s u10-10-10-2", babl_get_name (rgba));
+    babl_format_new (
+      "name", name,
+      "bitpacked",
+      rgba,
+      babl_type ("u10"),
+      red, green, blue,
+      babl_type ("u2"),
+      babl_component_from_id (BABL_ALPHA),
+      NULL);
+
+    snprintf (name, sizeof (name), "%s u12-12-12-12", babl_get_name (rgba));
+    babl_format_new (
+      "name", name,
+      "bitpacked",
+      rgba,
+      babl_type ("u12"),
+      red, green, blue,
+      babl_component_from_id (BABL_ALPHA),
+      NULL);
+
+    snprintf (name, sizeof (name), "%s u5-6-5", babl_get_name (rgb));
+    babl_format_new (
+      "name", name,
+      "bitpacked",
+      rgb,
+      babl_type ("u5"),
+      blue,
+      babl_type ("u6"),
+      green,
+      babl_type ("u5"),
+      red,
+      NULL);
+  }
+  babl_hmpf_on_name_lookups++;
+
+  /* planar counterparts of the common formats, one plane per component as
+   * laid out by planar codecs and the NCHW tensors of machine learning;
+   * named "R'G'B'A u8 planar" and so on
+   */
+  {
+    const Babl *planar_types[] = {
+      babl_type_from_id (BABL_U8),
+      babl_type_from_id (BABL_U16),
+      babl_type_from_id (BABL_HALF),
+      babl_type_from_id (BABL_FLOAT)
+    };
+
+    for (int i = 0; i < sizeof (planar_types) / sizeof (planar_types[0]); i++)
+    {
+      const Babl *type = planar_types[i];
+
+      for (int nonlinear = 0; nonlinear < 2; nonlinear++)
+      {
+        const Babl *red   = babl_component_from_id (nonlinear ? BABL_RED_NONLINEAR :
+                                                                BABL_RED);
+        const Babl *green = babl_component_from_id (nonlinear ? BABL_GREEN_NONLINEAR :
+                                                                BABL_GREEN);
+        const Babl *blue  = babl_component_from_id (nonlinear ? BABL_BLUE_NONLINEAR :
+                                                                BABL_BLUE);
+        const Babl *gray  = babl_component_from_id (nonlinear ? BABL_GRAY_NONLINEAR :
+                                                                BABL_GRAY_LINEAR);
+
+        babl_format_new (
+          "planar",
+          babl_model_from_id (nonlinear ? BABL_RGBA_NONLINEAR : BABL_RGBA),
+          type,
+          red, green, blue,
+          babl_component_from_id (BABL_ALPHA),
+          NULL);
+        babl_format_new (
+          "planar",
+          babl_model_from_id (nonlinear ? BABL_RGB_NONLINEAR : BABL_RGB),
+          type,
+          red, green, blue,
+          NULL);
+        babl_format_new (
+          "planar",
+          babl_model_from_id (nonlinear ? BABL_MODEL_GRAY_NONLINEAR_ALPHA :
+                                          BABL_GRAY_ALPHA),
+          type,
+          gray,
+          babl_component_from_id (BABL_ALPHA),
+          NULL);
+      }
+    }
+  }
+
   /* overriding name, since the generated name would be wrong due
    * to differing types
    */
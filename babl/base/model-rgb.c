@@ -1201,10 +1201,28 @@ rgba2rgba_nonlinear_associated_alpha_float (Babl *conversion,
   const Babl **trc  = (void*)space->space.trc;
   long n = samples;
 
-  while (n--)
+  while (n > 0)
     {
       float alpha = ((float *) src)[3];
       float used_alpha = babl_epsilon_for_zero_float (alpha);
+      long  span;
+
+      if (alpha == 1.0f)
+        {
+          /* opaque, nothing to multiply with */
+          span = babl_alpha_span_float ((float *) src, 4, n, 1.0f);
+          n -= span;
+          while (span--)
+            {
+              ((float *) dst)[0] = babl_trc_from_linear (trc[0], ((float *) src)[0]);
+              ((float *) dst)[1] = babl_trc_from_linear (trc[1], ((float *) src)[1]);
+              ((float *) dst)[2] = babl_trc_from_linear (trc[2], ((float *) src)[2]);
+              ((float *) dst)[3] = 1.0f;
+              src  += 4 * sizeof (float);
+              dst  += 4 * sizeof (float);
+            }
+          continue;
+        }
 
       ((float *) dst)[0] = babl_trc_from_linear (trc[0], ((float *) src)[0]) * used_alpha;
       ((float *) dst)[1] = babl_trc_from_linear (trc[1], ((float *) src)[1]) * used_alpha;
@@ -1212,6 +1230,16 @@ rgba2rgba_nonlinear_associated_alpha_float (Babl *conversion,
       ((float *) dst)[3] = alpha;
       src  += 4 * sizeof (float);
       dst  += 4 * sizeof (float);
+      n--;
+
+      if (alpha == 0.0f)
+        {
+          span = babl_repeat_transparent_float ((float *) src, (float *) dst,
+                                                4, n);
+          src += span * 4 * sizeof (float);
+          dst += span * 4 * sizeof (float);
+          n   -= span;
+        }
     }
 }
 
@@ -1226,11 +1254,33 @@ rgba_nonlinear_associated_alpha2rgba_float (Babl *conversion,
   const Babl **trc  = (void*)space->space.trc;
   long n = samples;
 
-  while (n--)
+  while (n > 0)
     {
       float alpha = ((float *) src)[3];
-      float used_alpha = babl_epsilon_for_zero_float (alpha);
-      float reciprocal= 1.0f / used_alpha;
+      float used_alpha;
+      float reciprocal;
+      long  span;
+
+      if (alpha == 1.0f)
+        {
+          /* opaque, nothing to divide by */
+          span = babl_alpha_span_float ((float *) src, 4, n, 1.0f);
+          n -= span;
+          while (span--)
+            {
+              ((float *) dst)[0] = babl_trc_to_linear (trc[0], ((float *) src)[0]);
+              ((float *) dst)[1] = babl_trc_to_linear (trc[1], ((float *) src)[1]);
+              ((float *) dst)[2] = babl_trc_to_linear (trc[2], ((float *) src)[2]);
+              ((float *) dst)[3] = 1.0f;
+
+              src += 4 * sizeof (float);
+              dst += 4 * sizeof (float);
+            }
+          continue;
+        }
+
+      used_alpha = babl_epsilon_for_zero_float (alpha);
+      reciprocal = 1.0f / used_alpha;
 
       ((float *) dst)[0] = babl_trc_to_linear (trc[0], ((float *) src)[0] * reciprocal);
       ((float *) dst)[1] = babl_trc_to_linear (trc[1], ((float *) src)[1] * reciprocal);
@@ -1239,6 +1289,16 @@ rgba_nonlinear_associated_alpha2rgba_float (Babl *conversion,
 
       src += 4 * sizeof (float);
       dst += 4 * sizeof (float);
+      n--;
+
+      if (alpha == 0.0f)
+        {
+          span = babl_repeat_transparent_float ((float *) src, (float *) dst,
+                                                4, n);
+          src += span * 4 * sizeof (float);
+          dst += span * 4 * sizeof (float);
+          n   -= span;
+        }
     }
 }
 
@@ -256,11 +256,8 @@ formats (void)
     babl_component_from_id (BABL_CR),
     NULL);
 
-/* deactivate these for now */
-if (0)
-{
   babl_format_new (
-    "name", "y'cbcr420",
+    "name", "Y'CbCr420 u8",
     "id", BABL_YCBCR420,
     "planar",
     babl_model_from_id (BABL_YCBCR),
@@ -274,9 +271,8 @@ if (0)
     babl_component_from_id (BABL_CR),
     NULL);
 
-
   babl_format_new (
-    "name", "y'cbcr422",
+    "name", "Y'CbCr422 u8",
     "id", BABL_YCBCR422,
     "planar",
     babl_model_from_id (BABL_YCBCR),
@@ -291,7 +287,7 @@ if (0)
     NULL);
 
   babl_format_new (
-    "name", "y'cbcr411",
+    "name", "Y'CbCr411 u8",
     "id", BABL_YCBCR411,
     "planar",
     babl_model_from_id (BABL_YCBCR),
@@ -304,5 +300,21 @@ if (0)
     babl_sampling (4, 1),
     babl_component_from_id (BABL_CR),
     NULL);
-}
+
+  /* 4:2:0 with a full resolution luma plane followed by a plane of
+   * interleaved Cb and Cr samples
+   */
+  babl_format_new (
+    "name", "Y'CbCr NV12 u8",
+    "id", BABL_YCBCR_NV12,
+    "semiplanar",
+    babl_model_from_id (BABL_YCBCR),
+    babl_type_from_id (BABL_U8_LUMA),
+    babl_sampling (1, 1),
+    babl_component_from_id (BABL_GRAY_NONLINEAR),
+    babl_type_from_id (BABL_U8_CHROMA),
+    babl_sampling (2, 2),
+    babl_component_from_id (BABL_CB),
+    babl_component_from_id (BABL_CR),
+    NULL);
 }
@@ -0,0 +1,203 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* bfloat16, the upper half of an IEEE 754 single precision float: 1 sign
+ * bit, 8 exponent bits and 7 mantissa bits. Conversions to it round to
+ * nearest even, and turn NaNs into quiet NaNs rather than infinities.
+ */
+
+#include "config.h"
+#include <string.h>
+#include <stdint.h>
+
+#include "babl.h"
+#include "babl-classes.h"
+#include "babl-ids.h"
+#include "babl-base.h"
+
+static inline uint16_t
+bits_to_bfloat16 (uint32_t bits)
+{
+  if ((bits & 0x7fffffff) > 0x7f800000)
+    return (bits >> 16) | 0x0040;
+
+  return (bits + 0x7fff + ((bits >> 16) & 1)) >> 16;
+}
+
+static inline uint16_t
+float_to_bfloat16 (float value)
+{
+  uint32_t bits;
+
+  memcpy (&bits, &value, sizeof (bits));
+  return bits_to_bfloat16 (bits);
+}
+
+/* rounding to float first would round twice, which gets halfway cases
+ * wrong when the float lands exactly between two bfloat16s; nudge those
+ * towards the side the double was on
+ */
+static inline uint16_t
+double_to_bfloat16 (double value)
+{
+  float    f = value;
+  uint32_t bits;
+
+  memcpy (&bits, &f, sizeof (bits));
+  if ((bits & 0xffff) == 0x8000 && f != value)
+    bits += (f > 0.0f ? value > f : value < f) ? 1 : -1;
+  return bits_to_bfloat16 (bits);
+}
+
+static inline float
+bfloat16_to_float (uint16_t value)
+{
+  uint32_t bits = (uint32_t) value << 16;
+  float    f;
+
+  memcpy (&f, &bits, sizeof (f));
+  return f;
+}
+
+static void
+convert_double_bfloat16 (BablConversion *conversion,
+                         char           *src,
+                         char           *dst,
+                         int             src_pitch,
+                         int             dst_pitch,
+                         long            n)
+{
+  while (n--)
+    {
+      (*(uint16_t *) dst) = double_to_bfloat16 (*(double *) src);
+      dst                += dst_pitch;
+      src                += src_pitch;
+    }
+}
+
+static void
+convert_bfloat16_double (BablConversion *conversion,
+                         char           *src,
+                         char           *dst,
+                         int             src_pitch,
+                         int             dst_pitch,
+                         long            n)
+{
+  while (n--)
+    {
+      (*(double *) dst) = bfloat16_to_float (*(uint16_t *) src);
+      dst              += dst_pitch;
+      src              += src_pitch;
+    }
+}
+
+/* planes of planar formats are contiguous, give the compiler a loop it
+ * can vectorize for them
+ */
+static void
+convert_float_bfloat16 (BablConversion *conversion,
+                        char           *src,
+                        char           *dst,
+                        int             src_pitch,
+                        int             dst_pitch,
+                        long            n)
+{
+  if (src_pitch == sizeof (float) && dst_pitch == sizeof (uint16_t))
+    {
+      const uint32_t *s = (const uint32_t *) src;
+      uint16_t       *d = (uint16_t *) dst;
+      long            i;
+
+      for (i = 0; i < n; i++)
+        d[i] = bits_to_bfloat16 (s[i]);
+      return;
+    }
+
+  while (n--)
+    {
+      (*(uint16_t *) dst) = float_to_bfloat16 (*(float *) src);
+      dst                += dst_pitch;
+      src                += src_pitch;
+    }
+}
+
+static void
+convert_bfloat16_float (BablConversion *conversion,
+                        char           *src,
+                        char           *dst,
+                        int             src_pitch,
+                        int             dst_pitch,
+                        long            n)
+{
+  if (src_pitch == sizeof (uint16_t) && dst_pitch == sizeof (float))
+    {
+      const uint16_t *s = (const uint16_t *) src;
+      uint32_t       *d = (uint32_t *) dst;
+      long            i;
+
+      for (i = 0; i < n; i++)
+        d[i] = (uint32_t) s[i] << 16;
+      return;
+    }
+
+  while (n--)
+    {
+      (*(float *) dst) = bfloat16_to_float (*(uint16_t *) src);
+      dst             += dst_pitch;
+      src             += src_pitch;
+    }
+}
+
+void
+babl_base_type_bfloat16 (void)
+{
+  babl_type_new (
+    "bfloat16",
+    "id", BABL_BFLOAT16,
+    "bits", 16,
+    "doc", "bfloat16, the upper 16 bits of an IEEE 754 single precision float",
+    NULL);
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_BFLOAT16),
+    babl_type_from_id (BABL_DOUBLE),
+    "plane", convert_bfloat16_double,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_DOUBLE),
+    babl_type_from_id (BABL_BFLOAT16),
+    "plane", convert_double_bfloat16,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_BFLOAT16),
+    babl_type_from_id (BABL_FLOAT),
+    "plane", convert_bfloat16_float,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_FLOAT),
+    babl_type_from_id (BABL_BFLOAT16),
+    "plane", convert_float_bfloat16,
+    NULL
+  );
+}
@@ -18,6 +18,7 @@
 
 #include "config.h"
 #include <string.h>
+#include <stdint.h>
 #include <assert.h>
 
 #include "babl.h"
@@ -81,6 +82,95 @@ convert_float_float (const Babl *babl,
   return n;
 }
 
+/* big endian, regardless of the host */
+
+static inline float
+get_floatbe (const char *p)
+{
+  uint32_t bits = ((uint32_t) (uint8_t) p[0] << 24) | ((uint32_t) (uint8_t) p[1] << 16) |
+                  ((uint32_t) (uint8_t) p[2] << 8)  |  (uint32_t) (uint8_t) p[3];
+  float    value;
+
+  memcpy (&value, &bits, sizeof (value));
+  return value;
+}
+
+static inline void
+set_floatbe (char  *p,
+             float  value)
+{
+  uint32_t bits;
+
+  memcpy (&bits, &value, sizeof (bits));
+  p[0] = bits >> 24;
+  p[1] = bits >> 16;
+  p[2] = bits >> 8;
+  p[3] = bits;
+}
+
+static void
+convert_floatbe_double (BablConversion *conversion,
+                        char           *src,
+                        char           *dst,
+                        int             src_pitch,
+                        int             dst_pitch,
+                        long            n)
+{
+  while (n--)
+    {
+      (*(double *) dst) = get_floatbe (src);
+      dst              += dst_pitch;
+      src              += src_pitch;
+    }
+}
+
+static void
+convert_double_floatbe (BablConversion *conversion,
+                        char           *src,
+                        char           *dst,
+                        int             src_pitch,
+                        int             dst_pitch,
+                        long            n)
+{
+  while (n--)
+    {
+      set_floatbe (dst, *(double *) src);
+      dst += dst_pitch;
+      src += src_pitch;
+    }
+}
+
+static void
+convert_floatbe_float (BablConversion *conversion,
+                       char           *src,
+                       char           *dst,
+                       int             src_pitch,
+                       int             dst_pitch,
+                       long            n)
+{
+  while (n--)
+    {
+      (*(float *) dst) = get_floatbe (src);
+      dst             += dst_pitch;
+      src             += src_pitch;
+    }
+}
+
+static void
+convert_float_floatbe (BablConversion *conversion,
+                       char           *src,
+                       char           *dst,
+                       int             src_pitch,
+                       int             dst_pitch,
+                       long            n)
+{
+  while (n--)
+    {
+      set_floatbe (dst, *(float *) src);
+      dst += dst_pitch;
+      src += src_pitch;
+    }
+}
 
 void
 babl_base_type_float (void)
@@ -92,6 +182,13 @@ babl_base_type_float (void)
     "doc", "IEEE 754 single precision",
     NULL);
 
+  babl_type_new (
+    "floatbe",
+    "id", BABL_FLOATBE,
+    "bits", 32,
+    "doc", "IEEE 754 single precision, big endian",
+    NULL);
+
   babl_conversion_new (
     babl_type_from_id (BABL_FLOAT),
     babl_type_from_id (BABL_DOUBLE),
@@ -112,4 +209,32 @@ babl_base_type_float (void)
     "plane", convert_float_float,
     NULL
   );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_FLOATBE),
+    babl_type_from_id (BABL_DOUBLE),
+    "plane", convert_floatbe_double,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_DOUBLE),
+    babl_type_from_id (BABL_FLOATBE),
+    "plane", convert_double_floatbe,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_FLOATBE),
+    babl_type_from_id (BABL_FLOAT),
+    "plane", convert_floatbe_float,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_FLOAT),
+    babl_type_from_id (BABL_FLOATBE),
+    "plane", convert_float_floatbe,
+    NULL
+  );
 }
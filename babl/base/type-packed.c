@@ -0,0 +1,177 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* unsigned integer types narrower than their storage, the components of
+ * bitpacked formats like 10-10-10-2 and 5-6-5; u2, u5 and u6 are stored in
+ * a byte and u10 and u12 in 16 bits when not packed.
+ */
+
+#include "config.h"
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "babl-internal.h"
+#include "babl-base.h"
+
+
+#define MAKE_CONVERSIONS(name, storage_t, bits)                          \
+  static void                                                            \
+  convert_double_ ## name (BablConversion *conversion,                   \
+                           char           *src,                          \
+                           char           *dst,                          \
+                           int             src_pitch,                    \
+                           int             dst_pitch,                    \
+                           long            n)                            \
+  {                                                                      \
+    const double max = (1 << bits) - 1;                                  \
+                                                                         \
+    while (n--)                                                          \
+      {                                                                  \
+        double    dval = *(double *) src;                                \
+        storage_t val;                                                   \
+                                                                         \
+        if (dval < 0.0)                                                  \
+          val = 0;                                                       \
+        else if (dval > 1.0)                                             \
+          val = max;                                                     \
+        else                                                             \
+          val = rint (dval * max);                                       \
+                                                                         \
+        *(storage_t *) dst = val;                                        \
+        dst += dst_pitch;                                                \
+        src += src_pitch;                                                \
+      }                                                                  \
+  }                                                                      \
+                                                                         \
+  static void                                                            \
+  convert_ ## name ## _double (BablConversion *conversion,               \
+                               char           *src,                      \
+                               char           *dst,                      \
+                               int             src_pitch,                \
+                               int             dst_pitch,                \
+                               long            n)                        \
+  {                                                                      \
+    const double max = (1 << bits) - 1;                                  \
+                                                                         \
+    while (n--)                                                          \
+      {                                                                  \
+        int val = *(storage_t *) src;                                    \
+                                                                         \
+        if (val > max)                                                   \
+          val = max;                                                     \
+        *(double *) dst = val / max;                                     \
+        dst += dst_pitch;                                                \
+        src += src_pitch;                                                \
+      }                                                                  \
+  }                                                                      \
+                                                                         \
+  static void                                                            \
+  convert_float_ ## name (BablConversion *conversion,                    \
+                          char           *src,                           \
+                          char           *dst,                           \
+                          int             src_pitch,                     \
+                          int             dst_pitch,                     \
+                          long            n)                             \
+  {                                                                      \
+    const float max = (1 << bits) - 1;                                   \
+                                                                         \
+    while (n--)                                                          \
+      {                                                                  \
+        float     fval = *(float *) src;                                 \
+        storage_t val;                                                   \
+                                                                         \
+        if (fval < 0.0f)                                                 \
+          val = 0;                                                       \
+        else if (fval > 1.0f)                                            \
+          val = max;                                                     \
+        else                                                             \
+          val = rintf (fval * max);                                      \
+                                                                         \
+        *(storage_t *) dst = val;                                        \
+        dst += dst_pitch;                                                \
+        src += src_pitch;                                                \
+      }                                                                  \
+  }                                                                      \
+                                                                         \
+  static void                                                            \
+  convert_ ## name ## _float (BablConversion *conversion,                \
+                              char           *src,                       \
+                              char           *dst,                       \
+                              int             src_pitch,                 \
+                              int             dst_pitch,                 \
+                              long            n)                         \
+  {                                                                      \
+    const float max = (1 << bits) - 1;                                   \
+                                                                         \
+    while (n--)                                                          \
+      {                                                                  \
+        int val = *(storage_t *) src;                                    \
+                                                                         \
+        if (val > max)                                                   \
+          val = max;                                                     \
+        *(float *) dst = val / max;                                      \
+        dst += dst_pitch;                                                \
+        src += src_pitch;                                                \
+      }                                                                  \
+  }                                                                      \
+                                                                         \
+  static void                                                            \
+  type_ ## name (void)                                                   \
+  {                                                                      \
+    babl_type_new (#name,                                                \
+                   "bits", (int) sizeof (storage_t) * 8,                 \
+                   "packed_bits", bits,                                  \
+                   "doc", #bits " bit unsigned integer",                 \
+                   NULL);                                                \
+                                                                         \
+    babl_conversion_new (babl_type (#name),                              \
+                         babl_type_from_id (BABL_DOUBLE),                \
+                         "plane", convert_ ## name ## _double,           \
+                         NULL);                                          \
+    babl_conversion_new (babl_type_from_id (BABL_DOUBLE),                \
+                         babl_type (#name),                              \
+                         "plane", convert_double_ ## name,               \
+                         NULL);                                          \
+    babl_conversion_new (babl_type (#name),                              \
+                         babl_type_from_id (BABL_FLOAT),                 \
+                         "plane", convert_ ## name ## _float,            \
+                         NULL);                                          \
+    babl_conversion_new (babl_type_from_id (BABL_FLOAT),                 \
+                         babl_type (#name),                              \
+                         "plane", convert_float_ ## name,                \
+                         NULL);                                          \
+  }
+
+MAKE_CONVERSIONS (u2,  uint8_t,  2)
+MAKE_CONVERSIONS (u5,  uint8_t,  5)
+MAKE_CONVERSIONS (u6,  uint8_t,  6)
+MAKE_CONVERSIONS (u10, uint16_t, 10)
+MAKE_CONVERSIONS (u12, uint16_t, 12)
+
+void
+babl_base_type_packed (void)
+{
+  babl_hmpf_on_name_lookups--;
+  type_u2 ();
+  type_u5 ();
+  type_u6 ();
+  type_u10 ();
+  type_u12 ();
+  babl_hmpf_on_name_lookups++;
+}
@@ -109,6 +109,9 @@ convert_u16_double_scaled (BablConversion *conversion,
   }
 
 MAKE_CONVERSIONS (u16, 0.0, 1.0, 0, UINT16_MAX)
+MAKE_CONVERSIONS (u16_luma, 0.0, 1.0, 16 << 8, 235 << 8)
+MAKE_CONVERSIONS (u16_chroma, -0.5, 0.5, 16 << 8, 240 << 8)
+MAKE_CONVERSIONS (u16_chroma_full, -32768.0 / 65535.0, 32767.0 / 65535.0, 0, UINT16_MAX)
 
 static inline void
 convert_float_u16_scaled (BablConversion *conversion,
@@ -193,6 +196,93 @@ convert_u16_float_scaled (BablConversion *conversion,
   }
 
 MAKE_CONVERSIONS_float (u16, 0.0, 1.0, 0, UINT16_MAX)
+MAKE_CONVERSIONS_float (u16_luma, 0.0, 1.0, 16 << 8, 235 << 8)
+MAKE_CONVERSIONS_float (u16_chroma, -0.5, 0.5, 16 << 8, 240 << 8)
+MAKE_CONVERSIONS_float (u16_chroma_full, -32768.0 / 65535.0, 32767.0 / 65535.0, 0, UINT16_MAX)
+
+/* big endian, regardless of the host */
+
+static inline uint16_t
+get_u16be (const char *p)
+{
+  return ((uint8_t) p[0] << 8) | (uint8_t) p[1];
+}
+
+static inline void
+set_u16be (char     *p,
+           uint16_t  value)
+{
+  p[0] = value >> 8;
+  p[1] = value;
+}
+
+static void
+convert_u16be_double (BablConversion *c,
+                      char           *src,
+                      char           *dst,
+                      int             src_pitch,
+                      int             dst_pitch,
+                      long            n)
+{
+  while (n--)
+    {
+      (*(double *) dst) = get_u16be (src) / 65535.0;
+      dst              += dst_pitch;
+      src              += src_pitch;
+    }
+}
+
+static void
+convert_double_u16be (BablConversion *c,
+                      char           *src,
+                      char           *dst,
+                      int             src_pitch,
+                      int             dst_pitch,
+                      long            n)
+{
+  while (n--)
+    {
+      double dval = *(double *) src;
+
+      set_u16be (dst, dval <= 0.0 ? 0 : dval >= 1.0 ? 65535 : rint (dval * 65535.0));
+      dst += dst_pitch;
+      src += src_pitch;
+    }
+}
+
+static void
+convert_u16be_float (BablConversion *c,
+                     char           *src,
+                     char           *dst,
+                     int             src_pitch,
+                     int             dst_pitch,
+                     long            n)
+{
+  while (n--)
+    {
+      (*(float *) dst) = get_u16be (src) / 65535.0f;
+      dst             += dst_pitch;
+      src             += src_pitch;
+    }
+}
+
+static void
+convert_float_u16be (BablConversion *c,
+                     char           *src,
+                     char           *dst,
+                     int             src_pitch,
+                     int             dst_pitch,
+                     long            n)
+{
+  while (n--)
+    {
+      float fval = *(float *) src;
+
+      set_u16be (dst, fval <= 0.0f ? 0 : fval >= 1.0f ? 65535 : rint (fval * 65535.0f));
+      dst += dst_pitch;
+      src += src_pitch;
+    }
+}
 
 
 void
@@ -204,6 +294,46 @@ babl_base_type_u16 (void)
     "bits", 16,
     NULL);
 
+  babl_type_new (
+    "u16-luma",
+    "id", BABL_U16_LUMA,
+    "bits", 16,
+    "doc", "16 bit unsigned integer, values from 4096-60160, the 8 bit video range scaled by 256",
+    NULL);
+
+  babl_type_new (
+    "u16-chroma",
+    "id", BABL_U16_CHROMA,
+    "integer",
+    "unsigned",
+    "bits", 16,
+    "min", (long) 4096,
+    "max", (long) 61440,
+    "min_val", -0.5,
+    "max_val", 0.5,
+    "doc", "16 bit unsigned integer -0.5 to 0.5 maps to 4096-61440",
+    NULL);
+
+  babl_type_new (
+    "u16-chroma-full",
+    "id", BABL_U16_CHROMA_FULL,
+    "integer",
+    "unsigned",
+    "bits", 16,
+    "min", (long) 0,
+    "max", (long) 65535,
+    "min_val", -32768.0 / 65535.0,
+    "max_val", 32767.0 / 65535.0,
+    "doc", "16 bit unsigned integer full range chroma, 32768 is 0.0 and 65535 steps per unit",
+    NULL);
+
+  babl_type_new (
+    "u16be",
+    "id", BABL_U16BE,
+    "bits", 16,
+    "doc", "16 bit unsigned integer, big endian",
+    NULL);
+
   babl_conversion_new (
     babl_type_from_id (BABL_U16),
     babl_type_from_id (BABL_DOUBLE),
@@ -231,4 +361,116 @@ babl_base_type_u16 (void)
     "plane", convert_float_u16,
     NULL
   );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_U16_LUMA),
+    babl_type_from_id (BABL_DOUBLE),
+    "plane", convert_u16_luma_double,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_DOUBLE),
+    babl_type_from_id (BABL_U16_LUMA),
+    "plane", convert_double_u16_luma,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_U16_LUMA),
+    babl_type_from_id (BABL_FLOAT),
+    "plane", convert_u16_luma_float,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_FLOAT),
+    babl_type_from_id (BABL_U16_LUMA),
+    "plane", convert_float_u16_luma,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_U16_CHROMA),
+    babl_type_from_id (BABL_DOUBLE),
+    "plane", convert_u16_chroma_double,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_DOUBLE),
+    babl_type_from_id (BABL_U16_CHROMA),
+    "plane", convert_double_u16_chroma,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_U16_CHROMA),
+    babl_type_from_id (BABL_FLOAT),
+    "plane", convert_u16_chroma_float,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_FLOAT),
+    babl_type_from_id (BABL_U16_CHROMA),
+    "plane", convert_float_u16_chroma,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_U16_CHROMA_FULL),
+    babl_type_from_id (BABL_DOUBLE),
+    "plane", convert_u16_chroma_full_double,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_DOUBLE),
+    babl_type_from_id (BABL_U16_CHROMA_FULL),
+    "plane", convert_double_u16_chroma_full,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_U16_CHROMA_FULL),
+    babl_type_from_id (BABL_FLOAT),
+    "plane", convert_u16_chroma_full_float,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_FLOAT),
+    babl_type_from_id (BABL_U16_CHROMA_FULL),
+    "plane", convert_float_u16_chroma_full,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_U16BE),
+    babl_type_from_id (BABL_DOUBLE),
+    "plane", convert_u16be_double,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_DOUBLE),
+    babl_type_from_id (BABL_U16BE),
+    "plane", convert_double_u16be,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_U16BE),
+    babl_type_from_id (BABL_FLOAT),
+    "plane", convert_u16be_float,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_FLOAT),
+    babl_type_from_id (BABL_U16BE),
+    "plane", convert_float_u16be,
+    NULL
+  );
 }
@@ -194,6 +194,95 @@ convert_u32_float_scaled (BablConversion *c,
 
 MAKE_CONVERSIONS_float(u32, 0.0, 1.0, 0, UINT32_MAX)
 
+/* big endian, regardless of the host */
+
+static inline uint32_t
+get_u32be (const char *p)
+{
+  return ((uint32_t) (uint8_t) p[0] << 24) | ((uint32_t) (uint8_t) p[1] << 16) |
+         ((uint32_t) (uint8_t) p[2] << 8)  |  (uint32_t) (uint8_t) p[3];
+}
+
+static inline void
+set_u32be (char     *p,
+           uint32_t  value)
+{
+  p[0] = value >> 24;
+  p[1] = value >> 16;
+  p[2] = value >> 8;
+  p[3] = value;
+}
+
+static void
+convert_u32be_double (BablConversion *c,
+                      char           *src,
+                      char           *dst,
+                      int             src_pitch,
+                      int             dst_pitch,
+                      long            n)
+{
+  while (n--)
+    {
+      (*(double *) dst) = get_u32be (src) / (double) UINT32_MAX;
+      dst              += dst_pitch;
+      src              += src_pitch;
+    }
+}
+
+static void
+convert_double_u32be (BablConversion *c,
+                      char           *src,
+                      char           *dst,
+                      int             src_pitch,
+                      int             dst_pitch,
+                      long            n)
+{
+  while (n--)
+    {
+      double dval = *(double *) src;
+
+      set_u32be (dst, dval <= 0.0 ? 0 :
+                      dval >= 1.0 ? UINT32_MAX : rint (dval * UINT32_MAX));
+      dst += dst_pitch;
+      src += src_pitch;
+    }
+}
+
+static void
+convert_u32be_float (BablConversion *c,
+                     char           *src,
+                     char           *dst,
+                     int             src_pitch,
+                     int             dst_pitch,
+                     long            n)
+{
+  while (n--)
+    {
+      (*(float *) dst) = get_u32be (src) / (double) UINT32_MAX;
+      dst             += dst_pitch;
+      src             += src_pitch;
+    }
+}
+
+static void
+convert_float_u32be (BablConversion *c,
+                     char           *src,
+                     char           *dst,
+                     int             src_pitch,
+                     int             dst_pitch,
+                     long            n)
+{
+  while (n--)
+    {
+      double dval = *(float *) src;
+
+      set_u32be (dst, dval <= 0.0 ? 0 :
+                      dval >= 1.0 ? UINT32_MAX : rint (dval * UINT32_MAX));
+      dst += dst_pitch;
+      src += src_pitch;
+    }
+}
+
 
 void
 babl_base_type_u32 (void)
@@ -204,6 +293,13 @@ babl_base_type_u32 (void)
     "bits", 32,
     NULL);
 
+  babl_type_new (
+    "u32be",
+    "id", BABL_U32BE,
+    "bits", 32,
+    "doc", "32 bit unsigned integer, big endian",
+    NULL);
+
   babl_conversion_new (
     babl_type_from_id (BABL_U32),
     babl_type_from_id (BABL_DOUBLE),
@@ -231,4 +327,32 @@ babl_base_type_u32 (void)
     "plane", convert_float_u32,
     NULL
   );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_U32BE),
+    babl_type_from_id (BABL_DOUBLE),
+    "plane", convert_u32be_double,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_DOUBLE),
+    babl_type_from_id (BABL_U32BE),
+    "plane", convert_double_u32be,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_U32BE),
+    babl_type_from_id (BABL_FLOAT),
+    "plane", convert_u32be_float,
+    NULL
+  );
+
+  babl_conversion_new (
+    babl_type_from_id (BABL_FLOAT),
+    babl_type_from_id (BABL_U32BE),
+    "plane", convert_float_u32be,
+    NULL
+  );
 }
@@ -111,6 +111,7 @@ convert_u8_double_scaled (BablConversion *c,
 MAKE_CONVERSIONS (u8, 0.0, 1.0, 0x00, UINT8_MAX)
 MAKE_CONVERSIONS (u8_luma, 0.0, 1.0, 16, 235)
 MAKE_CONVERSIONS (u8_chroma, -0.5, 0.5, 16, 240)
+MAKE_CONVERSIONS (u8_chroma_full, -128.0 / 255.0, 127.0 / 255.0, 0x00, UINT8_MAX)
 
 
 static inline void
@@ -199,6 +200,7 @@ convert_u8_float_scaled (BablConversion *c,
 MAKE_CONVERSIONS_float (u8, 0.0, 1.0, 0x00, UINT8_MAX)
 MAKE_CONVERSIONS_float (u8_luma, 0.0, 1.0, 16, 235)
 MAKE_CONVERSIONS_float (u8_chroma, -0.5, 0.5, 16, 240)
+MAKE_CONVERSIONS_float (u8_chroma_full, -128.0 / 255.0, 127.0 / 255.0, 0x00, UINT8_MAX)
 
 
 void
@@ -232,6 +234,20 @@ babl_base_type_u8 (void)
     "doc", "8 bit unsigned integer -0.5 to 0.5 maps to 16-240",
     NULL
   );
+
+  babl_type_new (
+    "u8-chroma-full",
+    "id", BABL_U8_CHROMA_FULL,
+    "integer",
+    "unsigned",
+    "bits", 8,
+    "min", (long) 0,
+    "max", (long) 255,
+    "min_val", -128.0 / 255.0,
+    "max_val", 127.0 / 255.0,
+    "doc", "8 bit unsigned integer full range chroma, 128 is 0.0 and 255 steps per unit",
+    NULL
+  );
   babl_conversion_new (
     babl_type_from_id (BABL_U8),
     babl_type_from_id (BABL_DOUBLE),
@@ -268,6 +284,18 @@ babl_base_type_u8 (void)
     "plane", convert_double_u8_chroma,
     NULL
   );
+  babl_conversion_new (
+    babl_type_from_id (BABL_U8_CHROMA_FULL),
+    babl_type_from_id (BABL_DOUBLE),
+    "plane", convert_u8_chroma_full_double,
+    NULL
+  );
+  babl_conversion_new (
+    babl_type_from_id (BABL_DOUBLE),
+    babl_type_from_id (BABL_U8_CHROMA_FULL),
+    "plane", convert_double_u8_chroma_full,
+    NULL
+  );
 
 
 
@@ -307,4 +335,16 @@ babl_base_type_u8 (void)
     "plane", convert_float_u8_chroma,
     NULL
   );
+  babl_conversion_new (
+    babl_type_from_id (BABL_U8_CHROMA_FULL),
+    babl_type_from_id (BABL_FLOAT),
+    "plane", convert_u8_chroma_full_float,
+    NULL
+  );
+  babl_conversion_new (
+    babl_type_from_id (BABL_FLOAT),
+    babl_type_from_id (BABL_U8_CHROMA_FULL),
+    "plane", convert_float_u8_chroma_full,
+    NULL
+  );
 }
@@ -21,6 +21,8 @@
 
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 #include "pow-24.h"
 #include <babl.h>
 
@@ -69,6 +71,121 @@ babl_epsilon_for_zero_float (float value)
  return value;
 }
 
+/* the number of pixels, from the first on and at most n, whose alpha is
+ * exactly alpha - four alphas are tested per step, without a branch for
+ * each. Conversions hand such spans of opaque or transparent pixels to
+ * reduced kernels.
+ */
+static inline long
+babl_alpha_span_float (const float *pixels,
+                       int          components,
+                       long         n,
+                       float        alpha)
+{
+  const float *a = pixels + components - 1;
+  long         i = 0;
+
+  for (; i + 4 <= n; i += 4, a += 4 * components)
+    if ((a[0] != alpha) | (a[components] != alpha) |
+        (a[2 * components] != alpha) | (a[3 * components] != alpha))
+      break;
+  for (; i < n && *a == alpha; i++, a += components);
+
+  return i;
+}
+
+/* the same for pixels of 4 bytes with alpha in the last, like cairo32 and
+ * R'G'B'A u8
+ */
+static inline long
+babl_alpha_span_u8 (const unsigned char *pixels,
+                    long                 n,
+                    unsigned char        alpha)
+{
+  long i = 0;
+
+  for (; i + 4 <= n; i += 4, pixels += 16)
+    if ((pixels[3] != alpha) | (pixels[7] != alpha) |
+        (pixels[11] != alpha) | (pixels[15] != alpha))
+      break;
+  for (; i < n && pixels[3] == alpha; i++, pixels += 4);
+
+  return i;
+}
+
+/* the number of pixels of up to 4 components, from the first on and at
+ * most n, that are all zero bits - the transparent pixels conversions
+ * compute the result for once, and repeat
+ */
+static inline long
+babl_zero_span_float (const float *pixels,
+                      int          components,
+                      long         n)
+{
+  long i = 0;
+
+  for (; i + 4 <= n; i += 4, pixels += 4 * components)
+    {
+      uint32_t bits[16];
+      uint32_t or = 0;
+      int      c;
+
+      memcpy (bits, pixels, 4 * components * sizeof (float));
+      for (c = 0; c < 4 * components; c++)
+        or |= bits[c];
+      if (or)
+        break;
+    }
+  for (; i < n; i++, pixels += components)
+    {
+      uint32_t bits[4];
+      uint32_t or = 0;
+      int      c;
+
+      memcpy (bits, pixels, components * sizeof (float));
+      for (c = 0; c < components; c++)
+        or |= bits[c];
+      if (or)
+        break;
+    }
+
+  return i;
+}
+
+/* copies the pixel before dst over the next count pixels */
+static inline void
+babl_repeat_pixel (void *dst,
+                   int   bytes_per_pixel,
+                   long  count)
+{
+  char *d = dst;
+
+  while (count--)
+    {
+      memcpy (d, d - bytes_per_pixel, bytes_per_pixel);
+      d += bytes_per_pixel;
+    }
+}
+
+/* for a conversion that just converted the transparent pixel before src
+ * to the one before dst: repeats that result over the following pixels,
+ * of the n left, that are all zero bits as well. Returns their number,
+ * for src and dst to be advanced by.
+ */
+static inline long
+babl_repeat_transparent_float (const float *src,
+                               float       *dst,
+                               int          components,
+                               long         n)
+{
+  long span = babl_zero_span_float (src - components, components, n + 1) - 1;
+
+  if (span <= 0)
+    return 0;
+  babl_repeat_pixel (dst, components * sizeof (float), span);
+  return span;
+}
+
 
 #define BABL_USE_SRGB_GAMMA
 
@@ -0,0 +1,884 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* AVX2 float conversions between "RGBA float" and CIE Lab and LCH(ab), with
+ * and without alpha, and between Lab and LCH(ab); and between Oklab and
+ * OkLCh and "RGBA float", "R'G'B'A float", "RGBA u8" and "R'G'B'A u8" in a
+ * single pass each. This file is built with AVX2 enabled and linked into
+ * the CIE extension, which owns the formats and registers these with
+ * cie_avx2_conversions () when AVX2 is available.
+ *
+ * Eight pixels are processed at a time with a vector per component. The
+ * cube root is the SSE2 one of CIE.c - a bit level estimate refined by two
+ * Halley iterations - while atan2 and sincos are branch free polynomial
+ * approximations, good to a few float ulps over the range of Lab. The sRGB
+ * TRC of the nonlinear formats is computed, u8 is looked up in a table on
+ * the way in.
+ */
+
+#include "config.h"
+
+#if defined(USE_AVX2)
+
+/* AVX 2 */
+#include <immintrin.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "babl-internal.h"
+#include "extensions/avx2-trc.h"
+
+/* as in CIE.c */
+#define LAB_EPSILON       (216.0f / 24389.0f)
+#define LAB_KAPPA         (24389.0f / 27.0f)
+
+#define D50_WHITE_REF_X   0.964202880f
+#define D50_WHITE_REF_Y   1.000000000f
+#define D50_WHITE_REF_Z   0.824905400f
+
+#define DEGREES_PER_RADIAN (180 / 3.14159265358979323846)
+#define RADIANS_PER_DEGREE (1 / DEGREES_PER_RADIAN)
+
+void cie_avx2_conversions (void);
+
+/* CIE.c */
+void cie_oklab_matrices (const Babl *space,
+                         double      rgb_to_lms[9],
+                         double      lms_to_lab[9],
+                         double      lab_to_lms[9],
+                         double      lms_to_rgb[9]);
+
+typedef void (*PixelsFunc) (__m256 *c, const float *m);
+
+static inline __m256
+select_ps (__m256 mask,
+           __m256 a,
+           __m256 b)
+{
+  return _mm256_blendv_ps (b, a, mask);
+}
+
+/* 4x4 transposes in both 128 bit lanes */
+static inline void
+transpose_ps (__m256 *c)
+{
+  __m256 t0 = _mm256_unpacklo_ps (c[0], c[1]);
+  __m256 t1 = _mm256_unpacklo_ps (c[2], c[3]);
+  __m256 t2 = _mm256_unpackhi_ps (c[0], c[1]);
+  __m256 t3 = _mm256_unpackhi_ps (c[2], c[3]);
+
+  c[0] = _mm256_shuffle_ps (t0, t1, _MM_SHUFFLE (1, 0, 1, 0));
+  c[1] = _mm256_shuffle_ps (t0, t1, _MM_SHUFFLE (3, 2, 3, 2));
+  c[2] = _mm256_shuffle_ps (t2, t3, _MM_SHUFFLE (1, 0, 1, 0));
+  c[3] = _mm256_shuffle_ps (t2, t3, _MM_SHUFFLE (3, 2, 3, 2));
+}
+
+/* loads 8 pixels of 3 or 4 components, as a vector per component; 3
+ * component pixels get an alpha of 1.0
+ */
+static inline void
+load_pixels (const float *src,
+             int          components,
+             __m256      *c)
+{
+  __m128 p[8];
+  int    i;
+
+  if (components == 4)
+    {
+      for (i = 0; i < 8; i++)
+        p[i] = _mm_loadu_ps (src + 4 * i);
+    }
+  else
+    {
+      /* each load takes one float of the next pixel along, but the last */
+      for (i = 0; i < 7; i++)
+        p[i] = _mm_loadu_ps (src + 3 * i);
+      p[7] = _mm_loadu_ps (src + 20);
+      p[7] = _mm_shuffle_ps (p[7], p[7], _MM_SHUFFLE (3, 3, 2, 1));
+    }
+
+  for (i = 0; i < 4; i++)
+    c[i] = _mm256_insertf128_ps (_mm256_castps128_ps256 (p[i]), p[i + 4], 1);
+  transpose_ps (c);
+
+  if (components == 3)
+    c[3] = _mm256_set1_ps (1.0f);
+}
+
+static inline void
+store_pixels (float  *dst,
+              int     components,
+              __m256 *c)
+{
+  __m128 p[8];
+  int    i;
+
+  transpose_ps (c);
+  for (i = 0; i < 4; i++)
+    {
+      p[i]     = _mm256_castps256_ps128 (c[i]);
+      p[i + 4] = _mm256_extractf128_ps (c[i], 1);
+    }
+
+  if (components == 4)
+    {
+      for (i = 0; i < 8; i++)
+        _mm_storeu_ps (dst + 4 * i, p[i]);
+    }
+  else
+    {
+      /* in order, each store overwrites the float past the pixel before */
+      for (i = 0; i < 7; i++)
+        _mm_storeu_ps (dst + 3 * i, p[i]);
+      _mm_store_ss (dst + 21, p[7]);
+      _mm_store_ss (dst + 22, _mm_shuffle_ps (p[7], p[7], _MM_SHUFFLE (1, 1, 1, 1)));
+      _mm_store_ss (dst + 23, _mm_shuffle_ps (p[7], p[7], _MM_SHUFFLE (2, 2, 2, 2)));
+    }
+}
+
+static inline void
+process_pixels (const float *src,
+                int          src_components,
+                float       *dst,
+                int          dst_components,
+                long         samples,
+                PixelsFunc   func,
+                const float *m)
+{
+  long i;
+
+  for (i = 0; i + 8 <= samples; i += 8)
+    {
+      __m256 c[4];
+
+      load_pixels (src + i * src_components, src_components, c);
+      func (c, m);
+      store_pixels (dst + i * dst_components, dst_components, c);
+    }
+
+  if (i < samples)
+    {
+      float  in[32] = { 0, };
+      float  out[32];
+      long   count = samples - i;
+      __m256 c[4];
+
+      memcpy (in, src + i * src_components, count * src_components * sizeof (float));
+      load_pixels (in, src_components, c);
+      func (c, m);
+      store_pixels (out, dst_components, c);
+      memcpy (dst + i * dst_components, out, count * dst_components * sizeof (float));
+    }
+}
+
+/* as process_pixels (), with 4 component u8 pixels on one side; on the way
+ * in the color components are looked up in a table, alpha is scaled
+ */
+static inline void
+load_pixels_u8 (const uint8_t *src,
+                const float   *table,
+                __m256        *c)
+{
+  __m256i p    = _mm256_loadu_si256 ((const __m256i *) src);
+  __m256i mask = _mm256_set1_epi32 (0xff);
+  int     i;
+
+  for (i = 0; i < 3; i++)
+    c[i] = _mm256_i32gather_ps (table, _mm256_and_si256 (_mm256_srli_epi32 (p, 8 * i), mask), 4);
+  c[3] = _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_srli_epi32 (p, 24)),
+                        _mm256_set1_ps (1.0f / 255.0f));
+}
+
+static inline void
+store_pixels_u8 (uint8_t *dst,
+                 __m256  *c)
+{
+  __m256i p = _mm256_setzero_si256 ();
+  int     i;
+
+  for (i = 0; i < 4; i++)
+    {
+      __m256 x = _mm256_min_ps (_mm256_max_ps (c[i], _mm256_setzero_ps ()),
+                                _mm256_set1_ps (1.0f));
+
+      x = _mm256_mul_ps (x, _mm256_set1_ps (255.0f));
+      p = _mm256_or_si256 (p, _mm256_slli_epi32 (_mm256_cvtps_epi32 (x), 8 * i));
+    }
+
+  _mm256_storeu_si256 ((__m256i *) dst, p);
+}
+
+static inline void
+process_pixels_from_u8 (const uint8_t *src,
+                        const float   *table,
+                        float         *dst,
+                        int            dst_components,
+                        long           samples,
+                        PixelsFunc     func,
+                        const float   *m)
+{
+  long i;
+
+  for (i = 0; i + 8 <= samples; i += 8)
+    {
+      __m256 c[4];
+
+      load_pixels_u8 (src + i * 4, table, c);
+      func (c, m);
+      store_pixels (dst + i * dst_components, dst_components, c);
+    }
+
+  if (i < samples)
+    {
+      uint8_t in[32] = { 0, };
+      float   out[32];
+      long    count = samples - i;
+      __m256  c[4];
+
+      memcpy (in, src + i * 4, count * 4);
+      load_pixels_u8 (in, table, c);
+      func (c, m);
+      store_pixels (out, dst_components, c);
+      memcpy (dst + i * dst_components, out, count * dst_components * sizeof (float));
+    }
+}
+
+static inline void
+process_pixels_to_u8 (const float *src,
+                      int          src_components,
+                      uint8_t     *dst,
+                      long         samples,
+                      PixelsFunc   func,
+                      const float *m)
+{
+  long i;
+
+  for (i = 0; i + 8 <= samples; i += 8)
+    {
+      __m256 c[4];
+
+      load_pixels (src + i * src_components, src_components, c);
+      func (c, m);
+      store_pixels_u8 (dst + i * 4, c);
+    }
+
+  if (i < samples)
+    {
+      float   in[32] = { 0, };
+      uint8_t out[32];
+      long    count = samples - i;
+      __m256  c[4];
+
+      memcpy (in, src + i * src_components, count * src_components * sizeof (float));
+      load_pixels (in, src_components, c);
+      func (c, m);
+      store_pixels_u8 (out, c);
+      memcpy (dst + i * 4, out, count * 4);
+    }
+}
+
+/* Halley's method for the cube root, see _cbrtf_ps_sse2 () in CIE.c */
+static inline __m256
+cbrt_ps (__m256 x)
+{
+  const __m256i magic = _mm256_set1_epi32 (709921077);
+
+  __m256i xi   = _mm256_castps_si256 (x);
+  __m256  xi_3 = _mm256_div_ps (_mm256_cvtepi32_ps (xi), _mm256_set1_ps (3.0f));
+  __m256  a    = _mm256_castsi256_ps (_mm256_add_epi32 (_mm256_cvtps_epi32 (xi_3), magic));
+  __m256  a3;
+  int     i;
+
+  for (i = 0; i < 2; i++)
+    {
+      a3 = _mm256_mul_ps (_mm256_mul_ps (a, a), a);
+      a  = _mm256_div_ps (_mm256_mul_ps (a, _mm256_add_ps (a3, _mm256_add_ps (x, x))),
+                          _mm256_add_ps (_mm256_add_ps (a3, a3), x));
+    }
+
+  return a;
+}
+
+static inline __m256
+lab_r_to_f (__m256 r)
+{
+  __m256 f_small = _mm256_div_ps (_mm256_add_ps (_mm256_mul_ps (_mm256_set1_ps (LAB_KAPPA), r),
+                                                 _mm256_set1_ps (16.0f)),
+                                  _mm256_set1_ps (116.0f));
+
+  return select_ps (_mm256_cmp_ps (r, _mm256_set1_ps (LAB_EPSILON), _CMP_GT_OQ),
+                    cbrt_ps (r), f_small);
+}
+
+static inline __m256
+lab_f_to_r (__m256 f)
+{
+  __m256 cube = _mm256_mul_ps (_mm256_mul_ps (f, f), f);
+  __m256 r_small = _mm256_div_ps (_mm256_sub_ps (_mm256_mul_ps (f, _mm256_set1_ps (116.0f)),
+                                                 _mm256_set1_ps (16.0f)),
+                                  _mm256_set1_ps (LAB_KAPPA));
+
+  return select_ps (_mm256_cmp_ps (cube, _mm256_set1_ps (LAB_EPSILON), _CMP_GT_OQ),
+                    cube, r_small);
+}
+
+/* atan2 (y, x) in degrees, from 0.0 to 360.0; reduced to atan of 0.0 to
+ * tan (pi / 8) and a Cephes polynomial
+ */
+static inline __m256
+atan2_degrees_ps (__m256 y,
+                  __m256 x)
+{
+  const __m256 sign = _mm256_set1_ps (-0.0f);
+  const __m256 zero = _mm256_setzero_ps ();
+  __m256 ax  = _mm256_andnot_ps (sign, x);
+  __m256 ay  = _mm256_andnot_ps (sign, y);
+  __m256 max = _mm256_max_ps (ax, ay);
+  __m256 t   = _mm256_div_ps (_mm256_min_ps (ax, ay),
+                              _mm256_max_ps (max, _mm256_set1_ps (1e-30f)));
+  __m256 big = _mm256_cmp_ps (t, _mm256_set1_ps (0.414213562f), _CMP_GT_OQ);
+  __m256 z, p, angle;
+
+  t = select_ps (big, _mm256_div_ps (_mm256_sub_ps (t, _mm256_set1_ps (1.0f)),
+                                     _mm256_add_ps (t, _mm256_set1_ps (1.0f))), t);
+  z = _mm256_mul_ps (t, t);
+  p = _mm256_set1_ps (8.05374449538e-2f);
+  p = _mm256_sub_ps (_mm256_mul_ps (p, z), _mm256_set1_ps (1.38776856032e-1f));
+  p = _mm256_add_ps (_mm256_mul_ps (p, z), _mm256_set1_ps (1.99777106478e-1f));
+  p = _mm256_sub_ps (_mm256_mul_ps (p, z), _mm256_set1_ps (3.33329491539e-1f));
+  p = _mm256_add_ps (_mm256_mul_ps (_mm256_mul_ps (p, z), t), t);
+  p = _mm256_add_ps (p, _mm256_and_ps (big, _mm256_set1_ps (M_PI / 4)));
+
+  angle = select_ps (_mm256_cmp_ps (ay, ax, _CMP_GT_OQ),
+                     _mm256_sub_ps (_mm256_set1_ps (M_PI / 2), p), p);
+  angle = select_ps (_mm256_cmp_ps (x, zero, _CMP_LT_OQ),
+                     _mm256_sub_ps (_mm256_set1_ps (M_PI), angle), angle);
+  angle = _mm256_mul_ps (angle, _mm256_set1_ps (DEGREES_PER_RADIAN));
+
+  return select_ps (_mm256_cmp_ps (y, zero, _CMP_LT_OQ),
+                    _mm256_sub_ps (_mm256_set1_ps (360.0f), angle), angle);
+}
+
+/* sine and cosine of degrees; reduced by the nearest multiple of 90
+ * degrees to -45.0 to 45.0 and Cephes polynomials
+ */
+static inline void
+sincos_degrees_ps (__m256  degrees,
+                   __m256 *sine,
+                   __m256 *cosine)
+{
+  __m256  q = _mm256_floor_ps (_mm256_add_ps (_mm256_mul_ps (degrees, _mm256_set1_ps (1.0f / 90.0f)),
+                                              _mm256_set1_ps (0.5f)));
+  __m256  x = _mm256_mul_ps (_mm256_sub_ps (degrees, _mm256_mul_ps (q, _mm256_set1_ps (90.0f))),
+                             _mm256_set1_ps (RADIANS_PER_DEGREE));
+  __m256  z = _mm256_mul_ps (x, x);
+  __m256i quadrant = _mm256_cvtps_epi32 (q);
+  __m256  swap, s, c, s_sign, c_sign;
+
+  s = _mm256_set1_ps (-1.9515295891e-4f);
+  s = _mm256_add_ps (_mm256_mul_ps (s, z), _mm256_set1_ps (8.3321608736e-3f));
+  s = _mm256_sub_ps (_mm256_mul_ps (s, z), _mm256_set1_ps (1.6666654611e-1f));
+  s = _mm256_add_ps (_mm256_mul_ps (_mm256_mul_ps (s, z), x), x);
+
+  c = _mm256_set1_ps (2.443315711809948e-5f);
+  c = _mm256_sub_ps (_mm256_mul_ps (c, z), _mm256_set1_ps (1.388731625493765e-3f));
+  c = _mm256_add_ps (_mm256_mul_ps (c, z), _mm256_set1_ps (4.166664568298827e-2f));
+  c = _mm256_mul_ps (_mm256_mul_ps (c, z), z);
+  c = _mm256_add_ps (_mm256_sub_ps (c, _mm256_mul_ps (z, _mm256_set1_ps (0.5f))),
+                     _mm256_set1_ps (1.0f));
+
+  /* quadrants 1 and 3 swap sine and cosine, 2 and 3 negate the sine, 1
+   * and 2 the cosine
+   */
+  swap   = _mm256_castsi256_ps (_mm256_cmpeq_epi32 (
+             _mm256_and_si256 (quadrant, _mm256_set1_epi32 (1)), _mm256_set1_epi32 (1)));
+  s_sign = _mm256_castsi256_ps (_mm256_slli_epi32 (
+             _mm256_and_si256 (quadrant, _mm256_set1_epi32 (2)), 30));
+  c_sign = _mm256_castsi256_ps (_mm256_slli_epi32 (
+             _mm256_and_si256 (_mm256_add_epi32 (quadrant, _mm256_set1_epi32 (1)),
+                               _mm256_set1_epi32 (2)), 30));
+
+  *sine   = _mm256_xor_ps (select_ps (swap, c, s), s_sign);
+  *cosine = _mm256_xor_ps (select_ps (swap, s, c), c_sign);
+}
+
+static inline __m256
+dot_ps (const float *m,
+        __m256       x,
+        __m256       y,
+        __m256       z)
+{
+  return _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (_mm256_set1_ps (m[0]), x),
+                                       _mm256_mul_ps (_mm256_set1_ps (m[1]), y)),
+                        _mm256_mul_ps (_mm256_set1_ps (m[2]), z));
+}
+
+static void
+rgb_to_lab (__m256      *c,
+            const float *m)
+{
+  __m256 fx = lab_r_to_f (dot_ps (m, c[0], c[1], c[2]));
+  __m256 fy = lab_r_to_f (dot_ps (m + 3, c[0], c[1], c[2]));
+  __m256 fz = lab_r_to_f (dot_ps (m + 6, c[0], c[1], c[2]));
+
+  c[0] = _mm256_sub_ps (_mm256_mul_ps (_mm256_set1_ps (116.0f), fy), _mm256_set1_ps (16.0f));
+  c[1] = _mm256_mul_ps (_mm256_set1_ps (500.0f), _mm256_sub_ps (fx, fy));
+  c[2] = _mm256_mul_ps (_mm256_set1_ps (200.0f), _mm256_sub_ps (fy, fz));
+}
+
+static void
+lab_to_rgb (__m256      *c,
+            const float *m)
+{
+  __m256 L  = c[0];
+  __m256 fy = _mm256_div_ps (_mm256_add_ps (L, _mm256_set1_ps (16.0f)), _mm256_set1_ps (116.0f));
+  __m256 fx = _mm256_add_ps (fy, _mm256_div_ps (c[1], _mm256_set1_ps (500.0f)));
+  __m256 fz = _mm256_sub_ps (fy, _mm256_div_ps (c[2], _mm256_set1_ps (200.0f)));
+  __m256 xr = lab_f_to_r (fx);
+  __m256 yr = select_ps (_mm256_cmp_ps (L, _mm256_set1_ps (LAB_KAPPA * LAB_EPSILON), _CMP_GT_OQ),
+                         _mm256_mul_ps (_mm256_mul_ps (fy, fy), fy),
+                         _mm256_div_ps (L, _mm256_set1_ps (LAB_KAPPA)));
+  __m256 zr = lab_f_to_r (fz);
+
+  c[0] = dot_ps (m, xr, yr, zr);
+  c[1] = dot_ps (m + 3, xr, yr, zr);
+  c[2] = dot_ps (m + 6, xr, yr, zr);
+}
+
+static void
+lab_to_lch (__m256      *c,
+            const float *m)
+{
+  __m256 A = c[1];
+  __m256 B = c[2];
+
+  c[1] = _mm256_sqrt_ps (_mm256_add_ps (_mm256_mul_ps (A, A), _mm256_mul_ps (B, B)));
+  c[2] = atan2_degrees_ps (B, A);
+}
+
+static void
+lch_to_lab (__m256      *c,
+            const float *m)
+{
+  __m256 C = c[1];
+  __m256 sine, cosine;
+
+  sincos_degrees_ps (c[2], &sine, &cosine);
+
+  c[1] = _mm256_mul_ps (C, cosine);
+  c[2] = _mm256_mul_ps (C, sine);
+}
+
+static void
+rgb_to_lch (__m256      *c,
+            const float *m)
+{
+  rgb_to_lab (c, m);
+  lab_to_lch (c, m);
+}
+
+static void
+lch_to_rgb (__m256      *c,
+            const float *m)
+{
+  lch_to_lab (c, m);
+  lab_to_rgb (c, m);
+}
+
+/* Oklab, with the matrices of cie_oklab_matrices () in m; LMS of colors
+ * outside the gamut can be negative, their cube roots are too
+ */
+static inline __m256
+cbrt_signed_ps (__m256 x)
+{
+  __m256 sign = _mm256_and_ps (x, _mm256_set1_ps (-0.0f));
+
+  return _mm256_or_ps (cbrt_ps (_mm256_andnot_ps (sign, x)), sign);
+}
+
+static void
+rgb_to_oklab (__m256      *c,
+              const float *m)
+{
+  __m256 l = cbrt_signed_ps (dot_ps (m, c[0], c[1], c[2]));
+  __m256 M = cbrt_signed_ps (dot_ps (m + 3, c[0], c[1], c[2]));
+  __m256 s = cbrt_signed_ps (dot_ps (m + 6, c[0], c[1], c[2]));
+
+  c[0] = dot_ps (m + 9, l, M, s);
+  c[1] = dot_ps (m + 12, l, M, s);
+  c[2] = dot_ps (m + 15, l, M, s);
+}
+
+static void
+oklab_to_rgb (__m256      *c,
+              const float *m)
+{
+  __m256 l = dot_ps (m, c[0], c[1], c[2]);
+  __m256 M = dot_ps (m + 3, c[0], c[1], c[2]);
+  __m256 s = dot_ps (m + 6, c[0], c[1], c[2]);
+
+  l = _mm256_mul_ps (_mm256_mul_ps (l, l), l);
+  M = _mm256_mul_ps (_mm256_mul_ps (M, M), M);
+  s = _mm256_mul_ps (_mm256_mul_ps (s, s), s);
+
+  c[0] = dot_ps (m + 9, l, M, s);
+  c[1] = dot_ps (m + 12, l, M, s);
+  c[2] = dot_ps (m + 15, l, M, s);
+}
+
+static void
+rgb_to_oklch (__m256      *c,
+              const float *m)
+{
+  rgb_to_oklab (c, m);
+  lab_to_lch (c, m);
+}
+
+static void
+oklch_to_rgb (__m256      *c,
+              const float *m)
+{
+  lch_to_lab (c, m);
+  oklab_to_rgb (c, m);
+}
+
+static inline void
+rgb_to_linear (__m256 *c)
+{
+  int i;
+
+  for (i = 0; i < 3; i++)
+    c[i] = gamma_2_2_to_linear_avx2 (c[i]);
+}
+
+static inline void
+rgb_to_nonlinear (__m256 *c)
+{
+  int i;
+
+  for (i = 0; i < 3; i++)
+    c[i] = linear_to_gamma_2_2_avx2 (c[i]);
+}
+
+static void
+nonlinear_rgb_to_oklab (__m256      *c,
+                        const float *m)
+{
+  rgb_to_linear (c);
+  rgb_to_oklab (c, m);
+}
+
+static void
+nonlinear_rgb_to_oklch (__m256      *c,
+                        const float *m)
+{
+  rgb_to_linear (c);
+  rgb_to_oklch (c, m);
+}
+
+static void
+oklab_to_nonlinear_rgb (__m256      *c,
+                        const float *m)
+{
+  oklab_to_rgb (c, m);
+  rgb_to_nonlinear (c);
+}
+
+static void
+oklch_to_nonlinear_rgb (__m256      *c,
+                        const float *m)
+{
+  oklch_to_rgb (c, m);
+  rgb_to_nonlinear (c);
+}
+
+static void
+rgb_to_xyz_matrix (const Babl *conversion,
+                   float       m[9])
+{
+  const Babl *space = babl_conversion_get_source_space (conversion);
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      m[i]     = space->space.RGBtoXYZf[i] / D50_WHITE_REF_X;
+      m[3 + i] = space->space.RGBtoXYZf[3 + i] / D50_WHITE_REF_Y;
+      m[6 + i] = space->space.RGBtoXYZf[6 + i] / D50_WHITE_REF_Z;
+    }
+}
+
+static void
+xyz_to_rgb_matrix (const Babl *conversion,
+                   float       m[9])
+{
+  const Babl *space = babl_conversion_get_source_space (conversion);
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      m[3 * i]     = space->space.XYZtoRGBf[3 * i] * D50_WHITE_REF_X;
+      m[3 * i + 1] = space->space.XYZtoRGBf[3 * i + 1] * D50_WHITE_REF_Y;
+      m[3 * i + 2] = space->space.XYZtoRGBf[3 * i + 2] * D50_WHITE_REF_Z;
+    }
+}
+
+/* RGB to LMS and LMS to Oklab, or Oklab to LMS and LMS to RGB */
+static void
+oklab_matrix (const Babl *conversion,
+              int         from_rgb,
+              float       m[18])
+{
+  double rgb_to_lms[9], lms_to_lab[9], lab_to_lms[9], lms_to_rgb[9];
+
+  if (from_rgb)
+    {
+      cie_oklab_matrices (babl_conversion_get_source_space (conversion),
+                          rgb_to_lms, lms_to_lab, lab_to_lms, lms_to_rgb);
+      babl_matrix_to_float (rgb_to_lms, m);
+      babl_matrix_to_float (lms_to_lab, m + 9);
+    }
+  else
+    {
+      cie_oklab_matrices (babl_conversion_get_destination_space (conversion),
+                          rgb_to_lms, lms_to_lab, lab_to_lms, lms_to_rgb);
+      babl_matrix_to_float (lab_to_lms, m);
+      babl_matrix_to_float (lms_to_rgb, m + 9);
+    }
+}
+
+#define FROM_RGBA(name, dst_components, func)                           \
+static void                                                             \
+name (const Babl  *conversion,                                          \
+      const float *src,                                                 \
+      float       *dst,                                                 \
+      long         samples)                                             \
+{                                                                       \
+  float m[9];                                                           \
+                                                                        \
+  rgb_to_xyz_matrix (conversion, m);                                    \
+  process_pixels (src, 4, dst, dst_components, samples, func, m);       \
+}
+
+#define TO_RGBA(name, src_components, func)                             \
+static void                                                             \
+name (const Babl  *conversion,                                          \
+      const float *src,                                                 \
+      float       *dst,                                                 \
+      long         samples)                                             \
+{                                                                       \
+  float m[9];                                                           \
+                                                                        \
+  xyz_to_rgb_matrix (conversion, m);                                    \
+  process_pixels (src, src_components, dst, 4, samples, func, m);       \
+}
+
+#define LAB_LCH(name, components, func)                                 \
+static void                                                             \
+name (const Babl  *conversion,                                          \
+      const float *src,                                                 \
+      float       *dst,                                                 \
+      long         samples)                                             \
+{                                                                       \
+  process_pixels (src, components, dst, components, samples, func, NULL); \
+}
+
+FROM_RGBA (rgbaf_to_Labf_avx2,     3, rgb_to_lab)
+FROM_RGBA (rgbaf_to_Labaf_avx2,    4, rgb_to_lab)
+FROM_RGBA (rgbaf_to_Lchabf_avx2,   3, rgb_to_lch)
+FROM_RGBA (rgbaf_to_Lchabaf_avx2,  4, rgb_to_lch)
+TO_RGBA   (Labf_to_rgbaf_avx2,     3, lab_to_rgb)
+TO_RGBA   (Labaf_to_rgbaf_avx2,    4, lab_to_rgb)
+TO_RGBA   (Lchabf_to_rgbaf_avx2,   3, lch_to_rgb)
+TO_RGBA   (Lchabaf_to_rgbaf_avx2,  4, lch_to_rgb)
+LAB_LCH   (Labf_to_Lchabf_avx2,    3, lab_to_lch)
+LAB_LCH   (Labaf_to_Lchabaf_avx2,  4, lab_to_lch)
+LAB_LCH   (Lchabf_to_Labf_avx2,    3, lch_to_lab)
+LAB_LCH   (Lchabaf_to_Labaf_avx2,  4, lch_to_lab)
+
+#define FROM_RGBA_OK(name, dst_components, func)                        \
+static void                                                             \
+name (const Babl  *conversion,                                          \
+      const float *src,                                                 \
+      float       *dst,                                                 \
+      long         samples)                                             \
+{                                                                       \
+  float m[18];                                                          \
+                                                                        \
+  oklab_matrix (conversion, 1, m);                                      \
+  process_pixels (src, 4, dst, dst_components, samples, func, m);       \
+}
+
+#define TO_RGBA_OK(name, src_components, func)                          \
+static void                                                             \
+name (const Babl  *conversion,                                          \
+      const float *src,                                                 \
+      float       *dst,                                                 \
+      long         samples)                                             \
+{                                                                       \
+  float m[18];                                                          \
+                                                                        \
+  oklab_matrix (conversion, 0, m);                                      \
+  process_pixels (src, src_components, dst, 4, samples, func, m);       \
+}
+
+#define FROM_RGBA8_OK(name, dst_components, table, func)                \
+static void                                                             \
+name (const Babl    *conversion,                                        \
+      const uint8_t *src,                                               \
+      float         *dst,                                               \
+      long           samples)                                           \
+{                                                                       \
+  float m[18];                                                          \
+                                                                        \
+  oklab_matrix (conversion, 1, m);                                      \
+  process_pixels_from_u8 (src, table, dst, dst_components, samples,     \
+                          func, m);                                     \
+}
+
+#define TO_RGBA8_OK(name, src_components, func)                         \
+static void                                                             \
+name (const Babl  *conversion,                                          \
+      const float *src,                                                 \
+      uint8_t     *dst,                                                 \
+      long         samples)                                             \
+{                                                                       \
+  float m[18];                                                          \
+                                                                        \
+  oklab_matrix (conversion, 0, m);                                      \
+  process_pixels_to_u8 (src, src_components, dst, samples, func, m);    \
+}
+
+/* u8 to linear float, for "RGBA u8" and "R'G'B'A u8" */
+static float u8_linear_table[256];
+static float u8_gamma_table[256];
+
+FROM_RGBA_OK  (rgbaf_to_Oklabf_avx2,        3, rgb_to_oklab)
+FROM_RGBA_OK  (rgbaf_to_Oklabaf_avx2,       4, rgb_to_oklab)
+FROM_RGBA_OK  (rgbaf_to_OkLChf_avx2,        3, rgb_to_oklch)
+FROM_RGBA_OK  (rgbaf_to_OkLChaf_avx2,       4, rgb_to_oklch)
+FROM_RGBA_OK  (rgbaf_gamma_to_Oklabf_avx2,  3, nonlinear_rgb_to_oklab)
+FROM_RGBA_OK  (rgbaf_gamma_to_Oklabaf_avx2, 4, nonlinear_rgb_to_oklab)
+FROM_RGBA_OK  (rgbaf_gamma_to_OkLChf_avx2,  3, nonlinear_rgb_to_oklch)
+FROM_RGBA_OK  (rgbaf_gamma_to_OkLChaf_avx2, 4, nonlinear_rgb_to_oklch)
+TO_RGBA_OK    (Oklabf_to_rgbaf_avx2,        3, oklab_to_rgb)
+TO_RGBA_OK    (Oklabaf_to_rgbaf_avx2,       4, oklab_to_rgb)
+TO_RGBA_OK    (OkLChf_to_rgbaf_avx2,        3, oklch_to_rgb)
+TO_RGBA_OK    (OkLChaf_to_rgbaf_avx2,       4, oklch_to_rgb)
+TO_RGBA_OK    (Oklabf_to_rgbaf_gamma_avx2,  3, oklab_to_nonlinear_rgb)
+TO_RGBA_OK    (Oklabaf_to_rgbaf_gamma_avx2, 4, oklab_to_nonlinear_rgb)
+TO_RGBA_OK    (OkLChf_to_rgbaf_gamma_avx2,  3, oklch_to_nonlinear_rgb)
+TO_RGBA_OK    (OkLChaf_to_rgbaf_gamma_avx2, 4, oklch_to_nonlinear_rgb)
+FROM_RGBA8_OK (rgba8_to_Oklabf_avx2,        3, u8_linear_table, rgb_to_oklab)
+FROM_RGBA8_OK (rgba8_to_Oklabaf_avx2,       4, u8_linear_table, rgb_to_oklab)
+FROM_RGBA8_OK (rgba8_to_OkLChf_avx2,        3, u8_linear_table, rgb_to_oklch)
+FROM_RGBA8_OK (rgba8_to_OkLChaf_avx2,       4, u8_linear_table, rgb_to_oklch)
+FROM_RGBA8_OK (rgba8_gamma_to_Oklabf_avx2,  3, u8_gamma_table,  rgb_to_oklab)
+FROM_RGBA8_OK (rgba8_gamma_to_Oklabaf_avx2, 4, u8_gamma_table,  rgb_to_oklab)
+FROM_RGBA8_OK (rgba8_gamma_to_OkLChf_avx2,  3, u8_gamma_table,  rgb_to_oklch)
+FROM_RGBA8_OK (rgba8_gamma_to_OkLChaf_avx2, 4, u8_gamma_table,  rgb_to_oklch)
+TO_RGBA8_OK   (Oklabf_to_rgba8_avx2,        3, oklab_to_rgb)
+TO_RGBA8_OK   (Oklabaf_to_rgba8_avx2,       4, oklab_to_rgb)
+TO_RGBA8_OK   (OkLChf_to_rgba8_avx2,        3, oklch_to_rgb)
+TO_RGBA8_OK   (OkLChaf_to_rgba8_avx2,       4, oklch_to_rgb)
+TO_RGBA8_OK   (Oklabf_to_rgba8_gamma_avx2,  3, oklab_to_nonlinear_rgb)
+TO_RGBA8_OK   (Oklabaf_to_rgba8_gamma_avx2, 4, oklab_to_nonlinear_rgb)
+TO_RGBA8_OK   (OkLChf_to_rgba8_gamma_avx2,  3, oklch_to_nonlinear_rgb)
+TO_RGBA8_OK   (OkLChaf_to_rgba8_gamma_avx2, 4, oklch_to_nonlinear_rgb)
+
+void
+cie_avx2_conversions (void)
+{
+  const Babl *rgbaF    = babl_format ("RGBA float");
+  const Babl *labF     = babl_format ("CIE Lab float");
+  const Babl *labaF    = babl_format ("CIE Lab alpha float");
+  const Babl *lchabF   = babl_format ("CIE LCH(ab) float");
+  const Babl *lchabaF  = babl_format ("CIE LCH(ab) alpha float");
+  const Babl *rgbaF_gamma = babl_format ("R'G'B'A float");
+  const Babl *rgba8    = babl_format ("RGBA u8");
+  const Babl *rgba8_gamma = babl_format ("R'G'B'A u8");
+  const Babl *oklabF   = babl_format ("Oklab float");
+  const Babl *oklabaF  = babl_format ("Oklab alpha float");
+  const Babl *oklchF   = babl_format ("OkLCh float");
+  const Babl *oklchaF  = babl_format ("OkLCh alpha float");
+  int         i;
+
+  for (i = 0; i < 256; i++)
+    {
+      double value = i / 255.0;
+
+      u8_linear_table[i] = value;
+      u8_gamma_table[i]  = value > 0.04045 ? pow ((value + 0.055) / 1.055, 2.4) :
+                                             value / 12.92;
+    }
+
+#define CONV(src, dst, func) \
+  babl_conversion_new (src, dst, "linear", func, \
+                       "accel", BABL_CPU_ACCEL_X86_AVX2, NULL)
+
+  CONV (rgbaF,   labF,    rgbaf_to_Labf_avx2);
+  CONV (rgbaF,   labaF,   rgbaf_to_Labaf_avx2);
+  CONV (rgbaF,   lchabF,  rgbaf_to_Lchabf_avx2);
+  CONV (rgbaF,   lchabaF, rgbaf_to_Lchabaf_avx2);
+  CONV (labF,    rgbaF,   Labf_to_rgbaf_avx2);
+  CONV (labaF,   rgbaF,   Labaf_to_rgbaf_avx2);
+  CONV (lchabF,  rgbaF,   Lchabf_to_rgbaf_avx2);
+  CONV (lchabaF, rgbaF,   Lchabaf_to_rgbaf_avx2);
+  CONV (labF,    lchabF,  Labf_to_Lchabf_avx2);
+  CONV (labaF,   lchabaF, Labaf_to_Lchabaf_avx2);
+  CONV (lchabF,  labF,    Lchabf_to_Labf_avx2);
+  CONV (lchabaF, labaF,   Lchabaf_to_Labaf_avx2);
+
+  CONV (rgbaF,       oklabF,      rgbaf_to_Oklabf_avx2);
+  CONV (rgbaF,       oklabaF,     rgbaf_to_Oklabaf_avx2);
+  CONV (rgbaF,       oklchF,      rgbaf_to_OkLChf_avx2);
+  CONV (rgbaF,       oklchaF,     rgbaf_to_OkLChaf_avx2);
+  CONV (rgbaF_gamma, oklabF,      rgbaf_gamma_to_Oklabf_avx2);
+  CONV (rgbaF_gamma, oklabaF,     rgbaf_gamma_to_Oklabaf_avx2);
+  CONV (rgbaF_gamma, oklchF,      rgbaf_gamma_to_OkLChf_avx2);
+  CONV (rgbaF_gamma, oklchaF,     rgbaf_gamma_to_OkLChaf_avx2);
+  CONV (oklabF,      rgbaF,       Oklabf_to_rgbaf_avx2);
+  CONV (oklabaF,     rgbaF,       Oklabaf_to_rgbaf_avx2);
+  CONV (oklchF,      rgbaF,       OkLChf_to_rgbaf_avx2);
+  CONV (oklchaF,     rgbaF,       OkLChaf_to_rgbaf_avx2);
+  CONV (oklabF,      rgbaF_gamma, Oklabf_to_rgbaf_gamma_avx2);
+  CONV (oklabaF,     rgbaF_gamma, Oklabaf_to_rgbaf_gamma_avx2);
+  CONV (oklchF,      rgbaF_gamma, OkLChf_to_rgbaf_gamma_avx2);
+  CONV (oklchaF,     rgbaF_gamma, OkLChaf_to_rgbaf_gamma_avx2);
+  CONV (rgba8,       oklabF,      rgba8_to_Oklabf_avx2);
+  CONV (rgba8,       oklabaF,     rgba8_to_Oklabaf_avx2);
+  CONV (rgba8,       oklchF,      rgba8_to_OkLChf_avx2);
+  CONV (rgba8,       oklchaF,     rgba8_to_OkLChaf_avx2);
+  CONV (rgba8_gamma, oklabF,      rgba8_gamma_to_Oklabf_avx2);
+  CONV (rgba8_gamma, oklabaF,     rgba8_gamma_to_Oklabaf_avx2);
+  CONV (rgba8_gamma, oklchF,      rgba8_gamma_to_OkLChf_avx2);
+  CONV (rgba8_gamma, oklchaF,     rgba8_gamma_to_OkLChaf_avx2);
+  CONV (oklabF,      rgba8,       Oklabf_to_rgba8_avx2);
+  CONV (oklabaF,     rgba8,       Oklabaf_to_rgba8_avx2);
+  CONV (oklchF,      rgba8,       OkLChf_to_rgba8_avx2);
+  CONV (oklchaF,     rgba8,       OkLChaf_to_rgba8_avx2);
+  CONV (oklabF,      rgba8_gamma, Oklabf_to_rgba8_gamma_avx2);
+  CONV (oklabaF,     rgba8_gamma, Oklabaf_to_rgba8_gamma_avx2);
+  CONV (oklchF,      rgba8_gamma, OkLChf_to_rgba8_gamma_avx2);
+  CONV (oklchaF,     rgba8_gamma, OkLChaf_to_rgba8_gamma_avx2);
+
+#undef CONV
+}
+
+#endif /* defined(USE_AVX2) */
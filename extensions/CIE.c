@@ -69,6 +69,11 @@ static void models (void);
 static void conversions (void);
 static void formats (void);
 
+#if defined(USE_AVX2)
+/* CIE-avx2.c */
+void cie_avx2_conversions (void);
+#endif /* defined(USE_AVX2) */
+
 int init (void);
 
 int
@@ -99,6 +104,11 @@ components (void)
   babl_component_new ("CIE u", NULL);
   babl_component_new ("CIE v", NULL);
 /*  babl_component_new ("CIE z", NULL);*/
+  babl_component_new ("Ok L", "doc", "Oklab lightness, range 0.0-1.0 in float", NULL);
+  babl_component_new ("Ok a", "chroma", "doc", "chroma component 0.0 is no saturation", NULL);
+  babl_component_new ("Ok b", "chroma", "doc", "chroma component 0.0 is no saturation", NULL);
+  babl_component_new ("Ok C", "chroma", "doc", "chrominance/saturation", NULL);
+  babl_component_new ("Ok h", "chroma", "doc", "hue value range 0.0-360.0", NULL);
 }
 
 static void
@@ -199,6 +209,42 @@ models (void)
     babl_component ("CIE v"),
     babl_component ("A"),
     NULL);
+
+  babl_model_new (
+    "name", "Oklab",
+    "doc", "Oklab color model, a perceptually uniform space with better hue linearity than CIE Lab, derived from D65 XYZ.",
+    babl_component ("Ok L"),
+    babl_component ("Ok a"),
+    babl_component ("Ok b"),
+    NULL);
+
+  babl_model_new (
+    "name", "Oklab alpha",
+    "doc", "Oklab color model, with separate alpha",
+    babl_component ("Ok L"),
+    babl_component ("Ok a"),
+    babl_component ("Ok b"),
+    babl_component ("A"),
+    "alpha",
+    NULL);
+
+  babl_model_new (
+    "name", "OkLCh",
+    "doc", "Oklab color model, using cylindrical coordinates",
+    babl_component ("Ok L"),
+    babl_component ("Ok C"),
+    babl_component ("Ok h"),
+    NULL);
+
+  babl_model_new (
+    "name", "OkLCh alpha",
+    "doc", "Oklab color model, using cylindrical coordinates, with separate alpha",
+    babl_component ("Ok L"),
+    babl_component ("Ok C"),
+    babl_component ("Ok h"),
+    babl_component ("A"),
+    "alpha",
+    NULL);
 }
 
 static void  rgbcie_init (void);
@@ -479,6 +525,232 @@ xyza_to_rgba (const Babl *conversion,char *src,
 }
 
 
+/* rgb <-> Oklab
+ *
+ * Oklab, https://bottosson.github.io/posts/oklab/ is defined on D65 XYZ,
+ * while babl's spaces are adapted to D50; the Bradford transform takes
+ * their XYZ back to D65. LMS is normalized to the D50 white, which every
+ * space has, like the reference sRGB matrix maps white to L 1.0 with no
+ * chroma.
+ */
+
+static const double bradford_d50_to_d65[9] =
+{
+   0.9555766, -0.0230393,  0.0631636,
+  -0.0282895,  1.0099416,  0.0210077,
+   0.0122982, -0.0204830,  1.3299098
+};
+
+static const double oklab_xyz_to_lms[9] =
+{
+  0.8189330101,  0.3618667424, -0.1288597137,
+  0.0329845436,  0.9293118715,  0.0361456387,
+  0.0482003018,  0.2643662691,  0.6338517070
+};
+
+static const double oklab_lms_to_lab[9] =
+{
+  0.2104542553,  0.7936177850, -0.0040720468,
+  1.9779984951, -2.4285922050,  0.4505937099,
+  0.0259040371,  0.7827717662, -0.8086757660
+};
+
+static const double oklab_lab_to_lms[9] =
+{
+  1.0,  0.3963377774,  0.2158037573,
+  1.0, -0.1055613458, -0.0638541728,
+  1.0, -0.0894841775, -1.2914855480
+};
+
+/* also used by CIE-avx2.c */
+void cie_oklab_matrices (const Babl *space,
+                         double      rgb_to_lms[9],
+                         double      lms_to_lab[9],
+                         double      lab_to_lms[9],
+                         double      lms_to_rgb[9]);
+
+void
+cie_oklab_matrices (const Babl *space,
+                    double      rgb_to_lms[9],
+                    double      lms_to_lab[9],
+                    double      lab_to_lms[9],
+                    double      lms_to_rgb[9])
+{
+  double white[3] = { D50_WHITE_REF_X, D50_WHITE_REF_Y, D50_WHITE_REF_Z };
+  double xyz_to_lms[9];
+  double lms_white[3];
+  int    i;
+
+  babl_matrix_mul_matrix (oklab_xyz_to_lms, bradford_d50_to_d65, xyz_to_lms);
+  babl_matrix_mul_vector (xyz_to_lms, white, lms_white);
+  for (i = 0; i < 9; i++)
+    xyz_to_lms[i] /= lms_white[i / 3];
+
+  babl_matrix_mul_matrix (xyz_to_lms, space->space.RGBtoXYZ, rgb_to_lms);
+  babl_matrix_invert (rgb_to_lms, lms_to_rgb);
+  memcpy (lms_to_lab, oklab_lms_to_lab, sizeof (oklab_lms_to_lab));
+  memcpy (lab_to_lms, oklab_lab_to_lms, sizeof (oklab_lab_to_lms));
+}
+
+static inline void
+rgb_to_oklab (const double *rgb_to_lms,
+              const double *rgb,
+              double       *lab)
+{
+  double lms[3];
+  int    i;
+
+  babl_matrix_mul_vector (rgb_to_lms, rgb, lms);
+  for (i = 0; i < 3; i++)
+    lms[i] = cbrt (lms[i]);
+  babl_matrix_mul_vector (oklab_lms_to_lab, lms, lab);
+}
+
+static inline void
+oklab_to_rgb (const double *lms_to_rgb,
+              const double *lab,
+              double       *rgb)
+{
+  double lms[3];
+  int    i;
+
+  babl_matrix_mul_vector (oklab_lab_to_lms, lab, lms);
+  for (i = 0; i < 3; i++)
+    lms[i] = lms[i] * lms[i] * lms[i];
+  babl_matrix_mul_vector (lms_to_rgb, lms, rgb);
+}
+
+/* from RGBA to Oklab or OkLCh, with or without alpha */
+static inline void
+rgba_to_oklab_any (const Babl *conversion,
+                   char       *src,
+                   char       *dst,
+                   long        n,
+                   int         dst_components,
+                   int         lch)
+{
+  const Babl *space = babl_conversion_get_source_space (conversion);
+  double      rgb_to_lms[9], lms_to_lab[9], lab_to_lms[9], lms_to_rgb[9];
+
+  cie_oklab_matrices (space, rgb_to_lms, lms_to_lab, lab_to_lms, lms_to_rgb);
+
+  while (n--)
+    {
+      double *lab = (double *) dst;
+
+      rgb_to_oklab (rgb_to_lms, (double *) src, lab);
+      if (lch)
+        ab_to_CHab (lab[1], lab[2], &lab[1], &lab[2]);
+      if (dst_components == 4)
+        lab[3] = ((double *) src)[3];
+
+      src += sizeof (double) * 4;
+      dst += sizeof (double) * dst_components;
+    }
+}
+
+static inline void
+oklab_any_to_rgba (const Babl *conversion,
+                   char       *src,
+                   char       *dst,
+                   long        n,
+                   int         src_components,
+                   int         lch)
+{
+  const Babl *space = babl_conversion_get_destination_space (conversion);
+  double      rgb_to_lms[9], lms_to_lab[9], lab_to_lms[9], lms_to_rgb[9];
+
+  cie_oklab_matrices (space, rgb_to_lms, lms_to_lab, lab_to_lms, lms_to_rgb);
+
+  while (n--)
+    {
+      double lab[3] = { ((double *) src)[0],
+                        ((double *) src)[1],
+                        ((double *) src)[2] };
+
+      if (lch)
+        CHab_to_ab (lab[1], lab[2], &lab[1], &lab[2]);
+      oklab_to_rgb (lms_to_rgb, lab, (double *) dst);
+      ((double *) dst)[3] = src_components == 4 ? ((double *) src)[3] : 1.0;
+
+      src += sizeof (double) * src_components;
+      dst += sizeof (double) * 4;
+    }
+}
+
+static void
+rgba_to_oklab (const Babl *conversion,
+               char       *src,
+               char       *dst,
+               long        n)
+{
+  rgba_to_oklab_any (conversion, src, dst, n, 3, 0);
+}
+
+static void
+rgba_to_oklaba (const Babl *conversion,
+                char       *src,
+                char       *dst,
+                long        n)
+{
+  rgba_to_oklab_any (conversion, src, dst, n, 4, 0);
+}
+
+static void
+rgba_to_oklch (const Babl *conversion,
+               char       *src,
+               char       *dst,
+               long        n)
+{
+  rgba_to_oklab_any (conversion, src, dst, n, 3, 1);
+}
+
+static void
+rgba_to_oklcha (const Babl *conversion,
+                char       *src,
+                char       *dst,
+                long        n)
+{
+  rgba_to_oklab_any (conversion, src, dst, n, 4, 1);
+}
+
+static void
+oklab_to_rgba (const Babl *conversion,
+               char       *src,
+               char       *dst,
+               long        n)
+{
+  oklab_any_to_rgba (conversion, src, dst, n, 3, 0);
+}
+
+static void
+oklaba_to_rgba (const Babl *conversion,
+                char       *src,
+                char       *dst,
+                long        n)
+{
+  oklab_any_to_rgba (conversion, src, dst, n, 4, 0);
+}
+
+static void
+oklch_to_rgba (const Babl *conversion,
+               char       *src,
+               char       *dst,
+               long        n)
+{
+  oklab_any_to_rgba (conversion, src, dst, n, 3, 1);
+}
+
+static void
+oklcha_to_rgba (const Babl *conversion,
+                char       *src,
+                char       *dst,
+                long        n)
+{
+  oklab_any_to_rgba (conversion, src, dst, n, 4, 1);
+}
+
+
 /* rgb -> xyY */
 static void
 rgba_to_xyY (const Babl *conversion,
@@ -2621,6 +2893,56 @@ conversions (void)
     NULL
   );
 
+  /* Oklab */
+  babl_conversion_new (
+    babl_model ("RGBA"),
+    babl_model ("Oklab"),
+    "linear", rgba_to_oklab,
+    NULL
+  );
+  babl_conversion_new (
+    babl_model ("Oklab"),
+    babl_model ("RGBA"),
+    "linear", oklab_to_rgba,
+    NULL
+  );
+  babl_conversion_new (
+    babl_model ("RGBA"),
+    babl_model ("Oklab alpha"),
+    "linear", rgba_to_oklaba,
+    NULL
+  );
+  babl_conversion_new (
+    babl_model ("Oklab alpha"),
+    babl_model ("RGBA"),
+    "linear", oklaba_to_rgba,
+    NULL
+  );
+  babl_conversion_new (
+    babl_model ("RGBA"),
+    babl_model ("OkLCh"),
+    "linear", rgba_to_oklch,
+    NULL
+  );
+  babl_conversion_new (
+    babl_model ("OkLCh"),
+    babl_model ("RGBA"),
+    "linear", oklch_to_rgba,
+    NULL
+  );
+  babl_conversion_new (
+    babl_model ("RGBA"),
+    babl_model ("OkLCh alpha"),
+    "linear", rgba_to_oklcha,
+    NULL
+  );
+  babl_conversion_new (
+    babl_model ("OkLCh alpha"),
+    babl_model ("RGBA"),
+    "linear", oklcha_to_rgba,
+    NULL
+  );
+
   /* CIE xyY */
   babl_conversion_new (
     babl_model ("RGBA"),
@@ -2848,36 +3170,44 @@ conversions (void)
   );
 #if defined(USE_SSE2)
 
-  if (babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_SSE2)
-    {
-      babl_conversion_new (
-        babl_format ("RGBA float"),
-        babl_format ("CIE Lab alpha float"),
-        "linear", rgbaf_to_Labaf_sse2,
-        NULL
-      );
-      babl_conversion_new (
-        babl_format ("Y float"),
-        babl_format ("CIE L float"),
-        "linear", Yf_to_Lf_sse2,
-        NULL
-      );
-      babl_conversion_new (
-        babl_format ("YA float"),
-        babl_format ("CIE L float"),
-        "linear", Yaf_to_Lf_sse2,
-        NULL
-      );
-      babl_conversion_new (
-        babl_format ("RGBA float"),
-        babl_format ("CIE L float"),
-        "linear", rgbaf_to_Lf_sse2,
-        NULL
-      );
-    }
+  babl_conversion_new (
+    babl_format ("RGBA float"),
+    babl_format ("CIE Lab alpha float"),
+    "linear", rgbaf_to_Labaf_sse2,
+    "accel", BABL_CPU_ACCEL_X86_SSE2,
+    NULL
+  );
+  babl_conversion_new (
+    babl_format ("Y float"),
+    babl_format ("CIE L float"),
+    "linear", Yf_to_Lf_sse2,
+    "accel", BABL_CPU_ACCEL_X86_SSE2,
+    NULL
+  );
+  babl_conversion_new (
+    babl_format ("YA float"),
+    babl_format ("CIE L float"),
+    "linear", Yaf_to_Lf_sse2,
+    "accel", BABL_CPU_ACCEL_X86_SSE2,
+    NULL
+  );
+  babl_conversion_new (
+    babl_format ("RGBA float"),
+    babl_format ("CIE L float"),
+    "linear", rgbaf_to_Lf_sse2,
+    "accel", BABL_CPU_ACCEL_X86_SSE2,
+    NULL
+  );
 
 #endif /* defined(USE_SSE2) */
 
+#if defined(USE_AVX2)
+
+  if ((babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_AVX2))
+    cie_avx2_conversions ();
+
+#endif /* defined(USE_AVX2) */
+
   rgbcie_init ();
 }
 
@@ -2947,6 +3277,48 @@ formats (void)
     babl_component ("A"),
     NULL);
 
+  babl_format_new (
+    "name", "Oklab float",
+    babl_model ("Oklab"),
+
+    babl_type ("float"),
+    babl_component ("Ok L"),
+    babl_component ("Ok a"),
+    babl_component ("Ok b"),
+    NULL);
+
+  babl_format_new (
+    "name", "Oklab alpha float",
+    babl_model ("Oklab alpha"),
+
+    babl_type ("float"),
+    babl_component ("Ok L"),
+    babl_component ("Ok a"),
+    babl_component ("Ok b"),
+    babl_component ("A"),
+    NULL);
+
+  babl_format_new (
+    "name", "OkLCh float",
+    babl_model ("OkLCh"),
+
+    babl_type ("float"),
+    babl_component ("Ok L"),
+    babl_component ("Ok C"),
+    babl_component ("Ok h"),
+    NULL);
+
+  babl_format_new (
+    "name", "OkLCh alpha float",
+    babl_model ("OkLCh alpha"),
+
+    babl_type ("float"),
+    babl_component ("Ok L"),
+    babl_component ("Ok C"),
+    babl_component ("Ok h"),
+    babl_component ("A"),
+    NULL);
+
   babl_format_new (
     "name", "CIE L float",
     babl_model ("CIE Lab"),
@@ -27,6 +27,8 @@
 #include <string.h>
 
 #include "babl.h"
+#include "babl-cpuaccel.h"
+#include "babl-vector.h"
 #include "base/util.h"
 
 #define EPSILON 1e-10
@@ -65,6 +67,9 @@ static void components       (void);
 static void models           (void);
 static void conversions      (void);
 static void formats          (void);
+#ifdef BABL_VECTOR
+static void vector_conversions (void);
+#endif
 
 int init (void);
 
@@ -75,6 +80,9 @@ init (void)
   models      ();
   conversions ();
   formats     ();
+#ifdef BABL_VECTOR
+  vector_conversions ();
+#endif
 
   return 0;
 }
@@ -392,3 +400,150 @@ hcy_to_rgba (const Babl *conversion,
     dst += 4 * sizeof (double);
   }
 }
+
+#ifdef BABL_VECTOR
+
+/* branch free float versions of the above, 4 pixels at a time */
+
+static void
+rgb_to_hcy_v4f (BablV4f    *c,
+                const void *data)
+{
+  const float *weights = data;
+  BablV4f red    = babl_v4f_linear_to_gamma_2_2 (c[0]);
+  BablV4f green  = babl_v4f_linear_to_gamma_2_2 (c[1]);
+  BablV4f blue   = babl_v4f_linear_to_gamma_2_2 (c[2]);
+  BablV4f max    = babl_v4f_max (red, babl_v4f_max (green, blue));
+  BablV4f min    = babl_v4f_min (red, babl_v4f_min (green, blue));
+  BablV4f chroma = max - min;
+  BablV4f luma   = babl_v4f_splat (weights[0]) * red +
+                   babl_v4f_splat (weights[1]) * green +
+                   babl_v4f_splat (weights[2]) * blue;
+  /* chroma * Y_peak, the luma above that of the min gray */
+  BablV4f peak   = luma - min * babl_v4f_splat (weights[0] + weights[1] + weights[2]);
+  BablV4i gray   = chroma < babl_v4f_splat (EPSILON);
+  BablV4i extreme = (luma == babl_v4f_splat (0.0f)) |
+                    (luma == babl_v4f_splat (1.0f));
+  BablV4f scaled;
+
+  scaled = babl_v4f_select (luma * chroma < peak,
+                            peak / babl_v4f_select (extreme, babl_v4f_splat (1.0f),
+                                                    luma),
+                            (chroma - peak) /
+                            babl_v4f_select (extreme, babl_v4f_splat (1.0f),
+                                             babl_v4f_splat (1.0f) - luma));
+
+  c[0] = babl_v4f_select (gray, babl_v4f_splat (0.0f),
+                          babl_v4f_hue (red, green, blue, max, chroma));
+  c[1] = babl_v4f_select (gray, babl_v4f_splat (0.0f),
+                          babl_v4f_select (extreme, chroma, scaled));
+  c[2] = luma;
+}
+
+static void
+hcy_to_rgb_v4f (BablV4f    *c,
+                const void *data)
+{
+  const float *weights = data;
+  BablV4f hue    = c[0];
+  BablV4f chroma = c[1];
+  BablV4f luma   = c[2];
+  BablV4i gray   = chroma < babl_v4f_splat (EPSILON);
+  BablV4f red    = babl_v4f_hue_component (hue, 5.0f);
+  BablV4f green  = babl_v4f_hue_component (hue, 3.0f);
+  BablV4f blue   = babl_v4f_hue_component (hue, 1.0f);
+  BablV4f Y_peak = babl_v4f_splat (weights[0]) * red +
+                   babl_v4f_splat (weights[1]) * green +
+                   babl_v4f_splat (weights[2]) * blue;
+  BablV4f m;
+
+  chroma *= babl_v4f_select (luma < Y_peak,
+                             luma / Y_peak,
+                             (babl_v4f_splat (1.0f) - luma) /
+                             (babl_v4f_splat (1.0f) - Y_peak));
+  m = luma - chroma * Y_peak;
+
+  c[0] = babl_v4f_gamma_2_2_to_linear (babl_v4f_select (gray, luma, m + chroma * red));
+  c[1] = babl_v4f_gamma_2_2_to_linear (babl_v4f_select (gray, luma, m + chroma * green));
+  c[2] = babl_v4f_gamma_2_2_to_linear (babl_v4f_select (gray, luma, m + chroma * blue));
+}
+
+static void
+get_weights_float (const Babl *conversion,
+                   float       weights[3])
+{
+  double w[3];
+
+  babl_space_get_rgb_luminance (babl_conversion_get_source_space (conversion),
+                                &w[0], &w[1], &w[2]);
+  weights[0] = w[0];
+  weights[1] = w[1];
+  weights[2] = w[2];
+}
+
+static void
+rgba_to_hcya_float (const Babl  *conversion,
+                    const float *src,
+                    float       *dst,
+                    long         samples)
+{
+  float weights[3];
+
+  get_weights_float (conversion, weights);
+  babl_v4f_process_pixels (src, 4, dst, 4, samples, rgb_to_hcy_v4f, weights);
+}
+
+static void
+rgba_to_hcy_float (const Babl  *conversion,
+                   const float *src,
+                   float       *dst,
+                   long         samples)
+{
+  float weights[3];
+
+  get_weights_float (conversion, weights);
+  babl_v4f_process_pixels (src, 4, dst, 3, samples, rgb_to_hcy_v4f, weights);
+}
+
+static void
+hcya_to_rgba_float (const Babl  *conversion,
+                    const float *src,
+                    float       *dst,
+                    long         samples)
+{
+  float weights[3];
+
+  get_weights_float (conversion, weights);
+  babl_v4f_process_pixels (src, 4, dst, 4, samples, hcy_to_rgb_v4f, weights);
+}
+
+static void
+hcy_to_rgba_float (const Babl  *conversion,
+                   const float *src,
+                   float       *dst,
+                   long         samples)
+{
+  float weights[3];
+
+  get_weights_float (conversion, weights);
+  babl_v4f_process_pixels (src, 3, dst, 4, samples, hcy_to_rgb_v4f, weights);
+}
+
+static void
+vector_conversions (void)
+{
+  const Babl *rgbaF = babl_format ("RGBA float");
+  const Babl *hcyaF = babl_format ("HCYA float");
+  const Babl *hcyF  = babl_format ("HCY float");
+
+  babl_conversion_new (rgbaF, hcyaF, "linear", rgba_to_hcya_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+  babl_conversion_new (rgbaF, hcyF, "linear", rgba_to_hcy_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+  babl_conversion_new (hcyaF, rgbaF, "linear", hcya_to_rgba_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+  babl_conversion_new (hcyF, rgbaF, "linear", hcy_to_rgba_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+}
+
+#endif /* BABL_VECTOR */
@@ -21,6 +21,8 @@
 #include <string.h>
 
 #include "babl.h"
+#include "babl-cpuaccel.h"
+#include "babl-vector.h"
 #include "base/util.h"
 
 #define MIN(a,b) ((a > b) ? b : a)
@@ -61,6 +63,10 @@ hue2cpn  (double  p,
           double  q,
           double  hue);
           
+#ifdef BABL_VECTOR
+static void vector_conversions (void);
+#endif
+
 int init (void);
 
 
@@ -120,6 +126,10 @@ init (void)
                    babl_component ("saturation"),
                    babl_component ("lightness"),
                    NULL);
+
+#ifdef BABL_VECTOR
+  vector_conversions ();
+#endif
   return 0;
 }
 
@@ -305,3 +315,113 @@ hsl_to_rgba (const Babl *conversion,
       dst += 4 * sizeof (double);
     }
 }
+
+#ifdef BABL_VECTOR
+
+/* branch free float versions of the above, 4 pixels at a time */
+
+static void
+rgb_to_hsl_v4f (BablV4f    *c,
+                const void *data)
+{
+  BablV4f red   = babl_v4f_linear_to_gamma_2_2 (c[0]);
+  BablV4f green = babl_v4f_linear_to_gamma_2_2 (c[1]);
+  BablV4f blue  = babl_v4f_linear_to_gamma_2_2 (c[2]);
+  BablV4f max   = babl_v4f_max (red, babl_v4f_max (green, blue));
+  BablV4f min   = babl_v4f_min (red, babl_v4f_min (green, blue));
+  BablV4f diff  = max - min;
+  BablV4f sum   = max + min;
+  BablV4f lightness = sum * babl_v4f_splat (0.5f);
+  BablV4i gray  = diff < babl_v4f_splat (EPSILON);
+  BablV4f saturation;
+
+  saturation = babl_v4f_select (lightness > babl_v4f_splat (0.5f),
+                                babl_v4f_splat (2.0f) - sum, sum);
+  saturation = diff / babl_v4f_select (gray, babl_v4f_splat (1.0f), saturation);
+
+  c[0] = babl_v4f_select (gray, babl_v4f_splat (0.0f),
+                          babl_v4f_hue (red, green, blue, max, diff));
+  c[1] = babl_v4f_select (gray, babl_v4f_splat (0.0f), saturation);
+  c[2] = lightness;
+}
+
+static void
+hsl_to_rgb_v4f (BablV4f    *c,
+                const void *data)
+{
+  BablV4f hue        = c[0];
+  BablV4f saturation = c[1];
+  BablV4f lightness  = c[2];
+  BablV4i gray       = saturation < babl_v4f_splat (1e-7f);
+  BablV4f q, p;
+
+  q = babl_v4f_select (lightness < babl_v4f_splat (0.5f),
+                       lightness * (babl_v4f_splat (1.0f) + saturation),
+                       lightness + saturation - lightness * saturation);
+  p = babl_v4f_splat (2.0f) * lightness - q;
+
+  c[0] = babl_v4f_gamma_2_2_to_linear (
+           babl_v4f_select (gray, lightness,
+                            p + (q - p) * babl_v4f_hue_component (hue, 5.0f)));
+  c[1] = babl_v4f_gamma_2_2_to_linear (
+           babl_v4f_select (gray, lightness,
+                            p + (q - p) * babl_v4f_hue_component (hue, 3.0f)));
+  c[2] = babl_v4f_gamma_2_2_to_linear (
+           babl_v4f_select (gray, lightness,
+                            p + (q - p) * babl_v4f_hue_component (hue, 1.0f)));
+}
+
+static void
+rgba_to_hsla_float (const Babl  *conversion,
+                    const float *src,
+                    float       *dst,
+                    long         samples)
+{
+  babl_v4f_process_pixels (src, 4, dst, 4, samples, rgb_to_hsl_v4f, NULL);
+}
+
+static void
+rgba_to_hsl_float (const Babl  *conversion,
+                   const float *src,
+                   float       *dst,
+                   long         samples)
+{
+  babl_v4f_process_pixels (src, 4, dst, 3, samples, rgb_to_hsl_v4f, NULL);
+}
+
+static void
+hsla_to_rgba_float (const Babl  *conversion,
+                    const float *src,
+                    float       *dst,
+                    long         samples)
+{
+  babl_v4f_process_pixels (src, 4, dst, 4, samples, hsl_to_rgb_v4f, NULL);
+}
+
+static void
+hsl_to_rgba_float (const Babl  *conversion,
+                   const float *src,
+                   float       *dst,
+                   long         samples)
+{
+  babl_v4f_process_pixels (src, 3, dst, 4, samples, hsl_to_rgb_v4f, NULL);
+}
+
+static void
+vector_conversions (void)
+{
+  const Babl *rgbaF = babl_format ("RGBA float");
+  const Babl *hslaF = babl_format ("HSLA float");
+  const Babl *hslF  = babl_format ("HSL float");
+
+  babl_conversion_new (rgbaF, hslaF, "linear", rgba_to_hsla_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+  babl_conversion_new (rgbaF, hslF, "linear", rgba_to_hsl_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+  babl_conversion_new (hslaF, rgbaF, "linear", hsla_to_rgba_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+  babl_conversion_new (hslF, rgbaF, "linear", hsl_to_rgba_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+}
+
+#endif /* BABL_VECTOR */
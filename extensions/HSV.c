@@ -26,6 +26,8 @@
 #include <string.h>
 
 #include "babl.h"
+#include "babl-cpuaccel.h"
+#include "babl-vector.h"
 #include "base/util.h"
 
 #define MIN(a,b) (a > b) ? b : a;
@@ -68,6 +70,9 @@ static void components       (void);
 static void models           (void);
 static void conversions      (void);
 static void formats          (void);
+#ifdef BABL_VECTOR
+static void vector_conversions (void);
+#endif
 
 int init (void);
 
@@ -78,6 +83,9 @@ init (void)
   models      ();
   conversions ();
   formats     ();
+#ifdef BABL_VECTOR
+  vector_conversions ();
+#endif
 
   return 0;
 }
@@ -368,3 +376,99 @@ hsv_to_rgba (const Babl *conversion,
       dst += 4 * sizeof (double);
     }
 }
+
+#ifdef BABL_VECTOR
+
+/* branch free float versions of the above, 4 pixels at a time */
+
+static void
+rgb_to_hsv_v4f (BablV4f    *c,
+                const void *data)
+{
+  BablV4f red    = babl_v4f_linear_to_gamma_2_2 (c[0]);
+  BablV4f green  = babl_v4f_linear_to_gamma_2_2 (c[1]);
+  BablV4f blue   = babl_v4f_linear_to_gamma_2_2 (c[2]);
+  BablV4f value  = babl_v4f_max (red, babl_v4f_max (green, blue));
+  BablV4f chroma = value - babl_v4f_min (red, babl_v4f_min (green, blue));
+  BablV4i dark   = value < babl_v4f_splat (EPSILON);
+  BablV4f saturation;
+
+  saturation = babl_v4f_select (dark, babl_v4f_splat (0.0f),
+                                chroma / babl_v4f_select (dark, babl_v4f_splat (1.0f),
+                                                          value));
+
+  c[0] = babl_v4f_select (saturation < babl_v4f_splat (EPSILON),
+                          babl_v4f_splat (0.0f),
+                          babl_v4f_hue (red, green, blue, value, chroma));
+  c[1] = saturation;
+  c[2] = value;
+}
+
+static void
+hsv_to_rgb_v4f (BablV4f    *c,
+                const void *data)
+{
+  BablV4f hue    = c[0];
+  BablV4f value  = c[2];
+  BablV4f chroma = c[1] * value;
+  BablV4f min    = value - chroma;
+
+  c[0] = babl_v4f_gamma_2_2_to_linear (min + chroma * babl_v4f_hue_component (hue, 5.0f));
+  c[1] = babl_v4f_gamma_2_2_to_linear (min + chroma * babl_v4f_hue_component (hue, 3.0f));
+  c[2] = babl_v4f_gamma_2_2_to_linear (min + chroma * babl_v4f_hue_component (hue, 1.0f));
+}
+
+static void
+rgba_to_hsva_float (const Babl  *conversion,
+                    const float *src,
+                    float       *dst,
+                    long         samples)
+{
+  babl_v4f_process_pixels (src, 4, dst, 4, samples, rgb_to_hsv_v4f, NULL);
+}
+
+static void
+rgba_to_hsv_float (const Babl  *conversion,
+                   const float *src,
+                   float       *dst,
+                   long         samples)
+{
+  babl_v4f_process_pixels (src, 4, dst, 3, samples, rgb_to_hsv_v4f, NULL);
+}
+
+static void
+hsva_to_rgba_float (const Babl  *conversion,
+                    const float *src,
+                    float       *dst,
+                    long         samples)
+{
+  babl_v4f_process_pixels (src, 4, dst, 4, samples, hsv_to_rgb_v4f, NULL);
+}
+
+static void
+hsv_to_rgba_float (const Babl  *conversion,
+                   const float *src,
+                   float       *dst,
+                   long         samples)
+{
+  babl_v4f_process_pixels (src, 3, dst, 4, samples, hsv_to_rgb_v4f, NULL);
+}
+
+static void
+vector_conversions (void)
+{
+  const Babl *rgbaF = babl_format ("RGBA float");
+  const Babl *hsvaF = babl_format ("HSVA float");
+  const Babl *hsvF  = babl_format ("HSV float");
+
+  babl_conversion_new (rgbaF, hsvaF, "linear", rgba_to_hsva_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+  babl_conversion_new (rgbaF, hsvF, "linear", rgba_to_hsv_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+  babl_conversion_new (hsvaF, rgbaF, "linear", hsva_to_rgba_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+  babl_conversion_new (hsvF, rgbaF, "linear", hsv_to_rgba_float,
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL);
+}
+
+#endif /* BABL_VECTOR */
@@ -0,0 +1,509 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* AVX2 premultiplication and unpremultiplication of RGBA and YA, for u8,
+ * u16, half and float - the same for the linear and the gamma variant.
+ *
+ * u8 is exactly rounded both ways: premultiplying divides by 255 with
+ * integer arithmetic, unpremultiplying multiplies by a table of 255 / alpha
+ * and rounds half up - the products are never closer than 1 / 510 to a
+ * rounding boundary, far more than the float error. The other types
+ * follow babl_epsilon_for_zero () for the alphas of zero.
+ */
+
+#include "config.h"
+
+#if defined(USE_AVX2)
+
+/* AVX 2 */
+#include <immintrin.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "babl.h"
+#include "babl-cpuaccel.h"
+#include "base/util.h"
+#include "extensions/util.h"
+
+#define splat8f(x) _mm256_set1_ps (x)
+
+static float recip_u8[256];
+
+
+/* u8 */
+
+/* the alpha of each pixel, in all of its 16 bit lanes */
+static inline __m256i
+broadcast_alpha_epi16 (__m256i x,
+                       int     components)
+{
+  if (components == 2)
+    return _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (x, _MM_SHUFFLE (3, 3, 1, 1)),
+                                   _MM_SHUFFLE (3, 3, 1, 1));
+  return _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (x, _MM_SHUFFLE (3, 3, 3, 3)),
+                                 _MM_SHUFFLE (3, 3, 3, 3));
+}
+
+/* round (x * alpha / 255), 255 for the alpha lanes themselves */
+static inline __m256i
+premultiply_epi16 (__m256i x,
+                   int     components)
+{
+  __m256i a = broadcast_alpha_epi16 (x, components);
+
+  a = components == 2 ? _mm256_blend_epi16 (a, _mm256_set1_epi16 (255), 0xaa)
+                      : _mm256_blend_epi16 (a, _mm256_set1_epi16 (255), 0x88);
+  x = _mm256_add_epi16 (_mm256_mullo_epi16 (x, a), _mm256_set1_epi16 (128));
+
+  return _mm256_srli_epi16 (_mm256_add_epi16 (x, _mm256_srli_epi16 (x, 8)), 8);
+}
+
+static inline void
+premultiply_u8 (const uint8_t *src,
+                uint8_t       *dst,
+                long           n,
+                int            components)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+
+  for (; n >= 32; n -= 32)
+    {
+      __m256i x  = _mm256_loadu_si256 ((const __m256i *) src);
+      __m256i lo = premultiply_epi16 (_mm256_unpacklo_epi8 (x, zero), components);
+      __m256i hi = premultiply_epi16 (_mm256_unpackhi_epi8 (x, zero), components);
+
+      _mm256_storeu_si256 ((__m256i *) dst, _mm256_packus_epi16 (lo, hi));
+
+      src += 32;
+      dst += 32;
+    }
+
+  for (; n; n -= components)
+    {
+      unsigned int alpha = src[components - 1];
+      int          c;
+
+      for (c = 0; c < components - 1; c++)
+        {
+          unsigned int t = *src++ * alpha + 128;
+
+          *dst++ = (t + (t >> 8)) >> 8;
+        }
+      *dst++ = *src++;
+    }
+}
+
+/* 8 u8 components as 32 bit lanes, unpremultiplied */
+static inline __m256i
+unpremultiply_epi32 (__m128i x,
+                     int     components)
+{
+  const __m128i alpha_index = components == 2 ?
+    _mm_setr_epi8 (1, 1, 3, 3, 5, 5, 7, 7, -1, -1, -1, -1, -1, -1, -1, -1) :
+    _mm_setr_epi8 (3, 3, 3, 3, 7, 7, 7, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i alpha_lanes = components == 2 ?
+    _mm256_setr_epi32 (0, -1, 0, -1, 0, -1, 0, -1) :
+    _mm256_setr_epi32 (0, 0, 0, -1, 0, 0, 0, -1);
+  __m256i a     = _mm256_cvtepu8_epi32 (_mm_shuffle_epi8 (x, alpha_index));
+  __m256i c     = _mm256_cvtepu8_epi32 (x);
+  __m256  recip = _mm256_i32gather_ps (recip_u8, a, 4);
+  __m256  y;
+
+  y = _mm256_cvtepi32_ps (c) * recip + splat8f (0.5f + 1.0f / 1024.0f);
+  y = _mm256_min_ps (y, splat8f (255.0f));
+
+  return _mm256_blendv_epi8 (_mm256_cvttps_epi32 (y), c, alpha_lanes);
+}
+
+static inline __m128i
+pack_epi32_epi8 (__m256i a,
+                 __m256i b)
+{
+  __m256i ab = _mm256_packus_epi32 (a, b);
+
+  ab = _mm256_permute4x64_epi64 (ab, _MM_SHUFFLE (3, 1, 2, 0));
+  ab = _mm256_packus_epi16 (ab, ab);
+
+  return _mm256_castsi256_si128 (_mm256_permute4x64_epi64 (ab, _MM_SHUFFLE (3, 1, 2, 0)));
+}
+
+static inline void
+unpremultiply_u8 (const uint8_t *src,
+                  uint8_t       *dst,
+                  long           n,
+                  int            components)
+{
+  for (; n >= 16; n -= 16)
+    {
+      __m128i x = _mm_loadu_si128 ((const __m128i *) src);
+
+      _mm_storeu_si128 ((__m128i *) dst,
+                        pack_epi32_epi8 (unpremultiply_epi32 (x, components),
+                                         unpremultiply_epi32 (_mm_srli_si128 (x, 8),
+                                                              components)));
+
+      src += 16;
+      dst += 16;
+    }
+
+  for (; n; n -= components)
+    {
+      float recip = recip_u8[src[components - 1]];
+      int   c;
+
+      for (c = 0; c < components - 1; c++)
+        {
+          float y = *src++ * recip + (0.5f + 1.0f / 1024.0f);
+
+          *dst++ = y >= 255.0f ? 255 : (int) y;
+        }
+      *dst++ = *src++;
+    }
+}
+
+
+/* u16 */
+
+/* round (x * alpha / 65535), on 8 components as 32 bit lanes */
+static inline __m256i
+premultiply_epi32 (__m256i x,
+                   int     components)
+{
+  __m256i a;
+
+  if (components == 2)
+    a = _mm256_blend_epi32 (_mm256_shuffle_epi32 (x, _MM_SHUFFLE (3, 3, 1, 1)),
+                            _mm256_set1_epi32 (65535), 0xaa);
+  else
+    a = _mm256_blend_epi32 (_mm256_shuffle_epi32 (x, _MM_SHUFFLE (3, 3, 3, 3)),
+                            _mm256_set1_epi32 (65535), 0x88);
+  x = _mm256_add_epi32 (_mm256_mullo_epi32 (x, a), _mm256_set1_epi32 (32768));
+
+  return _mm256_srli_epi32 (_mm256_add_epi32 (x, _mm256_srli_epi32 (x, 16)), 16);
+}
+
+static inline __m128i
+pack_epi32_epi16 (__m256i x)
+{
+  return _mm_packus_epi32 (_mm256_castsi256_si128 (x),
+                           _mm256_extracti128_si256 (x, 1));
+}
+
+static inline void
+premultiply_u16 (const uint16_t *src,
+                 uint16_t       *dst,
+                 long            n,
+                 int             components)
+{
+  for (; n >= 8; n -= 8)
+    {
+      __m256i x = _mm256_cvtepu16_epi32 (_mm_loadu_si128 ((const __m128i *) src));
+
+      _mm_storeu_si128 ((__m128i *) dst,
+                        pack_epi32_epi16 (premultiply_epi32 (x, components)));
+
+      src += 8;
+      dst += 8;
+    }
+
+  for (; n; n -= components)
+    {
+      unsigned int alpha = src[components - 1];
+      int          c;
+
+      for (c = 0; c < components - 1; c++)
+        {
+          unsigned int t = *src++ * alpha + 32768;
+
+          *dst++ = (t + (t >> 16)) >> 16;
+        }
+      *dst++ = *src++;
+    }
+}
+
+static inline void
+unpremultiply_u16 (const uint16_t *src,
+                   uint16_t       *dst,
+                   long            n,
+                   int             components)
+{
+  const __m256i alpha_lanes = components == 2 ?
+    _mm256_setr_epi32 (0, -1, 0, -1, 0, -1, 0, -1) :
+    _mm256_setr_epi32 (0, 0, 0, -1, 0, 0, 0, -1);
+
+  for (; n >= 8; n -= 8)
+    {
+      __m256i c = _mm256_cvtepu16_epi32 (_mm_loadu_si128 ((const __m128i *) src));
+      __m256  x = _mm256_cvtepi32_ps (c);
+      __m256  a = components == 2 ? _mm256_permute_ps (x, _MM_SHUFFLE (3, 3, 1, 1))
+                                  : _mm256_permute_ps (x, _MM_SHUFFLE (3, 3, 3, 3));
+
+      /* a zero alpha maps non-zero components to 65535, like the floor of
+       * babl_epsilon_for_zero () does
+       */
+      x = x * (splat8f (65535.0f) / _mm256_max_ps (a, splat8f (1.0f / 65536.0f)));
+      x = _mm256_min_ps (x + splat8f (0.5f), splat8f (65535.0f));
+
+      _mm_storeu_si128 ((__m128i *) dst,
+                        pack_epi32_epi16 (_mm256_blendv_epi8 (_mm256_cvttps_epi32 (x),
+                                                              c, alpha_lanes)));
+
+      src += 8;
+      dst += 8;
+    }
+
+  for (; n; n -= components)
+    {
+      float alpha = src[components - 1];
+      float recip = 65535.0f / (alpha > 0.0f ? alpha : 1.0f / 65536.0f);
+      int   c;
+
+      for (c = 0; c < components - 1; c++)
+        {
+          float y = *src++ * recip + 0.5f;
+
+          *dst++ = y >= 65535.0f ? 65535 : (int) y;
+        }
+      *dst++ = *src++;
+    }
+}
+
+
+/* float and half */
+
+static inline __m256
+alpha_lanes_ps (int components)
+{
+  if (components == 2)
+    return _mm256_castsi256_ps (_mm256_setr_epi32 (0, -1, 0, -1, 0, -1, 0, -1));
+  return _mm256_castsi256_ps (_mm256_setr_epi32 (0, 0, 0, -1, 0, 0, 0, -1));
+}
+
+/* the alpha of each pixel in all of its lanes, through
+ * babl_epsilon_for_zero_float ()
+ */
+static inline __m256
+used_alpha_ps (__m256 x,
+               int    components)
+{
+  __m256 a     = components == 2 ? _mm256_permute_ps (x, _MM_SHUFFLE (3, 3, 1, 1))
+                                 : _mm256_permute_ps (x, _MM_SHUFFLE (3, 3, 3, 3));
+  __m256 floor = splat8f (BABL_ALPHA_FLOOR_F);
+  __m256 zero  = _mm256_cmp_ps (_mm256_andnot_ps (splat8f (-0.0f), a), floor,
+                                _CMP_LE_OQ);
+
+  return _mm256_blendv_ps (a, floor, zero);
+}
+
+static inline __m256
+premultiply_ps (__m256 x,
+                int    components)
+{
+  return x * _mm256_blendv_ps (used_alpha_ps (x, components), splat8f (1.0f),
+                               alpha_lanes_ps (components));
+}
+
+static inline __m256
+unpremultiply_ps (__m256 x,
+                  int    components)
+{
+  return x * _mm256_blendv_ps (splat8f (1.0f) / used_alpha_ps (x, components),
+                               splat8f (1.0f), alpha_lanes_ps (components));
+}
+
+static inline void
+multiply_float (const float *src,
+                float       *dst,
+                long         n,
+                int          components,
+                int          premultiply)
+{
+  for (; n >= 8; n -= 8)
+    {
+      __m256 x = _mm256_loadu_ps (src);
+
+      x = premultiply ? premultiply_ps (x, components) : unpremultiply_ps (x, components);
+      _mm256_storeu_ps (dst, x);
+
+      src += 8;
+      dst += 8;
+    }
+
+  if (n)
+    {
+      float  tmp[8] = { 0, };
+      __m256 x;
+
+      memcpy (tmp, src, n * sizeof (float));
+      x = _mm256_loadu_ps (tmp);
+      x = premultiply ? premultiply_ps (x, components) : unpremultiply_ps (x, components);
+      _mm256_storeu_ps (tmp, x);
+      memcpy (dst, tmp, n * sizeof (float));
+    }
+}
+
+static inline void
+multiply_half (const uint16_t *src,
+               uint16_t       *dst,
+               long            n,
+               int             components,
+               int             premultiply)
+{
+  for (; n >= 8; n -= 8)
+    {
+      __m256 x = _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i *) src));
+
+      x = premultiply ? premultiply_ps (x, components) : unpremultiply_ps (x, components);
+      _mm_storeu_si128 ((__m128i *) dst,
+                        _mm256_cvtps_ph (x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+
+      src += 8;
+      dst += 8;
+    }
+
+  if (n)
+    {
+      uint16_t tmp[8] = { 0, };
+      __m256   x;
+
+      memcpy (tmp, src, n * sizeof (uint16_t));
+      x = _mm256_cvtph_ps (_mm_loadu_si128 ((const __m128i *) tmp));
+      x = premultiply ? premultiply_ps (x, components) : unpremultiply_ps (x, components);
+      _mm_storeu_si128 ((__m128i *) tmp,
+                        _mm256_cvtps_ph (x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+      memcpy (dst, tmp, n * sizeof (uint16_t));
+    }
+}
+
+
+#define CONV(name, type, components, call)                               \
+static void                                                              \
+conv_ ## name (const Babl *conversion,                                   \
+               const type *src,                                          \
+               type       *dst,                                          \
+               long        samples)                                      \
+{                                                                        \
+  const long n = samples * components;                                   \
+                                                                         \
+  call;                                                                  \
+}
+
+CONV (ya8_yA8,         uint8_t,  2, premultiply_u8    (src, dst, n, 2))
+CONV (rgba8_rgbA8,     uint8_t,  4, premultiply_u8    (src, dst, n, 4))
+CONV (yA8_ya8,         uint8_t,  2, unpremultiply_u8  (src, dst, n, 2))
+CONV (rgbA8_rgba8,     uint8_t,  4, unpremultiply_u8  (src, dst, n, 4))
+
+CONV (ya16_yA16,       uint16_t, 2, premultiply_u16   (src, dst, n, 2))
+CONV (rgba16_rgbA16,   uint16_t, 4, premultiply_u16   (src, dst, n, 4))
+CONV (yA16_ya16,       uint16_t, 2, unpremultiply_u16 (src, dst, n, 2))
+CONV (rgbA16_rgba16,   uint16_t, 4, unpremultiply_u16 (src, dst, n, 4))
+
+CONV (yaHalf_yAHalf,     uint16_t, 2, multiply_half (src, dst, n, 2, 1))
+CONV (rgbaHalf_rgbAHalf, uint16_t, 4, multiply_half (src, dst, n, 4, 1))
+CONV (yAHalf_yaHalf,     uint16_t, 2, multiply_half (src, dst, n, 2, 0))
+CONV (rgbAHalf_rgbaHalf, uint16_t, 4, multiply_half (src, dst, n, 4, 0))
+
+CONV (yaF_yAF,         float,    2, multiply_float (src, dst, n, 2, 1))
+CONV (rgbaF_rgbAF,     float,    4, multiply_float (src, dst, n, 4, 1))
+CONV (yAF_yaF,         float,    2, multiply_float (src, dst, n, 2, 0))
+CONV (rgbAF_rgbaF,     float,    4, multiply_float (src, dst, n, 4, 0))
+
+#undef CONV
+
+static const Babl *
+format (const char *model,
+        const char *type,
+        const char *c0,
+        const char *c1,
+        const char *c2,
+        const char *c3)
+{
+  return babl_format_new (babl_model (model),
+                          babl_type (type),
+                          babl_component (c0),
+                          c1 ? babl_component (c1) : NULL,
+                          c2 ? babl_component (c2) : NULL,
+                          c3 ? babl_component (c3) : NULL,
+                          NULL);
+}
+
+#endif /* defined(USE_AVX2) */
+
+int init (void);
+
+int
+init (void)
+{
+#if defined(USE_AVX2)
+
+#define FORMATS(suffix, type)                                                                       \
+  const Babl *ya ## suffix ## _linear   = format ("YA",         type, "Y",   "A",   NULL,  NULL);   \
+  const Babl *ya ## suffix ## _gamma    = format ("Y'A",        type, "Y'",  "A",   NULL,  NULL);   \
+  const Babl *yA ## suffix ## _linear   = format ("YaA",        type, "Ya",  "A",   NULL,  NULL);   \
+  const Babl *yA ## suffix ## _gamma    = format ("Y'aA",       type, "Y'a", "A",   NULL,  NULL);   \
+  const Babl *rgba ## suffix ## _linear = format ("RGBA",       type, "R",   "G",   "B",   "A");    \
+  const Babl *rgba ## suffix ## _gamma  = format ("R'G'B'A",    type, "R'",  "G'",  "B'",  "A");    \
+  const Babl *rgbA ## suffix ## _linear = format ("RaGaBaA",    type, "Ra",  "Ga",  "Ba",  "A");    \
+  const Babl *rgbA ## suffix ## _gamma  = format ("R'aG'aB'aA", type, "R'a", "G'a", "B'a", "A")
+
+  FORMATS (8,    "u8");
+  FORMATS (16,   "u16");
+  FORMATS (Half, "half");
+  FORMATS (F,    "float");
+
+#undef FORMATS
+
+  int i;
+
+  recip_u8[0] = 255.0f * 65536.0f;
+  for (i = 1; i < 256; i++)
+    recip_u8[i] = 255.0f / i;
+
+/* both ways between separate and associated alpha, for both the linear
+ * and the gamma variant
+ */
+#define MULTIPLY(separate, associated, accel)                                   \
+  babl_conversion_new (separate ## _linear, associated ## _linear, "linear",    \
+                       conv_ ## separate ## _ ## associated,                    \
+                       "accel", accel, NULL);                                   \
+  babl_conversion_new (separate ## _gamma, associated ## _gamma, "linear",      \
+                       conv_ ## separate ## _ ## associated,                    \
+                       "accel", accel, NULL);                                   \
+  babl_conversion_new (associated ## _linear, separate ## _linear, "linear",    \
+                       conv_ ## associated ## _ ## separate,                    \
+                       "accel", accel, NULL);                                   \
+  babl_conversion_new (associated ## _gamma, separate ## _gamma, "linear",      \
+                       conv_ ## associated ## _ ## separate,                    \
+                       "accel", accel, NULL)
+
+  MULTIPLY (ya8,      yA8,      BABL_CPU_ACCEL_X86_AVX2);
+  MULTIPLY (rgba8,    rgbA8,    BABL_CPU_ACCEL_X86_AVX2);
+  MULTIPLY (ya16,     yA16,     BABL_CPU_ACCEL_X86_AVX2);
+  MULTIPLY (rgba16,   rgbA16,   BABL_CPU_ACCEL_X86_AVX2);
+  MULTIPLY (yaHalf,   yAHalf,   BABL_CPU_ACCEL_X86_AVX2 | BABL_CPU_ACCEL_X86_F16C);
+  MULTIPLY (rgbaHalf, rgbAHalf, BABL_CPU_ACCEL_X86_AVX2 | BABL_CPU_ACCEL_X86_F16C);
+  MULTIPLY (yaF,      yAF,      BABL_CPU_ACCEL_X86_AVX2);
+  MULTIPLY (rgbaF,    rgbAF,    BABL_CPU_ACCEL_X86_AVX2);
+
+#undef MULTIPLY
+
+#endif /* defined(USE_AVX2) */
+
+  return 0;
+}
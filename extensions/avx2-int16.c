@@ -0,0 +1,624 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* AVX2 conversions of u16 images, the 16 bit counterpart of avx2-int8:
+ * u16 to and from float with and without alpha, with associated alpha,
+ * with the sRGB TRC applied on the way, and u16 to and from u8. bfloat16,
+ * being 16 bits too, is converted to and from float and from u8 here.
+ *
+ * The float kernels work on 8 components at a time regardless of the
+ * number of components per pixel, alpha is told apart by lane masks - 8 is
+ * a multiple of 1, 2 and 4 components, and 3 component formats have no
+ * alpha. Unlike u8, a table of all u16 values does not fit the caches, the
+ * TRC is computed with the approximations of sse2-float instead.
+ */
+
+#include "config.h"
+
+#if defined(USE_AVX2)
+
+/* AVX 2 */
+#include <immintrin.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "babl.h"
+#include "babl-cpuaccel.h"
+#include "base/util.h"
+#include "extensions/util.h"
+#include "extensions/avx2-trc.h"
+
+/* lanes holding alpha, for 2 and 4 components per pixel */
+static inline __m256
+alpha_lanes (int components)
+{
+  switch (components)
+    {
+      case 2:
+        return _mm256_castsi256_ps (_mm256_setr_epi32 (0, -1, 0, -1,
+                                                       0, -1, 0, -1));
+      case 4:
+        return _mm256_castsi256_ps (_mm256_setr_epi32 (0, 0, 0, -1,
+                                                       0, 0, 0, -1));
+      default:
+        return _mm256_setzero_ps ();
+    }
+}
+
+/* the alpha of each pixel, in all of its lanes */
+static inline __m256
+broadcast_alpha (__m256 x,
+                 int    components)
+{
+  if (components == 2)
+    return _mm256_permute_ps (x, _MM_SHUFFLE (3, 3, 1, 1));
+  return _mm256_permute_ps (x, _MM_SHUFFLE (3, 3, 3, 3));
+}
+
+
+/* the operations done on the way between u16 and float */
+
+static inline __m256
+op_none (__m256 x,
+         int    components)
+{
+  return x;
+}
+
+/* only ever stored as u16, clamping first keeps the unpremultiplied
+ * values of tiny alphas out of the slow path of avx2_pow_1_24 ()
+ */
+static inline __m256
+op_to_gamma (__m256 x,
+             int    components)
+{
+  x = _mm256_min_ps (_mm256_max_ps (x, _mm256_setzero_ps ()), splat8f (1.0f));
+  return _mm256_blendv_ps (linear_to_gamma_2_2_avx2 (x), x,
+                           alpha_lanes (components));
+}
+
+static inline __m256
+op_to_linear (__m256 x,
+              int    components)
+{
+  return _mm256_blendv_ps (gamma_2_2_to_linear_avx2 (x), x,
+                           alpha_lanes (components));
+}
+
+static inline __m256
+op_premultiply (__m256 x,
+                int    components)
+{
+  __m256 a     = broadcast_alpha (x, components);
+  __m256 floor = splat8f (BABL_ALPHA_FLOOR_F);
+  __m256 zero  = _mm256_cmp_ps (_mm256_andnot_ps (splat8f (-0.0f), a), floor,
+                                _CMP_LE_OQ);
+
+  a = _mm256_blendv_ps (a, floor, zero);
+  return x * _mm256_blendv_ps (a, splat8f (1.0f), alpha_lanes (components));
+}
+
+static inline __m256
+op_unpremultiply (__m256 x,
+                  int    components)
+{
+  __m256 a     = broadcast_alpha (x, components);
+  __m256 floor = splat8f (BABL_ALPHA_FLOOR_F);
+  __m256 zero  = _mm256_cmp_ps (_mm256_andnot_ps (splat8f (-0.0f), a), floor,
+                                _CMP_LE_OQ);
+
+  a = splat8f (1.0f) / _mm256_blendv_ps (a, floor, zero);
+  return x * _mm256_blendv_ps (a, splat8f (1.0f), alpha_lanes (components));
+}
+
+static inline __m256
+op_to_linear_premultiply (__m256 x,
+                          int    components)
+{
+  return op_premultiply (op_to_linear (x, components), components);
+}
+
+static inline __m256
+op_unpremultiply_to_gamma (__m256 x,
+                           int    components)
+{
+  return op_to_gamma (op_unpremultiply (x, components), components);
+}
+
+
+/* loads and stores of 8 components, as 0.0 - 1.0 floats */
+
+static inline __m256
+load_u16 (const uint16_t *src)
+{
+  __m256i i32 = _mm256_cvtepu16_epi32 (_mm_loadu_si128 ((const __m128i *) src));
+
+  return _mm256_cvtepi32_ps (i32) * splat8f (1.f / 65535);
+}
+
+/* scaled in double, where the product is exact; rounding it to float
+ * first can land it on .5 and round it the wrong way
+ */
+static inline __m128i
+float_to_u16 (__m256 x)
+{
+  __m128i lo, hi;
+
+  x  = _mm256_min_ps (_mm256_max_ps (x, _mm256_setzero_ps ()), splat8f (1.0f));
+  lo = _mm256_cvtpd_epi32 (_mm256_mul_pd (_mm256_cvtps_pd (_mm256_castps256_ps128 (x)),
+                                          _mm256_set1_pd (65535.0)));
+  hi = _mm256_cvtpd_epi32 (_mm256_mul_pd (_mm256_cvtps_pd (_mm256_extractf128_ps (x, 1)),
+                                          _mm256_set1_pd (65535.0)));
+
+  return _mm_packus_epi32 (lo, hi);
+}
+
+static inline void
+store_u16 (uint16_t *dst,
+           __m256    x)
+{
+  _mm_storeu_si128 ((__m128i *) dst, float_to_u16 (x));
+}
+
+/* big endian, with the byte swap folded into the loads and stores */
+
+#define BSWAP16 _mm_setr_epi8 (1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)
+
+static inline __m256
+load_u16be (const uint16_t *src)
+{
+  __m128i u16 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) src), BSWAP16);
+
+  return _mm256_cvtepi32_ps (_mm256_cvtepu16_epi32 (u16)) * splat8f (1.f / 65535);
+}
+
+static inline void
+store_u16be (uint16_t *dst,
+             __m256    x)
+{
+  _mm_storeu_si128 ((__m128i *) dst, _mm_shuffle_epi8 (float_to_u16 (x), BSWAP16));
+}
+
+static inline __m256
+load_float (const float *src)
+{
+  return _mm256_loadu_ps (src);
+}
+
+static inline void
+store_float (float  *dst,
+             __m256  x)
+{
+  _mm256_storeu_ps (dst, x);
+}
+
+/* bfloat16 is the upper half of a float, rounded to nearest even; NaNs
+ * are kept quiet rather than rounded into infinities
+ */
+static inline __m256
+load_bfloat16 (const uint16_t *src)
+{
+  __m256i i32 = _mm256_cvtepu16_epi32 (_mm_loadu_si128 ((const __m128i *) src));
+
+  return _mm256_castsi256_ps (_mm256_slli_epi32 (i32, 16));
+}
+
+static inline void
+store_bfloat16 (uint16_t *dst,
+                __m256    x)
+{
+  __m256i bits = _mm256_castps_si256 (x);
+  __m256i high = _mm256_srli_epi32 (bits, 16);
+  __m256i odd  = _mm256_and_si256 (high, _mm256_set1_epi32 (1));
+  __m256i i32  = _mm256_srli_epi32 (_mm256_add_epi32 (bits,
+                                      _mm256_add_epi32 (odd, _mm256_set1_epi32 (0x7fff))),
+                                    16);
+
+  i32 = _mm256_blendv_epi8 (i32, _mm256_or_si256 (high, _mm256_set1_epi32 (0x40)),
+                            _mm256_castps_si256 (_mm256_cmp_ps (x, x, _CMP_UNORD_Q)));
+  _mm_storeu_si128 ((__m128i *) dst,
+                    _mm_packus_epi32 (_mm256_castsi256_si128 (i32),
+                                      _mm256_extracti128_si256 (i32, 1)));
+}
+
+static inline __m256
+load_u8 (const uint8_t *src)
+{
+  __m256i i32 = _mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((const __m128i *) src));
+
+  return _mm256_div_ps (_mm256_cvtepi32_ps (i32), splat8f (255.0f));
+}
+
+#define CONV(name, src_type, dst_type, load, store, components, op)      \
+static void                                                              \
+conv_ ## name (const Babl     *conversion,                               \
+               const src_type *src,                                      \
+               dst_type       *dst,                                      \
+               long            samples)                                  \
+{                                                                        \
+  long n = samples * components;                                         \
+                                                                         \
+  for (; n >= 8; n -= 8, src += 8, dst += 8)                             \
+    store (dst, op (load (src), components));                            \
+                                                                         \
+  if (n)                                                                 \
+    {                                                                    \
+      src_type tmp_src[8] = { 0, };                                      \
+      dst_type tmp_dst[8];                                               \
+                                                                         \
+      memcpy (tmp_src, src, n * sizeof (src_type));                      \
+      store (tmp_dst, op (load (tmp_src), components));                  \
+      memcpy (dst, tmp_dst, n * sizeof (dst_type));                      \
+    }                                                                    \
+}
+
+/* between types, the same for linear and gamma */
+CONV (y16_yF,                     uint16_t, float,    load_u16,   store_float, 1, op_none)
+CONV (ya16_yaF,                   uint16_t, float,    load_u16,   store_float, 2, op_none)
+CONV (rgb16_rgbF,                 uint16_t, float,    load_u16,   store_float, 3, op_none)
+CONV (rgba16_rgbaF,               uint16_t, float,    load_u16,   store_float, 4, op_none)
+CONV (yF_y16,                     float,    uint16_t, load_float, store_u16,   1, op_none)
+CONV (yaF_ya16,                   float,    uint16_t, load_float, store_u16,   2, op_none)
+CONV (rgbF_rgb16,                 float,    uint16_t, load_float, store_u16,   3, op_none)
+CONV (rgbaF_rgba16,               float,    uint16_t, load_float, store_u16,   4, op_none)
+
+CONV (ya16_yAF,                   uint16_t, float,    load_u16,   store_float, 2, op_premultiply)
+CONV (rgba16_rgbAF,               uint16_t, float,    load_u16,   store_float, 4, op_premultiply)
+CONV (yAF_ya16,                   float,    uint16_t, load_float, store_u16,   2, op_unpremultiply)
+CONV (rgbAF_rgba16,               float,    uint16_t, load_float, store_u16,   4, op_unpremultiply)
+
+/* between the gamma u16 and the linear float variant */
+CONV (y16_gamma_yF_linear,        uint16_t, float,    load_u16,   store_float, 1, op_to_linear)
+CONV (ya16_gamma_yaF_linear,      uint16_t, float,    load_u16,   store_float, 2, op_to_linear)
+CONV (rgb16_gamma_rgbF_linear,    uint16_t, float,    load_u16,   store_float, 3, op_to_linear)
+CONV (rgba16_gamma_rgbaF_linear,  uint16_t, float,    load_u16,   store_float, 4, op_to_linear)
+CONV (yF_linear_y16_gamma,        float,    uint16_t, load_float, store_u16,   1, op_to_gamma)
+CONV (yaF_linear_ya16_gamma,      float,    uint16_t, load_float, store_u16,   2, op_to_gamma)
+CONV (rgbF_linear_rgb16_gamma,    float,    uint16_t, load_float, store_u16,   3, op_to_gamma)
+CONV (rgbaF_linear_rgba16_gamma,  float,    uint16_t, load_float, store_u16,   4, op_to_gamma)
+
+CONV (ya16_gamma_yAF_linear,      uint16_t, float,    load_u16,   store_float, 2, op_to_linear_premultiply)
+CONV (rgba16_gamma_rgbAF_linear,  uint16_t, float,    load_u16,   store_float, 4, op_to_linear_premultiply)
+CONV (yAF_linear_ya16_gamma,      float,    uint16_t, load_float, store_u16,   2, op_unpremultiply_to_gamma)
+CONV (rgbAF_linear_rgba16_gamma,  float,    uint16_t, load_float, store_u16,   4, op_unpremultiply_to_gamma)
+
+/* the same, from and to big endian u16 */
+CONV (y16be_yF,                     uint16_t, float,    load_u16be, store_float, 1, op_none)
+CONV (ya16be_yaF,                   uint16_t, float,    load_u16be, store_float, 2, op_none)
+CONV (rgb16be_rgbF,                 uint16_t, float,    load_u16be, store_float, 3, op_none)
+CONV (rgba16be_rgbaF,               uint16_t, float,    load_u16be, store_float, 4, op_none)
+CONV (yF_y16be,                     float,    uint16_t, load_float, store_u16be, 1, op_none)
+CONV (yaF_ya16be,                   float,    uint16_t, load_float, store_u16be, 2, op_none)
+CONV (rgbF_rgb16be,                 float,    uint16_t, load_float, store_u16be, 3, op_none)
+CONV (rgbaF_rgba16be,               float,    uint16_t, load_float, store_u16be, 4, op_none)
+
+CONV (ya16be_yAF,                   uint16_t, float,    load_u16be, store_float, 2, op_premultiply)
+CONV (rgba16be_rgbAF,               uint16_t, float,    load_u16be, store_float, 4, op_premultiply)
+CONV (yAF_ya16be,                   float,    uint16_t, load_float, store_u16be, 2, op_unpremultiply)
+CONV (rgbAF_rgba16be,               float,    uint16_t, load_float, store_u16be, 4, op_unpremultiply)
+
+CONV (y16be_gamma_yF_linear,        uint16_t, float,    load_u16be, store_float, 1, op_to_linear)
+CONV (ya16be_gamma_yaF_linear,      uint16_t, float,    load_u16be, store_float, 2, op_to_linear)
+CONV (rgb16be_gamma_rgbF_linear,    uint16_t, float,    load_u16be, store_float, 3, op_to_linear)
+CONV (rgba16be_gamma_rgbaF_linear,  uint16_t, float,    load_u16be, store_float, 4, op_to_linear)
+CONV (yF_linear_y16be_gamma,        float,    uint16_t, load_float, store_u16be, 1, op_to_gamma)
+CONV (yaF_linear_ya16be_gamma,      float,    uint16_t, load_float, store_u16be, 2, op_to_gamma)
+CONV (rgbF_linear_rgb16be_gamma,    float,    uint16_t, load_float, store_u16be, 3, op_to_gamma)
+CONV (rgbaF_linear_rgba16be_gamma,  float,    uint16_t, load_float, store_u16be, 4, op_to_gamma)
+
+CONV (ya16be_gamma_yAF_linear,      uint16_t, float,    load_u16be, store_float, 2, op_to_linear_premultiply)
+CONV (rgba16be_gamma_rgbAF_linear,  uint16_t, float,    load_u16be, store_float, 4, op_to_linear_premultiply)
+CONV (yAF_linear_ya16be_gamma,      float,    uint16_t, load_float, store_u16be, 2, op_unpremultiply_to_gamma)
+CONV (rgbAF_linear_rgba16be_gamma,  float,    uint16_t, load_float, store_u16be, 4, op_unpremultiply_to_gamma)
+
+/* bfloat16, the same for linear and gamma */
+CONV (yBf16_yF,                     uint16_t, float,    load_bfloat16, store_float,    1, op_none)
+CONV (yaBf16_yaF,                   uint16_t, float,    load_bfloat16, store_float,    2, op_none)
+CONV (rgbBf16_rgbF,                 uint16_t, float,    load_bfloat16, store_float,    3, op_none)
+CONV (rgbaBf16_rgbaF,               uint16_t, float,    load_bfloat16, store_float,    4, op_none)
+CONV (yF_yBf16,                     float,    uint16_t, load_float,    store_bfloat16, 1, op_none)
+CONV (yaF_yaBf16,                   float,    uint16_t, load_float,    store_bfloat16, 2, op_none)
+CONV (rgbF_rgbBf16,                 float,    uint16_t, load_float,    store_bfloat16, 3, op_none)
+CONV (rgbaF_rgbaBf16,               float,    uint16_t, load_float,    store_bfloat16, 4, op_none)
+CONV (y8_yBf16,                     uint8_t,  uint16_t, load_u8,       store_bfloat16, 1, op_none)
+CONV (rgba8_rgbaBf16,               uint8_t,  uint16_t, load_u8,       store_bfloat16, 4, op_none)
+
+#undef CONV
+
+
+/* u16 <-> u8, the same for all models */
+
+static inline __m256i
+bswap16 (__m256i x)
+{
+  return _mm256_shuffle_epi8 (x, _mm256_broadcastsi128_si256 (BSWAP16));
+}
+
+/* swap, for big endian u16, is constant at every call site and folded
+ * away where it is 0
+ */
+static inline void
+u16_u8 (const uint16_t *src,
+        uint8_t        *dst,
+        long            n,
+        int             swap)
+{
+  for (; n >= 32; n -= 32)
+    {
+      __m256i a = _mm256_loadu_si256 ((const __m256i *) src);
+      __m256i b = _mm256_loadu_si256 ((const __m256i *) src + 1);
+
+      if (swap)
+        {
+          a = bswap16 (a);
+          b = bswap16 (b);
+        }
+
+      /* round (x / 257), as (t - t / 256) / 256 with t = x + 128 - which
+       * may saturate, without changing the result
+       */
+      a = _mm256_adds_epu16 (a, _mm256_set1_epi16 (128));
+      b = _mm256_adds_epu16 (b, _mm256_set1_epi16 (128));
+      a = _mm256_srli_epi16 (_mm256_sub_epi16 (a, _mm256_srli_epi16 (a, 8)), 8);
+      b = _mm256_srli_epi16 (_mm256_sub_epi16 (b, _mm256_srli_epi16 (b, 8)), 8);
+
+      _mm256_storeu_si256 ((__m256i *) dst,
+                           _mm256_permute4x64_epi64 (_mm256_packus_epi16 (a, b),
+                                                     _MM_SHUFFLE (3, 1, 2, 0)));
+
+      src += 32;
+      dst += 32;
+    }
+
+  for (; n; n--)
+    {
+      unsigned int x = *src++;
+      unsigned int t = (swap ? (x >> 8 | x << 8) & 0xffff : x) + 128;
+
+      if (t > 65535)
+        t = 65535;
+      *dst++ = (t - (t >> 8)) >> 8;
+    }
+}
+
+static inline void
+u8_u16 (const uint8_t *src,
+        uint16_t      *dst,
+        long           n)
+{
+  for (; n >= 16; n -= 16)
+    {
+      __m256i x = _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i *) src));
+
+      _mm256_storeu_si256 ((__m256i *) dst,
+                           _mm256_or_si256 (x, _mm256_slli_epi16 (x, 8)));
+
+      src += 16;
+      dst += 16;
+    }
+
+  for (; n; n--)
+    *dst++ = *src++ * 257;
+}
+
+#define CONV(name, src_type, dst_type, components, call)                 \
+static void                                                              \
+conv_ ## name (const Babl     *conversion,                               \
+               const src_type *src,                                      \
+               dst_type       *dst,                                      \
+               long            samples)                                  \
+{                                                                        \
+  const long n = samples * components;                                   \
+                                                                         \
+  call;                                                                  \
+}
+
+CONV (y16_y8,         uint16_t, uint8_t,  1, u16_u8 (src, dst, n, 0))
+CONV (ya16_ya8,       uint16_t, uint8_t,  2, u16_u8 (src, dst, n, 0))
+CONV (rgb16_rgb8,     uint16_t, uint8_t,  3, u16_u8 (src, dst, n, 0))
+CONV (rgba16_rgba8,   uint16_t, uint8_t,  4, u16_u8 (src, dst, n, 0))
+CONV (y8_y16,         uint8_t,  uint16_t, 1, u8_u16 (src, dst, n))
+CONV (ya8_ya16,       uint8_t,  uint16_t, 2, u8_u16 (src, dst, n))
+CONV (rgb8_rgb16,     uint8_t,  uint16_t, 3, u8_u16 (src, dst, n))
+CONV (rgba8_rgba16,   uint8_t,  uint16_t, 4, u8_u16 (src, dst, n))
+
+CONV (y16be_y8,       uint16_t, uint8_t,  1, u16_u8 (src, dst, n, 1))
+CONV (ya16be_ya8,     uint16_t, uint8_t,  2, u16_u8 (src, dst, n, 1))
+CONV (rgb16be_rgb8,   uint16_t, uint8_t,  3, u16_u8 (src, dst, n, 1))
+CONV (rgba16be_rgba8, uint16_t, uint8_t,  4, u16_u8 (src, dst, n, 1))
+/* x * 257 has equal bytes, and reads the same in both byte orders */
+CONV (y8_y16be,       uint8_t,  uint16_t, 1, u8_u16 (src, dst, n))
+CONV (ya8_ya16be,     uint8_t,  uint16_t, 2, u8_u16 (src, dst, n))
+CONV (rgb8_rgb16be,   uint8_t,  uint16_t, 3, u8_u16 (src, dst, n))
+CONV (rgba8_rgba16be, uint8_t,  uint16_t, 4, u8_u16 (src, dst, n))
+
+#undef CONV
+
+static const Babl *
+format (const char *model,
+        const char *type,
+        const char *c0,
+        const char *c1,
+        const char *c2,
+        const char *c3)
+{
+  return babl_format_new (babl_model (model),
+                          babl_type (type),
+                          babl_component (c0),
+                          c1 ? babl_component (c1) : NULL,
+                          c2 ? babl_component (c2) : NULL,
+                          c3 ? babl_component (c3) : NULL,
+                          NULL);
+}
+
+#endif /* defined(USE_AVX2) */
+
+int init (void);
+
+int
+init (void)
+{
+#if defined(USE_AVX2)
+
+  const Babl *yF_linear     = format ("Y",          "float", "Y",   NULL,  NULL,  NULL);
+  const Babl *yF_gamma      = format ("Y'",         "float", "Y'",  NULL,  NULL,  NULL);
+  const Babl *yaF_linear    = format ("YA",         "float", "Y",   "A",   NULL,  NULL);
+  const Babl *yaF_gamma     = format ("Y'A",        "float", "Y'",  "A",   NULL,  NULL);
+  const Babl *yAF_linear    = format ("YaA",        "float", "Ya",  "A",   NULL,  NULL);
+  const Babl *yAF_gamma     = format ("Y'aA",       "float", "Y'a", "A",   NULL,  NULL);
+  const Babl *rgbF_linear   = format ("RGB",        "float", "R",   "G",   "B",   NULL);
+  const Babl *rgbF_gamma    = format ("R'G'B'",     "float", "R'",  "G'",  "B'",  NULL);
+  const Babl *rgbaF_linear  = format ("RGBA",       "float", "R",   "G",   "B",   "A");
+  const Babl *rgbaF_gamma   = format ("R'G'B'A",    "float", "R'",  "G'",  "B'",  "A");
+  const Babl *rgbAF_linear  = format ("RaGaBaA",    "float", "Ra",  "Ga",  "Ba",  "A");
+  const Babl *rgbAF_gamma   = format ("R'aG'aB'aA", "float", "R'a", "G'a", "B'a", "A");
+
+  const Babl *y16_linear    = format ("Y",          "u16",   "Y",   NULL,  NULL,  NULL);
+  const Babl *y16_gamma     = format ("Y'",         "u16",   "Y'",  NULL,  NULL,  NULL);
+  const Babl *ya16_linear   = format ("YA",         "u16",   "Y",   "A",   NULL,  NULL);
+  const Babl *ya16_gamma    = format ("Y'A",        "u16",   "Y'",  "A",   NULL,  NULL);
+  const Babl *rgb16_linear  = format ("RGB",        "u16",   "R",   "G",   "B",   NULL);
+  const Babl *rgb16_gamma   = format ("R'G'B'",     "u16",   "R'",  "G'",  "B'",  NULL);
+  const Babl *rgba16_linear = format ("RGBA",       "u16",   "R",   "G",   "B",   "A");
+  const Babl *rgba16_gamma  = format ("R'G'B'A",    "u16",   "R'",  "G'",  "B'",  "A");
+
+  const Babl *yBf16_linear    = format ("Y",       "bfloat16", "Y",   NULL,  NULL,  NULL);
+  const Babl *yBf16_gamma     = format ("Y'",      "bfloat16", "Y'",  NULL,  NULL,  NULL);
+  const Babl *yaBf16_linear   = format ("YA",      "bfloat16", "Y",   "A",   NULL,  NULL);
+  const Babl *yaBf16_gamma    = format ("Y'A",     "bfloat16", "Y'",  "A",   NULL,  NULL);
+  const Babl *rgbBf16_linear  = format ("RGB",     "bfloat16", "R",   "G",   "B",   NULL);
+  const Babl *rgbBf16_gamma   = format ("R'G'B'",  "bfloat16", "R'",  "G'",  "B'",  NULL);
+  const Babl *rgbaBf16_linear = format ("RGBA",    "bfloat16", "R",   "G",   "B",   "A");
+  const Babl *rgbaBf16_gamma  = format ("R'G'B'A", "bfloat16", "R'",  "G'",  "B'",  "A");
+
+  const Babl *y16be_linear    = format ("Y",       "u16be", "Y",   NULL,  NULL,  NULL);
+  const Babl *y16be_gamma     = format ("Y'",      "u16be", "Y'",  NULL,  NULL,  NULL);
+  const Babl *ya16be_linear   = format ("YA",      "u16be", "Y",   "A",   NULL,  NULL);
+  const Babl *ya16be_gamma    = format ("Y'A",     "u16be", "Y'",  "A",   NULL,  NULL);
+  const Babl *rgb16be_linear  = format ("RGB",     "u16be", "R",   "G",   "B",   NULL);
+  const Babl *rgb16be_gamma   = format ("R'G'B'",  "u16be", "R'",  "G'",  "B'",  NULL);
+  const Babl *rgba16be_linear = format ("RGBA",    "u16be", "R",   "G",   "B",   "A");
+  const Babl *rgba16be_gamma  = format ("R'G'B'A", "u16be", "R'",  "G'",  "B'",  "A");
+
+  const Babl *y8_linear     = format ("Y",          "u8",    "Y",   NULL,  NULL,  NULL);
+  const Babl *y8_gamma      = format ("Y'",         "u8",    "Y'",  NULL,  NULL,  NULL);
+  const Babl *ya8_linear    = format ("YA",         "u8",    "Y",   "A",   NULL,  NULL);
+  const Babl *ya8_gamma     = format ("Y'A",        "u8",    "Y'",  "A",   NULL,  NULL);
+  const Babl *rgb8_linear   = format ("RGB",        "u8",    "R",   "G",   "B",   NULL);
+  const Babl *rgb8_gamma    = format ("R'G'B'",     "u8",    "R'",  "G'",  "B'",  NULL);
+  const Babl *rgba8_linear  = format ("RGBA",       "u8",    "R",   "G",   "B",   "A");
+  const Babl *rgba8_gamma   = format ("R'G'B'A",    "u8",    "R'",  "G'",  "B'",  "A");
+
+/* between the u16 gamma and the float linear variant of a format */
+#define TRC(src, dst)                                                    \
+  babl_conversion_new (src ## _gamma, dst ## _linear, "linear",          \
+                       conv_ ## src ## _gamma_ ## dst ## _linear,        \
+                       "accel", BABL_CPU_ACCEL_X86_AVX2, NULL);          \
+  babl_conversion_new (dst ## _linear, src ## _gamma, "linear",          \
+                       conv_ ## dst ## _linear_ ## src ## _gamma,        \
+                       "accel", BABL_CPU_ACCEL_X86_AVX2, NULL)
+
+/* between types, for both the linear and the gamma variant */
+#define TYPE(src, dst)                                                   \
+  babl_conversion_new (src ## _linear, dst ## _linear, "linear",         \
+                       conv_ ## src ## _ ## dst,                         \
+                       "accel", BABL_CPU_ACCEL_X86_AVX2, NULL);          \
+  babl_conversion_new (src ## _gamma, dst ## _gamma, "linear",           \
+                       conv_ ## src ## _ ## dst,                         \
+                       "accel", BABL_CPU_ACCEL_X86_AVX2, NULL)
+
+  TYPE (y16,    yF);
+  TYPE (ya16,   yaF);
+  TYPE (rgb16,  rgbF);
+  TYPE (rgba16, rgbaF);
+  TYPE (yF,     y16);
+  TYPE (yaF,    ya16);
+  TYPE (rgbF,   rgb16);
+  TYPE (rgbaF,  rgba16);
+
+  TYPE (ya16,   yAF);
+  TYPE (rgba16, rgbAF);
+  TYPE (yAF,    ya16);
+  TYPE (rgbAF,  rgba16);
+
+  TRC (y16,    yF);
+  TRC (ya16,   yaF);
+  TRC (rgb16,  rgbF);
+  TRC (rgba16, rgbaF);
+  TRC (ya16,   yAF);
+  TRC (rgba16, rgbAF);
+
+  TYPE (y16,    y8);
+  TYPE (ya16,   ya8);
+  TYPE (rgb16,  rgb8);
+  TYPE (rgba16, rgba8);
+  TYPE (y8,     y16);
+  TYPE (ya8,    ya16);
+  TYPE (rgb8,   rgb16);
+  TYPE (rgba8,  rgba16);
+
+  TYPE (y16be,    yF);
+  TYPE (ya16be,   yaF);
+  TYPE (rgb16be,  rgbF);
+  TYPE (rgba16be, rgbaF);
+  TYPE (yF,       y16be);
+  TYPE (yaF,      ya16be);
+  TYPE (rgbF,     rgb16be);
+  TYPE (rgbaF,    rgba16be);
+
+  TYPE (ya16be,   yAF);
+  TYPE (rgba16be, rgbAF);
+  TYPE (yAF,      ya16be);
+  TYPE (rgbAF,    rgba16be);
+
+  TRC (y16be,    yF);
+  TRC (ya16be,   yaF);
+  TRC (rgb16be,  rgbF);
+  TRC (rgba16be, rgbaF);
+  TRC (ya16be,   yAF);
+  TRC (rgba16be, rgbAF);
+
+  TYPE (y16be,    y8);
+  TYPE (ya16be,   ya8);
+  TYPE (rgb16be,  rgb8);
+  TYPE (rgba16be, rgba8);
+  TYPE (y8,       y16be);
+  TYPE (ya8,      ya16be);
+  TYPE (rgb8,     rgb16be);
+  TYPE (rgba8,    rgba16be);
+
+  TYPE (yBf16,    yF);
+  TYPE (yaBf16,   yaF);
+  TYPE (rgbBf16,  rgbF);
+  TYPE (rgbaBf16, rgbaF);
+  TYPE (yF,       yBf16);
+  TYPE (yaF,      yaBf16);
+  TYPE (rgbF,     rgbBf16);
+  TYPE (rgbaF,    rgbaBf16);
+  TYPE (y8,       yBf16);
+  TYPE (rgba8,    rgbaBf16);
+
+#undef TRC
+#undef TYPE
+
+#endif /* defined(USE_AVX2) */
+
+  return 0;
+}
@@ -335,6 +335,97 @@ conv_rgbaF_linear_rgba8_gamma (const Babl  *conversion,
     }
 }
 
+/* float -> u8 without a TRC, the same for linear and gamma */
+static inline void
+conv_yF_y8 (const Babl  *conversion,
+            const float *src,
+            uint8_t     *dst,
+            long         samples)
+{
+  const __v8sf scale = _mm256_set1_ps (255.0f);
+  const __v8sf zero  = _mm256_setzero_ps ();
+  const __v8sf half  = _mm256_set1_ps (0.5f);
+
+  while (samples >= 32)
+    {
+      __m256i i32_0, i32_1, i32_2, i32_3;
+      __m256i i16_01,       i16_23;
+      __m256i i8_0123;
+
+      #define CVT8(i)                                                  \
+        do                                                             \
+          {                                                            \
+            __v8sf yyyyyyyy;                                           \
+                                                                       \
+            yyyyyyyy = scale * (__v8sf) _mm256_loadu_ps (src + 8 * i)  \
+                       + half;                                         \
+            yyyyyyyy = _mm256_max_ps (yyyyyyyy, zero);                 \
+            yyyyyyyy = _mm256_min_ps (yyyyyyyy, scale);                \
+            i32_##i  = _mm256_cvttps_epi32 (yyyyyyyy);                 \
+          }                                                            \
+        while (0)
+
+      CVT8 (0);
+      CVT8 (1);
+
+      i16_01 = _mm256_packus_epi32 (i32_0, i32_1);
+
+      CVT8 (2);
+      CVT8 (3);
+
+      i16_23 = _mm256_packus_epi32 (i32_2, i32_3);
+
+      i8_0123 = _mm256_packus_epi16 (i16_01, i16_23);
+      i8_0123 = _mm256_permutevar8x32_epi32 (
+        i8_0123,
+        _mm256_setr_epi32 (0, 4, 1, 5,
+                           2, 6, 3, 7));
+
+      _mm256_storeu_si256 ((__m256i *) dst, i8_0123);
+
+      #undef CVT8
+
+      src += 32;
+      dst += 32;
+
+      samples -= 32;
+    }
+
+  while (samples > 0)
+    {
+      CVTA1 (src, dst);
+
+      samples--;
+    }
+}
+
+static void
+conv_yaF_ya8 (const Babl  *conversion,
+              const float *src,
+              uint8_t     *dst,
+              long         samples)
+{
+  conv_yF_y8 (conversion, src, dst, 2 * samples);
+}
+
+static void
+conv_rgbF_rgb8 (const Babl  *conversion,
+                const float *src,
+                uint8_t     *dst,
+                long         samples)
+{
+  conv_yF_y8 (conversion, src, dst, 3 * samples);
+}
+
+static void
+conv_rgbaF_rgba8 (const Babl  *conversion,
+                  const float *src,
+                  uint8_t     *dst,
+                  long         samples)
+{
+  conv_yF_y8 (conversion, src, dst, 4 * samples);
+}
+
 #undef CVT1
 #undef CVTA1
 
@@ -578,6 +669,59 @@ init (void)
     babl_component ("A"),
     NULL);
 
+  const Babl *yF_gamma = babl_format_new (
+    babl_model ("Y'"),
+    babl_type ("float"),
+    babl_component ("Y'"),
+    NULL);
+  const Babl *y8_linear = babl_format_new (
+    babl_model ("Y"),
+    babl_type ("u8"),
+    babl_component ("Y"),
+    NULL);
+  const Babl *yaF_gamma = babl_format_new (
+    babl_model ("Y'A"),
+    babl_type ("float"),
+    babl_component ("Y'"),
+    babl_component ("A"),
+    NULL);
+  const Babl *ya8_linear = babl_format_new (
+    babl_model ("YA"),
+    babl_type ("u8"),
+    babl_component ("Y"),
+    babl_component ("A"),
+    NULL);
+  const Babl *rgbF_gamma = babl_format_new (
+    babl_model ("R'G'B'"),
+    babl_type ("float"),
+    babl_component ("R'"),
+    babl_component ("G'"),
+    babl_component ("B'"),
+    NULL);
+  const Babl *rgb8_linear = babl_format_new (
+    babl_model ("RGB"),
+    babl_type ("u8"),
+    babl_component ("R"),
+    babl_component ("G"),
+    babl_component ("B"),
+    NULL);
+  const Babl *rgbaF_gamma = babl_format_new (
+    babl_model ("R'G'B'A"),
+    babl_type ("float"),
+    babl_component ("R'"),
+    babl_component ("G'"),
+    babl_component ("B'"),
+    babl_component ("A"),
+    NULL);
+  const Babl *rgba8_linear = babl_format_new (
+    babl_model ("RGBA"),
+    babl_type ("u8"),
+    babl_component ("R"),
+    babl_component ("G"),
+    babl_component ("B"),
+    babl_component ("A"),
+    NULL);
+
 #define CONV(src, dst)                                                \
   do                                                                  \
     {                                                                 \
@@ -585,23 +729,47 @@ init (void)
                            dst ## _gamma,                             \
                            "linear",                                  \
                            conv_ ## src ## _linear_ ## dst ## _gamma, \
+                           "accel", BABL_CPU_ACCEL_X86_AVX2,          \
                            NULL);                                     \
                                                                       \
       babl_conversion_new (dst ## _gamma,                             \
                            src ## _linear,                            \
                            "linear",                                  \
                            conv_ ## dst ## _gamma_ ## src ## _linear, \
+                           "accel", BABL_CPU_ACCEL_X86_AVX2,          \
                            NULL);                                     \
     }                                                                 \
   while (0)
 
-  if ((babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_AVX2))
-    {
-      CONV (yF,    y8);
-      CONV (yaF,   ya8);
-      CONV (rgbF,  rgb8);
-      CONV (rgbaF, rgba8);
-    }
+  CONV (yF,    y8);
+  CONV (yaF,   ya8);
+  CONV (rgbF,  rgb8);
+  CONV (rgbaF, rgba8);
+
+/* between types, for both the linear and the gamma variant */
+#define TYPE(src, dst)                                                \
+  do                                                                  \
+    {                                                                 \
+      babl_conversion_new (src ## _linear,                            \
+                           dst ## _linear,                            \
+                           "linear",                                  \
+                           conv_ ## src ## _ ## dst,                  \
+                           "accel", BABL_CPU_ACCEL_X86_AVX2,          \
+                           NULL);                                     \
+                                                                      \
+      babl_conversion_new (src ## _gamma,                             \
+                           dst ## _gamma,                             \
+                           "linear",                                  \
+                           conv_ ## src ## _ ## dst,                  \
+                           "accel", BABL_CPU_ACCEL_X86_AVX2,          \
+                           NULL);                                     \
+    }                                                                 \
+  while (0)
+
+  TYPE (yF,    y8);
+  TYPE (yaF,   ya8);
+  TYPE (rgbF,  rgb8);
+  TYPE (rgbaF, rgba8);
 
 #endif /* defined(USE_AVX2) */
 
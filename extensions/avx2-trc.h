@@ -0,0 +1,102 @@
+/* The sRGB TRC between float linear and gamma for AVX2, the
+ * approximations of sse2-float, shared by avx2-int16 and CIE-avx2.
+ * Include after <immintrin.h> and <math.h>.
+ */
+
+#define splat8f(x)   _mm256_set1_ps (x)
+
+#define FLT_ONE      0x3f800000
+#define FLT_MANTISSA (1 << 23)
+
+static inline __m256
+avx2_init_newton (__m256 x,
+                  double exponent,
+                  double c0,
+                  double c1,
+                  double c2)
+{
+  double norm = exponent * M_LN2 / FLT_MANTISSA;
+  __m256 y    = _mm256_cvtepi32_ps (_mm256_sub_epi32 (_mm256_castps_si256 (x),
+                                                      _mm256_set1_epi32 (FLT_ONE)));
+
+  return splat8f (c0) + splat8f (c1 * norm) * y + splat8f (c2 * norm * norm) * y * y;
+}
+
+/* large values are out of the range of the newton iterations */
+static __attribute__((noinline)) __m256
+avx2_pow_accurate (__m256 y,
+                   __m256 x,
+                   int    lanes,
+                   float  exponent)
+{
+  float in[8], out[8];
+  int   i;
+
+  _mm256_storeu_ps (in, x);
+  _mm256_storeu_ps (out, y);
+  for (i = 0; i < 8; i++)
+    if (lanes & (1 << i))
+      out[i] = expf (logf (in[i]) * exponent);
+
+  return _mm256_loadu_ps (out);
+}
+
+static inline __m256
+avx2_pow_1_24 (__m256 x)
+{
+  int    large = _mm256_movemask_ps (_mm256_cmp_ps (x, splat8f (1024.0f), _CMP_GT_OQ));
+  __m256 y, z, s;
+
+  y = avx2_init_newton (x, -1./12, 0.9976800269, 0.9885126933, 0.5908575383);
+  s = _mm256_sqrt_ps (x);
+  /* newton's method for x^(-1/6) */
+  z = splat8f (1.f/6.f) * s;
+  y = splat8f (7.f/6.f) * y - z * ((y*y)*(y*y)*(y*y*y));
+  y = splat8f (7.f/6.f) * y - z * ((y*y)*(y*y)*(y*y*y));
+  y = s * y;
+
+  if (large)
+    y = avx2_pow_accurate (y, x, large, 1.0f / 2.4f);
+  return y;
+}
+
+static inline __m256
+avx2_pow_24 (__m256 x)
+{
+  int    large = _mm256_movemask_ps (_mm256_cmp_ps (x, splat8f (16.0f), _CMP_GT_OQ));
+  __m256 y, z, s;
+
+  y = avx2_init_newton (x, -1./5, 0.9953189663, 0.9594345146, 0.6742970332);
+  /* newton's method for x^(-1/5) */
+  z = splat8f (1.f/5.f) * x;
+  y = splat8f (6.f/5.f) * y - z * ((y*y*y)*(y*y*y));
+  y = splat8f (6.f/5.f) * y - z * ((y*y*y)*(y*y*y));
+  s = x * y;
+  y = s * s * s;
+
+  if (large)
+    y = avx2_pow_accurate (y, x, large, 2.4f);
+  return y;
+}
+
+static inline __m256
+linear_to_gamma_2_2_avx2 (__m256 x)
+{
+  __m256 curve = avx2_pow_1_24 (x) * splat8f (1.055f) -
+                 splat8f (0.055f - 3.0f / (float) (1 << 24));
+                 /* ^ offset the result such that 1 maps to 1 */
+  __m256 line  = x * splat8f (12.92f);
+  __m256 mask  = _mm256_cmp_ps (x, splat8f (0.003130804954f), _CMP_GT_OQ);
+
+  return _mm256_blendv_ps (line, curve, mask);
+}
+
+static inline __m256
+gamma_2_2_to_linear_avx2 (__m256 x)
+{
+  __m256 curve = avx2_pow_24 ((x + splat8f (0.055f)) * splat8f (1/1.055f));
+  __m256 line  = x * splat8f (1/12.92f);
+  __m256 mask  = _mm256_cmp_ps (x, splat8f (0.04045f), _CMP_GT_OQ);
+
+  return _mm256_blendv_ps (line, curve, mask);
+}
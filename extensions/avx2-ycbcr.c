@@ -0,0 +1,382 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* AVX2 decoding of horizontally subsampled 8 bit Y'CbCr - 4:2:0, 4:2:2 and
+ * NV12 - to "R'G'B'A u8" and "RGBA float". The conversions are registered as
+ * planar conversions and are handed one row of every plane at a time by
+ * babl_process_planar (), vertical subsampling is taken care of there.
+ *
+ * The Y'CbCr model is defined on sRGB encoded R'G'B', for R'G'B' output the
+ * matrix is all there is to it, for linear output the sRGB TRC is applied
+ * with a linearly interpolated table.
+ */
+
+#include "config.h"
+
+#if defined(USE_AVX2)
+
+/* AVX 2 */
+#include <immintrin.h>
+
+#include <stdint.h>
+#include <math.h>
+
+#include "babl.h"
+#include "babl-cpuaccel.h"
+
+#define TRC_RANGE  2             /* R'G'B' values of in range Y'CbCr stay below */
+#define TRC_SCALE  2048          /* table entries per unit */
+#define TRC_SIZE   (TRC_RANGE * TRC_SCALE + 2)
+
+static float trc_table[TRC_SIZE];
+
+static void
+trc_table_init (void)
+{
+  int i;
+
+  for (i = 0; i < TRC_SIZE; i++)
+    {
+      double value = i / (double) TRC_SCALE;
+
+      if (value > 0.04045)
+        trc_table[i] = pow ((value + 0.055) / 1.055, 2.4);
+      else
+        trc_table[i] = value / 12.92;
+    }
+}
+
+static inline float
+trc_to_linear (float value)
+{
+  float t;
+  int   i;
+
+  if (value < 0.0f)
+    return value / 12.92f;
+
+  t = value * TRC_SCALE;
+  if (t > TRC_RANGE * TRC_SCALE)
+    t = TRC_RANGE * TRC_SCALE;
+  i = (int) t;
+  return trc_table[i] + (t - i) * (trc_table[i + 1] - trc_table[i]);
+}
+
+static inline __m256
+trc_to_linear_avx2 (__m256 value)
+{
+  const __m256 zero = _mm256_setzero_ps ();
+  __m256       t, a, b, linear;
+  __m256i      i;
+
+  t      = _mm256_min_ps (_mm256_mul_ps (_mm256_max_ps (value, zero),
+                                         _mm256_set1_ps (TRC_SCALE)),
+                          _mm256_set1_ps (TRC_RANGE * TRC_SCALE));
+  i      = _mm256_cvttps_epi32 (t);
+  a      = _mm256_i32gather_ps (trc_table, i, 4);
+  b      = _mm256_i32gather_ps (trc_table + 1, i, 4);
+  linear = _mm256_add_ps (a, _mm256_mul_ps (_mm256_sub_ps (t, _mm256_cvtepi32_ps (i)),
+                                            _mm256_sub_ps (b, a)));
+
+  return _mm256_blendv_ps (linear,
+                           _mm256_mul_ps (value, _mm256_set1_ps (1.0f / 12.92f)),
+                           _mm256_cmp_ps (value, zero, _CMP_LT_OQ));
+}
+
+/* 8 bit limited range to Y' 0.0..1.0 and Cb, Cr -0.5..0.5, the u8-luma and
+ * u8-chroma types clamp out of range values
+ */
+#define LUMA_SCALE    (1.0f / 219.0f)
+#define CHROMA_SCALE  (1.0f / 224.0f)
+
+static inline void
+ycbcr_to_rgb (float  y,
+              float  cb,
+              float  cr,
+              float *rgb)
+{
+  rgb[0] = y + 1.40200f * cr;
+  rgb[1] = y - 0.344136f * cb - 0.71414136f * cr;
+  rgb[2] = y + 1.772f * cb;
+}
+
+static inline void
+decode_pixel (const uint8_t *y,
+              const uint8_t *cb,
+              const uint8_t *cr,
+              float         *rgb)
+{
+  int Y  = *y  < 16 ? 16 : *y  > 235 ? 235 : *y;
+  int Cb = *cb < 16 ? 16 : *cb > 240 ? 240 : *cb;
+  int Cr = *cr < 16 ? 16 : *cr > 240 ? 240 : *cr;
+
+  ycbcr_to_rgb ((Y - 16) * LUMA_SCALE,
+                (Cb - 16) * CHROMA_SCALE - 0.5f,
+                (Cr - 16) * CHROMA_SCALE - 0.5f,
+                rgb);
+}
+
+/* loads 8 chroma samples, for 16 pixels */
+static inline void
+load_chroma (const uint8_t *cb,
+             const uint8_t *cr,
+             int            chroma_pitch,
+             __m256        *cb_out,
+             __m256        *cr_out)
+{
+  __m256i cb_i, cr_i;
+
+  if (chroma_pitch == 2) /* interleaved, NV12 */
+    {
+      __m128i cbcr = _mm_loadu_si128 ((const __m128i *) cb);
+
+      cb_i = _mm256_cvtepu16_epi32 (_mm_and_si128 (cbcr, _mm_set1_epi16 (0xff)));
+      cr_i = _mm256_cvtepu16_epi32 (_mm_srli_epi16 (cbcr, 8));
+    }
+  else
+    {
+      cb_i = _mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((const __m128i *) cb));
+      cr_i = _mm256_cvtepu8_epi32 (_mm_loadl_epi64 ((const __m128i *) cr));
+    }
+
+  cb_i = _mm256_min_epi32 (_mm256_max_epi32 (cb_i, _mm256_set1_epi32 (16)),
+                           _mm256_set1_epi32 (240));
+  cr_i = _mm256_min_epi32 (_mm256_max_epi32 (cr_i, _mm256_set1_epi32 (16)),
+                           _mm256_set1_epi32 (240));
+
+  *cb_out = _mm256_sub_ps (_mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_sub_epi32 (cb_i, _mm256_set1_epi32 (16))),
+                                          _mm256_set1_ps (CHROMA_SCALE)),
+                           _mm256_set1_ps (0.5f));
+  *cr_out = _mm256_sub_ps (_mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_sub_epi32 (cr_i, _mm256_set1_epi32 (16))),
+                                          _mm256_set1_ps (CHROMA_SCALE)),
+                           _mm256_set1_ps (0.5f));
+}
+
+static inline __m256
+load_luma (__m128i y8)
+{
+  __m256i y_i = _mm256_cvtepu8_epi32 (y8);
+
+  y_i = _mm256_min_epi32 (_mm256_max_epi32 (y_i, _mm256_set1_epi32 (16)),
+                          _mm256_set1_epi32 (235));
+  return _mm256_mul_ps (_mm256_cvtepi32_ps (_mm256_sub_epi32 (y_i, _mm256_set1_epi32 (16))),
+                        _mm256_set1_ps (LUMA_SCALE));
+}
+
+static inline void
+ycbcr_to_rgb_avx2 (__m256  y,
+                   __m256  cb,
+                   __m256  cr,
+                   __m256 *r,
+                   __m256 *g,
+                   __m256 *b)
+{
+  *r = _mm256_add_ps (y, _mm256_mul_ps (cr, _mm256_set1_ps (1.40200f)));
+  *g = _mm256_sub_ps (_mm256_sub_ps (y, _mm256_mul_ps (cb, _mm256_set1_ps (0.344136f))),
+                      _mm256_mul_ps (cr, _mm256_set1_ps (0.71414136f)));
+  *b = _mm256_add_ps (y, _mm256_mul_ps (cb, _mm256_set1_ps (1.772f)));
+}
+
+static inline __m256i
+to_u8 (__m256 value)
+{
+  value = _mm256_mul_ps (value, _mm256_set1_ps (255.0f));
+  value = _mm256_min_ps (_mm256_max_ps (value, _mm256_setzero_ps ()),
+                         _mm256_set1_ps (255.0f));
+  return _mm256_cvtps_epi32 (value);
+}
+
+static inline void
+store_rgba8 (uint8_t *dst,
+             __m256   r,
+             __m256   g,
+             __m256   b)
+{
+  __m256i rgba = _mm256_or_si256 (
+                   _mm256_or_si256 (to_u8 (r),
+                                    _mm256_slli_epi32 (to_u8 (g), 8)),
+                   _mm256_or_si256 (_mm256_slli_epi32 (to_u8 (b), 16),
+                                    _mm256_set1_epi32 (0xff000000)));
+
+  _mm256_storeu_si256 ((__m256i *) dst, rgba);
+}
+
+static inline void
+store_rgbaf (float  *dst,
+             __m256  r,
+             __m256  g,
+             __m256  b)
+{
+  __m256 a  = _mm256_set1_ps (1.0f);
+  __m256 rg_lo = _mm256_unpacklo_ps (r, g);
+  __m256 rg_hi = _mm256_unpackhi_ps (r, g);
+  __m256 ba_lo = _mm256_unpacklo_ps (b, a);
+  __m256 ba_hi = _mm256_unpackhi_ps (b, a);
+  __m256 p0 = _mm256_shuffle_ps (rg_lo, ba_lo, _MM_SHUFFLE (1, 0, 1, 0));
+  __m256 p1 = _mm256_shuffle_ps (rg_lo, ba_lo, _MM_SHUFFLE (3, 2, 3, 2));
+  __m256 p2 = _mm256_shuffle_ps (rg_hi, ba_hi, _MM_SHUFFLE (1, 0, 1, 0));
+  __m256 p3 = _mm256_shuffle_ps (rg_hi, ba_hi, _MM_SHUFFLE (3, 2, 3, 2));
+
+  _mm256_storeu_ps (dst,      _mm256_permute2f128_ps (p0, p1, 0x20));
+  _mm256_storeu_ps (dst + 8,  _mm256_permute2f128_ps (p2, p3, 0x20));
+  _mm256_storeu_ps (dst + 16, _mm256_permute2f128_ps (p0, p1, 0x31));
+  _mm256_storeu_ps (dst + 24, _mm256_permute2f128_ps (p2, p3, 0x31));
+}
+
+static inline void
+decode_row (const uint8_t *y,
+            const uint8_t *cb,
+            const uint8_t *cr,
+            int            chroma_pitch,
+            uint8_t       *dst,
+            long           n,
+            int            to_float)
+{
+  const __m256i lo_pairs = _mm256_setr_epi32 (0, 0, 1, 1, 2, 2, 3, 3);
+  const __m256i hi_pairs = _mm256_setr_epi32 (4, 4, 5, 5, 6, 6, 7, 7);
+  long          x = 0;
+
+  for (; x + 16 <= n; x += 16)
+    {
+      __m128i y8 = _mm_loadu_si128 ((const __m128i *) (y + x));
+      __m256  cb_f, cr_f;
+      __m256  r, g, b;
+      int     half;
+
+      load_chroma (cb + (x / 2) * chroma_pitch,
+                   cr + (x / 2) * chroma_pitch,
+                   chroma_pitch, &cb_f, &cr_f);
+
+      for (half = 0; half < 2; half++)
+        {
+          __m256i pairs = half ? hi_pairs : lo_pairs;
+          __m256  y_f   = load_luma (half ? _mm_srli_si128 (y8, 8) : y8);
+
+          ycbcr_to_rgb_avx2 (y_f,
+                             _mm256_permutevar8x32_ps (cb_f, pairs),
+                             _mm256_permutevar8x32_ps (cr_f, pairs),
+                             &r, &g, &b);
+
+          if (to_float)
+            store_rgbaf ((float *) dst + (x + half * 8) * 4,
+                         trc_to_linear_avx2 (r),
+                         trc_to_linear_avx2 (g),
+                         trc_to_linear_avx2 (b));
+          else
+            store_rgba8 (dst + (x + half * 8) * 4, r, g, b);
+        }
+    }
+
+  for (; x < n; x++)
+    {
+      float rgb[3];
+      int   c;
+
+      decode_pixel (y + x,
+                    cb + (x / 2) * chroma_pitch,
+                    cr + (x / 2) * chroma_pitch,
+                    rgb);
+
+      if (to_float)
+        {
+          float *rgbaf = (float *) dst + x * 4;
+
+          for (c = 0; c < 3; c++)
+            rgbaf[c] = trc_to_linear (rgb[c]);
+          rgbaf[3] = 1.0f;
+        }
+      else
+        {
+          uint8_t *rgba8 = dst + x * 4;
+
+          for (c = 0; c < 3; c++)
+            {
+              float v = rgb[c] * 255.0f;
+              rgba8[c] = v <= 0.0f ? 0 : v >= 255.0f ? 255 : (int) lrintf (v);
+            }
+          rgba8[3] = 255;
+        }
+    }
+}
+
+#define CONV(name, chroma_pitch, to_float)                                    \
+static void                                                                   \
+conv_ ## name (const Babl  *conversion,                                       \
+               int          src_bands,                                        \
+               const char  *src[],                                            \
+               int          src_pitch[],                                      \
+               int          dst_bands,                                        \
+               char        *dst[],                                            \
+               int          dst_pitch[],                                      \
+               long         samples,                                          \
+               void        *user_data)                                        \
+{                                                                             \
+  decode_row ((const uint8_t *) src[0],                                       \
+              (const uint8_t *) src[1],                                       \
+              (const uint8_t *) src[2],                                       \
+              chroma_pitch,                                                   \
+              (uint8_t *) dst[0],                                             \
+              samples,                                                        \
+              to_float);                                                      \
+}
+
+CONV (ycbcr_h2_rgba8,      1, 0)
+CONV (ycbcr_h2_rgbaF,      1, 1)
+CONV (ycbcr_nv12_rgba8,    2, 0)
+CONV (ycbcr_nv12_rgbaF,    2, 1)
+
+#endif /* defined(USE_AVX2) */
+
+int init (void);
+
+int
+init (void)
+{
+#if defined(USE_AVX2)
+
+  const Babl *rgba8 = babl_format ("R'G'B'A u8");
+  const Babl *rgbaF = babl_format ("RGBA float");
+  const char *h2_formats[] = { "Y'CbCr u8", "Y'CbCr420 u8", "Y'CbCr422 u8" };
+  const Babl *nv12  = babl_format ("Y'CbCr NV12 u8");
+  int         i;
+
+  /* the tables are computed by code built for AVX2 as well */
+  if ((babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_AVX2))
+    {
+      trc_table_init ();
+
+      for (i = 0; i < sizeof (h2_formats) / sizeof (h2_formats[0]); i++)
+        {
+          const Babl *ycbcr = babl_format (h2_formats[i]);
+
+          babl_conversion_new (ycbcr, rgba8, "planar", conv_ycbcr_h2_rgba8,
+                               "accel", BABL_CPU_ACCEL_X86_AVX2, NULL);
+          babl_conversion_new (ycbcr, rgbaF, "planar", conv_ycbcr_h2_rgbaF,
+                               "accel", BABL_CPU_ACCEL_X86_AVX2, NULL);
+        }
+
+      babl_conversion_new (nv12, rgba8, "planar", conv_ycbcr_nv12_rgba8,
+                           "accel", BABL_CPU_ACCEL_X86_AVX2, NULL);
+      babl_conversion_new (nv12, rgbaF, "planar", conv_ycbcr_nv12_rgbaF,
+                           "accel", BABL_CPU_ACCEL_X86_AVX2, NULL);
+    }
+
+#endif /* defined(USE_AVX2) */
+
+  return 0;
+}
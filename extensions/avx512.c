@@ -0,0 +1,709 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* AVX-512 versions of the u8, u16, half and float conversions of the
+ * avx2-int8, sse2-int16, sse-half and sse2-float extensions, and of the
+ * bfloat16 ones of avx2-int16. They are registered alongside those, and
+ * path search takes whichever measures cheaper on the CPU at hand.
+ *
+ * All kernels work on 16 components at a time regardless of the number
+ * of components per pixel, alpha is told apart by a lane mask - 16 is a
+ * multiple of 1, 2 and 4 components, and 3 component formats have no
+ * alpha. The remaining components are handled with masked loads and
+ * stores rather than scalar loops.
+ */
+
+#include "config.h"
+
+#if defined(USE_AVX512)
+
+/* the GCC 12 avx512fintrin.h builds most intrinsics on top of
+ * _mm512_undefined_*(), which trips -Wmaybe-uninitialized once inlined
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <immintrin.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "babl.h"
+#include "babl-cpuaccel.h"
+#include "extensions/util.h"
+#include "extensions/avx2-int8-tables.h"
+
+#define TABLE_SIZE (sizeof (linear_to_gamma) / sizeof (linear_to_gamma[0]))
+#define SCALE      ((float) (TABLE_SIZE - 1))
+
+/* lanes holding alpha, for 1, 2 and 4 components per pixel */
+#define ALPHA_Y    ((__mmask16) 0x0000)
+#define ALPHA_YA   ((__mmask16) 0xaaaa)
+#define ALPHA_RGBA ((__mmask16) 0x8888)
+
+#define splat16f(x) _mm512_set1_ps (x)
+
+static inline __mmask16
+tail_mask (long n)
+{
+  return (__mmask16) ((1u << n) - 1);
+}
+
+
+/* u8 gamma <-> float linear, through the tables of avx2-int8 */
+
+static inline __m512i
+float_linear_to_u8_gamma (__m512    x,
+                          __mmask16 alpha)
+{
+  const __m512 scale = _mm512_mask_blend_ps (alpha, splat16f (SCALE),
+                                             splat16f (255.0f));
+  __m512i      i;
+
+  x = _mm512_add_ps (_mm512_mul_ps (x, scale), splat16f (0.5f));
+  x = _mm512_min_ps (_mm512_max_ps (x, _mm512_setzero_ps ()), scale);
+  i = _mm512_cvttps_epi32 (x);
+
+  return _mm512_mask_i32gather_epi32 (i, ~alpha, i, linear_to_gamma, 4);
+}
+
+static inline void
+float_linear_u8_gamma (const float *src,
+                       uint8_t     *dst,
+                       long         n,
+                       __mmask16    alpha)
+{
+  for (; n >= 16; n -= 16)
+    {
+      __m512i i = float_linear_to_u8_gamma (_mm512_loadu_ps (src), alpha);
+
+      _mm_storeu_si128 ((__m128i *) dst, _mm512_cvtusepi32_epi8 (i));
+
+      src += 16;
+      dst += 16;
+    }
+
+  if (n)
+    {
+      __mmask16 m = tail_mask (n);
+      __m512i   i = float_linear_to_u8_gamma (_mm512_maskz_loadu_ps (m, src),
+                                              alpha);
+
+      _mm512_mask_cvtusepi32_storeu_epi8 (dst, m, i);
+    }
+}
+
+static inline void
+u8_gamma_float_linear (const uint8_t *src,
+                       float         *dst,
+                       long           n,
+                       __mmask16      alpha)
+{
+  /* the second half of the table is linear, for alpha */
+  const __m512i offset = _mm512_maskz_set1_epi32 (alpha, 256);
+
+  for (; n >= 16; n -= 16)
+    {
+      __m512i i = _mm512_cvtepu8_epi32 (_mm_loadu_si128 ((const __m128i *) src));
+
+      i = _mm512_add_epi32 (i, offset);
+      _mm512_storeu_ps (dst, _mm512_i32gather_ps (i, gamma_to_linear, 4));
+
+      src += 16;
+      dst += 16;
+    }
+
+  if (n)
+    {
+      __mmask16 m = tail_mask (n);
+      __m512i   i = _mm512_cvtepu8_epi32 (_mm_maskz_loadu_epi8 (m, src));
+
+      i = _mm512_add_epi32 (i, offset);
+      _mm512_mask_storeu_ps (dst, m,
+                             _mm512_mask_i32gather_ps (_mm512_setzero_ps (), m, i,
+                                                       gamma_to_linear, 4));
+    }
+}
+
+
+/* u16 <-> float, the same for linear and gamma */
+
+static inline __m512
+u16_to_float (__m256i x)
+{
+  return _mm512_mul_ps (_mm512_cvtepi32_ps (_mm512_cvtepu16_epi32 (x)),
+                        splat16f (1.f / 65535));
+}
+
+/* premultiply by the alpha of each pixel, one pixel per 128 bit lane */
+static inline __m512
+premultiply_rgba (__m512 x)
+{
+  __m512 a = _mm512_permute_ps (x, _MM_SHUFFLE (3, 3, 3, 3));
+
+  return _mm512_mul_ps (x, _mm512_mask_blend_ps (ALPHA_RGBA, a, splat16f (1.0f)));
+}
+
+static inline void
+u16_float (const uint16_t *src,
+           float          *dst,
+           long            n,
+           int             premultiply)
+{
+  for (; n >= 16; n -= 16)
+    {
+      __m512 x = u16_to_float (_mm256_loadu_si256 ((const __m256i *) src));
+
+      if (premultiply)
+        x = premultiply_rgba (x);
+      _mm512_storeu_ps (dst, x);
+
+      src += 16;
+      dst += 16;
+    }
+
+  if (n)
+    {
+      __mmask16 m = tail_mask (n);
+      __m512    x = u16_to_float (_mm256_maskz_loadu_epi16 (m, src));
+
+      if (premultiply)
+        x = premultiply_rgba (x);
+      _mm512_mask_storeu_ps (dst, m, x);
+    }
+}
+
+/* scaled in double, where the product is exact; rounding it to float
+ * first can land it on .5 and round it the wrong way
+ */
+static inline __m512i
+float_to_u16 (__m512 x)
+{
+  __m256i lo, hi;
+
+  x  = _mm512_min_ps (_mm512_max_ps (x, _mm512_setzero_ps ()), splat16f (1.0f));
+  lo = _mm512_cvtpd_epi32 (_mm512_mul_pd (_mm512_cvtps_pd (_mm512_castps512_ps256 (x)),
+                                          _mm512_set1_pd (65535.0)));
+  hi = _mm512_cvtpd_epi32 (_mm512_mul_pd (_mm512_cvtps_pd (_mm256_castpd_ps (
+                                            _mm512_extractf64x4_pd (_mm512_castps_pd (x), 1))),
+                                          _mm512_set1_pd (65535.0)));
+
+  return _mm512_inserti64x4 (_mm512_castsi256_si512 (lo), hi, 1);
+}
+
+static inline void
+float_u16 (const float *src,
+           uint16_t    *dst,
+           long         n)
+{
+  for (; n >= 16; n -= 16)
+    {
+      _mm256_storeu_si256 ((__m256i *) dst,
+                           _mm512_cvtusepi32_epi16 (float_to_u16 (_mm512_loadu_ps (src))));
+
+      src += 16;
+      dst += 16;
+    }
+
+  if (n)
+    {
+      __mmask16 m = tail_mask (n);
+
+      _mm512_mask_cvtusepi32_storeu_epi16 (dst, m,
+                                           float_to_u16 (_mm512_maskz_loadu_ps (m, src)));
+    }
+}
+
+
+/* half <-> float, the same for linear and gamma */
+
+static inline void
+half_float (const uint16_t *src,
+            float          *dst,
+            long            n)
+{
+  for (; n >= 16; n -= 16)
+    {
+      _mm512_storeu_ps (dst, _mm512_cvtph_ps (_mm256_loadu_si256 ((const __m256i *) src)));
+
+      src += 16;
+      dst += 16;
+    }
+
+  if (n)
+    {
+      __mmask16 m = tail_mask (n);
+
+      _mm512_mask_storeu_ps (dst, m,
+                             _mm512_cvtph_ps (_mm256_maskz_loadu_epi16 (m, src)));
+    }
+}
+
+static inline void
+float_half (const float *src,
+            uint16_t    *dst,
+            long         n)
+{
+  for (; n >= 16; n -= 16)
+    {
+      _mm256_storeu_si256 ((__m256i *) dst,
+                           _mm512_cvtps_ph (_mm512_loadu_ps (src),
+                                            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+
+      src += 16;
+      dst += 16;
+    }
+
+  if (n)
+    {
+      __mmask16 m = tail_mask (n);
+
+      _mm256_mask_storeu_epi16 (dst, m,
+                                _mm512_cvtps_ph (_mm512_maskz_loadu_ps (m, src),
+                                                 _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+}
+
+
+/* bfloat16 <-> float, the same for linear and gamma; rounding to nearest
+ * even and keeping NaNs quiet like babl/base/type-bfloat16.c, rather than
+ * with the instructions of AVX512_BF16 that flush denormals
+ */
+
+static inline __m512
+bfloat16_to_float (__m256i x)
+{
+  return _mm512_castsi512_ps (_mm512_slli_epi32 (_mm512_cvtepu16_epi32 (x), 16));
+}
+
+static inline __m256i
+float_to_bfloat16 (__m512 x)
+{
+  __m512i bits = _mm512_castps_si512 (x);
+  __m512i high = _mm512_srli_epi32 (bits, 16);
+  __m512i odd  = _mm512_and_si512 (high, _mm512_set1_epi32 (1));
+  __m512i i32  = _mm512_srli_epi32 (_mm512_add_epi32 (bits,
+                                      _mm512_add_epi32 (odd, _mm512_set1_epi32 (0x7fff))),
+                                    16);
+
+  i32 = _mm512_mask_or_epi32 (i32, _mm512_cmp_ps_mask (x, x, _CMP_UNORD_Q),
+                              high, _mm512_set1_epi32 (0x40));
+  return _mm512_cvtepi32_epi16 (i32);
+}
+
+static inline void
+bfloat16_float (const uint16_t *src,
+                float          *dst,
+                long            n)
+{
+  for (; n >= 16; n -= 16)
+    {
+      _mm512_storeu_ps (dst, bfloat16_to_float (_mm256_loadu_si256 ((const __m256i *) src)));
+
+      src += 16;
+      dst += 16;
+    }
+
+  if (n)
+    {
+      __mmask16 m = tail_mask (n);
+
+      _mm512_mask_storeu_ps (dst, m,
+                             bfloat16_to_float (_mm256_maskz_loadu_epi16 (m, src)));
+    }
+}
+
+static inline void
+float_bfloat16 (const float *src,
+                uint16_t    *dst,
+                long         n)
+{
+  for (; n >= 16; n -= 16)
+    {
+      _mm256_storeu_si256 ((__m256i *) dst, float_to_bfloat16 (_mm512_loadu_ps (src)));
+
+      src += 16;
+      dst += 16;
+    }
+
+  if (n)
+    {
+      __mmask16 m = tail_mask (n);
+
+      _mm256_mask_storeu_epi16 (dst, m,
+                                float_to_bfloat16 (_mm512_maskz_loadu_ps (m, src)));
+    }
+}
+
+static inline __m512
+u8_to_float (__m128i x)
+{
+  return _mm512_div_ps (_mm512_cvtepi32_ps (_mm512_cvtepu8_epi32 (x)),
+                        splat16f (255.0f));
+}
+
+static inline void
+u8_bfloat16 (const uint8_t *src,
+             uint16_t      *dst,
+             long           n)
+{
+  for (; n >= 16; n -= 16)
+    {
+      _mm256_storeu_si256 ((__m256i *) dst,
+                           float_to_bfloat16 (u8_to_float (_mm_loadu_si128 ((const __m128i *) src))));
+
+      src += 16;
+      dst += 16;
+    }
+
+  if (n)
+    {
+      __mmask16 m = tail_mask (n);
+
+      _mm256_mask_storeu_epi16 (dst, m,
+                                float_to_bfloat16 (u8_to_float (_mm_maskz_loadu_epi8 (m, src))));
+    }
+}
+
+
+/* float linear <-> gamma, the approximations of sse2-float */
+
+#define FLT_ONE      0x3f800000
+#define FLT_MANTISSA (1 << 23)
+
+static inline __m512
+init_newton (__m512 x,
+             double exponent,
+             double c0,
+             double c1,
+             double c2)
+{
+  double norm = exponent * M_LN2 / FLT_MANTISSA;
+  __m512 y    = _mm512_cvtepi32_ps (_mm512_sub_epi32 (_mm512_castps_si512 (x),
+                                                      _mm512_set1_epi32 (FLT_ONE)));
+
+  return splat16f (c0) + splat16f (c1 * norm) * y + splat16f (c2 * norm * norm) * y * y;
+}
+
+/* large values are out of the range of the newton iterations */
+static __attribute__((noinline)) __m512
+pow_accurate (__m512    y,
+              __m512    x,
+              __mmask16 lanes,
+              float     exponent)
+{
+  float in[16], out[16];
+  int   i;
+
+  _mm512_storeu_ps (in, x);
+  _mm512_storeu_ps (out, y);
+  for (i = 0; i < 16; i++)
+    if (lanes & (1 << i))
+      out[i] = expf (logf (in[i]) * exponent);
+
+  return _mm512_loadu_ps (out);
+}
+
+static inline __m512
+pow_1_24 (__m512 x)
+{
+  __mmask16 large = _mm512_cmp_ps_mask (x, splat16f (1024.0f), _CMP_GT_OQ);
+  __m512    y, z, s;
+
+  y = init_newton (x, -1./12, 0.9976800269, 0.9885126933, 0.5908575383);
+  s = _mm512_sqrt_ps (x);
+  /* newton's method for x^(-1/6) */
+  z = splat16f (1.f/6.f) * s;
+  y = splat16f (7.f/6.f) * y - z * ((y*y)*(y*y)*(y*y*y));
+  y = splat16f (7.f/6.f) * y - z * ((y*y)*(y*y)*(y*y*y));
+  y = s * y;
+
+  if (large)
+    y = pow_accurate (y, x, large, 1.0f / 2.4f);
+  return y;
+}
+
+static inline __m512
+pow_24 (__m512 x)
+{
+  __mmask16 large = _mm512_cmp_ps_mask (x, splat16f (16.0f), _CMP_GT_OQ);
+  __m512    y, z, s;
+
+  y = init_newton (x, -1./5, 0.9953189663, 0.9594345146, 0.6742970332);
+  /* newton's method for x^(-1/5) */
+  z = splat16f (1.f/5.f) * x;
+  y = splat16f (6.f/5.f) * y - z * ((y*y*y)*(y*y*y));
+  y = splat16f (6.f/5.f) * y - z * ((y*y*y)*(y*y*y));
+  s = x * y;
+  y = s * s * s;
+
+  if (large)
+    y = pow_accurate (y, x, large, 2.4f);
+  return y;
+}
+
+static inline __m512
+linear_to_gamma_2_2_avx512 (__m512 x)
+{
+  __m512    curve = pow_1_24 (x) * splat16f (1.055f) -
+                    splat16f (0.055f - 3.0f / (float) (1 << 24));
+                    /* ^ offset the result such that 1 maps to 1 */
+  __m512    line  = x * splat16f (12.92f);
+  __mmask16 mask  = _mm512_cmp_ps_mask (x, splat16f (0.003130804954f), _CMP_GT_OQ);
+
+  return _mm512_mask_blend_ps (mask, line, curve);
+}
+
+static inline __m512
+gamma_2_2_to_linear_avx512 (__m512 x)
+{
+  __m512    curve = pow_24 ((x + splat16f (0.055f)) * splat16f (1/1.055f));
+  __m512    line  = x * splat16f (1/12.92f);
+  __mmask16 mask  = _mm512_cmp_ps_mask (x, splat16f (0.04045f), _CMP_GT_OQ);
+
+  return _mm512_mask_blend_ps (mask, line, curve);
+}
+
+static inline __m512
+float_trc (__m512    x,
+           __mmask16 alpha,
+           int       to_gamma)
+{
+  __m512 y = to_gamma ? linear_to_gamma_2_2_avx512 (x)
+                      : gamma_2_2_to_linear_avx512 (x);
+
+  return _mm512_mask_blend_ps (alpha, y, x);
+}
+
+static inline void
+float_float_trc (const float *src,
+                 float       *dst,
+                 long         n,
+                 __mmask16    alpha,
+                 int          to_gamma)
+{
+  for (; n >= 16; n -= 16)
+    {
+      _mm512_storeu_ps (dst, float_trc (_mm512_loadu_ps (src), alpha, to_gamma));
+
+      src += 16;
+      dst += 16;
+    }
+
+  if (n)
+    {
+      __mmask16 m = tail_mask (n);
+
+      /* masked off lanes are 1.0, away from the slow path for large values */
+      _mm512_mask_storeu_ps (dst, m,
+                             float_trc (_mm512_mask_loadu_ps (splat16f (1.0f), m, src),
+                                        alpha, to_gamma));
+    }
+}
+
+
+#define CONV(name, src_type, dst_type, components, call)                 \
+static void                                                              \
+conv_ ## name (const Babl     *conversion,                               \
+               const src_type *src,                                      \
+               dst_type       *dst,                                      \
+               long            samples)                                  \
+{                                                                        \
+  const long n = samples * components;                                   \
+                                                                         \
+  call;                                                                  \
+}
+
+CONV (yF_linear_y8_gamma,       float,    uint8_t,  1, float_linear_u8_gamma (src, dst, n, ALPHA_Y))
+CONV (yaF_linear_ya8_gamma,     float,    uint8_t,  2, float_linear_u8_gamma (src, dst, n, ALPHA_YA))
+CONV (rgbF_linear_rgb8_gamma,   float,    uint8_t,  3, float_linear_u8_gamma (src, dst, n, ALPHA_Y))
+CONV (rgbaF_linear_rgba8_gamma, float,    uint8_t,  4, float_linear_u8_gamma (src, dst, n, ALPHA_RGBA))
+CONV (y8_gamma_yF_linear,       uint8_t,  float,    1, u8_gamma_float_linear (src, dst, n, ALPHA_Y))
+CONV (ya8_gamma_yaF_linear,     uint8_t,  float,    2, u8_gamma_float_linear (src, dst, n, ALPHA_YA))
+CONV (rgb8_gamma_rgbF_linear,   uint8_t,  float,    3, u8_gamma_float_linear (src, dst, n, ALPHA_Y))
+CONV (rgba8_gamma_rgbaF_linear, uint8_t,  float,    4, u8_gamma_float_linear (src, dst, n, ALPHA_RGBA))
+
+CONV (rgba16_rgbaF,             uint16_t, float,    4, u16_float (src, dst, n, 0))
+CONV (rgba16_rgbAF,             uint16_t, float,    4, u16_float (src, dst, n, 1))
+CONV (rgbaF_rgba16,             float,    uint16_t, 4, float_u16 (src, dst, n))
+
+CONV (yHalf_yF,                 uint16_t, float,    1, half_float (src, dst, n))
+CONV (yaHalf_yaF,               uint16_t, float,    2, half_float (src, dst, n))
+CONV (rgbHalf_rgbF,             uint16_t, float,    3, half_float (src, dst, n))
+CONV (rgbaHalf_rgbaF,           uint16_t, float,    4, half_float (src, dst, n))
+CONV (yF_yHalf,                 float,    uint16_t, 1, float_half (src, dst, n))
+CONV (yaF_yaHalf,               float,    uint16_t, 2, float_half (src, dst, n))
+CONV (rgbF_rgbHalf,             float,    uint16_t, 3, float_half (src, dst, n))
+CONV (rgbaF_rgbaHalf,           float,    uint16_t, 4, float_half (src, dst, n))
+
+CONV (yBf16_yF,                 uint16_t, float,    1, bfloat16_float (src, dst, n))
+CONV (yaBf16_yaF,               uint16_t, float,    2, bfloat16_float (src, dst, n))
+CONV (rgbBf16_rgbF,             uint16_t, float,    3, bfloat16_float (src, dst, n))
+CONV (rgbaBf16_rgbaF,           uint16_t, float,    4, bfloat16_float (src, dst, n))
+CONV (yF_yBf16,                 float,    uint16_t, 1, float_bfloat16 (src, dst, n))
+CONV (yaF_yaBf16,               float,    uint16_t, 2, float_bfloat16 (src, dst, n))
+CONV (rgbF_rgbBf16,             float,    uint16_t, 3, float_bfloat16 (src, dst, n))
+CONV (rgbaF_rgbaBf16,           float,    uint16_t, 4, float_bfloat16 (src, dst, n))
+CONV (y8_yBf16,                 uint8_t,  uint16_t, 1, u8_bfloat16 (src, dst, n))
+CONV (rgba8_rgbaBf16,           uint8_t,  uint16_t, 4, u8_bfloat16 (src, dst, n))
+
+#define conv_yAHalf_yAF conv_yaHalf_yaF
+#define conv_yAF_yAHalf conv_yaF_yaHalf
+
+CONV (yF_linear_yF_gamma,       float,    float,    1, float_float_trc (src, dst, n, ALPHA_Y, 1))
+CONV (yaF_linear_yaF_gamma,     float,    float,    2, float_float_trc (src, dst, n, ALPHA_YA, 1))
+CONV (rgbF_linear_rgbF_gamma,   float,    float,    3, float_float_trc (src, dst, n, ALPHA_Y, 1))
+CONV (rgbaF_linear_rgbaF_gamma, float,    float,    4, float_float_trc (src, dst, n, ALPHA_RGBA, 1))
+CONV (yF_gamma_yF_linear,       float,    float,    1, float_float_trc (src, dst, n, ALPHA_Y, 0))
+CONV (yaF_gamma_yaF_linear,     float,    float,    2, float_float_trc (src, dst, n, ALPHA_YA, 0))
+CONV (rgbF_gamma_rgbF_linear,   float,    float,    3, float_float_trc (src, dst, n, ALPHA_Y, 0))
+CONV (rgbaF_gamma_rgbaF_linear, float,    float,    4, float_float_trc (src, dst, n, ALPHA_RGBA, 0))
+
+#undef CONV
+
+static const Babl *
+format (const char *model,
+        const char *type,
+        const char *c0,
+        const char *c1,
+        const char *c2,
+        const char *c3)
+{
+  return babl_format_new (babl_model (model),
+                          babl_type (type),
+                          babl_component (c0),
+                          c1 ? babl_component (c1) : NULL,
+                          c2 ? babl_component (c2) : NULL,
+                          c3 ? babl_component (c3) : NULL,
+                          NULL);
+}
+
+#endif /* defined(USE_AVX512) */
+
+int init (void);
+
+int
+init (void)
+{
+#if defined(USE_AVX512)
+
+  const Babl *yF_linear     = format ("Y",          "float", "Y",   NULL,  NULL,  NULL);
+  const Babl *yF_gamma      = format ("Y'",         "float", "Y'",  NULL,  NULL,  NULL);
+  const Babl *yaF_linear    = format ("YA",         "float", "Y",   "A",   NULL,  NULL);
+  const Babl *yaF_gamma     = format ("Y'A",        "float", "Y'",  "A",   NULL,  NULL);
+  const Babl *yAF_linear    = format ("YaA",        "float", "Ya",  "A",   NULL,  NULL);
+  const Babl *yAF_gamma     = format ("Y'aA",       "float", "Y'a", "A",   NULL,  NULL);
+  const Babl *rgbF_linear   = format ("RGB",        "float", "R",   "G",   "B",   NULL);
+  const Babl *rgbF_gamma    = format ("R'G'B'",     "float", "R'",  "G'",  "B'",  NULL);
+  const Babl *rgbaF_linear  = format ("RGBA",       "float", "R",   "G",   "B",   "A");
+  const Babl *rgbaF_gamma   = format ("R'G'B'A",    "float", "R'",  "G'",  "B'",  "A");
+  const Babl *rgbAF_linear  = format ("RaGaBaA",    "float", "Ra",  "Ga",  "Ba",  "A");
+  const Babl *rgbAF_gamma   = format ("R'aG'aB'aA", "float", "R'a", "G'a", "B'a", "A");
+
+  const Babl *rgba16_linear = format ("RGBA",       "u16",   "R",   "G",   "B",   "A");
+  const Babl *rgba16_gamma  = format ("R'G'B'A",    "u16",   "R'",  "G'",  "B'",  "A");
+
+  const Babl *yHalf_linear    = format ("Y",        "half",  "Y",   NULL,  NULL,  NULL);
+  const Babl *yHalf_gamma     = format ("Y'",       "half",  "Y'",  NULL,  NULL,  NULL);
+  const Babl *yaHalf_linear   = format ("YA",       "half",  "Y",   "A",   NULL,  NULL);
+  const Babl *yaHalf_gamma    = format ("Y'A",      "half",  "Y'",  "A",   NULL,  NULL);
+  const Babl *yAHalf_linear   = format ("YaA",      "half",  "Ya",  "A",   NULL,  NULL);
+  const Babl *yAHalf_gamma    = format ("Y'aA",     "half",  "Y'a", "A",   NULL,  NULL);
+  const Babl *rgbHalf_linear  = format ("RGB",      "half",  "R",   "G",   "B",   NULL);
+  const Babl *rgbHalf_gamma   = format ("R'G'B'",   "half",  "R'",  "G'",  "B'",  NULL);
+  const Babl *rgbaHalf_linear = format ("RGBA",     "half",  "R",   "G",   "B",   "A");
+  const Babl *rgbaHalf_gamma  = format ("R'G'B'A",  "half",  "R'",  "G'",  "B'",  "A");
+
+  const Babl *yBf16_linear    = format ("Y",       "bfloat16", "Y",   NULL,  NULL,  NULL);
+  const Babl *yBf16_gamma     = format ("Y'",      "bfloat16", "Y'",  NULL,  NULL,  NULL);
+  const Babl *yaBf16_linear   = format ("YA",      "bfloat16", "Y",   "A",   NULL,  NULL);
+  const Babl *yaBf16_gamma    = format ("Y'A",     "bfloat16", "Y'",  "A",   NULL,  NULL);
+  const Babl *rgbBf16_linear  = format ("RGB",     "bfloat16", "R",   "G",   "B",   NULL);
+  const Babl *rgbBf16_gamma   = format ("R'G'B'",  "bfloat16", "R'",  "G'",  "B'",  NULL);
+  const Babl *rgbaBf16_linear = format ("RGBA",    "bfloat16", "R",   "G",   "B",   "A");
+  const Babl *rgbaBf16_gamma  = format ("R'G'B'A", "bfloat16", "R'",  "G'",  "B'",  "A");
+
+  const Babl *y8_linear       = format ("Y",       "u8",       "Y",   NULL,  NULL,  NULL);
+  const Babl *y8_gamma        = format ("Y'",      "u8",       "Y'",  NULL,  NULL,  NULL);
+  const Babl *rgba8_linear    = format ("RGBA",    "u8",       "R",   "G",   "B",   "A");
+  const Babl *ya8_gamma       = format ("Y'A",     "u8",       "Y'",  "A",   NULL,  NULL);
+  const Babl *rgb8_gamma      = format ("R'G'B'",  "u8",       "R'",  "G'",  "B'",  NULL);
+  const Babl *rgba8_gamma     = format ("R'G'B'A", "u8",       "R'",  "G'",  "B'",  "A");
+
+/* between the linear and the gamma variant of a format */
+#define TRC(src, dst)                                                    \
+  babl_conversion_new (src ## _linear, dst ## _gamma, "linear",          \
+                       conv_ ## src ## _linear_ ## dst ## _gamma,        \
+                       "accel", BABL_CPU_ACCEL_X86_AVX512, NULL);        \
+  babl_conversion_new (dst ## _gamma, src ## _linear, "linear",          \
+                       conv_ ## dst ## _gamma_ ## src ## _linear,        \
+                       "accel", BABL_CPU_ACCEL_X86_AVX512, NULL)
+
+/* between types, for both the linear and the gamma variant */
+#define TYPE(src, dst)                                                   \
+  babl_conversion_new (src ## _linear, dst ## _linear, "linear",         \
+                       conv_ ## src ## _ ## dst,                         \
+                       "accel", BABL_CPU_ACCEL_X86_AVX512, NULL);        \
+  babl_conversion_new (src ## _gamma, dst ## _gamma, "linear",           \
+                       conv_ ## src ## _ ## dst,                         \
+                       "accel", BABL_CPU_ACCEL_X86_AVX512, NULL)
+
+  TRC (yF,    y8);
+  TRC (yaF,   ya8);
+  TRC (rgbF,  rgb8);
+  TRC (rgbaF, rgba8);
+
+  TRC (yF,    yF);
+  TRC (yaF,   yaF);
+  TRC (rgbF,  rgbF);
+  TRC (rgbaF, rgbaF);
+
+  TYPE (rgba16,   rgbaF);
+  TYPE (rgba16,   rgbAF);
+  TYPE (rgbaF,    rgba16);
+
+  TYPE (rgbaHalf, rgbaF);
+  TYPE (rgbHalf,  rgbF);
+  TYPE (yaHalf,   yaF);
+  TYPE (yAHalf,   yAF);
+  TYPE (yHalf,    yF);
+  TYPE (rgbaF,    rgbaHalf);
+  TYPE (rgbF,     rgbHalf);
+  TYPE (yaF,      yaHalf);
+  TYPE (yAF,      yAHalf);
+  TYPE (yF,       yHalf);
+
+  TYPE (rgbaBf16, rgbaF);
+  TYPE (rgbBf16,  rgbF);
+  TYPE (yaBf16,   yaF);
+  TYPE (yBf16,    yF);
+  TYPE (rgbaF,    rgbaBf16);
+  TYPE (rgbF,     rgbBf16);
+  TYPE (yaF,      yaBf16);
+  TYPE (yF,       yBf16);
+  TYPE (rgba8,    rgbaBf16);
+  TYPE (y8,       yBf16);
+
+#undef TRC
+#undef TYPE
+
+#endif /* defined(USE_AVX512) */
+
+  return 0;
+}
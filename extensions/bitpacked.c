@@ -0,0 +1,416 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* Unpacking and packing of the bitpacked 10-10-10-2, 12-12-12-12 and
+ * 5-6-5 formats to and from RGBA float, u8 and u16, on the portable
+ * vectors of babl-vector.h.
+ *
+ * The kernels take 4 pixels at a time with a vector per component, so
+ * every field is extracted or inserted with the same shift and mask for
+ * all lanes. A pixel word is kept as its low and high 32 bits, and the
+ * integer scaling rounds as the reference does; u16 goes through double
+ * since float cannot tell the halfway points of 12 to 16 bit scaling
+ * apart.
+ */
+
+#include "config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "babl.h"
+#include "babl-cpuaccel.h"
+#include "babl-vector.h"
+
+#ifdef BABL_VECTOR
+
+typedef struct
+{
+  int bytes;     /* bytes per pixel */
+  int shift[4];  /* bit offset of R, G, B and A in the word */
+  int bits[4];   /* width of R, G, B and A, 0 for no alpha */
+} Layout;
+
+static const Layout rgb10_a2 = { 4, {  0, 10, 20, 30 }, { 10, 10, 10,  2 } };
+static const Layout rgba12   = { 6, {  0, 12, 24, 36 }, { 12, 12, 12, 12 } };
+static const Layout rgb565   = { 2, { 11,  5,  0,  0 }, {  5,  6,  5,  0 } };
+
+typedef enum
+{
+  TYPE_FLOAT,
+  TYPE_U8,
+  TYPE_U16
+} Type;
+
+static inline void
+load_words (const uint8_t *src,
+            int            bytes,
+            BablV4u32     *lo,
+            BablV4u32     *hi)
+{
+  int i, b;
+
+  for (i = 0; i < 4; i++, src += bytes)
+    {
+      uint32_t l = 0;
+      uint32_t h = 0;
+
+      for (b = 0; b < bytes && b < 4; b++)
+        l |= (uint32_t) src[b] << (b * 8);
+      for (; b < bytes; b++)
+        h |= (uint32_t) src[b] << ((b - 4) * 8);
+
+      (*lo)[i] = l;
+      (*hi)[i] = h;
+    }
+}
+
+static inline void
+store_words (uint8_t   *dst,
+             int        bytes,
+             BablV4u32  lo,
+             BablV4u32  hi)
+{
+  int i, b;
+
+  for (i = 0; i < 4; i++, dst += bytes)
+    {
+      for (b = 0; b < bytes && b < 4; b++)
+        dst[b] = lo[i] >> (b * 8);
+      for (; b < bytes; b++)
+        dst[b] = hi[i] >> ((b - 4) * 8);
+    }
+}
+
+static inline BablV4i
+get_field (BablV4u32 lo,
+           BablV4u32 hi,
+           int       shift,
+           int       bits)
+{
+  BablV4u32 v;
+
+  if (shift >= 32)
+    v = hi >> (shift - 32);
+  else if (shift + bits > 32)
+    v = (lo >> shift) | (hi << (32 - shift));
+  else
+    v = lo >> shift;
+
+  return (BablV4i) (v & ((1u << bits) - 1));
+}
+
+static inline void
+set_field (BablV4u32 *lo,
+           BablV4u32 *hi,
+           BablV4i    value,
+           int        shift,
+           int        bits)
+{
+  BablV4u32 v = (BablV4u32) value;
+
+  if (shift >= 32)
+    {
+      *hi |= v << (shift - 32);
+    }
+  else
+    {
+      *lo |= v << shift;
+      if (shift + bits > 32)
+        *hi |= v >> (32 - shift);
+    }
+}
+
+/* integer field values to and from the lanes of the unpacked type */
+
+static inline BablV4i
+rescale_u16 (BablV4i value,
+             double  scale)
+{
+  BablV4d d = __builtin_convertvector (value, BablV4d);
+
+  d = d * (BablV4d) { scale, scale, scale, scale } +
+      (BablV4d) { 0.5, 0.5, 0.5, 0.5 };
+  return __builtin_convertvector (d, BablV4i);
+}
+
+static inline BablV4i
+rescale_u8 (BablV4i value,
+            float   scale)
+{
+  BablV4f f = __builtin_convertvector (value, BablV4f);
+
+  return __builtin_convertvector (f * babl_v4f_splat (scale) +
+                                  babl_v4f_splat (0.5f), BablV4i);
+}
+
+static inline void
+unpack (const Layout  *layout,
+        Type           type,
+        const uint8_t *src,
+        void          *dst,
+        long           samples)
+{
+  uint8_t in[4 * 8] = { 0, };
+  long    i;
+  int     j, c;
+
+  for (i = 0; i < samples; i += 4)
+    {
+      const uint8_t *s     = src + i * layout->bytes;
+      int            count = samples - i < 4 ? samples - i : 4;
+      BablV4u32      lo, hi;
+      BablV4f        f[4];
+      BablV4i        q[4];
+
+      if (count < 4)
+        {
+          memcpy (in, s, count * layout->bytes);
+          s = in;
+        }
+      load_words (s, layout->bytes, &lo, &hi);
+
+      for (c = 0; c < 4; c++)
+        {
+          int     bits = layout->bits[c];
+          int     max  = (1 << bits) - 1;
+          BablV4i v;
+
+          if (!bits)
+            {
+              f[c] = babl_v4f_splat (1.0f);
+              q[c] = babl_v4i_splat (type == TYPE_U8 ? 255 : 65535);
+              continue;
+            }
+
+          v = get_field (lo, hi, layout->shift[c], bits);
+          switch (type)
+            {
+              case TYPE_FLOAT:
+                f[c] = __builtin_convertvector (v, BablV4f) *
+                       babl_v4f_splat (1.0f / max);
+                break;
+              case TYPE_U8:
+                q[c] = rescale_u8 (v, 255.0f / max);
+                break;
+              case TYPE_U16:
+                q[c] = rescale_u16 (v, 65535.0 / max);
+                break;
+            }
+        }
+
+      for (j = 0; j < count; j++)
+        for (c = 0; c < 4; c++)
+          switch (type)
+            {
+              case TYPE_FLOAT:
+                ((float *) dst)[(i + j) * 4 + c] = f[c][j];
+                break;
+              case TYPE_U8:
+                ((uint8_t *) dst)[(i + j) * 4 + c] = q[c][j];
+                break;
+              case TYPE_U16:
+                ((uint16_t *) dst)[(i + j) * 4 + c] = q[c][j];
+                break;
+            }
+    }
+}
+
+static inline void
+pack (const Layout *layout,
+      Type          type,
+      const void   *src,
+      uint8_t      *dst,
+      long          samples)
+{
+  uint8_t out[4 * 8];
+  long    i;
+  int     j, c;
+
+  for (i = 0; i < samples; i += 4)
+    {
+      uint8_t   *d     = dst + i * layout->bytes;
+      int        count = samples - i < 4 ? samples - i : 4;
+      BablV4u32  lo    = { 0, };
+      BablV4u32  hi    = { 0, };
+
+      for (c = 0; c < 4; c++)
+        {
+          int     bits = layout->bits[c];
+          int     max  = (1 << bits) - 1;
+          BablV4f f    = babl_v4f_splat (0.0f);
+          BablV4i v    = babl_v4i_splat (0);
+
+          if (!bits)
+            continue;
+
+          for (j = 0; j < count; j++)
+            switch (type)
+              {
+                case TYPE_FLOAT:
+                  f[j] = ((const float *) src)[(i + j) * 4 + c];
+                  break;
+                case TYPE_U8:
+                  v[j] = ((const uint8_t *) src)[(i + j) * 4 + c];
+                  break;
+                case TYPE_U16:
+                  v[j] = ((const uint16_t *) src)[(i + j) * 4 + c];
+                  break;
+              }
+
+          switch (type)
+            {
+              case TYPE_FLOAT:
+                v = __builtin_convertvector (babl_v4f_clamp (f, 1.0f) *
+                                             babl_v4f_splat (max) +
+                                             babl_v4f_splat (0.5f), BablV4i);
+                break;
+              case TYPE_U8:
+                v = rescale_u8 (v, max / 255.0f);
+                break;
+              case TYPE_U16:
+                v = rescale_u16 (v, max / 65535.0);
+                break;
+            }
+          set_field (&lo, &hi, v, layout->shift[c], bits);
+        }
+
+      if (count < 4)
+        {
+          store_words (out, layout->bytes, lo, hi);
+          memcpy (d, out, count * layout->bytes);
+        }
+      else
+        {
+          store_words (d, layout->bytes, lo, hi);
+        }
+    }
+}
+
+#define CONVERSIONS(layout)                                              \
+  static void                                                            \
+  conv_ ## layout ## _rgbaF (const Babl    *conversion,                  \
+                             const uint8_t *src,                         \
+                             float         *dst,                         \
+                             long           samples)                     \
+  {                                                                      \
+    unpack (&layout, TYPE_FLOAT, src, dst, samples);                     \
+  }                                                                      \
+                                                                         \
+  static void                                                            \
+  conv_ ## layout ## _rgba8 (const Babl    *conversion,                  \
+                             const uint8_t *src,                         \
+                             uint8_t       *dst,                         \
+                             long           samples)                     \
+  {                                                                      \
+    unpack (&layout, TYPE_U8, src, dst, samples);                        \
+  }                                                                      \
+                                                                         \
+  static void                                                            \
+  conv_ ## layout ## _rgba16 (const Babl    *conversion,                 \
+                              const uint8_t *src,                        \
+                              uint16_t      *dst,                        \
+                              long           samples)                    \
+  {                                                                      \
+    unpack (&layout, TYPE_U16, src, dst, samples);                       \
+  }                                                                      \
+                                                                         \
+  static void                                                            \
+  conv_rgbaF_ ## layout (const Babl  *conversion,                        \
+                         const float *src,                               \
+                         uint8_t     *dst,                               \
+                         long         samples)                           \
+  {                                                                      \
+    pack (&layout, TYPE_FLOAT, src, dst, samples);                       \
+  }                                                                      \
+                                                                         \
+  static void                                                            \
+  conv_rgba8_ ## layout (const Babl    *conversion,                      \
+                         const uint8_t *src,                             \
+                         uint8_t       *dst,                             \
+                         long           samples)                         \
+  {                                                                      \
+    pack (&layout, TYPE_U8, src, dst, samples);                          \
+  }                                                                      \
+                                                                         \
+  static void                                                            \
+  conv_rgba16_ ## layout (const Babl     *conversion,                    \
+                          const uint16_t *src,                           \
+                          uint8_t        *dst,                           \
+                          long            samples)                       \
+  {                                                                      \
+    pack (&layout, TYPE_U16, src, dst, samples);                         \
+  }
+
+CONVERSIONS (rgb10_a2)
+CONVERSIONS (rgba12)
+CONVERSIONS (rgb565)
+
+#undef CONVERSIONS
+
+#endif /* BABL_VECTOR */
+
+int init (void);
+
+int
+init (void)
+{
+#ifdef BABL_VECTOR
+  int nonlinear;
+
+  for (nonlinear = 0; nonlinear < 2; nonlinear++)
+    {
+      const char *rgba    = nonlinear ? "R'G'B'A" : "RGBA";
+      const char *rgb     = nonlinear ? "R'G'B'"  : "RGB";
+      char        name[64];
+      const Babl *rgbaF, *rgba8, *rgba16;
+      const Babl *packed;
+
+      snprintf (name, sizeof (name), "%s float", rgba);
+      rgbaF = babl_format (name);
+      snprintf (name, sizeof (name), "%s u8", rgba);
+      rgba8 = babl_format (name);
+      snprintf (name, sizeof (name), "%s u16", rgba);
+      rgba16 = babl_format (name);
+
+#define o(src, dst, func)                                                \
+  babl_conversion_new (src, dst, "linear", conv_ ## func,                \
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL)
+
+#define LAYOUT(layout, model, suffix)                                    \
+      snprintf (name, sizeof (name), "%s " suffix, model);               \
+      packed = babl_format (name);                                       \
+      o (packed, rgbaF,  layout ## _rgbaF);                              \
+      o (packed, rgba8,  layout ## _rgba8);                              \
+      o (packed, rgba16, layout ## _rgba16);                             \
+      o (rgbaF,  packed, rgbaF_ ## layout);                              \
+      o (rgba8,  packed, rgba8_ ## layout);                              \
+      o (rgba16, packed, rgba16_ ## layout)
+
+      LAYOUT (rgb10_a2, rgba, "u10-10-10-2");
+      LAYOUT (rgba12,   rgba, "u12-12-12-12");
+      LAYOUT (rgb565,   rgb,  "u5-6-5");
+
+#undef LAYOUT
+#undef o
+    }
+
+#endif /* BABL_VECTOR */
+
+  return 0;
+}
@@ -134,6 +134,11 @@ conv_cairo32_rgbA8_le (const Babl    *conversion,
     }
 }
 
+/* 255 / alpha; a product with it is never closer than 1 / 510 to a
+ * rounding boundary, the bias keeps float errors from rounding down
+ */
+static float recip_alpha_u8[256];
+
 static void 
 conv_cairo32_rgba8_le (const Babl    *conversion,
                        unsigned char *src, 
@@ -141,43 +146,52 @@ conv_cairo32_rgba8_le (const Babl    *conversion,
                        long           samples)
 {
   long n = samples;
-  while (n--)
+  while (n > 0)
     {
-      unsigned char blue   = *src++;
-      unsigned char green  = *src++;
-      unsigned char red    = *src++;
-      unsigned char alpha  = *src++;
+      unsigned char alpha = src[3];
+      long          span  = 1;
 
       if (alpha == 0)
       {
-        *dst++ = 0;
-        *dst++ = 0;
-        *dst++ = 0;
-        *dst++ = 0;
+        span = babl_alpha_span_u8 (src, n, 0);
+        memset (dst, 0, span * 4);
+        src += span * 4;
+        dst += span * 4;
       }
       else if (alpha == 255)
       {
-        *dst++ = red;
-        *dst++ = green;
-        *dst++ = blue;
-        *dst++ = alpha;
+        long i;
+
+        /* opaque, only the red and blue bytes swap places */
+        span = babl_alpha_span_u8 (src, n, 255);
+        for (i = 0; i < span; i++)
+          {
+            uint32_t bgra;
+
+            memcpy (&bgra, src, 4);
+            bgra = (bgra & 0xff00ff00) |
+                   ((bgra >> 16) & 0xff) |
+                   ((bgra & 0xff) << 16);
+            memcpy (dst, &bgra, 4);
+            src += 4;
+            dst += 4;
+          }
       }
       else
       {
-        float falpha = alpha / 255.0;
-        float recip_alpha = 1.0 / falpha;
- //       unsigned int aa = ((255 << 16) + alpha) / falpha + 0.5;
-
-
-        *dst++ = ((red/255.0) * recip_alpha) * 255 + 0.5f;
-        *dst++ = ((green/255.0) * recip_alpha) * 255 + 0.5f;
-        *dst++ = ((blue/255.0) * recip_alpha) * 255 + 0.5f;
-
-//        *dst++ = (red   * aa + 0x8000) >> 16;
-//        *dst++ = (green * aa + 0x8000) >> 16;
-//        *dst++ = (blue  * aa + 0x8000) >> 16;
+        /* rounds exactly, see recip_alpha_u8 */
+        float recip = recip_alpha_u8[alpha];
+        float r     = src[2] * recip + (0.5f + 1.0f / 1024.0f);
+        float g     = src[1] * recip + (0.5f + 1.0f / 1024.0f);
+        float b     = src[0] * recip + (0.5f + 1.0f / 1024.0f);
+
+        *dst++ = r >= 255.0f ? 255 : (int) r;
+        *dst++ = g >= 255.0f ? 255 : (int) g;
+        *dst++ = b >= 255.0f ? 255 : (int) b;
         *dst++ = alpha;
+        src += 4;
       }
+      n -= span;
     }
 }
 
@@ -259,37 +273,67 @@ conv_rgba8_cairo32_le (const Babl    *conversion,
 {
   long n = samples;
   uint32_t *dsti = (void*) dst;
-  while (n--)
+  while (n > 0)
     {
       unsigned char alpha = src[3];
+      long          span;
+
+      if (alpha == 0)
+        {
+          span = babl_alpha_span_u8 (src, n, 0);
+          memset (dsti, 0, span * 4);
+          dsti += span;
+          src  += span * 4;
+          n    -= span;
+          continue;
+        }
+      else if (alpha == 255)
+        {
+          /* opaque, only reordered */
+          span = babl_alpha_span_u8 (src, n, 255);
+          n   -= span;
+          while (span--)
+            {
+              *dsti++ = ((uint32_t) src[0] << 16) |
+                        ((uint32_t) src[1] <<  8) |
+                        ((uint32_t) src[2] <<  0) |
+                        0xff000000u;
+              src += 4;
+            }
+          continue;
+        }
+
+      {
 #if SIZE_MAX >= UINT64_MAX /* 64-bit */
-      uint64_t rbag = ((uint64_t) src[0] << 48) |
-                      ((uint64_t) src[2] << 32) |
-                      ((uint64_t) 255    << 16) |
-                      ((uint64_t) src[1] <<  0);
-      rbag *= alpha;
-      rbag += 0x0080008000800080;
-      rbag += (rbag >> 8) & 0x00ff00ff00ff00ff;
-      rbag &= 0xff00ff00ff00ff00;
-      *dsti++ = (uint32_t) (rbag >>  0) |
-                (uint32_t) (rbag >> 40);
+        uint64_t rbag = ((uint64_t) src[0] << 48) |
+                        ((uint64_t) src[2] << 32) |
+                        ((uint64_t) 255    << 16) |
+                        ((uint64_t) src[1] <<  0);
+        rbag *= alpha;
+        rbag += 0x0080008000800080;
+        rbag += (rbag >> 8) & 0x00ff00ff00ff00ff;
+        rbag &= 0xff00ff00ff00ff00;
+        *dsti++ = (uint32_t) (rbag >>  0) |
+                  (uint32_t) (rbag >> 40);
 #else /* 32-bit */
-      uint32_t rb = ((uint32_t) src[0] << 16) |
-                    ((uint32_t) src[2] <<  0);
-      uint64_t ag = ((uint32_t) 255    << 16) |
-                    ((uint32_t) src[1] <<  0);
-      rb *= alpha;
-      ag *= alpha;
-      rb += 0x00800080;
-      ag += 0x00800080;
-      rb += (rb >> 8) & 0x00ff00ff;
-      ag += (ag >> 8) & 0x00ff00ff;
-      rb &= 0xff00ff00;
-      ag &= 0xff00ff00;
-      *dsti++ = (uint32_t) (ag >> 0) |
-                (uint32_t) (rb >> 8);
+        uint32_t rb = ((uint32_t) src[0] << 16) |
+                      ((uint32_t) src[2] <<  0);
+        uint64_t ag = ((uint32_t) 255    << 16) |
+                      ((uint32_t) src[1] <<  0);
+        rb *= alpha;
+        ag *= alpha;
+        rb += 0x00800080;
+        ag += 0x00800080;
+        rb += (rb >> 8) & 0x00ff00ff;
+        ag += (ag >> 8) & 0x00ff00ff;
+        rb &= 0xff00ff00;
+        ag &= 0xff00ff00;
+        *dsti++ = (uint32_t) (ag >> 0) |
+                  (uint32_t) (rb >> 8);
 #endif
+      }
       src+=4;
+      n--;
     }
 }
 
@@ -563,6 +607,10 @@ init (void)
   int   testint  = 23;
   char *testchar = (char*) &testint;
   int   littleendian = (testchar[0] == 23);
+  int   i;
+
+  for (i = 1; i < 256; i++)
+    recip_alpha_u8[i] = 255.0f / i;
 
   if (littleendian)
     {
@@ -39,13 +39,31 @@ conv_yaF_linear_yAF_linear (const Babl    *conversion,
    float *fdst = (float *) dst;
    int n = samples;
 
-   while (n--)
+   while (n > 0)
      {
        float alpha = fsrc[1];
-       float used_alpha = babl_epsilon_for_zero_float (alpha);
+       float used_alpha;
+       long  span = 0;
+
+       /* opaque and all zero pixels come out unchanged */
+       if (alpha == 1.0f)
+         span = babl_alpha_span_float (fsrc, 2, n, 1.0f);
+       else if (alpha == 0.0f)
+         span = babl_zero_span_float (fsrc, 2, n);
+       if (span)
+         {
+           memcpy (fdst, fsrc, span * 2 * sizeof (float));
+           fsrc += span * 2;
+           fdst += span * 2;
+           n    -= span;
+           continue;
+         }
+
+       used_alpha = babl_epsilon_for_zero_float (alpha);
        *fdst++ = (*fsrc++) * used_alpha;
        *fdst++ = alpha;
        fsrc++;
+       n--;
      }
 }
 
@@ -60,13 +78,31 @@ conv_yAF_linear_yaF_linear (const Babl    *conversion,
    float *fdst = (float *) dst;
    int n = samples;
 
-   while (n--)
+   while (n > 0)
      {
        float alpha = fsrc[1];
-       float alpha_reciprocal = 1.0f/babl_epsilon_for_zero_float (alpha);
+       float alpha_reciprocal;
+       long  span = 0;
+
+       /* opaque and all zero pixels come out unchanged */
+       if (alpha == 1.0f)
+         span = babl_alpha_span_float (fsrc, 2, n, 1.0f);
+       else if (alpha == 0.0f)
+         span = babl_zero_span_float (fsrc, 2, n);
+       if (span)
+         {
+           memcpy (fdst, fsrc, span * 2 * sizeof (float));
+           fsrc += span * 2;
+           fdst += span * 2;
+           n    -= span;
+           continue;
+         }
+
+       alpha_reciprocal = 1.0f/babl_epsilon_for_zero_float (alpha);
        *fdst++ = (*fsrc++) * alpha_reciprocal;
        *fdst++ = alpha;
        fsrc++;
+       n--;
      }
 }
 
@@ -84,13 +120,38 @@ conv_yaF_linear_yAF_nonlinear (const Babl    *conversion,
    float *fdst = (float *) dst;
    int n = samples;
 
-   while (n--)
+   while (n > 0)
      {
        float alpha = fsrc[1];
        float used_alpha = babl_epsilon_for_zero_float (alpha);
+       long  span;
+
+       if (alpha == 1.0f)
+         {
+           /* opaque, nothing to multiply with */
+           span = babl_alpha_span_float (fsrc, 2, n, 1.0f);
+           n -= span;
+           while (span--)
+             {
+               *fdst++ = babl_trc_from_linear (trc[0], *fsrc++);
+               *fdst++ = 1.0f;
+               fsrc++;
+             }
+           continue;
+         }
+
        *fdst++ = babl_trc_from_linear (trc[0], *fsrc++) * used_alpha;
        *fdst++ = alpha;
        fsrc++;
+       n--;
+
+       if (alpha == 0.0f)
+         {
+           span  = babl_repeat_transparent_float (fsrc, fdst, 2, n);
+           fsrc += span * 2;
+           fdst += span * 2;
+           n    -= span;
+         }
      }
 }
 
@@ -107,15 +168,42 @@ conv_rgbaF_linear_rgbAF_nonlinear (const Babl    *conversion,
    float *fdst = (float *) dst;
    int n = samples;
 
-   while (n--)
+   while (n > 0)
      {
        float alpha = fsrc[3];
        float used_alpha = babl_epsilon_for_zero_float (alpha);
+       long  span;
+
+       if (alpha == 1.0f)
+         {
+           /* opaque, nothing to multiply with */
+           span = babl_alpha_span_float (fsrc, 4, n, 1.0f);
+           n -= span;
+           while (span--)
+             {
+               *fdst++ = babl_trc_from_linear (trc[0], *fsrc++);
+               *fdst++ = babl_trc_from_linear (trc[1], *fsrc++);
+               *fdst++ = babl_trc_from_linear (trc[2], *fsrc++);
+               *fdst++ = 1.0f;
+               fsrc++;
+             }
+           continue;
+         }
+
        *fdst++ = babl_trc_from_linear (trc[0], *fsrc++) * used_alpha;
        *fdst++ = babl_trc_from_linear (trc[1], *fsrc++) * used_alpha;
        *fdst++ = babl_trc_from_linear (trc[2], *fsrc++) * used_alpha;
        *fdst++ = alpha;
        fsrc++;
+       n--;
+
+       if (alpha == 0.0f)
+         {
+           span  = babl_repeat_transparent_float (fsrc, fdst, 4, n);
+           fsrc += span * 4;
+           fdst += span * 4;
+           n    -= span;
+         }
      }
 }
 
@@ -129,15 +217,42 @@ conv_rgbaF_linear_rgbAF_perceptual (const Babl    *conversion,
    float *fdst = (float *) dst;
    int n = samples;
 
-   while (n--)
+   while (n > 0)
      {
        float alpha = fsrc[3];
        float used_alpha = babl_epsilon_for_zero (alpha);
+       long  span;
+
+       if (alpha == 1.0f)
+         {
+           /* opaque, nothing to multiply with */
+           span = babl_alpha_span_float (fsrc, 4, n, 1.0f);
+           n -= span;
+           while (span--)
+             {
+               *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++);
+               *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++);
+               *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++);
+               *fdst++ = 1.0f;
+               fsrc++;
+             }
+           continue;
+         }
+
        *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++) * used_alpha;
        *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++) * used_alpha;
        *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++) * used_alpha;
        *fdst++ = alpha;
        fsrc++;
+       n--;
+
+       if (alpha == 0.0f)
+         {
+           span  = babl_repeat_transparent_float (fsrc, fdst, 4, n);
+           fsrc += span * 4;
+           fdst += span * 4;
+           n    -= span;
+         }
      }
 }
 
@@ -155,16 +270,31 @@ conv_rgbAF_linear_rgbAF_nonlinear (const Babl    *conversion,
    float *fdst = (float *) dst;
    int n = samples;
 
-   while (n--)
+   while (n > 0)
      {
        float alpha = fsrc[3];
-       if (alpha == 0)
+       long  span;
+
+       if (alpha == 0.0f)
+         {
+           span = babl_alpha_span_float (fsrc, 4, n, 0.0f);
+           memset (fdst, 0, span * 4 * sizeof (float));
+           fsrc += span * 4;
+           fdst += span * 4;
+           n    -= span;
+         }
+       else if (alpha == 1.0f)
          {
-           *fdst++ = 0.0;
-           *fdst++ = 0.0;
-           *fdst++ = 0.0;
-           *fdst++ = 0.0;
-           fsrc+=4;
+           /* opaque, nothing to divide by or multiply with */
+           span = babl_alpha_span_float (fsrc, 4, n, 1.0f);
+           n -= span;
+           while (span--)
+             {
+               *fdst++ = babl_trc_from_linear (trc[0], *fsrc++);
+               *fdst++ = babl_trc_from_linear (trc[1], *fsrc++);
+               *fdst++ = babl_trc_from_linear (trc[2], *fsrc++);
+               *fdst++ = *fsrc++;
+             }
          }
        else
          {
@@ -173,6 +303,7 @@ conv_rgbAF_linear_rgbAF_nonlinear (const Babl    *conversion,
            *fdst++ = babl_trc_from_linear (trc[1], *fsrc++ * alpha_recip) * alpha;
            *fdst++ = babl_trc_from_linear (trc[2], *fsrc++ * alpha_recip) * alpha;
            *fdst++ = *fsrc++;
+           n--;
          }
      }
 }
@@ -191,22 +322,36 @@ conv_yAF_linear_yAF_nonlinear (const Babl    *conversion,
    float *fdst = (float *) dst;
    int n = samples;
 
-   while (n--)
+   while (n > 0)
      {
        float alpha = fsrc[1];
-       if (alpha == 0)
+       long  span;
+
+       if (alpha == 0.0f)
          {
-           *fdst++ = 0.0;
-           *fdst++ = 0.0;
-           *fdst++ = 0.0;
-           *fdst++ = 0.0;
-           fsrc+=4;
+           span = babl_alpha_span_float (fsrc, 2, n, 0.0f);
+           memset (fdst, 0, span * 2 * sizeof (float));
+           fsrc += span * 2;
+           fdst += span * 2;
+           n    -= span;
+         }
+       else if (alpha == 1.0f)
+         {
+           /* opaque, nothing to divide by or multiply with */
+           span = babl_alpha_span_float (fsrc, 2, n, 1.0f);
+           n -= span;
+           while (span--)
+             {
+               *fdst++ = babl_trc_from_linear (trc[0], *fsrc++);
+               *fdst++ = *fsrc++;
+             }
          }
        else
          {
            float alpha_recip = 1.0 / alpha;
            *fdst++ = babl_trc_from_linear (trc[0], *fsrc++ * alpha_recip) * alpha;
            *fdst++ = *fsrc++;
+           n--;
          }
      }
 }
@@ -224,16 +369,31 @@ conv_rgbAF_linear_rgbAF_perceptual (const Babl    *conversion,
    float *fdst = (float *) dst;
    int n = samples;
 
-   while (n--)
+   while (n > 0)
      {
        float alpha = fsrc[3];
+       long  span;
+
        if (alpha == 0.0f)
          {
-           *fdst++ = 0.0f;
-           *fdst++ = 0.0f;
-           *fdst++ = 0.0f;
-           *fdst++ = 0.0f;
-           fsrc+=4;
+           span = babl_alpha_span_float (fsrc, 4, n, 0.0f);
+           memset (fdst, 0, span * 4 * sizeof (float));
+           fsrc += span * 4;
+           fdst += span * 4;
+           n    -= span;
+         }
+       else if (alpha == 1.0f)
+         {
+           /* opaque, nothing to divide by or multiply with */
+           span = babl_alpha_span_float (fsrc, 4, n, 1.0f);
+           n -= span;
+           while (span--)
+             {
+               *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++);
+               *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++);
+               *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++);
+               *fdst++ = *fsrc++;
+             }
          }
        else
          {
@@ -242,6 +402,7 @@ conv_rgbAF_linear_rgbAF_perceptual (const Babl    *conversion,
            *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++ * alpha_recip) * alpha;
            *fdst++ = babl_trc_from_linear (trc_srgb, *fsrc++ * alpha_recip) * alpha;
            *fdst++ = *fsrc++;
+           n--;
          }
      }
 }
@@ -291,26 +291,24 @@ init (void)
     babl_component ("Y'"),
     NULL);
 
+#define ACCEL (BABL_CPU_ACCEL_X86_SSE4_1 | BABL_CPU_ACCEL_X86_F16C)
+
 #define CONV(src, dst) \
 { \
-  babl_conversion_new (src ## _linear, dst ## _linear, "linear", conv_ ## src ## _ ## dst, NULL); \
-  babl_conversion_new (src ## _gamma, dst ## _gamma, "linear", conv_ ## src ## _ ## dst, NULL); \
+  babl_conversion_new (src ## _linear, dst ## _linear, "linear", conv_ ## src ## _ ## dst, "accel", ACCEL, NULL); \
+  babl_conversion_new (src ## _gamma, dst ## _gamma, "linear", conv_ ## src ## _ ## dst, "accel", ACCEL, NULL); \
 }
 
-  if ((babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_SSE4_1) &&
-      (babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_F16C))
-    {
-      CONV(rgbaHalf, rgbaF);
-      CONV(rgbHalf,  rgbF);
-      CONV(yaHalf,   yaF);
-      CONV(yAHalf,   yAF);
-      CONV(yHalf,    yF);
-      CONV(rgbaF,    rgbaHalf);
-      CONV(rgbF,     rgbHalf);
-      CONV(yaF,      yaHalf);
-      CONV(yAF,      yAHalf);
-      CONV(yF,       yHalf);
-    }
+  CONV(rgbaHalf, rgbaF);
+  CONV(rgbHalf,  rgbF);
+  CONV(yaHalf,   yaF);
+  CONV(yAHalf,   yAF);
+  CONV(yHalf,    yF);
+  CONV(rgbaF,    rgbaHalf);
+  CONV(rgbF,     rgbHalf);
+  CONV(yaF,      yaHalf);
+  CONV(yAF,      yAHalf);
+  CONV(yF,       yHalf);
 
 #endif /* defined(USE_SSE4_1) && defined(USE_F16C) && defined(ARCH_X86_64) */
 
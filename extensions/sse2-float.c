@@ -37,6 +37,22 @@
 
 static const float BABL_ALPHA_FLOOR_FLOAT = (float)BABL_ALPHA_FLOOR;
 
+/* whether premultiplying and unpremultiplying leave 4 pixels as they
+ * are, all of them being opaque or all zero bits
+ */
+static inline int
+unchanged_by_alpha (const __v4sf *s)
+{
+  __v4sf  alpha = _mm_shuffle_ps (_mm_unpackhi_ps (s[0], s[1]),
+                                  _mm_unpackhi_ps (s[2], s[3]),
+                                  _MM_SHUFFLE (3, 2, 3, 2));
+  __m128i bits  = _mm_or_si128 (_mm_or_si128 ((__m128i) s[0], (__m128i) s[1]),
+                                _mm_or_si128 ((__m128i) s[2], (__m128i) s[3]));
+
+  return _mm_movemask_ps (_mm_cmpeq_ps (alpha, _mm_set1_ps (1.0f))) == 0xf ||
+         _mm_movemask_epi8 (_mm_cmpeq_epi32 (bits, _mm_setzero_si128 ())) == 0xffff;
+}
+
 static void
 conv_rgbaF_linear_rgbAF_linear (const Babl  *conversion,
                                 const float *src,
@@ -52,13 +68,24 @@ conv_rgbaF_linear_rgbAF_linear (const Babl  *conversion,
       const __v4sf *s = (const __v4sf*) src;
             __v4sf *d = (__v4sf*)dst;
 
-      for ( ; i < n; i += 2)
+      for ( ; i < n; )
         {
           float alpha0 = ((float *)s)[3];
           float alpha1 = ((float *)s)[7];
           float used_alpha0 = babl_epsilon_for_zero_float (alpha0);
           float used_alpha1 = babl_epsilon_for_zero_float (alpha1);
 
+          if ((alpha0 == 1.0f || alpha0 == 0.0f) &&
+              i + 4 <= n && unchanged_by_alpha (s))
+            {
+              *d++ = *s++;
+              *d++ = *s++;
+              *d++ = *s++;
+              *d++ = *s++;
+              i += 4;
+              continue;
+            }
+
          {
           __v4sf rbaa0, rbaa1;
         
@@ -87,6 +114,7 @@ conv_rgbaF_linear_rgbAF_linear (const Babl  *conversion,
           *d++ = rgba0;
           *d++ = rgba1;
          }
+          i += 2;
         }
       _mm_empty ();
     }
@@ -123,12 +151,24 @@ conv_rgbAF_linear_rgbaF_linear_shuffle (const Babl  *conversion,
       const __v4sf *s = (const __v4sf*) src;
             __v4sf *d = (__v4sf*)dst;
 
-      for ( ; i < n; i += 1)
+      for ( ; i < n; )
         {
           __v4sf pre_rgba0, rgba0, rbaa0, raaaa0;
           
           float alpha0 = ((float *)s)[3];
           float used_alpha0 = babl_epsilon_for_zero_float (alpha0);
+
+          if ((alpha0 == 1.0f || alpha0 == 0.0f) &&
+              i + 4 <= n && unchanged_by_alpha (s))
+            {
+              *d++ = *s++;
+              *d++ = *s++;
+              *d++ = *s++;
+              *d++ = *s++;
+              i += 4;
+              continue;
+            }
+
           pre_rgba0 = *s;
           
           {
@@ -147,6 +187,7 @@ conv_rgbAF_linear_rgbaF_linear_shuffle (const Babl  *conversion,
 
           s++;
           *d++ = rgba0;
+          i++;
         }
       _mm_empty ();
     }
@@ -600,8 +641,11 @@ conv_rgbF_gamma_rgbF_linear (const Babl  *conversion,
 
 #endif /* defined(USE_SSE2) */
 
+#define ACCEL (BABL_CPU_ACCEL_X86_SSE | BABL_CPU_ACCEL_X86_SSE2)
+
 #define o(src, dst) \
-  babl_conversion_new (src, dst, "linear", conv_ ## src ## _ ## dst, NULL)
+  babl_conversion_new (src, dst, "linear", conv_ ## src ## _ ## dst, \
+                       "accel", ACCEL, NULL)
 
 int init (void);
 
@@ -679,61 +723,62 @@ init (void)
     babl_component ("Y'"),
     NULL);
 
-  if ((babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_SSE) &&
-      (babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_SSE2))
-      
-    {
-      babl_conversion_new(rgbaF_linear, 
-                          rgbAF_linear,
-                          "linear",
-                          conv_rgbaF_linear_rgbAF_linear,
-                          NULL);
-
-      babl_conversion_new(rgbaF_gamma, 
-                          rgbAF_gamma,
-                          "linear",
-                          conv_rgbaF_linear_rgbAF_linear,
-                          NULL);
-                          
-      babl_conversion_new(rgbaF_linear, 
-                          rgbAF_gamma,
-                          "linear",
-                          conv_rgbaF_linear_rgbAF_gamma,
-                          NULL);
-
-      /* Which of these is faster varies by CPU, and the difference
-       * is big enough that it's worthwhile to include both and
-       * let them fight it out in the babl benchmarks.
-       */
-      babl_conversion_new(rgbAF_linear, 
-                          rgbaF_linear,
-                          "linear",
-                          conv_rgbAF_linear_rgbaF_linear_shuffle,
-                          NULL);
-      babl_conversion_new(rgbAF_gamma, 
-                          rgbaF_gamma,
-                          "linear",
-                          conv_rgbAF_linear_rgbaF_linear_shuffle,
-                          NULL);
-
-      babl_conversion_new(rgbAF_linear, 
-                          rgbaF_linear,
-                          "linear",
-                          conv_rgbAF_linear_rgbaF_linear_spin,
-                          NULL);
-
-      o (yF_linear, yF_gamma);
-      o (yF_gamma,  yF_linear);
-
-      o (yaF_linear, yaF_gamma);
-      o (yaF_gamma,  yaF_linear);
-
-      o (rgbF_linear, rgbF_gamma);
-      o (rgbF_gamma,  rgbF_linear);
-
-      o (rgbaF_linear, rgbaF_gamma);
-      o (rgbaF_gamma, rgbaF_linear);
-    }
+  babl_conversion_new (rgbaF_linear,
+                       rgbAF_linear,
+                       "linear",
+                       conv_rgbaF_linear_rgbAF_linear,
+                       "accel", ACCEL,
+                       NULL);
+
+  babl_conversion_new (rgbaF_gamma,
+                       rgbAF_gamma,
+                       "linear",
+                       conv_rgbaF_linear_rgbAF_linear,
+                       "accel", ACCEL,
+                       NULL);
+
+  babl_conversion_new (rgbaF_linear,
+                       rgbAF_gamma,
+                       "linear",
+                       conv_rgbaF_linear_rgbAF_gamma,
+                       "accel", ACCEL,
+                       NULL);
+
+  /* Which of these is faster varies by CPU, and the difference
+   * is big enough that it's worthwhile to include both and
+   * let them fight it out in the babl benchmarks.
+   */
+  babl_conversion_new (rgbAF_linear,
+                       rgbaF_linear,
+                       "linear",
+                       conv_rgbAF_linear_rgbaF_linear_shuffle,
+                       "accel", ACCEL,
+                       NULL);
+  babl_conversion_new (rgbAF_gamma,
+                       rgbaF_gamma,
+                       "linear",
+                       conv_rgbAF_linear_rgbaF_linear_shuffle,
+                       "accel", ACCEL,
+                       NULL);
+
+  babl_conversion_new (rgbAF_linear,
+                       rgbaF_linear,
+                       "linear",
+                       conv_rgbAF_linear_rgbaF_linear_spin,
+                       "accel", ACCEL,
+                       NULL);
+
+  o (yF_linear, yF_gamma);
+  o (yF_gamma,  yF_linear);
+
+  o (yaF_linear, yaF_gamma);
+  o (yaF_gamma,  yaF_linear);
+
+  o (rgbF_linear, rgbF_gamma);
+  o (rgbF_gamma,  rgbF_linear);
+
+  o (rgbaF_linear, rgbaF_gamma);
+  o (rgbaF_gamma, rgbaF_linear);
 
 #endif /* defined(USE_SSE2) */
 
@@ -196,18 +196,16 @@ init (void)
     babl_component ("A"),
     NULL);
 
+#define ACCEL (BABL_CPU_ACCEL_X86_SSE | BABL_CPU_ACCEL_X86_SSE2)
+
 #define CONV(src, dst) \
 { \
-  babl_conversion_new (src ## _linear, dst ## _linear, "linear", conv_ ## src ## _ ## dst, NULL); \
-  babl_conversion_new (src ## _gamma, dst ## _gamma, "linear", conv_ ## src ## _ ## dst, NULL); \
+  babl_conversion_new (src ## _linear, dst ## _linear, "linear", conv_ ## src ## _ ## dst, "accel", ACCEL, NULL); \
+  babl_conversion_new (src ## _gamma, dst ## _gamma, "linear", conv_ ## src ## _ ## dst, "accel", ACCEL, NULL); \
 }
 
-  if ((babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_SSE) &&
-      (babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_SSE2))
-    {
-      CONV (rgba16, rgbaF);
-      CONV (rgba16, rgbAF);
-    }
+  CONV (rgba16, rgbaF);
+  CONV (rgba16, rgbAF);
 
 #endif /* defined(USE_SSE2) */
 
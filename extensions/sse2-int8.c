@@ -312,20 +312,19 @@ init (void)
     babl_component ("Y'"),
     NULL);
 
+#define ACCEL BABL_CPU_ACCEL_X86_SSE2
+
 #define CONV(src, dst) \
 { \
-  babl_conversion_new (src ## _linear, dst ## _linear, "linear", conv_ ## src ## _ ## dst, NULL); \
-  babl_conversion_new (src ## _gamma, dst ## _gamma, "linear", conv_ ## src ## _ ## dst, NULL); \
+  babl_conversion_new (src ## _linear, dst ## _linear, "linear", conv_ ## src ## _ ## dst, "accel", ACCEL, NULL); \
+  babl_conversion_new (src ## _gamma, dst ## _gamma, "linear", conv_ ## src ## _ ## dst, "accel", ACCEL, NULL); \
 }
 
-  if ((babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_SSE2))
-    {
-      CONV(rgbaF, rgba8);
-      CONV(rgbAF, rgbA8);
-      CONV(rgbF,  rgb8);
-      CONV(yaF,   ya8);
-      CONV(yF,    y8);
-    }
+  CONV(rgbaF, rgba8);
+  CONV(rgbAF, rgbA8);
+  CONV(rgbF,  rgb8);
+  CONV(yaF,   ya8);
+  CONV(yF,    y8);
 
 #endif
 
@@ -207,19 +207,18 @@ init (void)
     babl_component ("Y'"),
     NULL);
 
+#define ACCEL BABL_CPU_ACCEL_X86_SSE4_1
+
 #define CONV(src, dst) \
 { \
-  babl_conversion_new (src ## _linear, dst ## _linear, "linear", conv_ ## src ## _ ## dst, NULL); \
-  babl_conversion_new (src ## _gamma, dst ## _gamma, "linear", conv_ ## src ## _ ## dst, NULL); \
+  babl_conversion_new (src ## _linear, dst ## _linear, "linear", conv_ ## src ## _ ## dst, "accel", ACCEL, NULL); \
+  babl_conversion_new (src ## _gamma, dst ## _gamma, "linear", conv_ ## src ## _ ## dst, "accel", ACCEL, NULL); \
 }
 
-  if ((babl_cpu_accel_get_support () & BABL_CPU_ACCEL_X86_SSE4_1))
-    {
-      CONV(rgba8, rgbaF);
-      CONV(rgb8,  rgbF);
-      CONV(ya8,   yaF);
-      CONV(y8,    yF);
-    }
+  CONV(rgba8, rgbaF);
+  CONV(rgb8,  rgbF);
+  CONV(ya8,   yaF);
+  CONV(y8,    yF);
 
 #endif
 
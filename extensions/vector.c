@@ -0,0 +1,449 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* The common u8, u16 and float gamma, type and premultiplication
+ * conversions written once on top of the portable vectors of
+ * babl-vector.h. They are what non-x86 builds get, on x86 the hand
+ * written SSE2 and later extensions take precedence, see BABL_CPU_ACCEL.
+ *
+ * The kernels work on 4 components at a time regardless of the number
+ * of components per pixel, alpha is told apart by a lane mask - 4 is a
+ * multiple of 1, 2 and 4 components, and 3 component formats have no
+ * alpha.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "babl.h"
+#include "babl-cpuaccel.h"
+#include "babl-vector.h"
+#include "base/util.h"
+#include "extensions/util.h"
+
+#ifdef BABL_VECTOR
+
+/* lanes holding alpha, for 1, 2 and 4 components per pixel */
+#define ALPHA_Y    ((BablV4i) {  0,  0,  0,  0 })
+#define ALPHA_YA   ((BablV4i) {  0, -1,  0, -1 })
+#define ALPHA_RGBA ((BablV4i) {  0,  0,  0, -1 })
+
+/* the operations, applied to 4 components at a time - premultiplication
+ * is only done for RGBA, with one pixel per vector
+ */
+
+static inline BablV4f
+op_none (BablV4f x,
+         BablV4i alpha)
+{
+  return x;
+}
+
+static inline BablV4f
+op_to_gamma (BablV4f x,
+             BablV4i alpha)
+{
+  return babl_v4f_select (alpha, x, babl_v4f_linear_to_gamma_2_2 (x));
+}
+
+static inline BablV4f
+op_to_linear (BablV4f x,
+              BablV4i alpha)
+{
+  return babl_v4f_select (alpha, x, babl_v4f_gamma_2_2_to_linear (x));
+}
+
+static inline BablV4f
+op_premultiply (BablV4f x,
+                BablV4i alpha)
+{
+  float a = babl_epsilon_for_zero_float (x[3]);
+
+  return x * (BablV4f) { a, a, a, 1.0f };
+}
+
+static inline BablV4f
+op_unpremultiply (BablV4f x,
+                  BablV4i alpha)
+{
+  float recip = 1.0f / babl_epsilon_for_zero_float (x[3]);
+
+  return x * (BablV4f) { recip, recip, recip, 1.0f };
+}
+
+static inline BablV4f
+op_to_gamma_premultiply (BablV4f x,
+                         BablV4i alpha)
+{
+  return op_premultiply (op_to_gamma (x, alpha), alpha);
+}
+
+/* loads and stores, of values in the 0.0-1.0 range */
+
+static inline BablV4f
+load_float (const float *src)
+{
+  return babl_v4f_load (src);
+}
+
+static inline void
+store_float (float   *dst,
+             BablV4f  x)
+{
+  babl_v4f_store (dst, x);
+}
+
+static inline BablV4f
+load_u8 (const uint8_t *src)
+{
+  return babl_v4f_load_u8 (src) * babl_v4f_splat (1.0f / 255.0f);
+}
+
+static inline void
+store_u8 (uint8_t *dst,
+          BablV4f  x)
+{
+  babl_v4f_store_u8 (dst, x);
+}
+
+static inline BablV4f
+load_u16 (const uint16_t *src)
+{
+  return babl_v4f_load_u16 (src) * babl_v4f_splat (1.0f / 65535.0f);
+}
+
+static inline void
+store_u16 (uint16_t *dst,
+           BablV4f   x)
+{
+  babl_v4f_store_u16 (dst, x);
+}
+
+/* big endian, with the byte swap folded into the loads and stores */
+
+static inline BablV4f
+load_u16be (const uint16_t *src)
+{
+  return babl_v4f_load_u16be (src) * babl_v4f_splat (1.0f / 65535.0f);
+}
+
+static inline void
+store_u16be (uint16_t *dst,
+             BablV4f   x)
+{
+  babl_v4f_store_u16be (dst, x);
+}
+
+static inline BablV4f
+load_floatbe (const float *src)
+{
+  return babl_v4f_load_floatbe (src);
+}
+
+static inline void
+store_floatbe (float   *dst,
+               BablV4f  x)
+{
+  babl_v4f_store_floatbe (dst, x);
+}
+
+
+#define CONV(name, src_type, dst_type, load, store, components, op, alpha)   \
+static void                                                                  \
+conv_ ## name (const Babl     *conversion,                                   \
+               const src_type *src,                                          \
+               dst_type       *dst,                                          \
+               long            samples)                                      \
+{                                                                            \
+  long n = samples * components;                                             \
+                                                                             \
+  for (; n >= 4; n -= 4, src += 4, dst += 4)                                 \
+    store (dst, op (load (src), alpha));                                     \
+                                                                             \
+  if (n)                                                                     \
+    {                                                                        \
+      src_type tmp_src[4] = { 0, };                                          \
+      dst_type tmp_dst[4];                                                   \
+                                                                             \
+      memcpy (tmp_src, src, n * sizeof (src_type));                          \
+      store (tmp_dst, op (load (tmp_src), alpha));                           \
+      memcpy (dst, tmp_dst, n * sizeof (dst_type));                          \
+    }                                                                        \
+}
+
+CONV (yF_linear_yF_gamma,       float,    float,    load_float, store_float, 1, op_to_gamma,  ALPHA_Y)
+CONV (yaF_linear_yaF_gamma,     float,    float,    load_float, store_float, 2, op_to_gamma,  ALPHA_YA)
+CONV (rgbF_linear_rgbF_gamma,   float,    float,    load_float, store_float, 3, op_to_gamma,  ALPHA_Y)
+CONV (rgbaF_linear_rgbaF_gamma, float,    float,    load_float, store_float, 4, op_to_gamma,  ALPHA_RGBA)
+CONV (yF_gamma_yF_linear,       float,    float,    load_float, store_float, 1, op_to_linear, ALPHA_Y)
+CONV (yaF_gamma_yaF_linear,     float,    float,    load_float, store_float, 2, op_to_linear, ALPHA_YA)
+CONV (rgbF_gamma_rgbF_linear,   float,    float,    load_float, store_float, 3, op_to_linear, ALPHA_Y)
+CONV (rgbaF_gamma_rgbaF_linear, float,    float,    load_float, store_float, 4, op_to_linear, ALPHA_RGBA)
+
+CONV (rgbaF_rgbAF,              float,    float,    load_float, store_float, 4, op_premultiply,   ALPHA_RGBA)
+CONV (rgbAF_rgbaF,              float,    float,    load_float, store_float, 4, op_unpremultiply, ALPHA_RGBA)
+CONV (rgbaF_linear_rgbAF_gamma, float,    float,    load_float, store_float, 4, op_to_gamma_premultiply, ALPHA_RGBA)
+
+CONV (yF_linear_y8_gamma,       float,    uint8_t,  load_float, store_u8,    1, op_to_gamma,  ALPHA_Y)
+CONV (yaF_linear_ya8_gamma,     float,    uint8_t,  load_float, store_u8,    2, op_to_gamma,  ALPHA_YA)
+CONV (rgbF_linear_rgb8_gamma,   float,    uint8_t,  load_float, store_u8,    3, op_to_gamma,  ALPHA_Y)
+CONV (rgbaF_linear_rgba8_gamma, float,    uint8_t,  load_float, store_u8,    4, op_to_gamma,  ALPHA_RGBA)
+CONV (y8_gamma_yF_linear,       uint8_t,  float,    load_u8,    store_float, 1, op_to_linear, ALPHA_Y)
+CONV (ya8_gamma_yaF_linear,     uint8_t,  float,    load_u8,    store_float, 2, op_to_linear, ALPHA_YA)
+CONV (rgb8_gamma_rgbF_linear,   uint8_t,  float,    load_u8,    store_float, 3, op_to_linear, ALPHA_Y)
+CONV (rgba8_gamma_rgbaF_linear, uint8_t,  float,    load_u8,    store_float, 4, op_to_linear, ALPHA_RGBA)
+
+CONV (rgba16_rgbaF,             uint16_t, float,    load_u16,   store_float, 4, op_none,        ALPHA_RGBA)
+CONV (rgba16_rgbAF,             uint16_t, float,    load_u16,   store_float, 4, op_premultiply, ALPHA_RGBA)
+CONV (rgbaF_rgba16,             float,    uint16_t, load_float, store_u16,   4, op_none,        ALPHA_RGBA)
+
+CONV (yF_linear_y16_gamma,       float,    uint16_t, load_float, store_u16,   1, op_to_gamma,  ALPHA_Y)
+CONV (yaF_linear_ya16_gamma,     float,    uint16_t, load_float, store_u16,   2, op_to_gamma,  ALPHA_YA)
+CONV (rgbF_linear_rgb16_gamma,   float,    uint16_t, load_float, store_u16,   3, op_to_gamma,  ALPHA_Y)
+CONV (rgbaF_linear_rgba16_gamma, float,    uint16_t, load_float, store_u16,   4, op_to_gamma,  ALPHA_RGBA)
+CONV (y16_gamma_yF_linear,       uint16_t, float,    load_u16,   store_float, 1, op_to_linear, ALPHA_Y)
+CONV (ya16_gamma_yaF_linear,     uint16_t, float,    load_u16,   store_float, 2, op_to_linear, ALPHA_YA)
+CONV (rgb16_gamma_rgbF_linear,   uint16_t, float,    load_u16,   store_float, 3, op_to_linear, ALPHA_Y)
+CONV (rgba16_gamma_rgbaF_linear, uint16_t, float,    load_u16,   store_float, 4, op_to_linear, ALPHA_RGBA)
+
+CONV (rgba16be_rgbaF,              uint16_t, float,    load_u16be, store_float,   4, op_none,        ALPHA_RGBA)
+CONV (rgba16be_rgbAF,              uint16_t, float,    load_u16be, store_float,   4, op_premultiply, ALPHA_RGBA)
+CONV (rgbaF_rgba16be,              float,    uint16_t, load_float, store_u16be,   4, op_none,        ALPHA_RGBA)
+
+CONV (yF_linear_y16be_gamma,       float,    uint16_t, load_float, store_u16be,   1, op_to_gamma,  ALPHA_Y)
+CONV (yaF_linear_ya16be_gamma,     float,    uint16_t, load_float, store_u16be,   2, op_to_gamma,  ALPHA_YA)
+CONV (rgbF_linear_rgb16be_gamma,   float,    uint16_t, load_float, store_u16be,   3, op_to_gamma,  ALPHA_Y)
+CONV (rgbaF_linear_rgba16be_gamma, float,    uint16_t, load_float, store_u16be,   4, op_to_gamma,  ALPHA_RGBA)
+CONV (y16be_gamma_yF_linear,       uint16_t, float,    load_u16be, store_float,   1, op_to_linear, ALPHA_Y)
+CONV (ya16be_gamma_yaF_linear,     uint16_t, float,    load_u16be, store_float,   2, op_to_linear, ALPHA_YA)
+CONV (rgb16be_gamma_rgbF_linear,   uint16_t, float,    load_u16be, store_float,   3, op_to_linear, ALPHA_Y)
+CONV (rgba16be_gamma_rgbaF_linear, uint16_t, float,    load_u16be, store_float,   4, op_to_linear, ALPHA_RGBA)
+
+CONV (yF_linear_yFbe_gamma,        float,    float,    load_float,   store_floatbe, 1, op_to_gamma,  ALPHA_Y)
+CONV (yaF_linear_yaFbe_gamma,      float,    float,    load_float,   store_floatbe, 2, op_to_gamma,  ALPHA_YA)
+CONV (rgbF_linear_rgbFbe_gamma,    float,    float,    load_float,   store_floatbe, 3, op_to_gamma,  ALPHA_Y)
+CONV (rgbaF_linear_rgbaFbe_gamma,  float,    float,    load_float,   store_floatbe, 4, op_to_gamma,  ALPHA_RGBA)
+CONV (yFbe_gamma_yF_linear,        float,    float,    load_floatbe, store_float,   1, op_to_linear, ALPHA_Y)
+CONV (yaFbe_gamma_yaF_linear,      float,    float,    load_floatbe, store_float,   2, op_to_linear, ALPHA_YA)
+CONV (rgbFbe_gamma_rgbF_linear,    float,    float,    load_floatbe, store_float,   3, op_to_linear, ALPHA_Y)
+CONV (rgbaFbe_gamma_rgbaF_linear,  float,    float,    load_floatbe, store_float,   4, op_to_linear, ALPHA_RGBA)
+CONV (rgbaFbe_rgbAF,               float,    float,    load_floatbe, store_float,   4, op_premultiply, ALPHA_RGBA)
+
+/* between big endian and host byte order, the same for all models */
+
+#define SWAP(name, type, components, swap)                                   \
+static void                                                                  \
+conv_ ## name (const Babl *conversion,                                       \
+               const type *src,                                              \
+               type       *dst,                                              \
+               long        samples)                                          \
+{                                                                            \
+  long n = samples * components;                                             \
+                                                                             \
+  for (; n >= 4; n -= 4, src += 4, dst += 4)                                 \
+    swap (dst, src);                                                         \
+                                                                             \
+  if (n)                                                                     \
+    {                                                                        \
+      type tmp[4] = { 0, };                                                  \
+                                                                             \
+      memcpy (tmp, src, n * sizeof (type));                                  \
+      swap (tmp, tmp);                                                       \
+      memcpy (dst, tmp, n * sizeof (type));                                  \
+    }                                                                        \
+}
+
+static inline void
+swap_u16 (uint16_t       *dst,
+          const uint16_t *src)
+{
+  BablV4u16 v;
+
+  memcpy (&v, src, sizeof (v));
+  v = babl_v4u16_be (v);
+  memcpy (dst, &v, sizeof (v));
+}
+
+static inline void
+swap_u32 (float       *dst,
+          const float *src)
+{
+  BablV4u32 v;
+
+  memcpy (&v, src, sizeof (v));
+  v = babl_v4u32_be (v);
+  memcpy (dst, &v, sizeof (v));
+}
+
+SWAP (y16_y16be,     uint16_t, 1, swap_u16)
+SWAP (ya16_ya16be,   uint16_t, 2, swap_u16)
+SWAP (rgb16_rgb16be, uint16_t, 3, swap_u16)
+SWAP (rgba16_rgba16be, uint16_t, 4, swap_u16)
+SWAP (yF_yFbe,       float,    1, swap_u32)
+SWAP (yaF_yaFbe,     float,    2, swap_u32)
+SWAP (rgbF_rgbFbe,   float,    3, swap_u32)
+SWAP (rgbaF_rgbaFbe, float,    4, swap_u32)
+
+#undef SWAP
+
+static const Babl *
+format (const char *model,
+        const char *type,
+        const char *c0,
+        const char *c1,
+        const char *c2,
+        const char *c3)
+{
+  return babl_format_new (babl_model (model), babl_type (type),
+                          babl_component (c0),
+                          c1 ? babl_component (c1) : NULL,
+                          c2 ? babl_component (c2) : NULL,
+                          c3 ? babl_component (c3) : NULL,
+                          NULL);
+}
+
+#endif /* BABL_VECTOR */
+
+int init (void);
+
+int
+init (void)
+{
+#ifdef BABL_VECTOR
+
+  const Babl *yF_linear     = format ("Y",          "float", "Y",   NULL,  NULL,  NULL);
+  const Babl *yF_gamma      = format ("Y'",         "float", "Y'",  NULL,  NULL,  NULL);
+  const Babl *yaF_linear    = format ("YA",         "float", "Y",   "A",   NULL,  NULL);
+  const Babl *yaF_gamma     = format ("Y'A",        "float", "Y'",  "A",   NULL,  NULL);
+  const Babl *rgbF_linear   = format ("RGB",        "float", "R",   "G",   "B",   NULL);
+  const Babl *rgbF_gamma    = format ("R'G'B'",     "float", "R'",  "G'",  "B'",  NULL);
+  const Babl *rgbaF_linear  = format ("RGBA",       "float", "R",   "G",   "B",   "A");
+  const Babl *rgbaF_gamma   = format ("R'G'B'A",    "float", "R'",  "G'",  "B'",  "A");
+  const Babl *rgbAF_linear  = format ("RaGaBaA",    "float", "Ra",  "Ga",  "Ba",  "A");
+  const Babl *rgbAF_gamma   = format ("R'aG'aB'aA", "float", "R'a", "G'a", "B'a", "A");
+
+  const Babl *y8_gamma      = format ("Y'",         "u8",    "Y'",  NULL,  NULL,  NULL);
+  const Babl *ya8_gamma     = format ("Y'A",        "u8",    "Y'",  "A",   NULL,  NULL);
+  const Babl *rgb8_gamma    = format ("R'G'B'",     "u8",    "R'",  "G'",  "B'",  NULL);
+  const Babl *rgba8_gamma   = format ("R'G'B'A",    "u8",    "R'",  "G'",  "B'",  "A");
+
+  const Babl *y16_gamma     = format ("Y'",         "u16",   "Y'",  NULL,  NULL,  NULL);
+  const Babl *ya16_gamma    = format ("Y'A",        "u16",   "Y'",  "A",   NULL,  NULL);
+  const Babl *rgb16_gamma   = format ("R'G'B'",     "u16",   "R'",  "G'",  "B'",  NULL);
+  const Babl *rgba16_linear = format ("RGBA",       "u16",   "R",   "G",   "B",   "A");
+  const Babl *rgba16_gamma  = format ("R'G'B'A",    "u16",   "R'",  "G'",  "B'",  "A");
+  const Babl *y16_linear    = format ("Y",          "u16",   "Y",   NULL,  NULL,  NULL);
+  const Babl *ya16_linear   = format ("YA",         "u16",   "Y",   "A",   NULL,  NULL);
+  const Babl *rgb16_linear  = format ("RGB",        "u16",   "R",   "G",   "B",   NULL);
+
+  const Babl *y16be_linear    = format ("Y",       "u16be",   "Y",   NULL,  NULL,  NULL);
+  const Babl *y16be_gamma     = format ("Y'",      "u16be",   "Y'",  NULL,  NULL,  NULL);
+  const Babl *ya16be_linear   = format ("YA",      "u16be",   "Y",   "A",   NULL,  NULL);
+  const Babl *ya16be_gamma    = format ("Y'A",     "u16be",   "Y'",  "A",   NULL,  NULL);
+  const Babl *rgb16be_linear  = format ("RGB",     "u16be",   "R",   "G",   "B",   NULL);
+  const Babl *rgb16be_gamma   = format ("R'G'B'",  "u16be",   "R'",  "G'",  "B'",  NULL);
+  const Babl *rgba16be_linear = format ("RGBA",    "u16be",   "R",   "G",   "B",   "A");
+  const Babl *rgba16be_gamma  = format ("R'G'B'A", "u16be",   "R'",  "G'",  "B'",  "A");
+
+  const Babl *yFbe_linear     = format ("Y",       "floatbe", "Y",   NULL,  NULL,  NULL);
+  const Babl *yFbe_gamma      = format ("Y'",      "floatbe", "Y'",  NULL,  NULL,  NULL);
+  const Babl *yaFbe_linear    = format ("YA",      "floatbe", "Y",   "A",   NULL,  NULL);
+  const Babl *yaFbe_gamma     = format ("Y'A",     "floatbe", "Y'",  "A",   NULL,  NULL);
+  const Babl *rgbFbe_linear   = format ("RGB",     "floatbe", "R",   "G",   "B",   NULL);
+  const Babl *rgbFbe_gamma    = format ("R'G'B'",  "floatbe", "R'",  "G'",  "B'",  NULL);
+  const Babl *rgbaFbe_linear  = format ("RGBA",    "floatbe", "R",   "G",   "B",   "A");
+  const Babl *rgbaFbe_gamma   = format ("R'G'B'A", "floatbe", "R'",  "G'",  "B'",  "A");
+
+#define o(src, dst, func)                                                \
+  babl_conversion_new (src, dst, "linear", conv_ ## func,                \
+                       "accel", BABL_CPU_ACCEL_VECTOR, NULL)
+
+/* between the linear and the gamma variant of a format */
+#define TRC(src, dst)                                                    \
+  o (src ## _linear, dst ## _gamma, src ## _linear_ ## dst ## _gamma);   \
+  o (dst ## _gamma, src ## _linear, dst ## _gamma_ ## src ## _linear)
+
+/* between types, for both the linear and the gamma variant */
+#define TYPE(src, dst)                                                   \
+  o (src ## _linear, dst ## _linear, src ## _ ## dst);                   \
+  o (src ## _gamma, dst ## _gamma, src ## _ ## dst)
+
+/* both ways between byte orders, with the one kernel */
+#define SWAP(a, b)                                                       \
+  TYPE (a, b);                                                           \
+  o (b ## _linear, a ## _linear, a ## _ ## b);                           \
+  o (b ## _gamma, a ## _gamma, a ## _ ## b)
+
+  TRC (yF,    yF);
+  TRC (yaF,   yaF);
+  TRC (rgbF,  rgbF);
+  TRC (rgbaF, rgbaF);
+
+  TYPE (rgbaF, rgbAF);
+  TYPE (rgbAF, rgbaF);
+  o (rgbaF_linear, rgbAF_gamma, rgbaF_linear_rgbAF_gamma);
+
+  TRC (yF,    y8);
+  TRC (yaF,   ya8);
+  TRC (rgbF,  rgb8);
+  TRC (rgbaF, rgba8);
+
+  TYPE (rgba16, rgbaF);
+  TYPE (rgba16, rgbAF);
+  TYPE (rgbaF,  rgba16);
+
+  TRC (yF,    y16);
+  TRC (yaF,   ya16);
+  TRC (rgbF,  rgb16);
+  TRC (rgbaF, rgba16);
+
+  TYPE (rgba16be, rgbaF);
+  TYPE (rgba16be, rgbAF);
+  TYPE (rgbaF,    rgba16be);
+
+  TRC (yF,    y16be);
+  TRC (yaF,   ya16be);
+  TRC (rgbF,  rgb16be);
+  TRC (rgbaF, rgba16be);
+
+  TRC (yF,    yFbe);
+  TRC (yaF,   yaFbe);
+  TRC (rgbF,  rgbFbe);
+  TRC (rgbaF, rgbaFbe);
+  TYPE (rgbaFbe, rgbAF);
+
+  SWAP (y16,    y16be);
+  SWAP (ya16,   ya16be);
+  SWAP (rgb16,  rgb16be);
+  SWAP (rgba16, rgba16be);
+  SWAP (yF,     yFbe);
+  SWAP (yaF,    yaFbe);
+  SWAP (rgbF,   rgbFbe);
+  SWAP (rgbaF,  rgbaFbe);
+
+#undef o
+#undef TRC
+#undef TYPE
+#undef SWAP
+
+#endif /* BABL_VECTOR */
+
+  return 0;
+}
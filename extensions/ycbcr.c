@@ -15,12 +15,32 @@
  * <https://www.gnu.org/licenses/>.
  */
 
+/* Y'CbCr with the BT.709 and BT.2020 luma coefficients.
+ *
+ * The models follow the BT.601 Y'CbCr model of the base set, Y' in 0.0-1.0
+ * and Cb, Cr in -0.5-0.5 computed from R'G'B' with the sRGB TRC. The range
+ * of the integer formats is carried by the component types, u8-luma and
+ * u8-chroma for limited (video) range and u8, u8-chroma-full for full
+ * range, likewise for u16.
+ *
+ * Between these formats and R'G'B' the conversion is a 3x3 matrix and an
+ * offset on the stored values, which is what the SSE2 fast paths at the end
+ * of the file compute in single precision.
+ */
+
 #include "config.h"
 
 #include <math.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
+#if defined(USE_SSE2)
+#include <emmintrin.h>
+#endif
+
 #include "babl.h"
+#include "babl-cpuaccel.h"
 #include "base/util.h"
 
 
@@ -28,6 +48,7 @@ static void components  (void);
 static void models      (void);
 static void conversions (void);
 static void formats     (void);
+static void fast_paths  (void);
 
 int init (void);
 
@@ -39,11 +60,19 @@ init (void)
   models ();
   conversions ();
   formats ();
+  fast_paths ();
 
   return 0;
 }
 
 
+/* luma coefficients of red and blue, green is the remainder */
+#define KR_709   0.2126
+#define KB_709   0.0722
+#define KR_2020  0.2627
+#define KB_2020  0.0593
+
+
 static void
 components (void)
 {
@@ -59,6 +88,7 @@ models (void)
     babl_component ("Y'"),
     babl_component ("Cb"),
     babl_component ("Cr"),
+    "doc", "Y'CbCr with BT.709 coefficients, NB! math is tuned to sRGB space",
     NULL);
 
   babl_model_new (
@@ -68,142 +98,165 @@ models (void)
     babl_component ("Cr"),
     babl_component ("alpha"),
     "alpha",
+    "doc", "Y'CbCr with BT.709 coefficients, separate alpha NB! math is tuned to sRGB space",
     NULL);
-}
-
-
-static void
-rgba_to_ycbcra709 (const Babl *conversion,
-                   char       *src,
-                   char       *dst,
-                   long        n)
-{
-  while (n--)
-    {
-      double red   = ((double *) src)[0];
-      double green = ((double *) src)[1];
-      double blue  = ((double *) src)[2];
-      double alpha = ((double *) src)[3];
-
-      double luminance, cb, cr;
 
-      red   = linear_to_gamma_2_2 (red);
-      green = linear_to_gamma_2_2 (green);
-      blue  = linear_to_gamma_2_2 (blue);
+  babl_model_new (
+    "name", "Y'CbCr2020",
+    babl_component ("Y'"),
+    babl_component ("Cb"),
+    babl_component ("Cr"),
+    "doc", "Y'CbCr with BT.2020 non-constant luminance coefficients, NB! math is tuned to sRGB space",
+    NULL);
 
-      luminance =  0.2126 * red + 0.7152 * green + 0.0722 * blue;
-      cb        =  (blue - luminance) / 1.8556;
-      cr        =  (red  - luminance) / 1.5748;
+  babl_model_new (
+    "name", "Y'CbCrA2020",
+    babl_component ("Y'"),
+    babl_component ("Cb"),
+    babl_component ("Cr"),
+    babl_component ("alpha"),
+    "alpha",
+    "doc", "Y'CbCr with BT.2020 non-constant luminance coefficients, separate alpha NB! math is tuned to sRGB space",
+    NULL);
+}
 
-      ((double *) dst)[0] = luminance;
-      ((double *) dst)[1] = cb;
-      ((double *) dst)[2] = cr;
-      ((double *) dst)[3] = alpha;
 
-      src += sizeof (double) * 4;
-      dst += sizeof (double) * 4;
-    }
+/* the rows of the R'G'B' to Y'CbCr matrix and of its inverse */
+static inline void
+ycbcr_matrices (double kr,
+                double kb,
+                double to_ycbcr[3][3],
+                double to_rgb[3][3])
+{
+  double kg = 1.0 - kr - kb;
+
+  to_ycbcr[0][0] = kr;
+  to_ycbcr[0][1] = kg;
+  to_ycbcr[0][2] = kb;
+  to_ycbcr[1][0] = -kr / (2.0 * (1.0 - kb));
+  to_ycbcr[1][1] = -kg / (2.0 * (1.0 - kb));
+  to_ycbcr[1][2] = 0.5;
+  to_ycbcr[2][0] = 0.5;
+  to_ycbcr[2][1] = -kg / (2.0 * (1.0 - kr));
+  to_ycbcr[2][2] = -kb / (2.0 * (1.0 - kr));
+
+  to_rgb[0][0] = 1.0;
+  to_rgb[0][1] = 0.0;
+  to_rgb[0][2] = 2.0 * (1.0 - kr);
+  to_rgb[1][0] = 1.0;
+  to_rgb[1][1] = -2.0 * kb * (1.0 - kb) / kg;
+  to_rgb[1][2] = -2.0 * kr * (1.0 - kr) / kg;
+  to_rgb[2][0] = 1.0;
+  to_rgb[2][1] = 2.0 * (1.0 - kb);
+  to_rgb[2][2] = 0.0;
 }
 
 
-static void
-rgba_to_ycbcr709 (const Babl *conversion,
-                  char       *src,
-                  char       *dst,
-                  long        n)
+static inline void
+rgba_to_ycbcr_generic (double  kr,
+                       double  kb,
+                       int     alpha,
+                       char   *src,
+                       char   *dst,
+                       long    n)
 {
-  while (n--)
-    {
-      double red   = ((double *) src)[0];
-      double green = ((double *) src)[1];
-      double blue  = ((double *) src)[2];
-
-      double luminance, cb, cr;
+  double m[3][3], unused[3][3];
 
-      red   = linear_to_gamma_2_2 (red);
-      green = linear_to_gamma_2_2 (green);
-      blue  = linear_to_gamma_2_2 (blue);
+  ycbcr_matrices (kr, kb, m, unused);
 
-      luminance =  0.2126 * red + 0.7152 * green + 0.0722 * blue;
-      cb        =  (blue - luminance) / 1.8556;
-      cr        =  (red  - luminance) / 1.5748;
+  while (n--)
+    {
+      double red   = linear_to_gamma_2_2 (((double *) src)[0]);
+      double green = linear_to_gamma_2_2 (((double *) src)[1]);
+      double blue  = linear_to_gamma_2_2 (((double *) src)[2]);
 
-      ((double *) dst)[0] = luminance;
-      ((double *) dst)[1] = cb;
-      ((double *) dst)[2] = cr;
+      ((double *) dst)[0] = m[0][0] * red + m[0][1] * green + m[0][2] * blue;
+      ((double *) dst)[1] = m[1][0] * red + m[1][1] * green + m[1][2] * blue;
+      ((double *) dst)[2] = m[2][0] * red + m[2][1] * green + m[2][2] * blue;
+      if (alpha)
+        ((double *) dst)[3] = ((double *) src)[3];
 
       src += sizeof (double) * 4;
-      dst += sizeof (double) * 3;
+      dst += sizeof (double) * (alpha ? 4 : 3);
     }
 }
 
 
-static void
-ycbcra709_to_rgba (const Babl *conversion,
-                   char       *src,
-                   char       *dst,
-                   long        n)
+static inline void
+ycbcr_to_rgba_generic (double  kr,
+                       double  kb,
+                       int     alpha,
+                       char   *src,
+                       char   *dst,
+                       long    n)
 {
+  double unused[3][3], m[3][3];
+
+  ycbcr_matrices (kr, kb, unused, m);
+
   while (n--)
     {
       double luminance = ((double *) src)[0];
       double cb        = ((double *) src)[1];
       double cr        = ((double *) src)[2];
-      double alpha     = ((double *) src)[3];
 
       double red, green, blue;
 
-      red   = 1.0 * luminance + 0.0    * cb + 1.5748 * cr;
-      green = 1.0 * luminance - 0.1873 * cb - 0.4681 * cr;
-      blue  = 1.0 * luminance + 1.8556 * cb + 0.0    * cr;
-
-      red   = gamma_2_2_to_linear (red);
-      green = gamma_2_2_to_linear (green);
-      blue  = gamma_2_2_to_linear (blue);
+      red   = m[0][0] * luminance + m[0][1] * cb + m[0][2] * cr;
+      green = m[1][0] * luminance + m[1][1] * cb + m[1][2] * cr;
+      blue  = m[2][0] * luminance + m[2][1] * cb + m[2][2] * cr;
 
-      ((double *) dst)[0] = red;
-      ((double *) dst)[1] = green;
-      ((double *) dst)[2] = blue;
-      ((double *) dst)[3] = alpha;
+      ((double *) dst)[0] = gamma_2_2_to_linear (red);
+      ((double *) dst)[1] = gamma_2_2_to_linear (green);
+      ((double *) dst)[2] = gamma_2_2_to_linear (blue);
+      ((double *) dst)[3] = alpha ? ((double *) src)[3] : 1.0;
 
-      src += sizeof (double) * 4;
+      src += sizeof (double) * (alpha ? 4 : 3);
       dst += sizeof (double) * 4;
     }
 }
 
 
-static void
-ycbcr709_to_rgba (const Babl *conversion,
-                  char       *src,
-                  char       *dst,
-                  long        n)
-{
-  while (n--)
-    {
-      double luminance = ((double *) src)[0];
-      double cb        = ((double *) src)[1];
-      double cr        = ((double *) src)[2];
-
-      double red, green, blue;
-
-      red   = 1.0 * luminance + 0.0    * cb + 1.5748 * cr;
-      green = 1.0 * luminance - 0.1873 * cb - 0.4681 * cr;
-      blue  = 1.0 * luminance + 1.8556 * cb + 0.0    * cr;
-
-      red   = gamma_2_2_to_linear (red);
-      green = gamma_2_2_to_linear (green);
-      blue  = gamma_2_2_to_linear (blue);
-
-      ((double *) dst)[0] = red;
-      ((double *) dst)[1] = green;
-      ((double *) dst)[2] = blue;
-      ((double *) dst)[3] = 1.0;
-
-      src += sizeof (double) * 3;
-      dst += sizeof (double) * 4;
-    }
+/* model conversions do not get user data when aliased to other spaces,
+ * so there is one set of functions per matrix
+ */
+#define YCBCR_MODEL_CONVERSIONS(name, kr, kb)                              \
+static void                                                                \
+rgba_to_ycbcra##name (const Babl *conversion,                              \
+                      char       *src,                                     \
+                      char       *dst,                                     \
+                      long        n)                                       \
+{                                                                          \
+  rgba_to_ycbcr_generic (kr, kb, 1, src, dst, n);                          \
+}                                                                          \
+static void                                                                \
+rgba_to_ycbcr##name (const Babl *conversion,                               \
+                     char       *src,                                      \
+                     char       *dst,                                      \
+                     long        n)                                        \
+{                                                                          \
+  rgba_to_ycbcr_generic (kr, kb, 0, src, dst, n);                          \
+}                                                                          \
+static void                                                                \
+ycbcra##name##_to_rgba (const Babl *conversion,                            \
+                        char       *src,                                   \
+                        char       *dst,                                   \
+                        long        n)                                     \
+{                                                                          \
+  ycbcr_to_rgba_generic (kr, kb, 1, src, dst, n);                          \
+}                                                                          \
+static void                                                                \
+ycbcr##name##_to_rgba (const Babl *conversion,                             \
+                       char       *src,                                    \
+                       char       *dst,                                    \
+                       long        n)                                      \
+{                                                                          \
+  ycbcr_to_rgba_generic (kr, kb, 0, src, dst, n);                          \
 }
 
+YCBCR_MODEL_CONVERSIONS (709, KR_709, KB_709)
+YCBCR_MODEL_CONVERSIONS (2020, KR_2020, KB_2020)
+
 
 static void
 conversions (void)
@@ -232,6 +285,49 @@ conversions (void)
     "linear", ycbcr709_to_rgba,
     NULL
   );
+
+  babl_conversion_new (
+    babl_model ("RGBA"),
+    babl_model ("Y'CbCr2020"),
+    "linear", rgba_to_ycbcr2020,
+    NULL
+  );
+  babl_conversion_new (
+    babl_model ("RGBA"),
+    babl_model ("Y'CbCrA2020"),
+    "linear", rgba_to_ycbcra2020,
+    NULL
+  );
+  babl_conversion_new (
+    babl_model ("Y'CbCrA2020"),
+    babl_model ("RGBA"),
+    "linear", ycbcra2020_to_rgba,
+    NULL
+  );
+  babl_conversion_new (
+    babl_model ("Y'CbCr2020"),
+    babl_model ("RGBA"),
+    "linear", ycbcr2020_to_rgba,
+    NULL
+  );
+}
+
+
+static const Babl *
+ycbcr_format (const char *name,
+              const char *model,
+              const char *luma_type,
+              const char *chroma_type)
+{
+  return babl_format_new (
+    "name", name,
+    babl_model (model),
+    babl_type (luma_type),
+    babl_component ("Y'"),
+    babl_type (chroma_type),
+    babl_component ("Cb"),
+    babl_component ("Cr"),
+    NULL);
 }
 
 
@@ -256,4 +352,549 @@ formats (void)
     babl_component ("Cb"),
     babl_component ("Cr"),
     NULL);
+
+  babl_format_new (
+    babl_model ("Y'CbCrA2020"),
+    babl_type ("float"),
+    babl_component ("Y'"),
+    babl_type ("float"),
+    babl_component ("Cb"),
+    babl_component ("Cr"),
+    babl_component ("alpha"),
+    NULL);
+
+  babl_format_new (
+    babl_model ("Y'CbCr2020"),
+    babl_type ("float"),
+    babl_component ("Y'"),
+    babl_type ("float"),
+    babl_component ("Cb"),
+    babl_component ("Cr"),
+    NULL);
+
+  ycbcr_format ("Y'CbCr709 u8",       "Y'CbCr709",  "u8-luma",  "u8-chroma");
+  ycbcr_format ("Y'CbCr709 full u8",  "Y'CbCr709",  "u8",       "u8-chroma-full");
+  ycbcr_format ("Y'CbCr709 u16",      "Y'CbCr709",  "u16-luma", "u16-chroma");
+  ycbcr_format ("Y'CbCr709 full u16", "Y'CbCr709",  "u16",      "u16-chroma-full");
+
+  ycbcr_format ("Y'CbCr2020 u8",       "Y'CbCr2020", "u8-luma",  "u8-chroma");
+  ycbcr_format ("Y'CbCr2020 full u8",  "Y'CbCr2020", "u8",       "u8-chroma-full");
+  ycbcr_format ("Y'CbCr2020 u16",      "Y'CbCr2020", "u16-luma", "u16-chroma");
+  ycbcr_format ("Y'CbCr2020 full u16", "Y'CbCr2020", "u16",      "u16-chroma-full");
+}
+
+
+#if defined(USE_SSE2)
+
+/* how stored values relate to the 0.0-1.0 (-0.5-0.5 for chroma) values
+ * of the models, value = (stored - offset) / scale, with integer sources
+ * clamped to min-max like the types do
+ */
+typedef struct
+{
+  double offset;
+  double scale;
+  double min;
+  double max;
+} Quantization;
+
+static const Quantization q_float        = { 0.0,     1.0,     0.0,    0.0 };
+static const Quantization q_u8           = { 0.0,     255.0,   0.0,    255.0 };
+static const Quantization q_u8_luma      = { 16.0,    219.0,   16.0,   235.0 };
+static const Quantization q_u8_chroma    = { 128.0,   224.0,   16.0,   240.0 };
+static const Quantization q_u8_full      = { 128.0,   255.0,   0.0,    255.0 };
+static const Quantization q_u16          = { 0.0,     65535.0, 0.0,    65535.0 };
+static const Quantization q_u16_luma     = { 4096.0,  56064.0, 4096.0, 60160.0 };
+static const Quantization q_u16_chroma   = { 32768.0, 57344.0, 4096.0, 61440.0 };
+static const Quantization q_u16_full     = { 32768.0, 65535.0, 0.0,    65535.0 };
+
+/* stored destination = matrix * clamped stored source + offset */
+typedef struct
+{
+  float matrix[3][3];
+  float offset[3];
+  float min[3];
+  float max[3];
+} YCbCrTransform;
+
+#define MAX_TRANSFORMS 20
+
+static YCbCrTransform transforms[MAX_TRANSFORMS];
+static int            n_transforms;
+
+static const YCbCrTransform *
+transform_new (const double        m[3][3],
+               const Quantization *source,
+               const Quantization *destination)
+{
+  YCbCrTransform *t = &transforms[n_transforms++];
+  int             i, j;
+
+  for (i = 0; i < 3; i++)
+    {
+      double offset = destination[i].offset;
+
+      for (j = 0; j < 3; j++)
+        {
+          double a = destination[i].scale * m[i][j] / source[j].scale;
+
+          t->matrix[i][j] = a;
+          offset         -= a * source[j].offset;
+        }
+      t->offset[i] = offset;
+      t->min[i]    = source[i].min;
+      t->max[i]    = source[i].max;
+    }
+
+  return t;
+}
+
+
+static inline float
+clampf (float v,
+        float min,
+        float max)
+{
+  return v < min ? min : v > max ? max : v;
+}
+
+static inline void
+ycbcr_scalar (const YCbCrTransform *t,
+              const float          *x,
+              float                *y)
+{
+  int i;
+
+  for (i = 0; i < 3; i++)
+    y[i] = t->matrix[i][0] * x[0] + t->matrix[i][1] * x[1] +
+           t->matrix[i][2] * x[2] + t->offset[i];
+}
+
+typedef struct
+{
+  __m128 m[3][3];
+  __m128 o[3];
+} MatrixPS;
+
+static inline void
+matrix_ps_init (MatrixPS             *m,
+                const YCbCrTransform *t)
+{
+  int i, j;
+
+  for (i = 0; i < 3; i++)
+    {
+      for (j = 0; j < 3; j++)
+        m->m[i][j] = _mm_set1_ps (t->matrix[i][j]);
+      m->o[i] = _mm_set1_ps (t->offset[i]);
+    }
+}
+
+static inline __m128
+matrix_ps_row (const MatrixPS *m,
+               int             i,
+               __m128          x0,
+               __m128          x1,
+               __m128          x2)
+{
+  return _mm_add_ps (_mm_add_ps (_mm_mul_ps (m->m[i][0], x0),
+                                 _mm_mul_ps (m->m[i][1], x1)),
+                     _mm_add_ps (_mm_mul_ps (m->m[i][2], x2), m->o[i]));
+}
+
+static inline void
+ycbcr_float (const YCbCrTransform *t,
+             const float          *src,
+             float                *dst,
+             long                  n,
+             const int             src_components,
+             const int             dst_components)
+{
+  const __m128 one = _mm_set1_ps (1.0f);
+  MatrixPS     m;
+
+  matrix_ps_init (&m, t);
+
+  for (; n >= 4; n -= 4)
+    {
+      __m128 x0, x1, x2, a, y0, y1, y2;
+
+      if (src_components == 4)
+        {
+          x0 = _mm_loadu_ps (src);
+          x1 = _mm_loadu_ps (src + 4);
+          x2 = _mm_loadu_ps (src + 8);
+          a  = _mm_loadu_ps (src + 12);
+          _MM_TRANSPOSE4_PS (x0, x1, x2, a);
+        }
+      else
+        {
+          x0 = _mm_setr_ps (src[0], src[3], src[6], src[9]);
+          x1 = _mm_setr_ps (src[1], src[4], src[7], src[10]);
+          x2 = _mm_setr_ps (src[2], src[5], src[8], src[11]);
+          a  = one;
+        }
+
+      y0 = matrix_ps_row (&m, 0, x0, x1, x2);
+      y1 = matrix_ps_row (&m, 1, x0, x1, x2);
+      y2 = matrix_ps_row (&m, 2, x0, x1, x2);
+
+      if (dst_components == 4)
+        {
+          _MM_TRANSPOSE4_PS (y0, y1, y2, a);
+          _mm_storeu_ps (dst, y0);
+          _mm_storeu_ps (dst + 4, y1);
+          _mm_storeu_ps (dst + 8, y2);
+          _mm_storeu_ps (dst + 12, a);
+        }
+      else
+        {
+          float out[3][4];
+          int   i;
+
+          _mm_storeu_ps (out[0], y0);
+          _mm_storeu_ps (out[1], y1);
+          _mm_storeu_ps (out[2], y2);
+          for (i = 0; i < 4; i++)
+            {
+              dst[i * 3 + 0] = out[0][i];
+              dst[i * 3 + 1] = out[1][i];
+              dst[i * 3 + 2] = out[2][i];
+            }
+        }
+
+      src += 4 * src_components;
+      dst += 4 * dst_components;
+    }
+
+  while (n--)
+    {
+      ycbcr_scalar (t, src, dst);
+      if (dst_components == 4)
+        dst[3] = src_components == 4 ? src[3] : 1.0f;
+
+      src += src_components;
+      dst += dst_components;
+    }
+}
+
+/* components are unpacked to and packed from 16 bit lanes with integer
+ * operations, the matrix is applied in single precision - 16 bit fixed
+ * point is off by one too often to pass as a fast path
+ */
+static inline __m128i
+ycbcr_u8_row (const MatrixPS *m,
+              int             i,
+              __m128i         x0,
+              __m128i         x1,
+              __m128i         x2)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128 lo, hi;
+
+  lo = matrix_ps_row (m, i,
+                      _mm_cvtepi32_ps (_mm_unpacklo_epi16 (x0, zero)),
+                      _mm_cvtepi32_ps (_mm_unpacklo_epi16 (x1, zero)),
+                      _mm_cvtepi32_ps (_mm_unpacklo_epi16 (x2, zero)));
+  hi = matrix_ps_row (m, i,
+                      _mm_cvtepi32_ps (_mm_unpackhi_epi16 (x0, zero)),
+                      _mm_cvtepi32_ps (_mm_unpackhi_epi16 (x1, zero)),
+                      _mm_cvtepi32_ps (_mm_unpackhi_epi16 (x2, zero)));
+
+  return _mm_packs_epi32 (_mm_cvtps_epi32 (lo), _mm_cvtps_epi32 (hi));
+}
+
+static inline void
+ycbcr_u8 (const YCbCrTransform *t,
+          const uint8_t        *src,
+          uint8_t              *dst,
+          long                  n,
+          const int             src_components,
+          const int             dst_components)
+{
+  const __m128i min0 = _mm_set1_epi16 (t->min[0]);
+  const __m128i min1 = _mm_set1_epi16 (t->min[1]);
+  const __m128i min2 = _mm_set1_epi16 (t->min[2]);
+  const __m128i max0 = _mm_set1_epi16 (t->max[0]);
+  const __m128i max1 = _mm_set1_epi16 (t->max[1]);
+  const __m128i max2 = _mm_set1_epi16 (t->max[2]);
+  const __m128i mask = _mm_set1_epi32 (0xff);
+  MatrixPS      m;
+
+  matrix_ps_init (&m, t);
+
+  /* eight pixels at a time */
+  for (; n >= 8; n -= 8)
+    {
+      __m128i x0, x1, x2, a, y0, y1, y2;
+
+      if (src_components == 4)
+        {
+          __m128i p0 = _mm_loadu_si128 ((const __m128i *) src);
+          __m128i p1 = _mm_loadu_si128 ((const __m128i *) (src + 16));
+
+          x0 = _mm_packs_epi32 (_mm_and_si128 (p0, mask),
+                                _mm_and_si128 (p1, mask));
+          x1 = _mm_packs_epi32 (_mm_and_si128 (_mm_srli_epi32 (p0, 8), mask),
+                                _mm_and_si128 (_mm_srli_epi32 (p1, 8), mask));
+          x2 = _mm_packs_epi32 (_mm_and_si128 (_mm_srli_epi32 (p0, 16), mask),
+                                _mm_and_si128 (_mm_srli_epi32 (p1, 16), mask));
+          a  = _mm_packs_epi32 (_mm_srli_epi32 (p0, 24),
+                                _mm_srli_epi32 (p1, 24));
+        }
+      else
+        {
+          x0 = _mm_setr_epi16 (src[0], src[3], src[6], src[9],
+                               src[12], src[15], src[18], src[21]);
+          x1 = _mm_setr_epi16 (src[1], src[4], src[7], src[10],
+                               src[13], src[16], src[19], src[22]);
+          x2 = _mm_setr_epi16 (src[2], src[5], src[8], src[11],
+                               src[14], src[17], src[20], src[23]);
+          a  = _mm_set1_epi16 (255);
+        }
+
+      x0 = _mm_min_epi16 (_mm_max_epi16 (x0, min0), max0);
+      x1 = _mm_min_epi16 (_mm_max_epi16 (x1, min1), max1);
+      x2 = _mm_min_epi16 (_mm_max_epi16 (x2, min2), max2);
+
+      y0 = ycbcr_u8_row (&m, 0, x0, x1, x2);
+      y1 = ycbcr_u8_row (&m, 1, x0, x1, x2);
+      y2 = ycbcr_u8_row (&m, 2, x0, x1, x2);
+
+      if (dst_components == 4)
+        {
+          __m128i b01 = _mm_packus_epi16 (y0, y1);
+          __m128i b2a = _mm_packus_epi16 (y2, a);
+          __m128i p01 = _mm_unpacklo_epi8 (b01, _mm_srli_si128 (b01, 8));
+          __m128i p2a = _mm_unpacklo_epi8 (b2a, _mm_srli_si128 (b2a, 8));
+
+          _mm_storeu_si128 ((__m128i *) dst, _mm_unpacklo_epi16 (p01, p2a));
+          _mm_storeu_si128 ((__m128i *) (dst + 16), _mm_unpackhi_epi16 (p01, p2a));
+        }
+      else
+        {
+          uint8_t out[3][16];
+          int     i;
+
+          _mm_storeu_si128 ((__m128i *) out[0], _mm_packus_epi16 (y0, y0));
+          _mm_storeu_si128 ((__m128i *) out[1], _mm_packus_epi16 (y1, y1));
+          _mm_storeu_si128 ((__m128i *) out[2], _mm_packus_epi16 (y2, y2));
+          for (i = 0; i < 8; i++)
+            {
+              dst[i * 3 + 0] = out[0][i];
+              dst[i * 3 + 1] = out[1][i];
+              dst[i * 3 + 2] = out[2][i];
+            }
+        }
+
+      src += 8 * src_components;
+      dst += 8 * dst_components;
+    }
+
+  while (n--)
+    {
+      float x[3], y[3];
+      int   i;
+
+      for (i = 0; i < 3; i++)
+        x[i] = clampf (src[i], t->min[i], t->max[i]);
+      ycbcr_scalar (t, x, y);
+      for (i = 0; i < 3; i++)
+        dst[i] = lrintf (clampf (y[i], 0.0f, 255.0f));
+      if (dst_components == 4)
+        dst[3] = src_components == 4 ? src[3] : 255;
+
+      src += src_components;
+      dst += dst_components;
+    }
+}
+
+static inline void
+ycbcr_u16 (const YCbCrTransform *t,
+           const uint16_t       *src,
+           uint16_t             *dst,
+           long                  n,
+           const int             src_components,
+           const int             dst_components)
+{
+  const __m128 min0 = _mm_set1_ps (t->min[0]);
+  const __m128 min1 = _mm_set1_ps (t->min[1]);
+  const __m128 min2 = _mm_set1_ps (t->min[2]);
+  const __m128 max0 = _mm_set1_ps (t->max[0]);
+  const __m128 max1 = _mm_set1_ps (t->max[1]);
+  const __m128 max2 = _mm_set1_ps (t->max[2]);
+  const __m128 low  = _mm_setzero_ps ();
+  const __m128 high = _mm_set1_ps (65535.0f);
+  MatrixPS     m;
+
+  matrix_ps_init (&m, t);
+
+  for (; n >= 4; n -= 4)
+    {
+      const int s = src_components;
+      int32_t   out[3][4];
+      __m128    x0, x1, x2;
+      int       i;
+
+      x0 = _mm_cvtepi32_ps (_mm_setr_epi32 (src[0], src[s], src[2 * s], src[3 * s]));
+      x1 = _mm_cvtepi32_ps (_mm_setr_epi32 (src[1], src[s + 1], src[2 * s + 1], src[3 * s + 1]));
+      x2 = _mm_cvtepi32_ps (_mm_setr_epi32 (src[2], src[s + 2], src[2 * s + 2], src[3 * s + 2]));
+
+      x0 = _mm_min_ps (_mm_max_ps (x0, min0), max0);
+      x1 = _mm_min_ps (_mm_max_ps (x1, min1), max1);
+      x2 = _mm_min_ps (_mm_max_ps (x2, min2), max2);
+
+      for (i = 0; i < 3; i++)
+        _mm_storeu_si128 ((__m128i *) out[i],
+                          _mm_cvtps_epi32 (_mm_min_ps (_mm_max_ps (
+                            matrix_ps_row (&m, i, x0, x1, x2), low), high)));
+
+      for (i = 0; i < 4; i++)
+        {
+          dst[0] = out[0][i];
+          dst[1] = out[1][i];
+          dst[2] = out[2][i];
+          if (dst_components == 4)
+            dst[3] = src_components == 4 ? src[3] : 65535;
+
+          src += src_components;
+          dst += dst_components;
+        }
+    }
+
+  while (n--)
+    {
+      float x[3], y[3];
+      int   i;
+
+      for (i = 0; i < 3; i++)
+        x[i] = clampf (src[i], t->min[i], t->max[i]);
+      ycbcr_scalar (t, x, y);
+      for (i = 0; i < 3; i++)
+        dst[i] = lrintf (clampf (y[i], 0.0f, 65535.0f));
+      if (dst_components == 4)
+        dst[3] = src_components == 4 ? src[3] : 65535;
+
+      src += src_components;
+      dst += dst_components;
+    }
+}
+
+#define YCBCR_FAST_PATH(kernel, type, src_components, dst_components)      \
+static void                                                                \
+conv_##kernel##_##src_components##_##dst_components (const Babl *conversion,\
+                                                     const char *src,      \
+                                                     char       *dst,      \
+                                                     long        samples,  \
+                                                     void       *data)     \
+{                                                                          \
+  ycbcr_##kernel (data, (const type *) src, (type *) dst, samples,         \
+                  src_components, dst_components);                         \
+}
+
+YCBCR_FAST_PATH (float, float, 3, 3)
+YCBCR_FAST_PATH (float, float, 3, 4)
+YCBCR_FAST_PATH (float, float, 4, 3)
+YCBCR_FAST_PATH (float, float, 4, 4)
+YCBCR_FAST_PATH (u8, uint8_t, 3, 3)
+YCBCR_FAST_PATH (u8, uint8_t, 3, 4)
+YCBCR_FAST_PATH (u8, uint8_t, 4, 3)
+YCBCR_FAST_PATH (u16, uint16_t, 3, 3)
+YCBCR_FAST_PATH (u16, uint16_t, 3, 4)
+YCBCR_FAST_PATH (u16, uint16_t, 4, 3)
+
+static void
+register_pair (const Babl           *rgb,
+               const Babl           *ycbcr,
+               BablFuncLinear        encode,
+               const YCbCrTransform *to_ycbcr,
+               BablFuncLinear        decode,
+               const YCbCrTransform *to_rgb)
+{
+  babl_conversion_new (rgb, ycbcr, "linear", encode, "data", to_ycbcr,
+                       "accel", BABL_CPU_ACCEL_X86_SSE | BABL_CPU_ACCEL_X86_SSE2,
+                       NULL);
+  babl_conversion_new (ycbcr, rgb, "linear", decode, "data", to_rgb,
+                       "accel", BABL_CPU_ACCEL_X86_SSE | BABL_CPU_ACCEL_X86_SSE2,
+                       NULL);
+}
+
+static void
+fast_paths_for_matrix (const char *name,
+                       double      kr,
+                       double      kb)
+{
+  const Quantization float3[3]      = { q_float, q_float, q_float };
+  const Quantization u8_rgb[3]      = { q_u8, q_u8, q_u8 };
+  const Quantization u8_limited[3]  = { q_u8_luma, q_u8_chroma, q_u8_chroma };
+  const Quantization u8_full[3]     = { q_u8, q_u8_full, q_u8_full };
+  const Quantization u16_rgb[3]     = { q_u16, q_u16, q_u16 };
+  const Quantization u16_limited[3] = { q_u16_luma, q_u16_chroma, q_u16_chroma };
+  const Quantization u16_full[3]    = { q_u16, q_u16_full, q_u16_full };
+  const Babl *rgbaF  = babl_format ("R'G'B'A float");
+  const Babl *rgbF   = babl_format ("R'G'B' float");
+  const Babl *rgba8  = babl_format ("R'G'B'A u8");
+  const Babl *rgb8   = babl_format ("R'G'B' u8");
+  const Babl *rgba16 = babl_format ("R'G'B'A u16");
+  const Babl *rgb16  = babl_format ("R'G'B' u16");
+  const YCbCrTransform *to_ycbcr, *to_rgb;
+  double m[3][3], inverse[3][3];
+  char   format_name[64];
+
+  ycbcr_matrices (kr, kb, m, inverse);
+
+  to_ycbcr = transform_new (m, float3, float3);
+  to_rgb   = transform_new (inverse, float3, float3);
+  snprintf (format_name, sizeof (format_name), "Y'CbCr%s float", name);
+  register_pair (rgbF, babl_format (format_name),
+                 conv_float_3_3, to_ycbcr, conv_float_3_3, to_rgb);
+  register_pair (rgbaF, babl_format (format_name),
+                 conv_float_4_3, to_ycbcr, conv_float_3_4, to_rgb);
+  snprintf (format_name, sizeof (format_name), "Y'CbCrA%s float", name);
+  register_pair (rgbaF, babl_format (format_name),
+                 conv_float_4_4, to_ycbcr, conv_float_4_4, to_rgb);
+
+  to_ycbcr = transform_new (m, u8_rgb, u8_limited);
+  to_rgb   = transform_new (inverse, u8_limited, u8_rgb);
+  snprintf (format_name, sizeof (format_name), "Y'CbCr%s u8", name);
+  register_pair (rgb8, babl_format (format_name),
+                 conv_u8_3_3, to_ycbcr, conv_u8_3_3, to_rgb);
+  register_pair (rgba8, babl_format (format_name),
+                 conv_u8_4_3, to_ycbcr, conv_u8_3_4, to_rgb);
+
+  to_ycbcr = transform_new (m, u8_rgb, u8_full);
+  to_rgb   = transform_new (inverse, u8_full, u8_rgb);
+  snprintf (format_name, sizeof (format_name), "Y'CbCr%s full u8", name);
+  register_pair (rgb8, babl_format (format_name),
+                 conv_u8_3_3, to_ycbcr, conv_u8_3_3, to_rgb);
+  register_pair (rgba8, babl_format (format_name),
+                 conv_u8_4_3, to_ycbcr, conv_u8_3_4, to_rgb);
+
+  to_ycbcr = transform_new (m, u16_rgb, u16_limited);
+  to_rgb   = transform_new (inverse, u16_limited, u16_rgb);
+  snprintf (format_name, sizeof (format_name), "Y'CbCr%s u16", name);
+  register_pair (rgb16, babl_format (format_name),
+                 conv_u16_3_3, to_ycbcr, conv_u16_3_3, to_rgb);
+  register_pair (rgba16, babl_format (format_name),
+                 conv_u16_4_3, to_ycbcr, conv_u16_3_4, to_rgb);
+
+  to_ycbcr = transform_new (m, u16_rgb, u16_full);
+  to_rgb   = transform_new (inverse, u16_full, u16_rgb);
+  snprintf (format_name, sizeof (format_name), "Y'CbCr%s full u16", name);
+  register_pair (rgb16, babl_format (format_name),
+                 conv_u16_3_3, to_ycbcr, conv_u16_3_3, to_rgb);
+  register_pair (rgba16, babl_format (format_name),
+                 conv_u16_4_3, to_ycbcr, conv_u16_3_4, to_rgb);
+}
+
+#endif /* defined(USE_SSE2) */
+
+
+static void
+fast_paths (void)
+{
+#if defined(USE_SSE2)
+  fast_paths_for_matrix ("709", KR_709, KB_709);
+  fast_paths_for_matrix ("2020", KR_2020, KB_2020);
+#endif /* defined(USE_SSE2) */
 }
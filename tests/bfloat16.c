@@ -0,0 +1,210 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "babl.h"
+#include "common.inc"
+
+/* not a multiple of the 8 or 16 floats the AVX2 and AVX-512 conversions
+ * take at a time
+ */
+#define PIXELS 4099
+
+static int
+is_nan (uint32_t bits)
+{
+  return (bits & 0x7fffffff) > 0x7f800000;
+}
+
+/* round to nearest even */
+static uint16_t
+expected_bfloat16 (uint32_t bits)
+{
+  return (bits + 0x7fff + ((bits >> 16) & 1)) >> 16;
+}
+
+/* every float pattern rounds to the nearest bfloat16, ties to even, with
+ * the halfway cases, denormals, infinities and NaNs among them
+ */
+static int
+test_from_float (const char *model)
+{
+  static uint32_t floats[PIXELS * 4];
+  static uint16_t result[PIXELS * 4];
+  char            name[64];
+  const Babl     *source;
+  const Babl     *fish;
+  int             components;
+  long            n;
+  long            i;
+
+  snprintf (name, sizeof (name), "%s float", model);
+  source = babl_format (name);
+  snprintf (name, sizeof (name), "%s bfloat16", model);
+  fish = babl_fish (source, babl_format (name));
+  components = babl_format_get_n_components (source);
+  n = PIXELS * components;
+
+  for (i = 0; i < n; i++)
+    {
+      uint32_t bits = test_hash (i);
+
+      switch (i % 4)
+        {
+          case 0: /* the values of images, with the alpha of 1.0 */
+            bits = 0x3f800000 - (bits >> 9);
+            break;
+          case 1: /* halfway between two bfloat16s */
+            bits = (bits & 0xffff0000) | 0x8000;
+            break;
+        }
+      floats[i] = bits;
+    }
+
+  babl_process (fish, floats, result, PIXELS);
+
+  for (i = 0; i < n; i++)
+    if (is_nan (floats[i]) ? !is_nan ((uint32_t) result[i] << 16) ||
+                             (result[i] ^ (floats[i] >> 16)) & 0x8000 :
+                             result[i] != expected_bfloat16 (floats[i]))
+      {
+        printf ("%s: %08x became %04x, expected %04x\n", babl_get_name (fish),
+                floats[i], result[i], expected_bfloat16 (floats[i]));
+        return 0;
+      }
+  return 1;
+}
+
+/* and every bfloat16 is exactly a float */
+static int
+test_to_float (const char *model)
+{
+  static uint16_t bfloat16s[65536];
+  static uint32_t result[65536];
+  char            name[64];
+  const Babl     *source;
+  long            n;
+  long            i;
+
+  snprintf (name, sizeof (name), "%s bfloat16", model);
+  source = babl_format (name);
+  snprintf (name, sizeof (name), "%s float", model);
+  n = 65536 / babl_format_get_n_components (source);
+
+  for (i = 0; i < 65536; i++)
+    bfloat16s[i] = i;
+
+  babl_process (babl_fish (source, babl_format (name)), bfloat16s, result, n);
+
+  for (i = 0; i < n * babl_format_get_n_components (source); i++)
+    if (result[i] != (uint32_t) bfloat16s[i] << 16 &&
+        !(is_nan (result[i]) && is_nan ((uint32_t) bfloat16s[i] << 16)))
+      {
+        printf ("%s: %04x became %08x\n", babl_get_name (source),
+                bfloat16s[i], result[i]);
+        return 0;
+      }
+  return 1;
+}
+
+/* interleaved float to planar bfloat16 gives the same values as to
+ * interleaved bfloat16
+ */
+static int
+test_planar (void)
+{
+  static float    rgba[PIXELS * 4];
+  static uint16_t interleaved[PIXELS * 4];
+  static uint16_t planes[4][PIXELS];
+  const Babl     *planar = babl_format_new ("planar",
+                                            babl_model ("RGBA"),
+                                            babl_type ("bfloat16"),
+                                            babl_component ("R"),
+                                            babl_component ("G"),
+                                            babl_component ("B"),
+                                            babl_component ("A"),
+                                            NULL);
+  const int       rgba_stride[1]  = { PIXELS * 4 * sizeof (float) };
+  const int       plane_stride[4] = { PIXELS * 2, PIXELS * 2, PIXELS * 2, PIXELS * 2 };
+  const void     *src_ptr[1]      = { rgba };
+  void           *plane_ptr[4]    = { planes[0], planes[1], planes[2], planes[3] };
+  long            i;
+  int             c;
+
+  for (i = 0; i < PIXELS * 4; i++)
+    rgba[i] = test_value (i);
+
+  babl_process (babl_fish ("RGBA float", "RGBA bfloat16"), rgba, interleaved, PIXELS);
+  babl_process_planar (babl_fish ("RGBA float", planar),
+                       src_ptr, rgba_stride, plane_ptr, plane_stride, PIXELS, 1);
+
+  for (i = 0; i < PIXELS; i++)
+    for (c = 0; c < 4; c++)
+      if (planes[c][i] != interleaved[i * 4 + c])
+        {
+          printf ("planar RGBA bfloat16: component %i of %li is %04x, expected %04x\n",
+                  c, i, planes[c][i], interleaved[i * 4 + c]);
+          return 0;
+        }
+  return 1;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  static const char *models[] = { "Y", "Y'A", "RGB", "R'G'B'A" };
+  int OK = 1;
+  int i;
+
+  babl_init ();
+
+  {
+    float          in[][4]  = {{1.0, 0.5, -2.0, 1.0 / 3.0}};
+    unsigned short out[][4] = {{0x3f80, 0x3f00, 0xc000, 0x3eab}};
+
+    CHECK_CONV ("float -> bfloat16", unsigned short,
+        babl_format ("RGBA float"),
+        babl_format ("RGBA bfloat16"),
+        in, out);
+  }
+
+  {
+    unsigned char  in[][4]  = {{255, 128, 51, 0}};
+    unsigned short out[][4] = {{0x3f80, 0x3f01, 0x3e4d, 0x0000}};
+
+    CHECK_CONV ("u8 -> bfloat16", unsigned short,
+        babl_format ("RGBA u8"),
+        babl_format ("RGBA bfloat16"),
+        in, out);
+  }
+
+  for (i = 0; i < sizeof (models) / sizeof (models[0]); i++)
+    {
+      OK &= test_from_float (models[i]);
+      OK &= test_to_float (models[i]);
+    }
+  OK &= test_planar ();
+
+  babl_exit ();
+
+  return !OK;
+}
@@ -0,0 +1,304 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "babl.h"
+#include "common.inc"
+
+/* all the values of a 12 bit field, and not a multiple of the 4 pixels the
+ * bitpacked kernels convert at a time
+ */
+#define PIXELS 4097
+
+typedef struct
+{
+  const char *name;
+  const char *rgba;   /* the model of the unpacked formats */
+  int         bytes;
+  int         shift[4];  /* of R, G, B and A in the little endian word */
+  int         bits[4];
+} Packed;
+
+static const Packed formats[] =
+{
+  { "R'G'B'A u10-10-10-2",  "R'G'B'A", 4, {  0, 10, 20, 30 }, { 10, 10, 10,  2 } },
+  { "RGBA u10-10-10-2",     "RGBA",    4, {  0, 10, 20, 30 }, { 10, 10, 10,  2 } },
+  { "R'G'B'A u12-12-12-12", "R'G'B'A", 6, {  0, 12, 24, 36 }, { 12, 12, 12, 12 } },
+  { "RGBA u12-12-12-12",    "RGBA",    6, {  0, 12, 24, 36 }, { 12, 12, 12, 12 } },
+  { "R'G'B' u5-6-5",        "R'G'B'A", 2, { 11,  5,  0,  0 }, {  5,  6,  5,  0 } },
+  { "RGB u5-6-5",           "RGBA",    2, { 11,  5,  0,  0 }, {  5,  6,  5,  0 } },
+};
+
+static uint64_t
+get_word (const uint8_t *p,
+          int            bytes)
+{
+  uint64_t word = 0;
+  int      b;
+
+  for (b = 0; b < bytes; b++)
+    word |= (uint64_t) p[b] << (b * 8);
+  return word;
+}
+
+static void
+set_word (uint8_t  *p,
+          int       bytes,
+          uint64_t  word)
+{
+  int b;
+
+  for (b = 0; b < bytes; b++)
+    p[b] = word >> (b * 8);
+}
+
+/* pixel i has the value i in every field, wrapped to its width */
+static int
+field_value (const Packed *f,
+             int           c,
+             long          i)
+{
+  return (i * (c + 1)) & ((1 << f->bits[c]) - 1);
+}
+
+/* every field value unpacked to u8 is exactly rounded, u16 give or take
+ * one since babl may pick a path through float
+ */
+static int
+test_unpack (const Packed *f,
+             int           bits)
+{
+  static uint8_t  packed[PIXELS * 8];
+  static uint16_t unpacked[PIXELS * 4];
+  const Babl     *format = babl_format (f->name);
+  char            name[64];
+  int             out_max = (1 << bits) - 1;
+  long            i;
+  int             c;
+
+  for (i = 0; i < PIXELS; i++)
+    {
+      uint64_t word = 0;
+
+      for (c = 0; c < 4; c++)
+        if (f->bits[c])
+          word |= (uint64_t) field_value (f, c, i) << f->shift[c];
+      set_word (packed + i * f->bytes, f->bytes, word);
+    }
+
+  snprintf (name, sizeof (name), "%s u%i", f->rgba, bits);
+  babl_process (babl_fish (format, babl_format (name)), packed, unpacked, PIXELS);
+
+  for (i = 0; i < PIXELS; i++)
+    for (c = 0; c < 4; c++)
+      {
+        int max      = (1 << f->bits[c]) - 1;
+        int expected = f->bits[c] ?
+                         (2 * (int64_t) field_value (f, c, i) * out_max + max) / (2 * max) :
+                         out_max;
+        int value    = bits == 8 ? ((uint8_t *) unpacked)[i * 4 + c] :
+                                   unpacked[i * 4 + c];
+
+        if (value != expected && (bits == 8 || value - expected > 1 ||
+                                               expected - value > 1))
+          {
+            printf ("%s to %s: component %i of %li is %i, expected %i\n",
+                    f->name, name, c, i, value, expected);
+            return 0;
+          }
+      }
+  return 1;
+}
+
+/* packing u8 is exactly rounded, u16 give or take one as float cannot
+ * round it exactly
+ */
+static int
+test_pack (const Packed *f,
+           int           bits)
+{
+  static uint16_t unpacked[65536 * 4];
+  static uint8_t  packed[65536 * 8];
+  const Babl     *format = babl_format (f->name);
+  char            name[64];
+  long            n      = 1 << bits;
+  int             in_max = n - 1;
+  long            i;
+  int             c;
+
+  for (i = 0; i < n; i++)
+    for (c = 0; c < 4; c++)
+      if (bits == 8)
+        ((uint8_t *) unpacked)[i * 4 + c] = (i * (c + 1)) & in_max;
+      else
+        unpacked[i * 4 + c] = (i * (c + 1)) & in_max;
+
+  snprintf (name, sizeof (name), "%s u%i", f->rgba, bits);
+  babl_process (babl_fish (babl_format (name), format), unpacked, packed, n);
+
+  for (i = 0; i < n; i++)
+    {
+      uint64_t word = get_word (packed + i * f->bytes, f->bytes);
+
+      for (c = 0; c < 4; c++)
+        {
+          int max      = (1 << f->bits[c]) - 1;
+          int value    = (word >> f->shift[c]) & max;
+          int expected = (2 * (int64_t) ((i * (c + 1)) & in_max) * max + in_max) /
+                         (2 * in_max);
+
+          if (!f->bits[c])
+            continue;
+
+          if (value != expected && (bits == 8 || value - expected > 1 ||
+                                                 expected - value > 1))
+            {
+              printf ("%s to %s: component %i of %li is %i, expected %i\n",
+                      name, f->name, c, i, value, expected);
+              return 0;
+            }
+        }
+    }
+  return 1;
+}
+
+/* float survives a round trip through the packed fields */
+static int
+test_float (const Packed *f)
+{
+  static float   rgba[PIXELS * 4];
+  static float   result[PIXELS * 4];
+  static uint8_t packed[PIXELS * 8];
+  const Babl    *format = babl_format (f->name);
+  const Babl    *float_format;
+  char           name[64];
+  long           i;
+  int            c;
+
+  snprintf (name, sizeof (name), "%s float", f->rgba);
+  float_format = babl_format (name);
+
+  for (i = 0; i < PIXELS; i++)
+    for (c = 0; c < 4; c++)
+      rgba[i * 4 + c] = (test_hash (i) >> (c * 8) & 0xffff) / 65535.0f;
+
+  babl_process (babl_fish (float_format, format), rgba, packed, PIXELS);
+  babl_process (babl_fish (format, float_format), packed, result, PIXELS);
+
+  for (i = 0; i < PIXELS; i++)
+    for (c = 0; c < 4; c++)
+      {
+        float expected  = f->bits[c] ? rgba[i * 4 + c] : 1.0f;
+        float tolerance = f->bits[c] ? 0.5f / ((1 << f->bits[c]) - 1) + 1e-6f :
+                                       0.0f;
+
+        if (result[i * 4 + c] - expected > tolerance ||
+            expected - result[i * 4 + c] > tolerance)
+          {
+            printf ("%s: component %i of %li is %f, expected %f\n",
+                    f->name, c, i, result[i * 4 + c], expected);
+            return 0;
+          }
+      }
+  return 1;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  int OK = 1;
+  int i;
+
+  babl_init ();
+
+  /* where each component lands in the little endian words */
+  {
+    float         in[][4]  = {{1.0, 0.0, 0.0, 0.0}, {0.0, 1.0, 0.0, 0.0},
+                              {0.0, 0.0, 1.0, 0.0}, {0.0, 0.0, 0.0, 1.0}};
+    unsigned char out[][4] = {{0xff, 0x03, 0x00, 0x00}, {0x00, 0xfc, 0x0f, 0x00},
+                              {0x00, 0x00, 0xf0, 0x3f}, {0x00, 0x00, 0x00, 0xc0}};
+
+    CHECK_CONV ("R'G'B'A u10-10-10-2", unsigned char,
+        babl_format ("R'G'B'A float"),
+        babl_format ("R'G'B'A u10-10-10-2"),
+        in, out);
+    CHECK_CONV ("RGBA u10-10-10-2", unsigned char,
+        babl_format ("RGBA float"),
+        babl_format ("RGBA u10-10-10-2"),
+        in, out);
+  }
+
+  {
+    float         in[][4]  = {{1.0, 0.0, 0.0, 0.0}, {0.0, 1.0, 0.0, 0.0},
+                              {0.0, 0.0, 1.0, 0.0}, {0.0, 0.0, 0.0, 1.0}};
+    unsigned char out[][6] = {{0xff, 0x0f, 0x00, 0x00, 0x00, 0x00},
+                              {0x00, 0xf0, 0xff, 0x00, 0x00, 0x00},
+                              {0x00, 0x00, 0x00, 0xff, 0x0f, 0x00},
+                              {0x00, 0x00, 0x00, 0x00, 0xf0, 0xff}};
+
+    CHECK_CONV ("R'G'B'A u12-12-12-12", unsigned char,
+        babl_format ("R'G'B'A float"),
+        babl_format ("R'G'B'A u12-12-12-12"),
+        in, out);
+    CHECK_CONV ("RGBA u12-12-12-12", unsigned char,
+        babl_format ("RGBA float"),
+        babl_format ("RGBA u12-12-12-12"),
+        in, out);
+  }
+
+  {
+    float         in[][3]  = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+    unsigned char out[][2] = {{0x00, 0xf8}, {0xe0, 0x07}, {0x1f, 0x00}};
+
+    CHECK_CONV ("R'G'B' u5-6-5", unsigned char,
+        babl_format ("R'G'B' float"),
+        babl_format ("R'G'B' u5-6-5"),
+        in, out);
+    CHECK_CONV ("RGB u5-6-5", unsigned char,
+        babl_format ("RGB float"),
+        babl_format ("RGB u5-6-5"),
+        in, out);
+  }
+
+  for (i = 0; i < sizeof (formats) / sizeof (formats[0]); i++)
+    {
+      const Packed *f = &formats[i];
+
+      if (babl_format_get_bytes_per_pixel (babl_format (f->name)) != f->bytes)
+        {
+          printf ("%s: %i bytes per pixel, expected %i\n", f->name,
+                  babl_format_get_bytes_per_pixel (babl_format (f->name)),
+                  f->bytes);
+          OK = 0;
+        }
+
+      OK &= test_unpack (f, 8);
+      OK &= test_unpack (f, 16);
+      OK &= test_pack (f, 8);
+      OK &= test_pack (f, 16);
+      OK &= test_float (f);
+    }
+
+  babl_exit ();
+
+  return !OK;
+}
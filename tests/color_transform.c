@@ -0,0 +1,107 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* a BablColorTransform gives the same pixels as babl_process () on one
+ * pixel, for fishes of a single conversion, paths of several, reference
+ * fishes and conversions between spaces
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "babl.h"
+#include "common.inc"
+
+#define PIXELS 256
+
+static int OK = 1;
+
+static void
+test_formats (const Babl *src_fmt,
+              const Babl *dst_fmt)
+{
+  const Babl         *fish      = babl_fish (src_fmt, dst_fmt);
+  BablColorTransform *transform = babl_color_transform_new (fish);
+  int                 src_bpp   = babl_format_get_bytes_per_pixel (src_fmt);
+  int                 dst_bpp   = babl_format_get_bytes_per_pixel (dst_fmt);
+  unsigned char      *source    = test_pixels_new (src_fmt, PIXELS);
+  unsigned char      *reference = malloc (dst_bpp);
+  unsigned char      *dest      = malloc (dst_bpp);
+  long                i;
+
+  for (i = 0; i < PIXELS; i++)
+    {
+      memset (reference, 0x55, dst_bpp);
+      memset (dest, 0x55, dst_bpp);
+
+      babl_process (fish, source + i * src_bpp, reference, 1);
+      babl_color_transform_process (transform, source + i * src_bpp, dest);
+
+      if (memcmp (dest, reference, dst_bpp))
+        {
+          printf ("%s to %s: pixel %li differs from babl_process ()\n",
+                  babl_get_name (src_fmt), babl_get_name (dst_fmt), i);
+          OK = 0;
+          break;
+        }
+    }
+
+  babl_color_transform_free (transform);
+  free (source);
+  free (reference);
+  free (dest);
+}
+
+static const char *fishes[] =
+{
+  "R'G'B'A u8",     "RGBA float",
+  "RGBA float",     "R'G'B'A u8",
+  "R'G'B' u8",      "CIE Lab float",
+  "R'G'B'A u16",    "CIE LCH(ab) alpha float",
+  "CIE Lab double", "R'G'B'A u8",
+  "R'G'B' double",  "Y u8",
+  "R'G'B' double",  "HSV double",
+  "R'G'B' double",  "R'G'B'A half",
+  "R'G'B' u16",     "HSLA float",
+  NULL
+};
+
+int
+main (int    argc,
+      char **argv)
+{
+  const Babl *prophoto;
+
+  babl_init ();
+
+  prophoto = babl_space ("ProPhoto");
+
+  test_format_pairs (test_formats, fishes);
+
+  test_formats (babl_format_with_space ("R'G'B'A float", prophoto),
+                babl_format ("RGBA float"));
+  test_formats (babl_format_with_space ("R'G'B' double", prophoto),
+                babl_format ("R'G'B' u16"));
+  test_formats (babl_format ("R'G'B'A u8"),
+                babl_format_with_space ("Y'A u8", prophoto));
+
+  babl_exit ();
+
+  return !OK;
+}
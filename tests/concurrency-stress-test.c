@@ -30,7 +30,7 @@
 
 
 static void *
-babl_fish_path_stress_test_thread_func (void *not_used)
+babl_fish_path_stress_test_thread_func (void *failed)
 {
   int i;
 
@@ -43,6 +43,13 @@ babl_fish_path_stress_test_thread_func (void *not_used)
 
       /* Just do something random with the fish */
       babl_get_name (fish);
+
+      /* lookups by format go through the per-thread fish cache, and
+       * should end up with the same fish
+       */
+      if (babl_fish (babl_format ("R'G'B'A u16"),
+                     babl_format ("YA double")) != fish)
+        *(int *) failed = 1;
     }
 
   return NULL;
@@ -53,6 +60,8 @@ main (int    argc,
       char **argv)
 {
   pthread_t threads[N_THREADS];
+  int       failed = 0;
+  long      hits;
   int       i;
 
   babl_init ();
@@ -63,7 +72,7 @@ main (int    argc,
       pthread_create (&threads[i],
                       NULL, /* attr */
                       babl_fish_path_stress_test_thread_func,
-                      NULL /* arg */);
+                      &failed);
      }
 
   /* Wait for them all to finish */
@@ -73,8 +82,13 @@ main (int    argc,
                     NULL /* thread_return */);
     }
 
+  babl_fish_cache_get_stats (&hits, NULL);
+
   babl_exit ();
 
+  if (failed || hits <= 0)
+    return -1;
+
   /* If we didn't crash we assume we're OK. We might want to add more
    * asserts in the test later
    */
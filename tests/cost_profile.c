@@ -0,0 +1,295 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* fish paths are chosen from a cost profile given in $BABL_COST_PROFILE:
+ * the same path from run to run, not from profiles of another babl
+ * version or CPU, and with timing for paths the profile lacks entries for.
+ *
+ * The profiled costs are made tiny, so a path costed from the profile
+ * always comes out below one tick, and a timed one above.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "babl-internal.h"
+
+#define PROFILE    "cost_profile.txt"
+#define CACHE_DIR  "cost_profile-cache"
+#define FISH_CACHE CACHE_DIR "/babl/babl-fishes"
+
+#define SOURCE      "R'G'B'A float"
+#define DESTINATION "RGBA float"
+
+#define MAX_CONVERSIONS 256
+
+static int OK = 1;
+
+/* the conversions out of SOURCE, the direct ones to DESTINATION and the
+ * ones to another format with a conversion on to DESTINATION
+ */
+static char *direct[MAX_CONVERSIONS];
+static int   n_direct;
+static char *first[MAX_CONVERSIONS];
+static char *second[MAX_CONVERSIONS];
+static int   n_steps;
+
+static int
+profiled (const Babl *conversion)
+{
+  return conversion->class_type == BABL_CONVERSION_LINEAR &&
+         conversion->conversion.source->format.space == babl_space ("sRGB") &&
+         conversion->conversion.destination->format.space == babl_space ("sRGB") &&
+         !babl_format_is_palette (conversion->conversion.destination) &&
+         !babl_format_is_format_n (conversion->conversion.destination);
+}
+
+static void
+collect_conversions (void)
+{
+  const Babl *destination = babl_format (DESTINATION);
+  BablList   *list        = babl_format (SOURCE)->format.from_list;
+  int         i;
+  int         j;
+
+  for (i = 0; i < babl_list_size (list); i++)
+    {
+      const Babl *conversion = list->items[i];
+      const Babl *mid        = conversion->conversion.destination;
+
+      if (!profiled (conversion))
+        continue;
+      if (mid == destination)
+        {
+          if (n_direct < MAX_CONVERSIONS)
+            direct[n_direct++] = strdup (babl_get_name (conversion));
+          continue;
+        }
+      if (!mid->format.from_list)
+        continue;
+
+      for (j = 0; j < babl_list_size (mid->format.from_list); j++)
+        {
+          const Babl *next = mid->format.from_list->items[j];
+
+          if (next->conversion.destination == destination &&
+              profiled (next) && n_steps < MAX_CONVERSIONS)
+            {
+              first[n_steps]  = strdup (babl_get_name (conversion));
+              second[n_steps] = strdup (babl_get_name (next));
+              n_steps++;
+            }
+        }
+    }
+}
+
+enum
+{
+  PROFILE_VALID,
+  PROFILE_OTHER_VERSION,
+  PROFILE_OTHER_ACCEL,
+  PROFILE_NO_REFERENCE,
+  PROFILE_MISSING_STEP
+};
+
+/* the direct conversions cost 0.004 ns per pixel, two steps 0.002 - or
+ * 0.0002 when the second step is missing from the profile, which wins only
+ * if missing entries were taken as free
+ */
+static void
+write_profile (int kind)
+{
+  FILE *file = fopen (PROFILE, "w");
+  int   i;
+
+  fprintf (file, "#babl-cost-profile %i.%i.%i accel=%x\n",
+           BABL_MAJOR_VERSION,
+           BABL_MINOR_VERSION + (kind == PROFILE_OTHER_VERSION),
+           BABL_MICRO_VERSION,
+           (unsigned int) babl_cpu_accel_get_support () ^
+             (kind == PROFILE_OTHER_ACCEL));
+
+  for (i = 0; i < n_direct; i++)
+    fprintf (file, "conversion\t0.004\t%s\n", direct[i]);
+  for (i = 0; i < n_steps; i++)
+    {
+      if (kind == PROFILE_MISSING_STEP)
+        {
+          fprintf (file, "conversion\t0.0001\t%s\n", first[i]);
+        }
+      else
+        {
+          fprintf (file, "conversion\t0.001\t%s\n", first[i]);
+          fprintf (file, "conversion\t0.001\t%s\n", second[i]);
+        }
+    }
+
+  fprintf (file, "reference\t100.0\t100.0\t%s\n", SOURCE);
+  if (kind != PROFILE_NO_REFERENCE)
+    fprintf (file, "reference\t100.0\t100.0\t%s\n", DESTINATION);
+  fclose (file);
+}
+
+/* runs this test again with the profile of /kind/ and without a fish
+ * cache, babl does not come back up after babl_exit (); returns the names
+ * of the conversions in the chosen path, and its cost
+ */
+static char *
+choose_path (const char *self,
+             int         kind,
+             double     *cost)
+{
+  char  command[4096];
+  char  names[4096] = "";
+  char  line[1024];
+  FILE *child;
+
+  write_profile (kind);
+  remove (FISH_CACHE);
+
+  snprintf (command, sizeof (command), "\"%s\" chosen-path", self);
+  child = popen (command, "r");
+  *cost = -1.0;
+  while (child && fgets (line, sizeof (line), child))
+    {
+      if (!strncmp (line, "cost ", 5))
+        *cost = atof (line + 5);
+      else
+        strncat (names, line, sizeof (names) - strlen (names) - 1);
+    }
+  if (!child || pclose (child) || *cost < 0.0)
+    {
+      printf ("running %s failed\n", command);
+      OK = 0;
+    }
+
+  return strdup (names);
+}
+
+/* the child process of choose_path () */
+static int
+print_chosen_path (void)
+{
+  const Babl *fish;
+  int         i;
+
+  babl_init ();
+  fish = babl_fish_path (babl_format (SOURCE), babl_format (DESTINATION));
+  for (i = 0; i < babl_list_size (fish->fish_path.conversion_list); i++)
+    printf ("%s\n", babl_get_name (fish->fish_path.conversion_list->items[i]));
+  printf ("cost %f\n", fish->fish_path.cost);
+  babl_exit ();
+
+  return 0;
+}
+
+static int
+is_direct (const char *names)
+{
+  int i;
+
+  for (i = 0; i < n_direct; i++)
+    if (!strncmp (names, direct[i], strlen (direct[i])) &&
+        !strcmp (names + strlen (direct[i]), "\n"))
+      return 1;
+  return 0;
+}
+
+/* profiles babl is to ignore, or lacking the reference costs */
+static void
+test_timed (const char *self,
+            int         kind,
+            const char *description)
+{
+  double  cost;
+  char   *names = choose_path (self, kind, &cost);
+
+  if (cost < 1.0)
+    {
+      printf ("%s: the path was not timed, cost %f\n", description, cost);
+      OK = 0;
+    }
+  free (names);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  double  cost;
+  char   *path;
+  char   *again;
+  int     i;
+
+  putenv ("BABL_COST_PROFILE" "=" PROFILE);
+  putenv ("XDG_CACHE_HOME" "=" CACHE_DIR);
+
+  if (argc > 1 && !strcmp (argv[1], "chosen-path"))
+    return print_chosen_path ();
+
+  babl_init ();
+  collect_conversions ();
+  babl_exit ();
+
+  if (!n_direct)
+    {
+      printf ("no conversion from %s to %s\n", SOURCE, DESTINATION);
+      return 1;
+    }
+
+  path  = choose_path (argv[0], PROFILE_VALID, &cost);
+  again = choose_path (argv[0], PROFILE_VALID, &cost);
+  if (strcmp (path, again))
+    {
+      printf ("different paths from the same profile:\n%s\n%s", path, again);
+      OK = 0;
+    }
+  if (cost >= 1.0)
+    {
+      printf ("the profiled path was timed, cost %f\n", cost);
+      OK = 0;
+    }
+  free (path);
+  free (again);
+
+  test_timed (argv[0], PROFILE_OTHER_VERSION, "other version");
+  test_timed (argv[0], PROFILE_OTHER_ACCEL, "other accel");
+  test_timed (argv[0], PROFILE_NO_REFERENCE, "no reference cost");
+
+  /* the steps lacking costs are timed, losing against the direct ones */
+  path = choose_path (argv[0], PROFILE_MISSING_STEP, &cost);
+  if (!is_direct (path) || cost >= 1.0)
+    {
+      printf ("missing step: chose, at cost %f\n%s", cost, path);
+      OK = 0;
+    }
+  free (path);
+
+  remove (PROFILE);
+  remove (FISH_CACHE);
+  for (i = 0; i < n_direct; i++)
+    free (direct[i]);
+  for (i = 0; i < n_steps; i++)
+    {
+      free (first[i]);
+      free (second[i]);
+    }
+
+  return !OK;
+}
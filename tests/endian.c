@@ -0,0 +1,210 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "babl.h"
+#include "common.inc"
+
+/* not a multiple of the vector width of the fast paths */
+#define PIXELS 1031
+
+static const char *models[] =
+{
+  "Y", "Y'", "YA", "Y'A", "RGB", "R'G'B'", "RGBA", "R'G'B'A"
+};
+
+static const struct
+{
+  const char *native;
+  const char *big_endian;
+  int         bytes;
+  double      tolerance;  /* of a value decoded from either */
+} types[] =
+{
+  { "u16",   "u16be",   2, 1.01 / 65535.0 },
+  { "u32",   "u32be",   4, 1e-6 },
+  { "float", "floatbe", 4, 1e-6 },
+};
+
+/* from host byte order, which a big endian value needs no work for */
+static void
+to_big_endian (uint8_t *data,
+               long     n,
+               int      bytes)
+{
+  union { uint16_t u16; uint8_t u8[2]; } probe = { 1 };
+  long i;
+  int  b;
+
+  if (!probe.u8[0])
+    return;
+
+  for (i = 0; i < n; i++, data += bytes)
+    for (b = 0; b < bytes / 2; b++)
+      {
+        uint8_t tmp = data[b];
+
+        data[b] = data[bytes - 1 - b];
+        data[bytes - 1 - b] = tmp;
+      }
+}
+
+static int
+compare (const float *a,
+         const float *b,
+         long         n,
+         double       tolerance)
+{
+  long i;
+
+  for (i = 0; i < n; i++)
+    if (a[i] - b[i] > tolerance || b[i] - a[i] > tolerance)
+      return i;
+  return -1;
+}
+
+/* a big endian format decodes and encodes the same values as the
+ * byte swapped native one, on its own and through the fast paths to
+ * and from float
+ */
+static int
+test (const char *model,
+      int         t)
+{
+  int            OK = 1;
+  static uint8_t native[PIXELS * 4 * 4];
+  static uint8_t swapped[PIXELS * 4 * 4];
+  static uint8_t encoded[PIXELS * 4 * 4];
+  static float   source[PIXELS * 4];
+  static float   expected[PIXELS * 4];
+  static float   result[PIXELS * 4];
+  const Babl    *float_format;
+  const Babl    *native_format;
+  const Babl    *be_format;
+  char           name[64];
+  int            components;
+  long           n;
+  long           i;
+
+  snprintf (name, sizeof (name), "%s float", model);
+  float_format = babl_format (name);
+  snprintf (name, sizeof (name), "%s %s", model, types[t].native);
+  native_format = babl_format (name);
+  snprintf (name, sizeof (name), "%s %s", model, types[t].big_endian);
+  be_format = babl_format (name);
+
+  components = babl_format_get_n_components (float_format);
+  n = PIXELS * components;
+  for (i = 0; i < n; i++)
+    source[i] = test_value (i);
+
+  if (babl_format_get_bytes_per_pixel (be_format) !=
+      babl_format_get_bytes_per_pixel (native_format))
+    {
+      printf ("%s: %i bytes per pixel\n", babl_get_name (be_format),
+              babl_format_get_bytes_per_pixel (be_format));
+      return 0;
+    }
+
+  babl_process (babl_fish (float_format, native_format), source, native, PIXELS);
+  memcpy (swapped, native, n * types[t].bytes);
+  to_big_endian (swapped, n, types[t].bytes);
+
+  babl_process (babl_fish (native_format, float_format), native, expected, PIXELS);
+  babl_process (babl_fish (be_format, float_format), swapped, result, PIXELS);
+  if ((i = compare (expected, result, n, types[t].tolerance)) >= 0)
+    {
+      printf ("%s to %s: component %li is %f, expected %f\n",
+              babl_get_name (be_format), babl_get_name (float_format),
+              i, result[i], expected[i]);
+      OK = 0;
+    }
+
+  babl_process (babl_fish (float_format, be_format), source, encoded, PIXELS);
+  to_big_endian (encoded, n, types[t].bytes);
+  babl_process (babl_fish (native_format, float_format), encoded, result, PIXELS);
+  if ((i = compare (expected, result, n, types[t].tolerance)) >= 0)
+    {
+      printf ("%s to %s: component %li is %f, expected %f\n",
+              babl_get_name (float_format), babl_get_name (be_format),
+              i, result[i], expected[i]);
+      OK = 0;
+    }
+
+  babl_process (babl_fish (native_format, be_format), native, encoded, PIXELS);
+  if (memcmp (encoded, swapped, n * types[t].bytes))
+    {
+      printf ("%s to %s is not a byte swap\n",
+              babl_get_name (native_format), babl_get_name (be_format));
+      OK = 0;
+    }
+  return OK;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  int OK = 1;
+  int m, t;
+
+  babl_init ();
+
+  /* the most significant byte first */
+  {
+    float         in[][4]  = {{1.0, 0.5, 0.0, 0.25}};
+    unsigned char out[][8] = {{0xff, 0xff, 0x80, 0x00, 0x00, 0x00, 0x40, 0x00}};
+
+    CHECK_CONV ("float -> u16be", unsigned char,
+        babl_format ("R'G'B'A float"),
+        babl_format ("R'G'B'A u16be"),
+        in, out);
+  }
+
+  {
+    float         in[][2]  = {{1.0, -2.5}};
+    unsigned char out[][8] = {{0x3f, 0x80, 0x00, 0x00, 0xc0, 0x20, 0x00, 0x00}};
+
+    CHECK_CONV ("float -> floatbe", unsigned char,
+        babl_format ("YA float"),
+        babl_format ("YA floatbe"),
+        in, out);
+  }
+
+  {
+    unsigned char in[][4] = {{0x80, 0x00, 0x40, 0x00}, {0xff, 0xff, 0x00, 0x01}};
+    float         out[][2] = {{32768 / 65535.0, 16384 / 65535.0},
+                              {1.0,             1 / 65535.0}};
+
+    CHECK_CONV_FLOAT ("u16be -> float", float, 0.000001,
+        babl_format ("Y'A u16be"),
+        babl_format ("Y'A float"),
+        in, out);
+  }
+
+  for (m = 0; m < sizeof (models) / sizeof (models[0]); m++)
+    for (t = 0; t < sizeof (types) / sizeof (types[0]); t++)
+      OK &= test (models[m], t);
+
+  babl_exit ();
+
+  return !OK;
+}
@@ -95,6 +95,57 @@ test3 (void)
   return 0;
 }
 
+static int
+test4 (void)
+{
+  int OK = 1;
+  const Babl *apple  = babl_space ("Apple");
+  const Babl *fmt;
+  char encoding[64];
+  int i;
+
+  fmt = babl_format_with_space ("R'G'B'A u8", apple);
+  for (i = 0; i < 4; i++)
+  {
+    if (babl_format_with_space ("R'G'B'A u8", apple) != fmt)
+    {
+      babl_log ("repeated lookup of %s gave a different format", babl_get_name (fmt));
+      OK = 0;
+    }
+    if (babl_format_with_space ((void*)babl_format ("R'G'B'A u8"), apple) != fmt)
+    {
+      babl_log ("lookup of %s from format gave a different format", babl_get_name (fmt));
+      OK = 0;
+    }
+    if (babl_format_with_space ((void*)fmt, apple) != fmt)
+    {
+      babl_log ("lookup of %s from itself gave a different format", babl_get_name (fmt));
+      OK = 0;
+    }
+  }
+
+  /* the same string buffer reused for different encodings */
+  strcpy (encoding, "RGBA float");
+  fmt = babl_format_with_space (encoding, apple);
+  strcpy (encoding, "Y float");
+  if (babl_format_with_space (encoding, apple) == fmt ||
+      babl_format_get_n_components (babl_format_with_space (encoding, apple)) != 1)
+  {
+    babl_log ("reused encoding buffer gave a stale format");
+    OK = 0;
+  }
+  strcpy (encoding, "RGBA float");
+  if (babl_format_with_space (encoding, apple) != fmt)
+  {
+    babl_log ("reused encoding buffer gave a different format");
+    OK = 0;
+  }
+
+  if (!OK)
+    return -1;
+  return 0;
+}
+
 int
 main (int    argc,
       char **argv)
@@ -104,6 +155,8 @@ main (int    argc,
     return -1;
   if (test3 ())
     return -1;
+  if (test4 ())
+    return -1;
   babl_exit ();
   return 0;
 }
@@ -0,0 +1,121 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include "babl.h"
+
+#include "common.inc"
+
+/* the steps of a ramp over the signal range */
+#define STEPS 1001
+
+/* linear light over the whole signal range survives a round trip; the
+ * curves are too steep near black to compare the signals themselves
+ */
+static int
+test_round_trip (const char *name)
+{
+  static float  signal[STEPS];
+  static float  linear[STEPS];
+  static float  result[STEPS];
+  const Babl   *space     = babl_space (name);
+  const Babl   *nonlinear = babl_format_with_space ("Y' float", space);
+  const Babl   *lin       = babl_format_with_space ("Y float", space);
+  int           i;
+
+  for (i = 0; i < STEPS; i++)
+    signal[i] = (float) i / (STEPS - 1);
+
+  babl_process (babl_fish (nonlinear, lin), signal, linear, STEPS);
+  babl_process (babl_fish (lin, nonlinear), linear, result, STEPS);
+  babl_process (babl_fish (nonlinear, lin), result, signal, STEPS);
+
+  for (i = 0; i < STEPS; i++)
+    if (fabs (signal[i] - linear[i]) > 1e-4 * (linear[i] > 1.0 ? linear[i] : 1.0))
+      {
+        printf ("%s: %f round trips to %f\n", name, linear[i], signal[i]);
+        return 0;
+      }
+  return 1;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  int         OK = 1;
+  const Babl *rec2020;
+
+  babl_init ();
+
+  /* linear light is 1.0 at 203 cd/m² for PQ and at a signal of 0.75 for
+   * HLG; both curves are mirrored around 0
+   */
+  {
+    float signal[][4] = {{ 0.0,   0.10,  0.25,  1.0 },
+                         { 0.50,  0.58,  0.75,  1.0 },
+                         {-0.10, -0.50, -0.75,  1.0 }};
+    float pq[][4]      = {{ 0.0,         0.00159885, 0.02539003, 1.0 },
+                          { 0.45441236,  0.99342986, 4.84422589, 1.0 },
+                          {-0.00159885, -0.45441236,-4.84422589, 1.0 }};
+    float hlg[][4]     = {{ 0.0,         0.01258039, 0.07862746, 1.0 },
+                          { 0.31450984,  0.44143253, 1.0,        1.0 },
+                          {-0.01258039, -0.31450984,-1.0,        1.0 }};
+
+    CHECK_CONV_FLOAT ("PQ to linear", float, 0.0001,
+        babl_format_with_space ("R'G'B'A float", babl_space ("Rec2100-PQ")),
+        babl_format_with_space ("RGBA float", babl_space ("Rec2100-PQ")),
+        signal, pq);
+    CHECK_CONV_FLOAT ("HLG to linear", float, 0.0001,
+        babl_format_with_space ("R'G'B'A float", babl_space ("Rec2100-HLG")),
+        babl_format_with_space ("RGBA float", babl_space ("Rec2100-HLG")),
+        signal, hlg);
+  }
+
+  /* the peaks, 10000 cd/m² of PQ and 12 times the reference of HLG */
+  {
+    float signal[][1] = {{ 1.0 }};
+    float pq[][1]     = {{ 49.26108374 }};
+    float hlg[][1]    = {{ 3.77411822 }};
+
+    CHECK_CONV_FLOAT ("PQ peak", float, 0.005,
+        babl_format_with_space ("Y' float", babl_space ("Rec2100-PQ")),
+        babl_format_with_space ("Y float", babl_space ("Rec2100-PQ")),
+        signal, pq);
+    CHECK_CONV_FLOAT ("HLG peak", float, 0.0004,
+        babl_format_with_space ("Y' float", babl_space ("Rec2100-HLG")),
+        babl_format_with_space ("Y float", babl_space ("Rec2100-HLG")),
+        signal, hlg);
+  }
+
+  if (!test_round_trip ("Rec2100-PQ") || !test_round_trip ("Rec2100-HLG"))
+    OK = 0;
+
+  rec2020 = babl_space ("Rec2020");
+  if (babl_space_with_trc (rec2020, babl_trc ("PQ")) != babl_space ("Rec2100-PQ") ||
+      babl_space_with_trc (rec2020, babl_trc ("HLG")) != babl_space ("Rec2100-HLG"))
+    {
+      printf ("babl_space_with_trc does not find the Rec2100 spaces\n");
+      OK = 0;
+    }
+
+  babl_exit ();
+
+  return !OK;
+}
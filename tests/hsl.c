@@ -80,6 +80,11 @@ main (int    argc,
                     babl_format ("RGBA float"),
                     hsla, rgba);
 
+  CHECK_CONV_HUE_GRID ("hsla grid", 1e-5, "HSLA",
+                       "hue", "saturation", "lightness");
+  CHECK_CONV_HUE_GRID ("hsl grid", 1e-5, "HSL",
+                       "hue", "saturation", "lightness");
+
   babl_exit ();
 
   return !OK;
@@ -87,6 +87,11 @@ main (int    argc,
                     babl_format ("RGBA float"),
                     hsva, rgba);
 
+  CHECK_CONV_HUE_GRID ("hsva grid", 1e-5, "HSVA",
+                       "hue", "saturation", "value");
+  CHECK_CONV_HUE_GRID ("hsv grid", 1e-5, "HSV",
+                       "hue", "saturation", "value");
+
   babl_exit ();
 
   return !OK;
@@ -0,0 +1,177 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* fishes whose destination pixels are no larger than their source pixels
+ * convert in place - with babl_process (), babl_process_rows () and
+ * babl_process_spans () - to the same pixels as between separate buffers
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "babl.h"
+#include "common.inc"
+
+/* more than the staging buffer of single conversions holds, and odd */
+#define PIXELS 5003
+#define ROWS   3
+
+static int OK = 1;
+
+static void
+check (const char *what,
+       const Babl *src_fmt,
+       const Babl *dst_fmt,
+       const void *result,
+       const void *reference,
+       size_t      size)
+{
+  if (memcmp (result, reference, size))
+    {
+      printf ("%s to %s: %s in place differs\n",
+              babl_get_name (src_fmt), babl_get_name (dst_fmt), what);
+      OK = 0;
+    }
+}
+
+static void
+test_formats (const Babl *src_fmt,
+              const Babl *dst_fmt)
+{
+  const Babl    *fish      = babl_fish (src_fmt, dst_fmt);
+  int            src_bpp   = babl_format_get_bytes_per_pixel (src_fmt);
+  int            dst_bpp   = babl_format_get_bytes_per_pixel (dst_fmt);
+  long           size      = (long) PIXELS * ROWS * src_bpp;
+  unsigned char *source    = test_pixels_new (src_fmt, (long) PIXELS * ROWS);
+  unsigned char *reference = malloc ((long) PIXELS * ROWS * dst_bpp);
+  unsigned char *buffer    = malloc (size);
+  BablSpan       spans[2];
+  long           i;
+
+  if (!babl_fish_supports_in_place (fish))
+    {
+      printf ("%s to %s: in place not supported\n",
+              babl_get_name (src_fmt), babl_get_name (dst_fmt));
+      OK = 0;
+    }
+
+  babl_process (fish, source, reference, (long) PIXELS * ROWS);
+
+  memcpy (buffer, source, size);
+  babl_process (fish, buffer, buffer, (long) PIXELS * ROWS);
+  check ("babl_process ()", src_fmt, dst_fmt, buffer, reference,
+         (long) PIXELS * ROWS * dst_bpp);
+
+  /* rows converted in place keep the source stride */
+  memcpy (buffer, source, size);
+  babl_process_rows (fish, buffer, PIXELS * src_bpp,
+                     buffer, PIXELS * src_bpp, PIXELS, ROWS);
+  for (i = 0; i < ROWS; i++)
+    check ("babl_process_rows ()", src_fmt, dst_fmt,
+           buffer + i * PIXELS * src_bpp,
+           reference + i * PIXELS * dst_bpp,
+           (long) PIXELS * dst_bpp);
+
+  memcpy (buffer, source, size);
+  spans[0].source      = buffer;
+  spans[0].destination = buffer;
+  spans[0].n           = PIXELS;
+  spans[1].source      = buffer + 2 * PIXELS * src_bpp;
+  spans[1].destination = buffer + 2 * PIXELS * src_bpp;
+  spans[1].n           = PIXELS;
+  babl_process_spans (fish, spans, 2);
+  check ("babl_process_spans ()", src_fmt, dst_fmt,
+         buffer, reference, (long) PIXELS * dst_bpp);
+  check ("babl_process_spans ()", src_fmt, dst_fmt,
+         buffer + 2 * PIXELS * src_bpp, reference + 2 * PIXELS * dst_bpp,
+         (long) PIXELS * dst_bpp);
+
+  free (source);
+  free (reference);
+  free (buffer);
+}
+
+/* a conversion that stores the first component of a pixel before it has
+ * read the last
+ */
+static void
+rgb_to_bgr (const Babl *conversion,
+            const char *src,
+            char       *dst,
+            long        n,
+            void       *user_data)
+{
+  while (n--)
+    {
+      dst[0] = src[2];
+      dst[1] = src[1];
+      dst[2] = src[0];
+      src += 3;
+      dst += 3;
+    }
+}
+
+static const char *fishes[] =
+{
+  "RGBA float",          "R'G'B'A u8",
+  "RGBA float",          "RaGaBaA float",
+  "R'G'B'A float",       "R'G'B'A half",
+  "R'G'B'A u16",         "R'G'B' u8",
+  "R'G'B'A u8",          "R'G'B' u8",
+  "RGBA float",          "CIE Lab float",
+  "CIE Lab alpha float", "R'G'B'A u8",
+  "RGBA double",         "Y'A u8",
+  "R'G'B' double",       "HSV double",
+  "R'G'B'A u8",          "R'G'B'A u8",
+  NULL
+};
+
+int
+main (int    argc,
+      char **argv)
+{
+  const Babl *rgb;
+  const Babl *bgr;
+
+  babl_init ();
+
+  rgb = babl_format_new ("name", "in-place R'G'B' u8",
+                         babl_model ("R'G'B'"), babl_type ("u8"),
+                         babl_component ("R'"), babl_component ("G'"),
+                         babl_component ("B'"), NULL);
+  bgr = babl_format_new ("name", "in-place B'G'R' u8",
+                         babl_model ("R'G'B'"), babl_type ("u8"),
+                         babl_component ("B'"), babl_component ("G'"),
+                         babl_component ("R'"), NULL);
+  babl_conversion_new (rgb, bgr, "linear", rgb_to_bgr, NULL);
+
+  test_formats (rgb, bgr);
+
+  test_format_pairs (test_formats, fishes);
+
+  if (babl_fish_supports_in_place (babl_fish ("R'G'B'A u8", "RGBA float")))
+    {
+      printf ("R'G'B'A u8 to RGBA float: in place supported\n");
+      OK = 0;
+    }
+
+  babl_exit ();
+
+  return !OK;
+}
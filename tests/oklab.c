@@ -0,0 +1,92 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+
+#include <babl/babl.h>
+
+#include "common.inc"
+
+
+int
+main (int    argc,
+      char **argv)
+{
+  int OK = 1;
+
+  /* white, black and the sRGB primaries, with Oklab values of
+   * https://bottosson.github.io/posts/oklab/
+   */
+  float rgba[][4] = {{1.0, 1.0, 1.0, 1.0},
+                     {0.0, 0.0, 0.0, 0.5},
+                     {1.0, 0.0, 0.0, 1.0},
+                     {0.0, 1.0, 0.0, 0.25},
+                     {0.0, 0.0, 1.0, 1.0}};
+
+  unsigned char rgba8[][4] = {{255, 255, 255, 255},
+                              {  0,   0,   0, 128},
+                              {255,   0,   0, 255},
+                              {  0, 255,   0,  64},
+                              {  0,   0, 255, 255}};
+
+  float laba[][4] = {{1.0,       0.0,       0.0,      1.0},
+                     {0.0,       0.0,       0.0,      0.5},
+                     {0.627955,  0.224863,  0.125846, 1.0},
+                     {0.866440, -0.233888,  0.179498, 0.25},
+                     {0.452014, -0.032457, -0.311528, 1.0}};
+
+  /* hues of white and black are meaningless, leave them out */
+  unsigned char primaries8[][4] = {{255,   0,   0, 255},
+                                   {  0, 255,   0,  64},
+                                   {  0,   0, 255, 255}};
+
+  float lcha[][4] = {{0.627955,  0.257683,  29.2339,  1.0},
+                     {0.866440,  0.294827,  142.4953, 0.25},
+                     {0.452014,  0.313214,  264.0520, 1.0}};
+
+  babl_init ();
+
+  CHECK_CONV_FLOAT ("rgba to oklab", float, 0.001,
+                    babl_format ("R'G'B'A float"),
+                    babl_format ("Oklab alpha float"),
+                    rgba, laba);
+
+  CHECK_CONV_FLOAT ("oklab to rgba", float, 0.001,
+                    babl_format ("Oklab alpha float"),
+                    babl_format ("RGBA float"),
+                    laba, rgba);
+
+  CHECK_CONV_FLOAT ("rgba u8 to oklch", float, 0.02,
+                    babl_format ("R'G'B'A u8"),
+                    babl_format ("OkLCh alpha float"),
+                    primaries8, lcha);
+
+  CHECK_CONV ("oklch to rgba u8", unsigned char,
+              babl_format ("OkLCh alpha float"),
+              babl_format ("R'G'B'A u8"),
+              lcha, primaries8);
+
+  CHECK_CONV ("oklab to rgba u8", unsigned char,
+              babl_format ("Oklab alpha float"),
+              babl_format ("R'G'B'A u8"),
+              laba, rgba8);
+
+  babl_exit ();
+
+  return !OK;
+}
@@ -0,0 +1,325 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* planar layouts - interleaving and deinterleaving, with and without a
+ * change of type - give the same samples as converting between the
+ * packed formats
+ */
+
+#include "config.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "babl.h"
+#include "common.inc"
+
+/* not a multiple of the 4 pixels the layout kernels move at a time */
+#define WIDTH 1027
+#define ROWS  3
+/* padding at the end of each row, the strides are not width * size */
+#define PAD   13
+
+static const char *models[] = { "R'G'B'A", "RGB", "Y'A" };
+static const char *types[]  = { "u8", "u16", "half", "float" };
+
+static const Babl *
+format (const char *model,
+        const char *type,
+        int         planar)
+{
+  char name[64];
+
+  snprintf (name, sizeof (name), "%s %s%s", model, type, planar ? " planar" : "");
+  return babl_format (name);
+}
+
+/* packed rows of the model, filled with values from -0.2 to 1.2 */
+static char *
+packed_new (const char *model,
+            const char *type)
+{
+  const Babl *fmt        = format (model, type, 0);
+  int         components = babl_format_get_n_components (fmt);
+  int         bpp        = babl_format_get_bytes_per_pixel (fmt);
+  long        samples    = (long) WIDTH * ROWS * components;
+  float      *values     = malloc (samples * sizeof (float));
+  char       *buf        = malloc ((long) WIDTH * ROWS * bpp);
+  long        i;
+
+  for (i = 0; i < samples; i++)
+    values[i] = (float) test_value (i) * 1.4f - 0.2f;
+
+  babl_process (babl_fish (format (model, "float", 0), fmt),
+                values, buf, (long) WIDTH * ROWS);
+  free (values);
+  return buf;
+}
+
+static void
+planes_new (const Babl *fmt,
+            void      **planes,
+            int        *strides)
+{
+  int n     = babl_format_get_n_planes (fmt);
+  int size  = babl_format_get_bytes_per_pixel (fmt) /
+              babl_format_get_n_components (fmt);
+  int p;
+
+  for (p = 0; p < n; p++)
+    {
+      strides[p] = (WIDTH + PAD) * size;
+      planes[p]  = calloc (ROWS, strides[p]);
+    }
+}
+
+static void
+planes_free (const Babl *fmt,
+             void      **planes)
+{
+  int p;
+
+  for (p = 0; p < babl_format_get_n_planes (fmt); p++)
+    free (planes[p]);
+}
+
+/* whether two samples of size bytes are more than tolerance units in the
+ * last place apart; integers and the bit patterns of halfs and floats of
+ * the same sign count up with their values
+ */
+static int
+samples_differ (const char *a,
+                const char *b,
+                int         size,
+                int         tolerance)
+{
+  int64_t x;
+  int64_t y;
+
+  switch (size)
+    {
+      case 1:
+        x = *(const uint8_t *) a;
+        y = *(const uint8_t *) b;
+        break;
+      case 2:
+        x = *(const uint16_t *) a;
+        y = *(const uint16_t *) b;
+        break;
+      default:
+        x = *(const uint32_t *) a;
+        y = *(const uint32_t *) b;
+        break;
+    }
+
+  return x - y > tolerance || y - x > tolerance;
+}
+
+/* planes holds the same samples as the packed rows; the conversions of the
+ * instruction set tiers round differently, a change of type can give
+ * samples a unit in the last place apart
+ */
+static int
+compare (const char  *what,
+         const Babl  *fmt,
+         const char  *packed,
+         void       **planes,
+         const int   *strides,
+         int          tolerance)
+{
+  int  components = babl_format_get_n_components (fmt);
+  int  size       = babl_format_get_bytes_per_pixel (fmt) / components;
+  long x;
+  int  y;
+  int  c;
+
+  for (y = 0; y < ROWS; y++)
+    for (x = 0; x < WIDTH; x++)
+      for (c = 0; c < components; c++)
+        {
+          const char *a = packed + ((y * WIDTH + x) * components + c) * size;
+          const char *b = (char *) planes[c] + y * strides[c] + x * size;
+
+          if (samples_differ (a, b, size, tolerance))
+            {
+              printf ("%s: component %i of pixel %li,%i differs\n",
+                      what, c, x, y);
+              return 0;
+            }
+        }
+  return 1;
+}
+
+static int
+test_layout (const char *model,
+             const char *src_type,
+             const char *dst_type)
+{
+  const Babl *src        = format (model, src_type, 0);
+  const Babl *dst        = format (model, dst_type, 0);
+  const Babl *src_planar = format (model, src_type, 1);
+  const Babl *dst_planar = format (model, dst_type, 1);
+  int         src_bpp    = babl_format_get_bytes_per_pixel (src);
+  int         dst_bpp    = babl_format_get_bytes_per_pixel (dst);
+  char       *src_buf    = packed_new (model, src_type);
+  char       *reference  = malloc ((long) WIDTH * ROWS * dst_bpp);
+  char       *packed     = malloc ((long) WIDTH * ROWS * dst_bpp);
+  void       *src_planes[4];
+  void       *dst_planes[4];
+  int         src_strides[4];
+  int         dst_strides[4];
+  const void *packed_src[1]        = { src_buf };
+  const int   packed_src_stride[1] = { WIDTH * src_bpp };
+  void       *packed_dst[1]        = { packed };
+  const int   packed_dst_stride[1] = { WIDTH * dst_bpp };
+  int         size       = dst_bpp / babl_format_get_n_components (dst);
+  int         tolerance  = strcmp (src_type, dst_type) != 0;
+  char        what[128];
+  int         OK         = 1;
+  long        i;
+
+  babl_process (babl_fish (src, dst), src_buf, reference, (long) WIDTH * ROWS);
+
+  planes_new (src_planar, src_planes, src_strides);
+  planes_new (dst_planar, dst_planes, dst_strides);
+
+  /* deinterleave to the source type, then to the destination type */
+  babl_process_planar (babl_fish (src, src_planar),
+                       packed_src, packed_src_stride,
+                       src_planes, src_strides, WIDTH, ROWS);
+  snprintf (what, sizeof (what), "%s %s to planar", model, src_type);
+  OK &= compare (what, src_planar, src_buf, src_planes, src_strides, 0);
+
+  babl_process_planar (babl_fish (src, dst_planar),
+                       packed_src, packed_src_stride,
+                       dst_planes, dst_strides, WIDTH, ROWS);
+  snprintf (what, sizeof (what), "%s %s to %s planar", model, src_type, dst_type);
+  OK &= compare (what, dst_planar, reference, dst_planes, dst_strides, tolerance);
+
+  /* planar to planar */
+  planes_free (dst_planar, dst_planes);
+  planes_new (dst_planar, dst_planes, dst_strides);
+  babl_process_planar (babl_fish (src_planar, dst_planar),
+                       (const void **) src_planes, src_strides,
+                       dst_planes, dst_strides, WIDTH, ROWS);
+  snprintf (what, sizeof (what), "%s %s planar to %s planar", model, src_type, dst_type);
+  OK &= compare (what, dst_planar, reference, dst_planes, dst_strides, tolerance);
+
+  /* interleave */
+  babl_process_planar (babl_fish (src_planar, dst),
+                       (const void **) src_planes, src_strides,
+                       packed_dst, packed_dst_stride, WIDTH, ROWS);
+  for (i = 0; i < (long) WIDTH * ROWS * dst_bpp; i += size)
+    if (samples_differ (packed + i, reference + i, size, tolerance))
+      {
+        printf ("%s %s planar to %s differs\n", model, src_type, dst_type);
+        OK = 0;
+        break;
+      }
+
+  planes_free (src_planar, src_planes);
+  planes_free (dst_planar, dst_planes);
+  free (src_buf);
+  free (reference);
+  free (packed);
+  return OK;
+}
+
+/* between models the planes are gathered and scattered around a fish */
+static int
+test_models (void)
+{
+  const Babl *src                  = babl_format ("R'G'B'A u8");
+  const Babl *src_planar           = babl_format ("R'G'B'A u8 planar");
+  const Babl *dst                  = babl_format ("YA float");
+  const Babl *dst_planar           = babl_format ("YA float planar");
+  char       *src_buf              = packed_new ("R'G'B'A", "u8");
+  char       *reference            = malloc ((long) WIDTH * ROWS * 8);
+  void       *src_planes[4];
+  void       *dst_planes[2];
+  int         src_strides[4];
+  int         dst_strides[2];
+  const void *packed_src[1]        = { src_buf };
+  const int   packed_src_stride[1] = { WIDTH * 4 };
+  int         OK;
+
+  babl_process (babl_fish (src, dst), src_buf, reference, (long) WIDTH * ROWS);
+
+  planes_new (src_planar, src_planes, src_strides);
+  planes_new (dst_planar, dst_planes, dst_strides);
+
+  babl_process_planar (babl_fish (src, src_planar),
+                       packed_src, packed_src_stride,
+                       src_planes, src_strides, WIDTH, ROWS);
+  babl_process_planar (babl_fish (src_planar, dst_planar),
+                       (const void **) src_planes, src_strides,
+                       dst_planes, dst_strides, WIDTH, ROWS);
+  OK = compare ("R'G'B'A u8 planar to YA float planar", dst_planar, reference,
+                dst_planes, dst_strides, 0);
+
+  planes_free (src_planar, src_planes);
+  planes_free (dst_planar, dst_planes);
+  free (src_buf);
+  free (reference);
+  return OK;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  int OK = 1;
+  int m;
+  int s;
+  int d;
+
+  babl_init ();
+
+  /* two R'G'B'A u8 pixels deinterleaved to u16 planes */
+  {
+    unsigned char  packed[2][4]   = {{0, 128, 255, 51}, {255, 1, 0, 204}};
+    unsigned short planes[4][2]   = {{0, 0}, };
+    unsigned short expected[4][2] = {{0, 65535}, {32896, 257},
+                                     {65535, 0}, {13107, 52428}};
+    const void    *src[1]         = { packed };
+    void          *dst[4]         = { planes[0], planes[1], planes[2], planes[3] };
+    const int      src_stride[1]  = { sizeof (packed) };
+    const int      dst_stride[4]  = { 4, 4, 4, 4 };
+
+    babl_process_planar (babl_fish (babl_format ("R'G'B'A u8"),
+                                    babl_format ("R'G'B'A u16 planar")),
+                         src, src_stride, dst, dst_stride, 2, 1);
+    if (memcmp (planes, expected, sizeof (planes)))
+      {
+        printf ("R'G'B'A u8 to u16 planar: %i %i %i %i, %i %i %i %i\n",
+                planes[0][0], planes[1][0], planes[2][0], planes[3][0],
+                planes[0][1], planes[1][1], planes[2][1], planes[3][1]);
+        OK = 0;
+      }
+  }
+
+  for (m = 0; m < sizeof (models) / sizeof (models[0]); m++)
+    for (s = 0; s < sizeof (types) / sizeof (types[0]); s++)
+      for (d = 0; d < sizeof (types) / sizeof (types[0]); d++)
+        OK &= test_layout (models[m], types[s], types[d]);
+  OK &= test_models ();
+
+  babl_exit ();
+
+  return !OK;
+}
@@ -0,0 +1,168 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* babl_process_spans () gives the same pixels as babl_process () on each
+ * span, for single conversions and paths of several, with spans
+ * that get merged, empty spans, spans longer than the scratch buffers
+ * of paths and short spans merged into runs longer than those
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "babl.h"
+#include "common.inc"
+
+#define PIXELS 3000
+#define SPANS  7
+#define RUNS   4
+/* spans of 4 pixels, 1024 pixels together */
+#define SHORT_SPANS 256
+
+static int OK = 1;
+
+/* offsets and lengths into the buffers; the second to fifth span are
+ * contiguous, the fourth is empty, and the last is longer than the
+ * scratch buffers of paths
+ */
+static const long span_offset[SPANS] = { 0,  17, 27, 40, 40, 300, 1000 };
+static const long span_length[SPANS] = { 5,  10, 13,  0, 250, 1, 2000 };
+
+/* the same pixels, with the contiguous spans as the one run they are
+ * merged into; vectorized conversions can round their tails differently
+ */
+static const long run_offset[RUNS]   = { 0,  17, 300, 1000 };
+static const long run_length[RUNS]   = { 5, 273,   1, 2000 };
+
+static void
+test_formats (const Babl *src_fmt,
+              const Babl *dst_fmt)
+{
+  const Babl    *fish      = babl_fish (src_fmt, dst_fmt);
+  int            src_bpp   = babl_format_get_bytes_per_pixel (src_fmt);
+  int            dst_bpp   = babl_format_get_bytes_per_pixel (dst_fmt);
+  unsigned char *source    = test_pixels_new (src_fmt, PIXELS);
+  unsigned char *reference = calloc (PIXELS, dst_bpp);
+  unsigned char *dest      = calloc (PIXELS, dst_bpp);
+  BablSpan       spans[SPANS];
+  long           expected  = 0;
+  long           i;
+
+  for (i = 0; i < SPANS; i++)
+    {
+      spans[i].source      = source + span_offset[i] * src_bpp;
+      spans[i].destination = dest + span_offset[i] * dst_bpp;
+      spans[i].n           = span_length[i];
+      expected            += span_length[i];
+    }
+
+  for (i = 0; i < RUNS; i++)
+    babl_process (fish,
+                  source + run_offset[i] * src_bpp,
+                  reference + run_offset[i] * dst_bpp,
+                  run_length[i]);
+
+  if (babl_process_spans (fish, spans, SPANS) != expected)
+    {
+      printf ("%s to %s: wrong pixel count\n",
+              babl_get_name (src_fmt), babl_get_name (dst_fmt));
+      OK = 0;
+    }
+
+  if (memcmp (dest, reference, PIXELS * dst_bpp))
+    {
+      printf ("%s to %s: spans differ from babl_process ()\n",
+              babl_get_name (src_fmt), babl_get_name (dst_fmt));
+      OK = 0;
+    }
+
+  free (source);
+  free (reference);
+  free (dest);
+}
+
+/* contiguous spans of a few pixels, merged into one run longer than the
+ * scratch of a path sized for any single span
+ */
+static void
+test_short_spans (const char *source_format,
+                  const char *destination_format)
+{
+  const Babl    *src_fmt   = babl_format (source_format);
+  const Babl    *dst_fmt   = babl_format (destination_format);
+  const Babl    *fish      = babl_fish (src_fmt, dst_fmt);
+  int            src_bpp   = babl_format_get_bytes_per_pixel (src_fmt);
+  int            dst_bpp   = babl_format_get_bytes_per_pixel (dst_fmt);
+  unsigned char *source    = test_pixels_new (src_fmt, SHORT_SPANS * 4);
+  unsigned char *reference = calloc (SHORT_SPANS * 4, dst_bpp);
+  unsigned char *dest      = calloc (SHORT_SPANS * 4, dst_bpp);
+  BablSpan       spans[SHORT_SPANS];
+  int            i;
+
+  for (i = 0; i < SHORT_SPANS; i++)
+    {
+      spans[i].source      = source + i * 4 * src_bpp;
+      spans[i].destination = dest + i * 4 * dst_bpp;
+      spans[i].n           = 4;
+    }
+
+  babl_process (fish, source, reference, SHORT_SPANS * 4);
+  babl_process_spans (fish, spans, SHORT_SPANS);
+
+  if (memcmp (dest, reference, SHORT_SPANS * 4 * dst_bpp))
+    {
+      printf ("%s to %s: short spans differ from babl_process ()\n",
+              source_format, destination_format);
+      OK = 0;
+    }
+
+  free (source);
+  free (reference);
+  free (dest);
+}
+
+static const char *fishes[] =
+{
+  "R'G'B'A u8", "RGBA float",
+  "R'G'B' u16", "CIE Lab alpha float",
+  "Y'A u8",     "HSVA float",
+  "R'G'B'A u8", "CIE LCH(ab) alpha float",
+  NULL
+};
+
+int
+main (int    argc,
+      char **argv)
+{
+  babl_init ();
+
+  test_format_pairs (test_formats, fishes);
+  test_short_spans ("R'G'B' u16", "CIE Lab alpha float");
+  test_short_spans ("Y'A u8", "HSVA float");
+
+  if (babl_process_spans (babl_fish ("R'G'B'A u8", "RGBA float"), NULL, 0) != 0)
+    {
+      printf ("no spans: wrong pixel count\n");
+      OK = 0;
+    }
+
+  babl_exit ();
+
+  return !OK;
+}
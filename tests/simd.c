@@ -0,0 +1,297 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* runs the conversions of the SIMD extensions below on their own, also
+ * where those of a higher instruction set tier take precedence, and
+ * compares them against babl's double precision conversions
+ */
+
+#include "config.h"
+#include <math.h>
+#include "babl-internal.h"
+#include "common.inc"
+
+#define PIXELS 37 /* not a multiple of the vector width */
+
+static struct
+{
+  const char *name;
+  long        accel;
+  double      range;  /* of the components, scales the tolerance */
+  int         tested;
+} extensions[] =
+{
+  { "vector.",     BABL_CPU_ACCEL_VECTOR,   1.0 },
+  { "HSV.",        BABL_CPU_ACCEL_VECTOR,   1.0 },
+  { "HSL.",        BABL_CPU_ACCEL_VECTOR,   1.0 },
+  { "HCY.",        BABL_CPU_ACCEL_VECTOR,   1.0 },
+  { "avx2-int16.", BABL_CPU_ACCEL_X86_AVX2, 1.0 },
+  { "avx2-alpha.", BABL_CPU_ACCEL_X86_AVX2, 1.0 },
+  { "avx512.",     BABL_CPU_ACCEL_X86_AVX512, 1.0 },
+  { " Ok",         BABL_CPU_ACCEL_X86_AVX2, 1.0 },  /* Oklab, in CIE. */
+  { "CIE.",        BABL_CPU_ACCEL_X86_AVX2, 100.0 },
+  { "bitpacked.",  BABL_CPU_ACCEL_VECTOR,   1.0 },
+};
+
+#define N_EXTENSIONS (sizeof (extensions) / sizeof (extensions[0]))
+
+static int OK = 1;
+
+static const Babl *
+double_format (const Babl *format)
+{
+  const Babl *model = babl_format_get_model (format);
+  const Babl *component[4] = { NULL, };
+  int         i;
+
+  for (i = 0; i < model->model.components; i++)
+    component[i] = BABL (model->model.component[i]);
+
+  return babl_format_new (model, babl_type ("double"),
+                          component[0], component[1],
+                          component[2], component[3], NULL);
+}
+
+static int
+is_integer (const Babl *type)
+{
+  return type == babl_type ("u8") || type == babl_type ("u16") ||
+         type == babl_type ("u16be") ||
+         type->type.packed_bits < type->type.bits;
+}
+
+static double
+tolerance (const Babl *type,
+           double      range)
+{
+  if (type == babl_type ("u8"))
+    return 1.01 / 255.0;
+  else if (type == babl_type ("u16") || type == babl_type ("u16be"))
+    return 2.01 / 65535.0;
+  else if (type == babl_type ("half"))
+    return 1e-3;
+  else if (type == babl_type ("bfloat16"))
+    return 1.0 / 256.0;
+  else if (type->type.packed_bits < type->type.bits)
+    return 1.01 / ((1 << type->type.packed_bits) - 1);
+  return 1e-5 * range;
+}
+
+static void
+make_source (const Babl    *format,
+             unsigned char *data)
+{
+  double values[PIXELS * 4];
+  int    n = PIXELS * babl_format_get_n_components (format);
+  int    i;
+
+  /* stay clear of the tiny alphas unpremultiplying amplifies noise of */
+  for (i = 0; i < n; i++)
+    values[i] = 0.05 + 0.95 * test_value (i);
+
+  babl_process (babl_fish (double_format (format), format),
+                values, data, PIXELS);
+}
+
+/* the u8 alpha kernels are exactly rounded, check them for every pair of
+ * component and alpha
+ */
+static void
+test_exact_u8 (BablConversion *conversion)
+{
+  int           associated = babl_get_model_flags (babl_format_get_model (
+                                conversion->destination)) &
+                              BABL_MODEL_FLAG_ASSOCIATED;
+  int           components = babl_format_get_n_components (conversion->source);
+  unsigned char src[256 * 4];
+  unsigned char dst[256 * 4];
+  int           alpha, c, i;
+
+  for (alpha = 0; alpha < 256; alpha++)
+    {
+      for (i = 0; i < 256; i++)
+        {
+          for (c = 0; c < components - 1; c++)
+            src[i * components + c] = i;
+          src[i * components + c] = alpha;
+        }
+      conversion->dispatch ((void *) conversion, (void *) src, (void *) dst,
+                            256, conversion->data);
+
+      for (i = 0; i < 256; i++)
+        {
+          int expected;
+
+          if (associated)
+            expected = (2 * i * alpha + 255) / 510;
+          else if (alpha == 0)
+            expected = i ? 255 : 0;
+          else
+            expected = (2 * i * 255 + alpha) / (2 * alpha);
+          if (expected > 255)
+            expected = 255;
+
+          if (dst[i * components] != expected ||
+              dst[i * components + components - 1] != alpha)
+            {
+              printf ("%s: %i with alpha %i is %i, expected %i\n",
+                      babl_get_name ((void *) conversion), i, alpha,
+                      dst[i * components], expected);
+              OK = 0;
+              return;
+            }
+        }
+    }
+}
+
+/* float to u16 within a model is rounded exactly, even where the
+ * product rounded to float would land on .5
+ */
+static void
+test_exact_u16 (BablConversion *conversion)
+{
+  float    src[4096];
+  uint16_t dst[4096];
+  int      components = babl_format_get_n_components (conversion->source);
+  long     k;
+  int      i;
+
+  for (k = 0; k < 65535; k += 4096 / 2)
+    {
+      long count = k + 4096 / 2 > 65535 ? 65535 - k : 4096 / 2;
+
+      /* either side of the halfway points */
+      for (i = 0; i < count; i++)
+        {
+          float x = (k + i + 0.5) / 65535.0;
+
+          src[i * 2]     = x;
+          src[i * 2 + 1] = x * (1.0f - 1.0f / 16777216.0f);
+        }
+      conversion->dispatch ((void *) conversion, (void *) src, (void *) dst,
+                            count * 2 / components, conversion->data);
+
+      for (i = 0; i < count * 2 / components * components; i++)
+        {
+          long expected = src[i] * 65535.0 + 0.5;
+
+          if (dst[i] != expected)
+            {
+              printf ("%s: %.9g is %i, expected %li\n",
+                      babl_get_name ((void *) conversion), src[i], dst[i],
+                      expected);
+              OK = 0;
+              return;
+            }
+        }
+    }
+}
+
+static int
+test_conversion (Babl *babl,
+                 void *user_data)
+{
+  BablConversion *conversion = (BablConversion *) babl;
+  const Babl     *source     = conversion->source;
+  const Babl     *destination = conversion->destination;
+  const Babl     *type;
+  unsigned char   src[PIXELS * 4 * 4];
+  unsigned char   dst[PIXELS * 4 * 4];
+  double          ref[PIXELS * 4];
+  double          out[PIXELS * 4];
+  double          range;
+  int             components;
+  int             n, i;
+
+  if (babl->class_type != BABL_CONVERSION_LINEAR ||
+      source->class_type != BABL_FORMAT ||
+      destination->class_type != BABL_FORMAT ||
+      babl_format_get_type (destination, 0) == babl_type ("double"))
+    return 0;
+
+  for (i = 0; i < N_EXTENSIONS; i++)
+    if (strstr (babl_get_name (babl), extensions[i].name) &&
+        (conversion->accel & extensions[i].accel) == extensions[i].accel)
+      break;
+  if (i == N_EXTENSIONS)
+    return 0;
+  extensions[i].tested++;
+  range = extensions[i].range;
+
+  make_source (source, src);
+  conversion->dispatch (babl, (void *) src, (void *) dst, PIXELS,
+                        conversion->data);
+
+  babl_process (babl_fish (source, double_format (destination)),
+                src, ref, PIXELS);
+  babl_process (babl_fish (destination, double_format (destination)),
+                dst, out, PIXELS);
+
+  type = babl_format_get_type (destination, 0);
+  if (type == babl_type ("u8") && strstr (babl_get_name (babl), "avx2-alpha."))
+    test_exact_u8 (conversion);
+  if (type == babl_type ("u16") &&
+      babl_format_get_type (source, 0) == babl_type ("float") &&
+      babl_format_get_model (source) == babl_format_get_model (destination))
+    test_exact_u16 (conversion);
+
+  components = babl_format_get_n_components (destination);
+  n = PIXELS * components;
+  for (i = 0; i < n; i++)
+    if (is_integer (babl_format_get_type (destination, i % components)))
+      ref[i] = ref[i] < 0.0 ? 0.0 : ref[i] > 1.0 ? 1.0 : ref[i];
+  /* hues of 0.0 and 1.0 are the same */
+  if (!strcmp (babl_get_name (BABL (destination->format.component[0])), "hue"))
+    for (i = 0; i < n; i += components)
+      if (fabs (out[i] - ref[i]) > 0.5)
+        out[i] += out[i] < ref[i] ? 1.0 : -1.0;
+  for (i = 0; i < n; i++)
+    if (fabs (out[i] - ref[i]) >
+        tolerance (babl_format_get_type (destination, i % components), range) *
+        (fabs (ref[i]) > 1.0 ? fabs (ref[i]) : 1.0))
+      {
+        printf ("%s: component %i is %f, expected %f\n",
+                babl_get_name (babl), i, out[i], ref[i]);
+        OK = 0;
+        break;
+      }
+
+  return 0;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  int i;
+
+  babl_init ();
+
+  babl_conversion_class_for_each (test_conversion, NULL);
+
+  for (i = 0; i < N_EXTENSIONS; i++)
+    if (!extensions[i].tested &&
+        (babl_cpu_accel_get_support () & extensions[i].accel) == extensions[i].accel)
+      {
+        printf ("no %s conversions registered\n", extensions[i].name);
+        OK = 0;
+      }
+
+  babl_exit ();
+  return !OK;
+}
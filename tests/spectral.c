@@ -0,0 +1,210 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include "babl.h"
+
+#include "common.inc"
+
+#define MAX_BANDS 81
+
+/* a few colors, grays and primaries among them; spectra have no alpha */
+static const float colors[][4] =
+{
+  { 0.0,      0.0,      0.0,      1.0 },
+  { 0.214041, 0.214041, 0.214041, 1.0 },
+  { 1.0,      1.0,      1.0,      1.0 },
+  { 1.0,      0.0,      0.0,      1.0 },
+  { 0.0,      1.0,      0.0,      1.0 },
+  { 0.0,      0.0,      1.0,      1.0 },
+  { 0.353069, 0.372000, 0.017878, 1.0 },
+  { 0.850554, 0.181933, 0.081839, 1.0 },
+};
+
+#define COLORS (sizeof (colors) / sizeof (colors[0]))
+
+/* a flat spectrum is the white of the space, with any number of bands,
+ * illuminant and space
+ */
+static int
+test_white (const Babl *format,
+            int         bands,
+            const char *what)
+{
+  int   OK             = 1;
+  float flat[1][MAX_BANDS];
+  float white[][4]     = {{ 0.5, 0.5, 0.5, 1.0 }};
+  int   b;
+
+  for (b = 0; b < bands; b++)
+    flat[0][b] = 0.5f;
+
+  CHECK_CONV_FLOAT (what, float, 0.0001, format,
+                    babl_format_with_space ("RGBA float",
+                                            babl_format_get_space (format)),
+                    flat, white);
+  return OK;
+}
+
+/* the colors survive a round trip through the spectra, and the float fast
+ * paths agree with the double reference
+ */
+static int
+test_round_trip (const Babl *format,
+                 const Babl *double_format,
+                 int         bands,
+                 const char *what)
+{
+  static float  spectra[COLORS * MAX_BANDS];
+  static double spectra_double[COLORS * MAX_BANDS];
+  float         result[COLORS][4];
+  double        result_double[COLORS][4];
+  const Babl   *space = babl_format_get_space (format);
+  int           i, c;
+
+  babl_process (babl_fish (babl_format_with_space ("RGBA float", space), format),
+                colors, spectra, COLORS);
+  babl_process (babl_fish (format, babl_format_with_space ("RGBA float", space)),
+                spectra, result, COLORS);
+
+  for (i = 0; i < COLORS; i++)
+    for (c = 0; c < 4; c++)
+      if (fabs (result[i][c] - colors[i][c]) > 0.0001)
+        {
+          printf ("%s: #%i[%i] %f round trips to %f\n", what, i, c,
+                  colors[i][c], result[i][c]);
+          return 0;
+        }
+
+  if (!double_format)
+    return 1;
+
+  for (i = 0; i < COLORS * bands; i++)
+    spectra_double[i] = spectra[i];
+  babl_process (babl_fish (double_format,
+                           babl_format_with_space ("RGBA double", space)),
+                spectra_double, result_double, COLORS);
+
+  for (i = 0; i < COLORS; i++)
+    for (c = 0; c < 4; c++)
+      if (fabs (result[i][c] - result_double[i][c]) > 0.0001)
+        {
+          printf ("%s: #%i[%i] float %f, double %f\n", what, i, c,
+                  result[i][c], result_double[i][c]);
+          return 0;
+        }
+  return 1;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  int         OK = 1;
+  double      illuminant[MAX_BANDS];
+  const Babl *visible;
+  const Babl *fine;
+  const Babl *lit;
+  const Babl *rec2020;
+  int         b;
+
+  babl_init ();
+
+  /* a warm illuminant, linear over the wavelengths */
+  for (b = 0; b < MAX_BANDS; b++)
+    illuminant[b] = 0.5 + b / 80.0;
+
+  visible = babl_spectral_format (NULL, 400.0, 10.0, 31, NULL, NULL, NULL);
+  fine    = babl_spectral_format (NULL, 380.0, 5.0, 81, NULL, NULL, NULL);
+  lit     = babl_spectral_format (NULL, 380.0, 5.0, 81, NULL, illuminant, NULL);
+  rec2020 = babl_spectral_format (NULL, 380.0, 5.0, 81, NULL, NULL,
+                                  babl_space ("Rec2020"));
+
+  if (babl_spectral_format (babl_type ("float"), 400.0, 10.0, 31,
+                            NULL, NULL, babl_space ("sRGB")) != visible)
+    {
+      printf ("the same configuration gives a different format\n");
+      OK = 0;
+    }
+  if (lit == fine)
+    {
+      printf ("the illuminant is not part of the format\n");
+      OK = 0;
+    }
+
+  /* illuminants whose hashes in the model names are the same */
+  {
+    static const double first[3]  = { 1.0, 1.0, 0.82230736967176199 };
+    static const double second[3] = { 1.0, 1.0, 0.56491330661810935 };
+    const Babl         *a = babl_spectral_format (NULL, 400.0, 50.0, 3,
+                                                  NULL, first, NULL);
+    const Babl         *b = babl_spectral_format (NULL, 400.0, 50.0, 3,
+                                                  NULL, second, NULL);
+
+    if (a == b)
+      {
+        printf ("illuminants of the same hash give the same format\n");
+        OK = 0;
+      }
+    if (babl_spectral_format (NULL, 400.0, 50.0, 3, NULL, second, NULL) != b ||
+        babl_spectral_format (NULL, 400.0, 50.0, 3, NULL, first, NULL) != a)
+      {
+        printf ("a colliding illuminant gives a different format again\n");
+        OK = 0;
+      }
+  }
+
+  OK &= test_white (visible, 31, "31 bands");
+  OK &= test_white (fine, 81, "81 bands");
+  OK &= test_white (lit, 81, "81 bands under an illuminant");
+  OK &= test_white (rec2020, 81, "81 bands in Rec2020");
+
+  OK &= test_round_trip (visible, NULL, 31, "31 bands");
+  OK &= test_round_trip (fine,
+          babl_spectral_format (babl_type ("double"), 380.0, 5.0, 81,
+                                NULL, NULL, NULL),
+          81, "81 bands");
+  OK &= test_round_trip (lit,
+          babl_spectral_format (babl_type ("double"), 380.0, 5.0, 81,
+                                NULL, illuminant, NULL),
+          81, "81 bands under an illuminant");
+  OK &= test_round_trip (rec2020,
+          babl_spectral_format (babl_type ("double"), 380.0, 5.0, 81,
+                                NULL, NULL, babl_space ("Rec2020")),
+          81, "81 bands in Rec2020");
+
+  /* the band at 550 nm alone is a green outside of the sRGB gamut */
+  {
+    float spectrum[31] = { 0.0f, };
+    float rgba[4];
+
+    spectrum[15] = 1.0f;
+    babl_process (babl_fish (visible, babl_format ("RGBA float")),
+                  spectrum, rgba, 1);
+    if (!(rgba[1] > 0.0f && rgba[0] < 0.0f && rgba[2] < 0.0f))
+      {
+        printf ("550 nm is %f %f %f\n", rgba[0], rgba[1], rgba[2]);
+        OK = 0;
+      }
+  }
+
+  babl_exit ();
+
+  return !OK;
+}
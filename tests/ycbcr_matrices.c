@@ -0,0 +1,209 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "babl.h"
+#include "common.inc"
+
+/* not a multiple of the 4 or 8 pixels the SSE2 fast paths convert at a
+ * time
+ */
+#define PIXELS 203
+
+typedef struct
+{
+  const char *name;
+  double      kr;
+  double      kb;
+  int         bits;
+  int         full;
+} Encoding;
+
+static const Encoding encodings[] =
+{
+  { "Y'CbCr709 u8",        0.2126, 0.0722, 8,  0 },
+  { "Y'CbCr709 full u8",   0.2126, 0.0722, 8,  1 },
+  { "Y'CbCr709 u16",       0.2126, 0.0722, 16, 0 },
+  { "Y'CbCr709 full u16",  0.2126, 0.0722, 16, 1 },
+  { "Y'CbCr2020 u8",       0.2627, 0.0593, 8,  0 },
+  { "Y'CbCr2020 full u8",  0.2627, 0.0593, 8,  1 },
+  { "Y'CbCr2020 u16",      0.2627, 0.0593, 16, 0 },
+  { "Y'CbCr2020 full u16", 0.2627, 0.0593, 16, 1 },
+  { "Y'CbCr709 float",     0.2126, 0.0722, 0,  1 },
+  { "Y'CbCr2020 float",    0.2627, 0.0593, 0,  1 },
+};
+
+/* the equations of BT.709 / BT.2020 for R'G'B' in 0.0-1.0 */
+static void
+encode (const Encoding *e,
+        const double   *rgb,
+        double         *ycbcr)
+{
+  double kg = 1.0 - e->kr - e->kb;
+  double y  = e->kr * rgb[0] + kg * rgb[1] + e->kb * rgb[2];
+  double cb = (rgb[2] - y) / (2.0 * (1.0 - e->kb));
+  double cr = (rgb[0] - y) / (2.0 * (1.0 - e->kr));
+  double scale = e->bits == 8 ? 1.0 : 256.0;
+
+  if (e->bits == 0)
+    {
+      ycbcr[0] = y;
+      ycbcr[1] = cb;
+      ycbcr[2] = cr;
+    }
+  else if (e->full)
+    {
+      double max = (1 << e->bits) - 1;
+
+      ycbcr[0] = y * max;
+      ycbcr[1] = cb * max + (1 << (e->bits - 1));
+      ycbcr[2] = cr * max + (1 << (e->bits - 1));
+    }
+  else
+    {
+      ycbcr[0] = (16.0 + 219.0 * y) * scale;
+      ycbcr[1] = (128.0 + 224.0 * cb) * scale;
+      ycbcr[2] = (128.0 + 224.0 * cr) * scale;
+    }
+}
+
+static double
+stored (const Encoding *e,
+        const void     *buf,
+        int             i)
+{
+  switch (e->bits)
+    {
+      case 8:  return ((const uint8_t *) buf)[i];
+      case 16: return ((const uint16_t *) buf)[i];
+      default: return ((const float *) buf)[i];
+    }
+}
+
+static int
+test_encoding (const Encoding *e)
+{
+  const Babl *format = babl_format (e->name);
+  const char *rgb_name = e->bits == 8  ? "R'G'B'A u8" :
+                         e->bits == 16 ? "R'G'B'A u16" : "R'G'B'A float";
+  const Babl *rgb_format = babl_format (rgb_name);
+  double      tolerance = e->bits ? 1.0 : 0.00001;
+  double      max = e->bits ? (1 << e->bits) - 1 : 1.0;
+  char        rgba[PIXELS * 4 * 4];
+  char        ycbcr[PIXELS * 3 * 4];
+  char        decoded[PIXELS * 4 * 4];
+  int         OK = 1;
+  int         i, c;
+
+  for (i = 0; i < PIXELS * 4; i++)
+    {
+      unsigned int v = test_hash (i) >> 8;
+
+      switch (e->bits)
+        {
+          case 8:  ((uint8_t *) rgba)[i]  = v; break;
+          case 16: ((uint16_t *) rgba)[i] = v; break;
+          default: ((float *) rgba)[i]    = (v & 0xffff) / 65535.0; break;
+        }
+    }
+
+  babl_process (babl_fish (rgb_format, format), rgba, ycbcr, PIXELS);
+  babl_process (babl_fish (format, rgb_format), ycbcr, decoded, PIXELS);
+
+  for (i = 0; i < PIXELS; i++)
+    {
+      double rgb[3];
+      double expected[3];
+
+      for (c = 0; c < 3; c++)
+        rgb[c] = stored (e, rgba, i * 4 + c) / max;
+      encode (e, rgb, expected);
+
+      for (c = 0; c < 3; c++)
+        {
+          double got = stored (e, ycbcr, i * 3 + c);
+
+          if (fabs (got - expected[c]) > tolerance)
+            {
+              if (OK)
+                fprintf (stderr, "%s: pixel %i[%i] encoded %f expected %f\n",
+                         e->name, i, c, got, expected[c]);
+              OK = 0;
+            }
+        }
+
+      /* limited range u8 is lossy, otherwise round trips are within
+       * rounding of the stored values
+       */
+      for (c = 0; c < 4; c++)
+        {
+          double got  = stored (e, decoded, i * 4 + c);
+          double orig = stored (e, rgba, i * 4 + c);
+
+          if (c == 3)
+            orig = max;
+          if (fabs (got - orig) > (e->bits == 8 ? 2.0 : e->bits ? 4.0 : 0.00001))
+            {
+              if (OK)
+                fprintf (stderr, "%s: pixel %i[%i] round trip %f expected %f\n",
+                         e->name, i, c, got, orig);
+              OK = 0;
+            }
+        }
+    }
+
+  return OK;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  int OK = 1;
+  int i;
+
+  babl_init ();
+
+  /* black, white and red, on the limited range of 16 to 235 and 240 */
+  {
+    unsigned char in[][4]     = {{0, 0, 0, 255}, {255, 255, 255, 255}, {255, 0, 0, 255}};
+    unsigned char bt709[][3]  = {{16, 128, 128}, {235, 128, 128}, {63, 102, 240}};
+    unsigned char bt2020[][3] = {{16, 128, 128}, {235, 128, 128}, {74,  97, 240}};
+
+    CHECK_CONV ("R'G'B'A u8 -> Y'CbCr709 u8", unsigned char,
+        babl_format ("R'G'B'A u8"),
+        babl_format ("Y'CbCr709 u8"),
+        in, bt709);
+    CHECK_CONV ("R'G'B'A u8 -> Y'CbCr2020 u8", unsigned char,
+        babl_format ("R'G'B'A u8"),
+        babl_format ("Y'CbCr2020 u8"),
+        in, bt2020);
+  }
+
+  for (i = 0; i < sizeof (encodings) / sizeof (encodings[0]); i++)
+    if (!test_encoding (&encodings[i]))
+      OK = 0;
+
+  babl_exit ();
+
+  return !OK;
+}
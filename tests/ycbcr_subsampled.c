@@ -0,0 +1,189 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "babl.h"
+#include "common.inc"
+
+#define WIDTH   37
+#define HEIGHT  23
+#define STRIDE  (WIDTH * 2)
+
+typedef struct
+{
+  const char *name;
+  int         horizontal;
+  int         vertical;
+  int         interleaved; /* Cb and Cr share a plane */
+} Subsampled;
+
+static const Subsampled formats[] =
+{
+  { "Y'CbCr u8",      2, 2, 0 },
+  { "Y'CbCr420 u8",   2, 2, 0 },
+  { "Y'CbCr422 u8",   2, 1, 0 },
+  { "Y'CbCr411 u8",   4, 1, 0 },
+  { "Y'CbCr NV12 u8", 2, 2, 1 },
+};
+
+static unsigned char rgba[HEIGHT][WIDTH][4];
+static unsigned char planes[3][HEIGHT * STRIDE];
+
+/* constant colors in 4x2 blocks, these survive any of the subsamplings */
+static void
+make_source (void)
+{
+  int x, y, c;
+
+  for (y = 0; y < HEIGHT; y++)
+    for (x = 0; x < WIDTH; x++)
+      {
+        unsigned int block = (y / 2) * 131 + (x / 4) * 7919;
+
+        for (c = 0; c < 3; c++)
+          rgba[y][x][c] = test_hash (block * (c + 3)) >> 24;
+        rgba[y][x][3] = 255;
+      }
+}
+
+static void
+gather_pixel (const Subsampled *sub,
+              int               x,
+              int               y,
+              unsigned char    *ycbcr)
+{
+  int cx = x / sub->horizontal;
+  int cy = y / sub->vertical;
+
+  ycbcr[0] = planes[0][y * STRIDE + x];
+  if (sub->interleaved)
+    {
+      ycbcr[1] = planes[1][cy * STRIDE + cx * 2];
+      ycbcr[2] = planes[1][cy * STRIDE + cx * 2 + 1];
+    }
+  else
+    {
+      ycbcr[1] = planes[1][cy * STRIDE + cx];
+      ycbcr[2] = planes[2][cy * STRIDE + cx];
+    }
+}
+
+static int
+test_format (const Subsampled *sub)
+{
+  const Babl *format = babl_format (sub->name);
+  const Babl *packed = babl_format_new (babl_model ("Y'CbCr"),
+                                        babl_type ("u8-luma"),
+                                        babl_component ("Y'"),
+                                        babl_type ("u8-chroma"),
+                                        babl_component ("Cb"),
+                                        babl_component ("Cr"),
+                                        NULL);
+  const int   strides[3] = { STRIDE, STRIDE, STRIDE };
+  const int   rgba_stride[1] = { WIDTH * 4 };
+  const int   float_stride[1] = { WIDTH * 4 * sizeof (float) };
+  void       *plane_ptr[3] = { planes[0], planes[1], planes[2] };
+  void       *rgba_ptr[1];
+  const void *src_ptr[1] = { rgba };
+  unsigned char decoded[HEIGHT][WIDTH][4];
+  float         decoded_float[HEIGHT][WIDTH][4];
+  int OK = 1;
+  int x, y, c;
+
+  if (babl_format_get_n_planes (format) != (sub->interleaved ? 2 : 3))
+    {
+      fprintf (stderr, "%s: wrong number of planes %i\n", sub->name,
+               babl_format_get_n_planes (format));
+      return 0;
+    }
+
+  memset (planes, 0, sizeof (planes));
+  babl_process_planar (babl_fish ("R'G'B'A u8", format),
+                       src_ptr, rgba_stride, plane_ptr, strides,
+                       WIDTH, HEIGHT);
+
+  rgba_ptr[0] = decoded;
+  babl_process_planar (babl_fish (format, "R'G'B'A u8"),
+                       (const void **) plane_ptr, strides, rgba_ptr, rgba_stride,
+                       WIDTH, HEIGHT);
+  rgba_ptr[0] = decoded_float;
+  babl_process_planar (babl_fish (format, "RGBA float"),
+                       (const void **) plane_ptr, strides, rgba_ptr, float_stride,
+                       WIDTH, HEIGHT);
+
+  for (y = 0; y < HEIGHT; y++)
+    {
+      unsigned char ycbcr[WIDTH][3];
+      unsigned char expected[WIDTH][4];
+      float         expected_float[WIDTH][4];
+
+      for (x = 0; x < WIDTH; x++)
+        gather_pixel (sub, x, y, ycbcr[x]);
+      babl_process (babl_fish (packed, "R'G'B'A u8"), ycbcr, expected, WIDTH);
+      babl_process (babl_fish (packed, "RGBA float"), ycbcr, expected_float, WIDTH);
+
+      for (x = 0; x < WIDTH; x++)
+        for (c = 0; c < 4; c++)
+          {
+            /* round trip through limited range u8 */
+            if (abs (decoded[y][x][c] - rgba[y][x][c]) > 2)
+              {
+                if (OK)
+                  fprintf (stderr, "%s: %i,%i[%i] round trip %i expected %i\n",
+                           sub->name, x, y, c, decoded[y][x][c], rgba[y][x][c]);
+                OK = 0;
+              }
+            /* against the packed format */
+            if (abs (decoded[y][x][c] - expected[x][c]) > 1 ||
+                fabs (decoded_float[y][x][c] - expected_float[x][c]) > 0.00001)
+              {
+                if (OK)
+                  fprintf (stderr, "%s: %i,%i[%i] decoded %i %f expected %i %f\n",
+                           sub->name, x, y, c,
+                           decoded[y][x][c], decoded_float[y][x][c],
+                           expected[x][c], expected_float[x][c]);
+                OK = 0;
+              }
+          }
+    }
+
+  return OK;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  int OK = 1;
+  int i;
+
+  babl_init ();
+
+  make_source ();
+  for (i = 0; i < sizeof (formats) / sizeof (formats[0]); i++)
+    if (!test_format (&formats[i]))
+      OK = 0;
+
+  babl_exit ();
+
+  return !OK;
+}
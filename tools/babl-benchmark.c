@@ -183,6 +183,112 @@ test (void)
   return 0;
 }
 
+/* time each conversion registered between the format pairs covered by
+ * the SIMD extensions on its own, the implementations of all instruction
+ * set tiers the CPU supports are registered side by side - BABL_CPU_ACCEL
+ * set to vector, sse2, sse4.1, avx2 or avx512 leaves out the higher ones
+ */
+static void
+test_tiers (void)
+{
+  static const char *pairs[][2]={
+    {"R'G'B'A u8",    "RGBA float"},
+    {"RGBA float",    "R'G'B'A u8"},
+    {"Y float",       "Y' u8"},
+    {"RGBA float",    "R'G'B'A float"},
+    {"R'G'B'A float", "RGBA float"},
+    {"RGBA u16",      "RGBA float"},
+    {"RGBA u16",      "RaGaBaA float"},
+    {"RGBA float",    "RGBA u16"},
+    {"R'G'B'A u16",   "RGBA float"},
+    {"RGBA float",    "R'G'B'A u16"},
+    {"R'G'B'A u16",   "RaGaBaA float"},
+    {"Y'A u16",       "YA float"},
+    {"R'G'B'A u16",   "R'G'B'A u8"},
+    {"R'G'B'A u8",    "R'aG'aB'aA u8"},
+    {"R'aG'aB'aA u8", "R'G'B'A u8"},
+    {"RGBA u16",      "RaGaBaA u16"},
+    {"RaGaBaA half",  "RGBA half"},
+    {"RGBA half",     "RGBA float"},
+    {"RGBA float",    "RGBA half"},
+    {"RGBA float",    "CIE Lab alpha float"},
+    {"CIE Lab alpha float", "RGBA float"},
+    {"RGBA float",    "CIE LCH(ab) float"},
+    {"CIE LCH(ab) float", "RGBA float"},
+    {"CIE Lab float", "CIE LCH(ab) float"},
+    {"CIE LCH(ab) float", "CIE Lab float"},
+    {"RGBA float",    "Oklab alpha float"},
+    {"Oklab alpha float", "RGBA float"},
+    {"R'G'B'A float", "OkLCh float"},
+    {"OkLCh float",   "R'G'B'A float"},
+    {"R'G'B'A u8",    "Oklab float"},
+    {"Oklab alpha float", "R'G'B'A u8"},
+    {"R'G'B'A u10-10-10-2", "R'G'B'A u8"},
+    {"R'G'B'A u8",    "R'G'B'A u10-10-10-2"},
+    {"RGBA u10-10-10-2", "RGBA float"},
+    {"RGBA float",    "RGBA u10-10-10-2"},
+    {"R'G'B' u5-6-5", "R'G'B'A u8"},
+    {"R'G'B'A u8",    "R'G'B' u5-6-5"},
+    {"R'G'B'A u16be", "RGBA float"},
+    {"RGBA float",    "R'G'B'A u16be"},
+    {"R'G'B'A u16be", "R'G'B'A u8"},
+    {"RGBA floatbe",  "RGBA float"},
+    {"RGBA float",    "RGBA bfloat16"},
+    {"RGBA bfloat16", "RGBA float"},
+    {"R'G'B'A u8",    "R'G'B'A bfloat16"},
+    {"Y float",       "Y bfloat16"},
+  };
+  char *src_data = babl_malloc (N_BYTES);
+  char *dst_data = babl_malloc (N_BYTES);
+  int i, k;
+
+  for (i = 0; i < N_BYTES / 4; i++)
+    ((float *) src_data)[i] = (i % 1024) / 1023.0f;
+
+  fprintf (stdout, "\nper conversion, %i iterations of %i pixels\n",
+           ITERATIONS, N_PIXELS);
+
+  for (i = 0; i < sizeof (pairs) / sizeof (pairs[0]); i++)
+    {
+      const Babl *source      = babl_format (pairs[i][0]);
+      const Babl *destination = babl_format (pairs[i][1]);
+      BablList   *list        = source->format.from_list;
+
+      if (!list)
+        continue;
+
+      for (k = 0; k < list->count; k++)
+        {
+          BablConversion *conversion = (BablConversion *) list->items[k];
+          long  start, end;
+          int   iters = ITERATIONS;
+
+          if (conversion->destination != destination ||
+              BABL (conversion)->class_type != BABL_CONVERSION_LINEAR)
+            continue;
+
+          conversion->dispatch ((Babl *) conversion, src_data, dst_data,
+                                N_PIXELS / 4, conversion->data);
+          start = babl_ticks ();
+          while (iters--)
+            conversion->dispatch ((Babl *) conversion, src_data, dst_data,
+                                  N_PIXELS, conversion->data);
+          end = babl_ticks ();
+
+          fprintf (stdout, "%8.1f mb/s\t%s\n",
+                   (babl_format_get_bytes_per_pixel (source) +
+                    babl_format_get_bytes_per_pixel (destination)) *
+                   (N_PIXELS * ITERATIONS / 1024.0 / 1024.0) /
+                   ((end - start) / (1000.0 * 1000.0)),
+                   babl_get_name ((Babl *) conversion));
+        }
+    }
+
+  babl_free (src_data);
+  babl_free (dst_data);
+  fflush (0);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -191,6 +297,7 @@ main (int    argc,
   babl_init ();
   if (test ())
     return -1;
+  test_tiers ();
   babl_exit ();
   return 0;
 }
@@ -0,0 +1,44 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* Benchmarks all conversions and reference fishes and writes the cost
+ * profile used for choosing fish paths on this CPU, to the path given as
+ * argument, $BABL_COST_PROFILE or next to the fish cache.
+ */
+
+#include "config.h"
+#include "babl-internal.h"
+
+int
+main (int    argc,
+      char **argv)
+{
+  int count;
+
+  babl_init ();
+  count = babl_cost_profile_calibrate (argc > 1 ? argv[1] : NULL);
+  babl_exit ();
+
+  if (count < 0)
+    {
+      fprintf (stderr, "babl-calibrate: failed writing the cost profile\n");
+      return -1;
+    }
+  fprintf (stdout, "calibrated %i conversions and reference fishes\n", count);
+  return 0;
+}
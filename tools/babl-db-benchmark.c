@@ -0,0 +1,118 @@
+/* babl - dynamically extendable universal pixel conversion library.
+ * Copyright (C) 2005, 2017 Øyvind Kolås.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/* Microbenchmark of BablDb insertion and lookup by name and id, the
+ * databases holding fishes, formats and conversions grow to tens of
+ * thousands of entries when many spaces are in use.
+ */
+
+#include "config.h"
+#include "babl-internal.h"
+
+int N_ITEMS = 50000;
+#define LOOKUPS   (1024 * 1024)
+
+static Babl *
+item_new (int i)
+{
+  char  name[64];
+  Babl *item;
+
+  snprintf (name, sizeof (name), "R'G'B'A u8 %i-space-%p", i, (void*)&name);
+  item = babl_malloc (sizeof (BablInstance) + strlen (name) + 1);
+  memset (item, 0, sizeof (BablInstance));
+  item->class_type    = BABL_INSTANCE;
+  item->instance.id   = i + 1;
+  item->instance.name = ((char *) item) + sizeof (BablInstance);
+  strcpy (item->instance.name, name);
+  return item;
+}
+
+static int
+test (void)
+{
+  BablDb *db = babl_db_init ();
+  Babl  **items = babl_malloc (sizeof (Babl *) * N_ITEMS);
+  long    start, end;
+  int     i;
+  int     OK = 1;
+
+  for (i = 0; i < N_ITEMS; i++)
+    items[i] = item_new (i);
+
+  start = babl_ticks ();
+  for (i = 0; i < N_ITEMS; i++)
+    babl_db_insert (db, items[i]);
+  end = babl_ticks ();
+  fprintf (stdout, "%i inserts:          %8.1f ns/item\n", N_ITEMS,
+           (end - start) * 1000.0 / N_ITEMS);
+
+  start = babl_ticks ();
+  for (i = 0; i < LOOKUPS; i++)
+    {
+      Babl *item = items[(i * 7919L) % N_ITEMS];
+      if (babl_db_exist_by_name (db, item->instance.name) != item)
+        OK = 0;
+    }
+  end = babl_ticks ();
+  fprintf (stdout, "%i lookups by name: %8.1f ns/item\n", LOOKUPS,
+           (end - start) * 1000.0 / LOOKUPS);
+
+  start = babl_ticks ();
+  for (i = 0; i < LOOKUPS; i++)
+    {
+      Babl *item = items[(i * 7919L) % N_ITEMS];
+      if (babl_db_exist_by_id (db, item->instance.id) != item)
+        OK = 0;
+    }
+  end = babl_ticks ();
+  fprintf (stdout, "%i lookups by id:   %8.1f ns/item\n", LOOKUPS,
+           (end - start) * 1000.0 / LOOKUPS);
+
+  start = babl_ticks ();
+  for (i = 0; i < LOOKUPS; i++)
+    {
+      if (babl_db_exist_by_name (db, "not a registered name"))
+        OK = 0;
+    }
+  end = babl_ticks ();
+  fprintf (stdout, "%i failed lookups:  %8.1f ns/item\n", LOOKUPS,
+           (end - start) * 1000.0 / LOOKUPS);
+
+  babl_free (items);
+  babl_free (db);
+
+  if (!OK)
+    {
+      fprintf (stdout, "lookups returned wrong items\n");
+      return -1;
+    }
+  return 0;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  if (argv[1]) N_ITEMS = atoi (argv[1]);
+  babl_init ();
+  if (test ())
+    return -1;
+  babl_exit ();
+  return 0;
+}